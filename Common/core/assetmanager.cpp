@@ -17,6 +17,7 @@
 #include "util/directory.h"
 #include "util/multifilelib.h"
 #include "util/path.h"
+#include "util/sharedfilestream.h"
 #include "util/string_utils.h" // cbuf_to_string_and_free
 
 
@@ -255,7 +256,45 @@ AssetError AssetManager::RegisterAssetLib(const String &path, AssetLibEx *&out_l
     return kAssetNoError;
 }
 
+void AssetManager::GetLibraryLocations(std::vector<AssetLibLocations> &libs, const String &filter) const
+{
+    for (const auto *lib : _activeLibs)
+    {
+        if (!lib->TestFilter(filter)) continue; // filter does not match
+
+        AssetLibLocations lib_locs;
+        if (IsAssetLibDir(lib))
+        {
+            lib_locs.BaseDir = lib->BaseDir;
+        }
+        else
+        {
+            for (const auto &a : lib->AssetInfos)
+            {
+                if (lib->RealLibFiles[a.LibUid].IsEmpty())
+                    continue;
+                AssetLocation loc;
+                loc.FileName = lib->RealLibFiles[a.LibUid];
+                loc.Offset = a.Offset;
+                loc.Size = a.Size;
+                lib_locs.Assets.emplace_back(a.FileName, loc);
+            }
+        }
+        libs.push_back(std::move(lib_locs));
+    }
+}
+
 Stream *AssetManager::OpenAsset(const String &asset_name, const String &filter) const
+{
+    return OpenAssetImpl(asset_name, filter, false);
+}
+
+Stream *AssetManager::OpenAssetShared(const String &asset_name, const String &filter) const
+{
+    return OpenAssetImpl(asset_name, filter, true);
+}
+
+Stream *AssetManager::OpenAssetImpl(const String &asset_name, const String &filter, bool shared) const
 {
     for (const auto *lib : _activeLibs)
     {
@@ -265,14 +304,14 @@ Stream *AssetManager::OpenAsset(const String &asset_name, const String &filter)
         if (IsAssetLibDir(lib))
             s = OpenAssetFromDir(lib, asset_name);
         else
-            s = OpenAssetFromLib(lib, asset_name);
+            s = OpenAssetFromLib(lib, asset_name, shared);
         if (s)
             return s;
     }
     return nullptr;
 }
 
-Stream *AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const
+Stream *AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name, bool shared) const
 {
     for (const auto &a : lib->AssetInfos)
     {
@@ -281,6 +320,15 @@ Stream *AssetManager::OpenAssetFromLib(const AssetLibEx *lib, const String &asse
             String libfile = lib->RealLibFiles[a.LibUid];
             if (libfile.IsEmpty())
                 return nullptr;
+            if (shared)
+            {
+                // If the library file cannot be opened as a shared file
+                // (e.g. it's located in the Android assets), then fallback
+                // to opening a regular file stream
+                auto file = SharedFile::Open(libfile);
+                if (file)
+                    return new SharedFileStream(file, a.Offset, a.Offset + a.Size);
+            }
             return File::OpenFile(libfile, a.Offset, a.Offset + a.Size);
         }
     }
@@ -30,6 +30,8 @@
 #define __AGS_CN_CORE__ASSETMANAGER_H
 
 #include <memory>
+#include <utility>
+#include <vector>
 #include "core/asset.h"
 #include "util/file.h" // TODO: extract filestream mode constants or introduce generic ones
 
@@ -64,6 +66,23 @@ struct AssetPath
     AssetPath(const String &name = "", const String &filter = "") : Name(name), Filter(filter) {}
 };
 
+// AssetLocation tells where the asset's data is stored: the real file
+// and the section of that file
+struct AssetLocation
+{
+    String FileName;
+    soff_t Offset = 0;
+    soff_t Size = 0;
+};
+
+// AssetLibLocations tells where the assets of a single library are stored;
+// a directory library only tells its directory, the files are not listed
+struct AssetLibLocations
+{
+    String BaseDir; // directory, if it's a directory library
+    std::vector<std::pair<String, AssetLocation>> Assets; // asset names and locations
+};
+
 
 class AssetManager
 {
@@ -100,12 +119,21 @@ public:
     // assets using given wildcard pattern
     void         FindAssets(std::vector<String> &assets, const String &wildcard,
                                    const String &filter = "") const;
+    // Collects the locations of the assets of all the libraries matching
+    // the filter, in the order in which the libraries are searched
+    void         GetLibraryLocations(std::vector<AssetLibLocations> &libs, const String &filter = "") const;
     // Open asset stream in the given work mode; returns null if asset is not found or cannot be opened
     // This method only searches in libraries that do not have any defined filters
     Stream      *OpenAsset(const String &asset_name) const;
     // Open asset stream, providing a single filter to search in matching libraries
     Stream      *OpenAsset(const String &asset_name, const String &filter) const;
     inline Stream *OpenAsset(const AssetPath &apath) const { return OpenAsset(apath.Name, apath.Filter); }
+    // Open asset stream for reading, which shares a file handle with all the other
+    // shared streams from the same library file. This is meant for streams which are
+    // kept open for a long time, and of which many may exist at once (e.g. streamed sounds).
+    // Assets from the directories are opened as regular files.
+    Stream      *OpenAssetShared(const String &asset_name, const String &filter = "") const;
+    inline Stream *OpenAssetShared(const AssetPath &apath) const { return OpenAssetShared(apath.Name, apath.Filter); }
 
 private:
     // AssetLibEx combines library info with extended internal data required for the manager
@@ -120,8 +148,10 @@ private:
     // Loads library and registers its contents into the cache
     AssetError  RegisterAssetLib(const String &path, AssetLibEx *&lib);
 
+    // Searches for the asset in all the registered locations, and opens a stream for reading
+    Stream     *OpenAssetImpl(const String &asset_name, const String &filter, bool shared) const;
     // Tries to find asset in the given location, and then opens a stream for reading
-    Stream     *OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name) const;
+    Stream     *OpenAssetFromLib(const AssetLibEx *lib, const String &asset_name, bool shared) const;
     Stream     *OpenAssetFromDir(const AssetLibEx *lib, const String &asset_name) const;
 
     std::vector<std::unique_ptr<AssetLibEx>> _libs;
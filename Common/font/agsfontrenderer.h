@@ -92,6 +92,11 @@ public:
     virtual void GetFontMetrics(int fontNumber, FontMetrics *metrics) = 0;
     // Perform any necessary adjustments when the AA mode is toggled
     virtual void AdjustFontForAntiAlias(int fontNumber, bool aa_mode) = 0;
+    // Gets the horizontal advance of a single character, passed as a string
+    // in the current text encoding. The width of any line of text must be
+    // equal to the sum of its characters' advances (that is: no kerning),
+    // which lets the engine cache these and measure text incrementally.
+    virtual int GetCharAdvance(const char *ch, int fontNumber) = 0;
 
 protected:
     IAGSFontRendererInternal() = default;
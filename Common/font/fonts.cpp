@@ -13,15 +13,18 @@
 //=============================================================================
 #include <algorithm>
 #include <cstdio>
+#include <unordered_map>
 #include <vector>
 #include <alfont.h>
 #include "ac/common.h" // set_our_eip
 #include "ac/gamestructdefines.h"
+#include "debug/out.h"
 #include "font/fonts.h"
 #include "font/ttffontrenderer.h"
 #include "font/wfnfontrenderer.h"
 #include "gfx/bitmap.h"
 #include "gui/guidefines.h" // MAXLINE
+#include "util/lrucache.h"
 #include "util/string_utils.h"
 #include "util/utf8.h"
 
@@ -48,6 +51,11 @@ struct Font
     FontMetrics         Metrics;
     // Precalculated linespacing, based on font properties and compat settings
     int                 LineSpacingCalc = 0;
+    // Cached character advances, for measuring text incrementally;
+    // only supported by the built-in renderers
+    std::vector<int>    AsciiAdvances; // -1 means not cached yet
+    std::unordered_map<int, int> Advances;
+    int                 AdvancesFormat = 0; // text format of the cached advances
 
     // Outline buffers
     Bitmap TextStencil, TextStencilSub;
@@ -63,6 +71,49 @@ static std::vector<Font> fonts;
 static TTFFontRenderer ttfRenderer;
 static WFNFontRenderer wfnRenderer;
 
+// Key for the text measurement caches
+struct TextCacheKey
+{
+    std::string Text;
+    int Font = 0;
+    int Width = 0; // wrapping width, or 0 if not wrapped
+    size_t MaxLines = 0;
+    int Format = 0; // text encoding
+
+    TextCacheKey(const char *text, int font, int width = 0, size_t max_lines = 0)
+        : Text(text), Font(font), Width(width), MaxLines(max_lines), Format(get_uformat()) {}
+
+    bool operator==(const TextCacheKey &other) const
+    {
+        return (Font == other.Font) && (Width == other.Width) && (MaxLines == other.MaxLines) &&
+            (Format == other.Format) && (Text == other.Text);
+    }
+};
+
+struct TextCacheKeyHash
+{
+    size_t operator()(const TextCacheKey &key) const
+    {
+        size_t hash = std::hash<std::string>()(key.Text);
+        hash = hash * 31 + std::hash<int>()(key.Font);
+        hash = hash * 31 + std::hash<int>()(key.Width);
+        return hash * 31 + std::hash<size_t>()(key.MaxLines);
+    }
+};
+
+// Results of splitting the same texts into lines
+static LRUCache<TextCacheKey, std::vector<String>, TextCacheKeyHash> LayoutCache(256);
+// Results of measuring the same texts' width
+static LRUCache<TextCacheKey, int, TextCacheKeyHash> WidthCache(1024);
+
+// Disposes the cached text measurements; this must be done whenever any font
+// changes, because this may affect the texts in other fonts which use it for outline
+static void reset_text_cache()
+{
+    LayoutCache.Clear();
+    WidthCache.Clear();
+}
+
 
 FontInfo::FontInfo()
     : Flags(0)
@@ -84,6 +135,9 @@ void init_font_renderer()
 
 void shutdown_font_renderer()
 {
+  const TextCacheStats stats = get_text_cache_stats();
+  Debug::Printf(kDbgMsg_Info, "Text cache: layouts %zu hits, %zu misses; widths %zu hits, %zu misses",
+      stats.LayoutHits, stats.LayoutMisses, stats.WidthHits, stats.WidthMisses);
   set_our_eip(9919);
   alfont_exit();
 }
@@ -105,10 +159,19 @@ bool is_font_loaded(size_t fontNumber)
     return fontNumber < fonts.size() && fonts[fontNumber].Renderer != nullptr;
 }
 
+// Disposes cached character advances
+static void font_reset_advances(Font &font)
+{
+    font.AsciiAdvances.clear();
+    font.Advances.clear();
+}
+
 // Finish font's initialization
 static void font_post_init(size_t fontNumber)
 {
     Font &font = fonts[fontNumber];
+    font_reset_advances(font);
+    reset_text_cache();
     // If no font height property was provided, then try several methods,
     // depending on which interface is available
     if ((font.Metrics.Height == 0) && font.Renderer)
@@ -257,13 +320,44 @@ int get_text_width(const char *texx, size_t fontNumber)
   return fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
 }
 
-int get_text_width_outlined(const char *text, size_t font_number)
+bool can_measure_by_advances(size_t font_number)
 {
-    if (font_number >= fonts.size() || !fonts[font_number].Renderer)
-        return 0;
-    if(text == nullptr || text[0] == 0) // we ignore outline width since the text is empty
-        return 0;
+    if (font_number >= fonts.size() || !fonts[font_number].RendererInt)
+        return false;
+    const int outline = fonts[font_number].Info.Outline;
+    if (outline < 0)
+        return true; // FONT_OUTLINE_AUTO or FONT_OUTLINE_NONE
+    return static_cast<size_t>(outline) < fonts.size() && fonts[outline].RendererInt;
+}
+
+int get_char_advance(size_t font_number, int code, const char *ch)
+{
+    Font &font = fonts[font_number];
+    if (code >= 0 && code < 128)
+    {
+        if (font.AsciiAdvances.empty())
+            font.AsciiAdvances.resize(128, -1);
+        int &advance = font.AsciiAdvances[code];
+        if (advance < 0)
+            advance = font.RendererInt->GetCharAdvance(ch, font_number);
+        return advance;
+    }
+    // Other characters may be encoded differently, depending on the text format
+    if (font.AdvancesFormat != get_uformat())
+    {
+        font.Advances.clear();
+        font.AdvancesFormat = get_uformat();
+    }
+    auto it = font.Advances.find(code);
+    if (it != font.Advances.end())
+        return it->second;
+    const int advance = font.RendererInt->GetCharAdvance(ch, font_number);
+    font.Advances.insert(std::make_pair(code, advance));
+    return advance;
+}
 
+static int get_text_width_outlined_impl(const char *text, size_t font_number)
+{
     int self_width = fonts[font_number].Renderer->GetTextWidth(text, font_number);
     int outline = fonts[font_number].Info.Outline;
     if (outline < 0 || static_cast<size_t>(outline) > fonts.size())
@@ -274,6 +368,35 @@ int get_text_width_outlined(const char *text, size_t font_number)
     return std::max(self_width, outline_width);
 }
 
+int get_text_width_outlined(const char *text, size_t font_number)
+{
+    if (font_number >= fonts.size() || !fonts[font_number].Renderer)
+        return 0;
+    if(text == nullptr || text[0] == 0) // we ignore outline width since the text is empty
+        return 0;
+    // Only built-in renderers are known to measure same text consistently
+    if (!can_measure_by_advances(font_number))
+        return get_text_width_outlined_impl(text, font_number);
+
+    TextCacheKey key(text, font_number);
+    const int *cached = WidthCache.Get(key);
+    if (cached)
+        return *cached;
+    const int width = get_text_width_outlined_impl(text, font_number);
+    WidthCache.Put(key, width);
+    return width;
+}
+
+TextCacheStats get_text_cache_stats()
+{
+    TextCacheStats stats;
+    stats.LayoutHits = LayoutCache.GetHits();
+    stats.LayoutMisses = LayoutCache.GetMisses();
+    stats.WidthHits = WidthCache.GetHits();
+    stats.WidthMisses = WidthCache.GetMisses();
+    return stats;
+}
+
 int get_font_outline(size_t font_number)
 {
     if (font_number >= fonts.size())
@@ -296,6 +419,7 @@ void set_font_outline(size_t font_number, int outline_type,
     fonts[font_number].Info.Outline = outline_type;
     fonts[font_number].Info.AutoOutlineStyle = style;
     fonts[font_number].Info.AutoOutlineThickness = thickness;
+    reset_text_cache();
 }
 
 bool is_font_antialiased(size_t font_number)
@@ -405,7 +529,7 @@ static void unescape_script_string(const char *cstr, std::string &out)
 }
 
 // Break up the text into lines
-size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
+static size_t split_lines_impl(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
     // NOTE: following hack accomodates for the legacy math mistake in split_lines.
     // It's hard to tell how cruicial it is for the game looks, so research may be needed.
     // TODO: IMHO this should rely not on game format, but script API level, because it
@@ -420,6 +544,16 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
     std::string &line_buf = lines.LineBuf[0];
     std::string &test_buf = lines.LineBuf[1];
 
+    // If supported by the fonts, then the line's width is accumulated from
+    // the cached character advances; otherwise the whole line has to be
+    // measured again after each added character.
+    const bool by_advances = can_measure_by_advances(fonnt);
+    const int outline = get_font_outline(fonnt);
+    const bool outline_font = by_advances && (outline >= 0);
+    const int auto_outline = outline_font ? 0 : 2 * get_font_outline_thickness(fonnt);
+    int self_width = 0; // accumulated line width in the main font
+    int outline_width = 0; // accumulated line width in the outline font
+
     // Do all necessary preliminary conversions: unescape, etc
     unescape_script_string(todis, line_buf);
 
@@ -456,9 +590,22 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
         } else {
             // copy next character to the test buffer and calculate its width
             char uch[Utf8::UtfSz + 1]{};
-            usetc(uch, ugetxc(&scan_ptr)); // this advances scan_ptr
+            const int ch = ugetxc(&scan_ptr); // this advances scan_ptr
+            usetc(uch, ch);
             test_buf.append(uch);
-            if (get_text_width_outlined(test_buf.c_str(), fonnt) > wii) {
+            int line_width;
+            if (by_advances) {
+                self_width += get_char_advance(fonnt, ch, uch);
+                if (outline_font) {
+                    outline_width += get_char_advance(outline, ch, uch);
+                    line_width = std::max(self_width, outline_width);
+                } else {
+                    line_width = self_width + auto_outline;
+                }
+            } else {
+                line_width = get_text_width_outlined(test_buf.c_str(), fonnt);
+            }
+            if (line_width > wii) {
                 // line is too wide, order the split
                 if (last_whitespace)
                     // revert to the last whitespace
@@ -480,6 +627,7 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
             test_buf.resize(split_at - theline); // cut the buffer at the split index
             lines.Add(test_buf.c_str());
             test_buf.clear();
+            self_width = outline_width = 0;
             // check if too many lines
             if (lines.Count() >= max_lines) {
                 lines[lines.Count() - 1].Append("...");
@@ -498,6 +646,28 @@ size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, siz
     return lines.Count();
 }
 
+size_t split_lines(const char *todis, SplitLines &lines, int wii, int fonnt, size_t max_lines) {
+    // Only built-in renderers are known to measure same text consistently
+    if ((fonnt < 0) || !can_measure_by_advances(fonnt))
+        return split_lines_impl(todis, lines, wii, fonnt, max_lines);
+
+    TextCacheKey key(todis, fonnt, wii, max_lines);
+    const auto *cached = LayoutCache.Get(key);
+    if (cached)
+    {
+        lines.Reset();
+        for (const auto &line : *cached)
+            lines.Add(line);
+        return lines.Count();
+    }
+    split_lines_impl(todis, lines, wii, fonnt, max_lines);
+    std::vector<String> cache_lines(lines.Count());
+    for (size_t i = 0; i < lines.Count(); ++i)
+        cache_lines[i] = lines[i];
+    LayoutCache.Put(key, std::move(cache_lines));
+    return lines.Count();
+}
+
 void wouttextxy(Common::Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t text_color, const char *texx)
 {
   if (fontNumber >= fonts.size())
@@ -610,7 +780,9 @@ void adjust_fonts_for_render_mode(bool aa_mode)
     {
         if (fonts[i].RendererInt)
             fonts[i].RendererInt->AdjustFontForAntiAlias(i, aa_mode);
+        font_reset_advances(fonts[i]);
     }
+    reset_text_cache();
 }
 
 void wfreefont(size_t fontNumber)
@@ -626,6 +798,8 @@ void wfreefont(size_t fontNumber)
     fonts[fontNumber].Renderer->FreeMemory(fontNumber);
 
   fonts[fontNumber].Renderer = nullptr;
+  font_reset_advances(fonts[fontNumber]);
+  reset_text_cache();
 }
 
 void free_all_fonts()
@@ -636,4 +810,5 @@ void free_all_fonts()
             fonts[i].Renderer->FreeMemory(i);
     }
     fonts.clear();
+    reset_text_cache();
 }
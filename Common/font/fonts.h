@@ -57,6 +57,23 @@ int get_font_scaling_mul(size_t fontNumber);
 int get_text_width(const char *texx, size_t fontNumber);
 // Get the maximal width of the given font, with corresponding outlining
 int get_text_width_outlined(const char *text, size_t font_number);
+// Statistics of the text measurement caches, which keep the results
+// of split_lines and get_text_width_outlined for the recently used texts
+struct TextCacheStats
+{
+    size_t LayoutHits = 0;
+    size_t LayoutMisses = 0;
+    size_t WidthHits = 0;
+    size_t WidthMisses = 0;
+};
+// Gets the text measurement caches statistics
+TextCacheStats get_text_cache_stats();
+// Tells if the text in this font may be measured by the character advances;
+// this requires the same support from its outline font
+bool can_measure_by_advances(size_t font_number);
+// Gets the advance of a character, passed both as a code and as an encoded string;
+// the font must support measuring by advances
+int get_char_advance(size_t font_number, int code, const char *ch);
 // Get font's height; this value is used for logical arrangement of UI elements;
 // note that this is a "formal" font height, that may have different value
 // depending on compatibility mode (used when running old games);
@@ -126,6 +143,11 @@ public:
         if (_pool.size() == _count) _pool.resize(_count + 1);
         _pool[_count++].SetString(cstr);
     }
+    inline void Add(const Common::String &str)
+    {
+        if (_pool.size() == _count) _pool.resize(_count + 1);
+        _pool[_count++] = str;
+    }
 
     // Auxiliary line processing buffers
     std::string LineBuf[2];
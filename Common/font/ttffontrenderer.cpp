@@ -42,6 +42,14 @@ int TTFFontRenderer::GetTextWidth(const char *text, int fontNumber)
   return alfont_text_length(_fontData[fontNumber].AlFont, text);
 }
 
+int TTFFontRenderer::GetCharAdvance(const char *ch, int fontNumber)
+{
+  // alfont does not apply kerning, and we never set italic styles which
+  // add extra width to the last character, so the text length is always
+  // the sum of the character lengths
+  return alfont_text_length(_fontData[fontNumber].AlFont, ch);
+}
+
 int TTFFontRenderer::GetTextHeight(const char * /*text*/, int fontNumber)
 {
   return alfont_get_font_real_height(_fontData[fontNumber].AlFont);
@@ -45,6 +45,7 @@ public:
       FontMetrics *metrics) override;
   void GetFontMetrics(int fontNumber, FontMetrics *metrics) override;
   void AdjustFontForAntiAlias(int fontNumber, bool aa_mode) override;
+  int GetCharAdvance(const char *ch, int fontNumber) override;
 
   //
   // Utility functions
@@ -45,6 +45,7 @@ public:
       FontMetrics *metrics) override;
   void GetFontMetrics(int fontNumber, FontMetrics *metrics) override { *metrics = FontMetrics(); }
   void AdjustFontForAntiAlias(int /*fontNumber*/, bool /*aa_mode*/) override { /* do nothing */}
+  int GetCharAdvance(const char *ch, int fontNumber) override { return GetTextWidth(ch, fontNumber); }
 
 private:
   struct FontData
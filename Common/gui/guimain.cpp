@@ -156,6 +156,22 @@ const std::vector<int> &GUIMain::GetControlsDrawOrder() const
     return _ctrlDrawOrder;
 }
 
+Rect GUIMain::GetControlDrawArea(int index) const
+{
+    if (index < 0 || (size_t)index >= _controls.size())
+        return Rect();
+    if ((all_buttons_disabled >= 0) && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
+        return Rect(); // controls are not drawn
+    GUIObject *obj = _controls[index];
+    if (!obj->IsVisible() || (obj->Width <= 0 || obj->Height <= 0))
+        return Rect();
+    if (!obj->IsEnabled() && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
+        return Rect();
+    // Include control's logical bounds, as selection marks are drawn over them
+    const Rect rc = obj->CalcGraphicRect(GUI::Options.ClipControls && obj->IsContentClipped());
+    return OffsetRect(SumRects(rc, RectWH(0, 0, obj->Width, obj->Height)), Point(obj->X, obj->Y));
+}
+
 bool GUIMain::IsClickable() const
 {
     return (_flags & kGUIMain_Clickable) != 0;
@@ -289,11 +305,25 @@ void GUIMain::DrawSelf(Bitmap *ds)
 
 void GUIMain::DrawWithControls(Bitmap *ds)
 {
-    ds->ResetClip();
+    DrawWithControls(ds, RectWH(0, 0, ds->GetWidth(), ds->GetHeight()));
+}
+
+void GUIMain::DrawWithControls(Bitmap *ds, const Rect &area)
+{
+    const Rect draw_area = IntersectRects(area, RectWH(0, 0, ds->GetWidth(), ds->GetHeight()));
+    if (draw_area.IsEmpty())
+        return;
+    ds->SetClip(draw_area);
+    // GUI background may be partially transparent, so erase the old image first
+    if (draw_area.GetWidth() < ds->GetWidth() || draw_area.GetHeight() < ds->GetHeight())
+        ds->ClearTransparent();
     DrawSelf(ds);
 
     if ((all_buttons_disabled >= 0) && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
+    {
+        ds->ResetClip();
         return; // don't draw GUI controls
+    }
 
     Bitmap tempbmp; // in case we need transforms
     for (size_t ctrl_index = 0; ctrl_index < _controls.size(); ++ctrl_index)
@@ -302,18 +332,17 @@ void GUIMain::DrawWithControls(Bitmap *ds)
 
         GUIObject *objToDraw = _controls[_ctrlDrawOrder[ctrl_index]];
 
-        if (!objToDraw->IsVisible() || (objToDraw->Width <= 0 || objToDraw->Height <= 0))
-            continue;
-        if (!objToDraw->IsEnabled() && (GUI::Options.DisabledStyle == kGuiDis_Blackout))
+        const Rect obj_area = GetControlDrawArea(_ctrlDrawOrder[ctrl_index]);
+        if (obj_area.IsEmpty() || !AreRectsIntersecting(obj_area, draw_area))
             continue;
 
         // Depending on draw properties - draw directly on the gui surface, or use a buffer
         if (objToDraw->GetTransparency() == 0)
         {
             if (GUI::Options.ClipControls && objToDraw->IsContentClipped())
-                ds->SetClip(RectWH(objToDraw->X, objToDraw->Y, objToDraw->Width, objToDraw->Height));
+                ds->SetClip(IntersectRects(draw_area, RectWH(objToDraw->X, objToDraw->Y, objToDraw->Width, objToDraw->Height)));
             else
-                ds->ResetClip();
+                ds->SetClip(draw_area);
             objToDraw->Draw(ds, objToDraw->X, objToDraw->Y);
         }
         else
@@ -321,6 +350,7 @@ void GUIMain::DrawWithControls(Bitmap *ds)
             const Rect rc = objToDraw->CalcGraphicRect(GUI::Options.ClipControls && objToDraw->IsContentClipped());
             tempbmp.CreateTransparent(rc.GetWidth(), rc.GetHeight());
             objToDraw->Draw(&tempbmp, -rc.Left, -rc.Top);
+            ds->SetClip(draw_area);
             draw_gui_sprite(ds, true, objToDraw->X + rc.Left, objToDraw->Y + rc.Top,
                 &tempbmp, objToDraw->HasAlphaChannel(), kBlendMode_Alpha,
                 GfxDef::LegacyTrans255ToAlpha255(objToDraw->GetTransparency()));
@@ -356,6 +386,7 @@ void GUIMain::DrawWithControls(Bitmap *ds)
         }
     }
 
+    ds->ResetClip();
     SET_EIP(380);
 }
 
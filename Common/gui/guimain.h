@@ -113,6 +113,9 @@ public:
     int32_t GetControlID(int index) const;
     // Gets an array of child control indexes in the z-order, from bottom to top
     const std::vector<int> &GetControlsDrawOrder() const;
+    // Gets the area which child control's image occupies on the GUI surface,
+    // in GUI's coordinates; returns empty rect if the control is not drawn
+    Rect    GetControlDrawArea(int index) const;
 
     // Child control management
     // Note that currently GUIMain does not own controls (should not delete them)
@@ -123,6 +126,9 @@ public:
     bool    BringControlToFront(int index);
     void    DrawSelf(Bitmap *ds);
     void    DrawWithControls(Bitmap *ds);
+    // Redraws only the given area of the GUI surface: the GUI's background
+    // and all the controls which overlap it, clipped by this area
+    void    DrawWithControls(Bitmap *ds, const Rect &area);
     // Polls GUI state, providing current cursor (mouse) coordinates
     void    Poll(int mx, int my);
     HError  RebuildArray();
@@ -18,7 +18,7 @@
 
 using namespace AGS::Common;
 
-int ccCompOptions = SCOPT_LEFTTORIGHT;
+CC_THREAD_LOCAL int ccCompOptions = SCOPT_LEFTTORIGHT;
 
 void ccSetOption(int optbit, int onoroff)
 {
@@ -39,7 +39,7 @@ int ccGetOption(int optbit)
 // Returns current running script callstack as a human-readable text
 extern String cc_get_callstack(int max_lines = INT_MAX);
 
-static ScriptError ccError;
+static CC_THREAD_LOCAL ScriptError ccError;
 
 void cc_clear_error()
 {
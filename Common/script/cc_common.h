@@ -20,6 +20,14 @@
 
 #include "util/string.h"
 
+// The script compiler may be built for compiling multiple scripts at once,
+// on separate threads; in such case each thread has its own compilation state.
+#if defined(AGS_CC_THREADSAFE)
+#define CC_THREAD_LOCAL thread_local
+#else
+#define CC_THREAD_LOCAL
+#endif
+
 #define SCOPT_EXPORTALL      1   // export all functions automatically
 #define SCOPT_SHOWWARNINGS   2   // printf warnings to console
 #define SCOPT_LINENUMBERS    4   // include line numbers in compiled code
@@ -29,6 +37,7 @@
 #define SCOPT_LEFTTORIGHT 0x40   // left-to-right operator precedance
 #define SCOPT_OLDSTRINGS  0x80   // allow old-style strings
 #define SCOPT_UTF8        0x100  // UTF-8 text mode
+#define SCOPT_OPTIMIZE    0x200  // optimize the compiled bytecode
 
 extern void ccSetOption(int, int);
 extern int ccGetOption(int);
@@ -52,6 +61,6 @@ void cc_error(const ScriptError &err);
 // Project-dependent script error formatting
 AGS::Common::String cc_format_error(const AGS::Common::String &message);
 
-extern int currentline;
+extern CC_THREAD_LOCAL int currentline;
 
 #endif // __CC_ERROR_H
@@ -23,7 +23,7 @@
 using namespace AGS::Common;
 
 // currently executed line
-int currentline;
+CC_THREAD_LOCAL int currentline;
 // script file format signature
 const char scfilesig[5] = "SCOM";
 
@@ -171,7 +171,7 @@ ccScript::~ccScript()
     Free();
 }
 
-void ccScript::Write(Stream *out) {
+void ccScript::Write(Stream *out) const {
     int n;
     out->Write(scfilesig,4);
     out->WriteInt32(SCOM_VERSION);
@@ -59,7 +59,7 @@ public:
     virtual ~ccScript(); // there are few derived classes, so dtor should be virtual
 
     // write the script to disk (after compiling)
-    void        Write(Common::Stream *out);
+    void        Write(Common::Stream *out) const;
     // read back a script written with Write
     bool        Read(Common::Stream *in);
     const char* GetSectionName(int32_t offset) const;
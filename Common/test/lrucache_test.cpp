@@ -0,0 +1,52 @@
+#include <string>
+#include "gtest/gtest.h"
+#include "util/lrucache.h"
+
+using namespace AGS::Common;
+
+TEST(LRUCache, PutGet) {
+    LRUCache<std::string, int> cache(4);
+    ASSERT_EQ(cache.Get("one"), nullptr);
+    cache.Put("one", 1);
+    cache.Put("two", 2);
+    ASSERT_EQ(cache.GetCount(), 2u);
+    ASSERT_NE(cache.Get("one"), nullptr);
+    ASSERT_EQ(*cache.Get("one"), 1);
+    ASSERT_EQ(*cache.Get("two"), 2);
+    // Replace existing value
+    cache.Put("two", 22);
+    ASSERT_EQ(cache.GetCount(), 2u);
+    ASSERT_EQ(*cache.Get("two"), 22);
+    ASSERT_EQ(cache.GetHits(), 4u);
+    ASSERT_EQ(cache.GetMisses(), 1u);
+    cache.ResetStats();
+    ASSERT_EQ(cache.GetHits(), 0u);
+    ASSERT_EQ(cache.GetMisses(), 0u);
+    cache.Clear();
+    ASSERT_EQ(cache.GetCount(), 0u);
+    ASSERT_EQ(cache.Get("one"), nullptr);
+}
+
+TEST(LRUCache, Eviction) {
+    LRUCache<int, int> cache(3);
+    cache.Put(1, 10);
+    cache.Put(2, 20);
+    cache.Put(3, 30);
+    // Touch the oldest item, so that the next one becomes least recently used
+    ASSERT_NE(cache.Get(1), nullptr);
+    cache.Put(4, 40);
+    ASSERT_EQ(cache.GetCount(), 3u);
+    ASSERT_EQ(cache.Get(2), nullptr);
+    ASSERT_NE(cache.Get(1), nullptr);
+    ASSERT_NE(cache.Get(3), nullptr);
+    ASSERT_NE(cache.Get(4), nullptr);
+    // Shrinking removes the least recently used items
+    cache.SetMaxCount(1);
+    ASSERT_EQ(cache.GetCount(), 1u);
+    ASSERT_NE(cache.Get(4), nullptr);
+    // Zero size disables the cache
+    cache.SetMaxCount(0);
+    cache.Put(5, 50);
+    ASSERT_EQ(cache.GetCount(), 0u);
+    ASSERT_EQ(cache.Get(5), nullptr);
+}
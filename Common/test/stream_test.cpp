@@ -5,6 +5,7 @@
 #include "util/alignedstream.h"
 #include "util/bufferedstream.h"
 #include "util/memorystream.h"
+#include "util/sharedfilestream.h"
 #include "util/string_utils.h"
 
 using namespace AGS::Common;
@@ -589,6 +590,79 @@ TEST_F(FileBasedTest, BufferedSectionStream) {
     File::DeleteFile(DummyFile);
 }
 
+TEST_F(FileBasedTest, SharedFileStream) {
+    //-------------------------------------------------------------------------
+    // Write data into the temp file
+    FileStream out(DummyFile, kFile_CreateAlways, kFile_Write);
+    out.WriteInt32(0);
+    out.WriteInt32(1);
+    out.WriteInt32(2);
+    out.WriteInt32(3);
+    // fill in to ensure that the stream has to refill its buffer
+    out.WriteByteCount(0xFF, SharedFileStream::BufferSize);
+    const auto section1_start = out.GetPosition();
+    out.WriteInt32(4);
+    out.WriteInt32(5);
+    out.WriteInt32(6);
+    out.WriteInt32(7);
+    const auto section1_end = out.GetPosition();
+    out.Close();
+
+    //-------------------------------------------------------------------------
+    // Same file is shared by all the readers
+    auto file = SharedFile::Open(DummyFile);
+    ASSERT_TRUE(file);
+    ASSERT_EQ(file, SharedFile::Open(DummyFile));
+    ASSERT_EQ(file->GetLength(), section1_end);
+
+    // Interleaved reading from two sections does not affect each other
+    SharedFileStream in1(file, 0, 4 * sizeof(int32_t));
+    SharedFileStream in2(file, section1_start, section1_end);
+    ASSERT_TRUE(in1.CanRead());
+    ASSERT_TRUE(in2.CanSeek());
+    ASSERT_FALSE(in2.CanWrite());
+    ASSERT_EQ(in2.GetPosition(), 0);
+    ASSERT_EQ(in2.GetLength(), section1_end - section1_start);
+    ASSERT_EQ(in1.ReadInt32(), 0);
+    ASSERT_EQ(in2.ReadInt32(), 4);
+    ASSERT_EQ(in1.ReadInt32(), 1);
+    ASSERT_EQ(in2.ReadInt32(), 5);
+    ASSERT_EQ(in1.ReadInt32(), 2);
+    ASSERT_EQ(in2.ReadInt32(), 6);
+    ASSERT_EQ(in1.ReadInt32(), 3);
+    ASSERT_EQ(in2.ReadInt32(), 7);
+    ASSERT_TRUE(in1.EOS());
+    ASSERT_TRUE(in2.EOS());
+    // reading past section end - results in no data
+    char temp[10];
+    ASSERT_EQ(in1.ReadByte(), -1);
+    ASSERT_EQ(in1.Read(temp, sizeof(temp)), 0);
+    ASSERT_EQ(in1.GetPosition(), 4 * sizeof(int32_t));
+
+    // Test seeks limited to the section
+    ASSERT_FALSE(in2.Seek(-1, kSeekBegin));
+    ASSERT_EQ(in2.GetPosition(), 0);
+    ASSERT_TRUE(in2.Seek(2 * sizeof(int32_t), kSeekBegin));
+    ASSERT_EQ(in2.ReadInt32(), 6);
+    ASSERT_FALSE(in2.Seek(1, kSeekEnd));
+    ASSERT_TRUE(in2.EOS());
+
+    // Large reads go directly into the user's buffer, and are limited too
+    SharedFileStream in3(file, 0, section1_end);
+    std::vector<uint8_t> buf(SharedFileStream::BufferSize * 2);
+    ASSERT_EQ(in3.Read(buf.data(), buf.size()), section1_end);
+    ASSERT_EQ(buf[0], 0);
+    ASSERT_EQ(buf[section1_start], 4);
+    ASSERT_TRUE(in3.EOS());
+
+    // Section is clamped to the file length
+    SharedFileStream in4(file, section1_start, section1_end + 100);
+    ASSERT_EQ(in4.GetLength(), section1_end - section1_start);
+    in1.Close();
+    ASSERT_FALSE(in1.IsValid());
+    ASSERT_EQ(in1.ReadInt32(), 0);
+}
+
 #endif // AGS_PLATFORM_TEST_FILE_IO
 
 
@@ -272,6 +272,9 @@ TEST(String, FactoryMethods) {
     ASSERT_TRUE(strcmp(s1.GetCStr(), "some string") == 0);
     s1.SetString("some string", 4);
     ASSERT_TRUE(strcmp(s1.GetCStr(), "some") == 0);
+    const char unterminated[4] = { 'a', 'b', 'c', 'd' };
+    s1.SetString(unterminated, sizeof(unterminated));
+    ASSERT_TRUE(strcmp(s1.GetCStr(), "abcd") == 0);
 }
 
 TEST(String, LowerUpperCase) {
@@ -0,0 +1,124 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// LRUCache is a key-value storage of limited capacity: when it is full,
+// the least recently used item is removed to make room for the new one.
+// The cache counts its hits and misses, which may be used to measure its
+// efficiency.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__LRUCACHE_H
+#define __AGS_CN_UTIL__LRUCACHE_H
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace AGS
+{
+namespace Common
+{
+
+template <typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class LRUCache
+{
+public:
+    explicit LRUCache(size_t max_count)
+        : _maxCount(max_count) {}
+
+    size_t GetCount() const { return _lookup.size(); }
+    size_t GetMaxCount() const { return _maxCount; }
+    size_t GetHits() const { return _hits; }
+    size_t GetMisses() const { return _misses; }
+
+    // Sets the max number of cached items, removes the extra items if necessary;
+    // passing 0 disables the cache
+    void SetMaxCount(size_t max_count)
+    {
+        _maxCount = max_count;
+        Trim(_maxCount);
+    }
+
+    // Finds the cached value and marks it as the most recently used;
+    // returns null if no value is cached for this key
+    const TValue *Get(const TKey &key)
+    {
+        auto it = _lookup.find(key);
+        if (it == _lookup.end())
+        {
+            _misses++;
+            return nullptr;
+        }
+        _hits++;
+        _items.splice(_items.begin(), _items, it->second);
+        return &it->second->second;
+    }
+
+    // Puts the value into the cache, replacing any existing value for this key
+    void Put(const TKey &key, TValue value)
+    {
+        if (_maxCount == 0)
+            return;
+        auto it = _lookup.find(key);
+        if (it != _lookup.end())
+        {
+            it->second->second = std::move(value);
+            _items.splice(_items.begin(), _items, it->second);
+            return;
+        }
+        Trim(_maxCount - 1);
+        _items.emplace_front(key, std::move(value));
+        _lookup.insert(std::make_pair(key, _items.begin()));
+    }
+
+    // Removes all the cached items
+    void Clear()
+    {
+        _items.clear();
+        _lookup.clear();
+    }
+
+    // Resets hits and misses counters
+    void ResetStats()
+    {
+        _hits = 0;
+        _misses = 0;
+    }
+
+private:
+    typedef std::list<std::pair<TKey, TValue>> ItemList;
+
+    // Removes least recently used items until there's no more than max_count left
+    void Trim(size_t max_count)
+    {
+        while (_lookup.size() > max_count)
+        {
+            _lookup.erase(_items.back().first);
+            _items.pop_back();
+        }
+    }
+
+    size_t _maxCount = 0;
+    size_t _hits = 0;
+    size_t _misses = 0;
+    // Items in the order of use, most recently used first
+    ItemList _items;
+    std::unordered_map<TKey, typename ItemList::iterator, THash> _lookup;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__LRUCACHE_H
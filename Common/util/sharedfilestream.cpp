@@ -0,0 +1,212 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "core/platform.h"
+#include "util/sharedfilestream.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#if !AGS_PLATFORM_OS_WINDOWS
+#include <errno.h>
+#include <unistd.h>
+#endif
+#include "util/stdio_compat.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+//-----------------------------------------------------------------------------
+// SharedFile
+//-----------------------------------------------------------------------------
+
+// Registry of the currently opened shared files; the records are removed
+// by the last owner of the file, which may be on any thread, so the keys
+// must not share their buffers with any String
+static std::mutex SharedFilesMutex;
+static std::unordered_map<std::string, std::weak_ptr<SharedFile>> SharedFiles;
+
+std::shared_ptr<SharedFile> SharedFile::Open(const String &file_name)
+{
+    const std::string key = file_name.GetCStr();
+    std::lock_guard<std::mutex> lk(SharedFilesMutex);
+    auto it = SharedFiles.find(key);
+    if (it != SharedFiles.end())
+    {
+        auto file = it->second.lock();
+        if (file)
+            return file;
+    }
+
+    FILE *f = ags_fopen(file_name.GetCStr(), "rb");
+    if (!f)
+        return nullptr;
+    soff_t length = -1;
+    if (ags_fseek(f, 0, SEEK_END) == 0)
+        length = ags_ftell(f);
+    if (length < 0)
+    {
+        fclose(f);
+        return nullptr;
+    }
+    std::shared_ptr<SharedFile> file(new SharedFile(f, key, length));
+    SharedFiles[key] = file;
+    return file;
+}
+
+SharedFile::SharedFile(FILE *file, const std::string &file_name, soff_t length)
+    : _file(file)
+    , _fileName(file_name)
+    , _length(length)
+{
+}
+
+SharedFile::~SharedFile()
+{
+    fclose(_file);
+    // Remove the expired record, unless the file was reopened meanwhile
+    std::lock_guard<std::mutex> lk(SharedFilesMutex);
+    auto it = SharedFiles.find(_fileName);
+    if (it != SharedFiles.end() && it->second.expired())
+        SharedFiles.erase(it);
+}
+
+size_t SharedFile::ReadAt(soff_t offset, void *buffer, size_t size)
+{
+    if (offset < 0 || offset >= _length)
+        return 0;
+    size = std::min(size, static_cast<size_t>(_length - offset));
+#if !AGS_PLATFORM_OS_WINDOWS
+    // Positioned reads do not change the file position, and may be
+    // done in parallel without locking
+    const int fd = fileno(_file);
+    uint8_t *to = static_cast<uint8_t*>(buffer);
+    size_t total = 0;
+    while (total < size)
+    {
+        const ssize_t sz = pread(fd, to + total, size - total, static_cast<off_t>(offset + total));
+        if (sz < 0 && errno == EINTR)
+            continue;
+        if (sz <= 0)
+            break;
+        total += static_cast<size_t>(sz);
+    }
+    return total;
+#else
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (ags_fseek(_file, offset, SEEK_SET) != 0)
+        return 0;
+    return fread(buffer, 1, size, _file);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// SharedFileStream
+//-----------------------------------------------------------------------------
+
+const size_t SharedFileStream::BufferSize;
+
+SharedFileStream::SharedFileStream(std::shared_ptr<SharedFile> file, soff_t start_pos, soff_t end_pos,
+        DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _file(file)
+{
+    if (!_file)
+        return;
+    end_pos = std::min(std::max(end_pos, (soff_t)0), _file->GetLength());
+    _start = std::min(std::max(start_pos, (soff_t)0), end_pos);
+    _end = end_pos;
+    _position = _start;
+    _bufferPosition = _start;
+}
+
+void SharedFileStream::Close()
+{
+    _file.reset();
+    _buffer.clear();
+    _start = _end = _position = _bufferPosition = 0;
+}
+
+void SharedFileStream::FillBufferFromPosition(soff_t position)
+{
+    // remember to restrict to the end position!
+    size_t fill_size = std::min(BufferSize, static_cast<size_t>(_end - position));
+    _buffer.resize(fill_size);
+    auto sz = _file->ReadAt(position, _buffer.data(), fill_size);
+    _buffer.resize(sz);
+    _bufferPosition = position;
+}
+
+size_t SharedFileStream::Read(void *buffer, size_t size)
+{
+    if (!_file)
+        return 0;
+    // If the read size is larger than the internal buffer size,
+    // then read directly into the user buffer and bail out.
+    if (size >= BufferSize)
+    {
+        size_t fill_size = std::min(size, static_cast<size_t>(_end - _position));
+        size_t sz = _file->ReadAt(_position, buffer, fill_size);
+        _position += sz;
+        return sz;
+    }
+
+    auto *to = static_cast<uint8_t*>(buffer);
+    while (size > 0)
+    {
+        if (_position < _bufferPosition || _position >= _bufferPosition + (soff_t)_buffer.size())
+        {
+            if (_position >= _end) { break; } // reached EOS
+            FillBufferFromPosition(_position);
+        }
+        if (_buffer.empty()) { break; } // read error
+
+        size_t bufferOffset = static_cast<size_t>(_position - _bufferPosition);
+        size_t chunkSize = std::min<size_t>(_buffer.size() - bufferOffset, size);
+        std::memcpy(to, _buffer.data() + bufferOffset, chunkSize);
+        to += chunkSize;
+        _position += chunkSize;
+        size -= chunkSize;
+    }
+    return to - static_cast<uint8_t*>(buffer);
+}
+
+int32_t SharedFileStream::ReadByte()
+{
+    uint8_t ch;
+    auto bytesRead = Read(&ch, 1);
+    if (bytesRead != 1) { return EOF; }
+    return ch;
+}
+
+bool SharedFileStream::Seek(soff_t offset, StreamSeek origin)
+{
+    if (!_file)
+        return false;
+    soff_t want_pos = -1;
+    switch(origin)
+    {
+        case StreamSeek::kSeekCurrent:  want_pos = _position   + offset; break;
+        case StreamSeek::kSeekBegin:    want_pos = _start      + offset; break;
+        case StreamSeek::kSeekEnd:      want_pos = _end        + offset; break;
+        default: return false;
+    }
+
+    // clamp
+    _position = std::min(std::max(want_pos, _start), _end);
+    return _position == want_pos;
+}
+
+} // namespace Common
+} // namespace AGS
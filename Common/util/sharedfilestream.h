@@ -0,0 +1,120 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// SharedFile is a read-only file handle which may be used by any number of
+// readers at once, including ones running on different threads. Reads are
+// done at the explicit offsets, so that readers do not disturb each other's
+// position. Only one SharedFile exists for the same path at any time: it's
+// opened by the first reader, and closed when the last reader releases it.
+//
+// SharedFileStream reads an arbitrary section of the SharedFile, using its
+// own read-ahead buffer. This is meant for streams which are kept open for
+// a long time, and of which many may exist simultaneously, such as audio
+// streamed from the game package: they all share a single file descriptor
+// instead of opening and buffering the whole file each.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__SHAREDFILESTREAM_H
+#define __AGS_CN_UTIL__SHAREDFILESTREAM_H
+
+#include <stdio.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "util/datastream.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class SharedFile
+{
+public:
+    // Returns the already opened file with this path, or opens a new one;
+    // returns null if the file could not be opened
+    static std::shared_ptr<SharedFile> Open(const String &file_name);
+    ~SharedFile();
+
+    const std::string &GetPath() const { return _fileName; }
+    soff_t GetLength() const { return _length; }
+    // Reads data starting at the given absolute file offset;
+    // returns number of bytes actually read. This method is thread-safe.
+    size_t ReadAt(soff_t offset, void *buffer, size_t size);
+
+private:
+    SharedFile(FILE *file, const std::string &file_name, soff_t length);
+
+    FILE *_file = nullptr;
+    // Kept as a deep copy, because the file may be closed on another thread,
+    // while the name is shared by the Strings owned by the caller
+    const std::string _fileName;
+    const soff_t _length = 0;
+    // Guards the file position, on systems without positioned reads
+    std::mutex _mutex;
+};
+
+
+class SharedFileStream : public DataStream
+{
+public:
+    // Default size of the read-ahead buffer
+    static const size_t BufferSize = 1024u * 64;
+
+    // Constructs a stream over the section of the file, limited by the
+    // [start_pos, end_pos) range; the range is clamped to the file's length
+    SharedFileStream(std::shared_ptr<SharedFile> file, soff_t start_pos, soff_t end_pos,
+        DataEndianess stream_endianess = kLittleEndian);
+    ~SharedFileStream() override = default;
+
+    void    Close() override;
+    bool    Flush() override { return false; }
+
+    // Is stream valid (underlying data initialized properly)
+    bool    IsValid() const override { return _file != nullptr; }
+    // Is end of stream
+    bool    EOS() const override { return _position == _end; }
+    // Total length of stream (if known)
+    soff_t  GetLength() const override { return _end - _start; }
+    // Current position (if known)
+    soff_t  GetPosition() const override { return _position - _start; }
+    bool    CanRead() const override { return IsValid(); }
+    bool    CanWrite() const override { return false; }
+    bool    CanSeek() const override { return IsValid(); }
+
+    size_t  Read(void *buffer, size_t size) override;
+    int32_t ReadByte() override;
+    size_t  Write(const void * /*buffer*/, size_t /*size*/) override { return 0; }
+    int32_t WriteByte(uint8_t /*b*/) override { return -1; }
+
+    bool    Seek(soff_t offset, StreamSeek origin) override;
+
+private:
+    // Reads a chunk of file into the buffer, starting from the given offset
+    void FillBufferFromPosition(soff_t position);
+
+    std::shared_ptr<SharedFile> _file;
+    soff_t _start = 0; // section's starting offset
+    soff_t _end = 0; // section's ending offset
+    soff_t _position = 0; // absolute read offset
+    soff_t _bufferPosition = 0; // buffer's location relative to file
+    std::vector<uint8_t> _buffer;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__SHAREDFILESTREAM_H
@@ -887,7 +887,12 @@ void String::SetString(const char *cstr, size_t length)
 {
     if (cstr)
     {
-        length = std::min(length, strlen(cstr));
+        // Test for null-terminator in the range; the source may be a part
+        // of a much longer string, which should not be scanned to its end,
+        // nor read past the given length
+        const char *ptr = cstr;
+        for (; (static_cast<size_t>(ptr - cstr) < length) && *ptr; ++ptr);
+        length = ptr - cstr;
         if (length > 0)
         {
             ReserveAndShift(false, Math::Surplus(length, _len));
@@ -43,6 +43,18 @@ inline size_t Hash_LowerCase(const char *data, const size_t len)
     return hash;
 }
 
+const uint64_t PRIME_NUMBER_64 = 14695981039346656037ULL;
+const uint64_t SECONDARY_NUMBER_64 = 1099511628211ULL;
+
+// 64-bit hash, for the keys which have to be stable between program runs;
+// the hash of a data sequence may be continued by passing the previous result
+inline uint64_t Hash64(const char *data, const size_t len, uint64_t hash = PRIME_NUMBER_64)
+{
+    for (size_t i = 0; i < len; ++i)
+        hash = (SECONDARY_NUMBER_64 * hash) ^ (uint8_t)(data[i]);
+    return hash;
+}
+
 } // namespace FNV
 
 
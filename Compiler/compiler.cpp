@@ -11,18 +11,28 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <utility>
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include "compiler.h"
+#include "script_deps.h"
 #include "script/cs_compiler.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
 #include "util/filestream.h"
 #include "util/file.h"
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/textstreamreader.h"
 #include "util/string_compat.h"
+#include "util/string_types.h"
+#include "util/string_utils.h"
 #include "preproc/preprocessor.h"
 #include "compiler.h"
 
@@ -63,12 +73,109 @@ std::vector<const char *> GetScriptAPIs()
 }
 
 
+// Precompiled headers file keeps the preprocessed headers and the macros
+// defined after them, followed by the compiler state after these headers
+static const char PCH_FILE_SIGNATURE[] = "AGSCCPCH";
+
+typedef std::vector<std::pair<String, String>> HeaderList;
+
+// Makes a string of all the options that may affect the compiled headers
+static std::string GetOptionsString(const CompilerOptions &comp_opts)
+{
+    const auto &flags = comp_opts.Flags;
+    std::string options = comp_opts.Version + ";" + comp_opts.ScriptAPI.ScriptAPIVersion +
+        ";" + comp_opts.ScriptAPI.ScriptCompatLevel + ";";
+    for (bool flag : { comp_opts.DebugMode, flags.ExportAll, flags.LineNumbers, flags.NoImportOverride,
+            flags.EnforceObjectBasedScript, flags.LeftToRightPrecedence, flags.EnforceNewStrings,
+            flags.EnforceNewAudio, flags.UseOldCustomDialogOptionsAPI })
+        options += flag ? '1' : '0';
+    for (const auto &macro : comp_opts.Macros)
+        options += ";" + macro.first + "=" + macro.second;
+    return options;
+}
+
+// Calculates the key of the headers contents and all the options that may affect them
+static uint64_t GetHeadersKey(const CompilerOptions &comp_opts, const HeaderList &heads)
+{
+    const std::string options = GetOptionsString(comp_opts);
+    uint64_t hash = FNV::Hash64(options.c_str(), options.size() + 1);
+    for (const auto &head : heads)
+    {
+        hash = FNV::Hash64(head.second.GetCStr(), head.second.GetLength() + 1, hash);
+        hash = FNV::Hash64(head.first.GetCStr(), head.first.GetLength() + 1, hash);
+    }
+    return hash;
+}
+
+static bool ReadPrecompiledHeaders(const std::string &filename, uint64_t key,
+    AGS::Preprocessor::Preprocessor &pp, HeaderList &preprocessed_heads)
+{
+    std::unique_ptr<Stream> in (File::OpenFileRead(filename.c_str()));
+    if (!in)
+        return false;
+    char sig[sizeof(PCH_FILE_SIGNATURE)] = {};
+    in->Read(sig, sizeof(sig));
+    if ((memcmp(sig, PCH_FILE_SIGNATURE, sizeof(sig)) != 0) ||
+        (static_cast<uint64_t>(in->ReadInt64()) != key))
+        return false;
+
+    MacroTable macros;
+    macros.read(in.get());
+    HeaderList heads;
+    int count = in->ReadInt32();
+    for (int i = 0; i < count; ++i)
+    {
+        String text = StrUtil::ReadString(in.get());
+        String name = StrUtil::ReadString(in.get());
+        heads.emplace_back(text, name);
+    }
+    if (in->HasErrors() || !ccReadPrecompiledHeaders(in.get()))
+        return false;
+
+    pp.SetMacros(macros);
+    preprocessed_heads = std::move(heads);
+    return true;
+}
+
+static bool WritePrecompiledHeaders(const std::string &filename, uint64_t key,
+    const std::vector<uint8_t> &macros, const HeaderList &preprocessed_heads)
+{
+    std::unique_ptr<Stream> out (File::CreateFile(filename.c_str()));
+    if (!out || !(out->CanWrite()))
+        return false;
+    out->Write(PCH_FILE_SIGNATURE, sizeof(PCH_FILE_SIGNATURE));
+    out->WriteInt64(key);
+    out->Write(macros.data(), macros.size()); // as serialized by MacroTable::write
+    out->WriteInt32(preprocessed_heads.size());
+    for (const auto &head : preprocessed_heads)
+    {
+        StrUtil::WriteString(head.first, out.get());
+        StrUtil::WriteString(head.second, out.get());
+    }
+    return ccWritePrecompiledHeaders(out.get());
+}
+
 void CompilerOptions::PrintToStdout() const {
     printf("\n--- Compiler Settings ---\n");
-    printf("Input: %s\n", InputScriptFile.c_str());
-    printf("Output: %s\n", OutputObjFile.c_str());
-    printf("Headers:");
     bool comma = false;
+    if (BatchScriptFiles.empty())
+    {
+        printf("Input: %s\n", InputScriptFile.c_str());
+        printf("Output: %s\n", OutputObjFile.c_str());
+    }
+    else
+    {
+        printf("Inputs:");
+        for (const auto& input : BatchScriptFiles)
+        {
+            if (comma) printf(", ");
+            printf("%s", input.c_str());
+            comma = true;
+        }
+        printf("\n");
+    }
+    printf("Headers:");
+    comma = false;
     for (const auto& header : HeaderFiles)
     {
         if (comma) printf(", ");
@@ -83,6 +190,10 @@ void CompilerOptions::PrintToStdout() const {
         printf("%s:%s", macro.first.c_str(), macro.second.c_str());
         comma = true;
     }
+    if (!PrecompiledHeadersFile.empty())
+        printf("\nPrecompiled headers: %s", PrecompiledHeadersFile.c_str());
+    if (Incremental)
+        printf("\nIncremental");
     printf("\nVersion: %s\n", Version.c_str());
     printf("ScriptAPIVersion: %s\n", ScriptAPI.ScriptAPIVersion.c_str());
     printf("ScriptCompatLevel: %s\n", ScriptAPI.ScriptCompatLevel.c_str());
@@ -99,13 +210,12 @@ void CompilerOptions::PrintToStdout() const {
     if (Flags.EnforceNewAudio) printf("EnforceNewAudio; ");
     if (Flags.UseOldCustomDialogOptionsAPI) printf("UseOldCustomDialogOptionsAPI; ");
     if(DebugMode) printf("\nDebugMode\n");
+    if(Optimize) printf("\nOptimize\n");
 }
 
 
-int Compile(const CompilerOptions& comp_opts)
+static void ConfigurePreprocessor(const CompilerOptions& comp_opts, AGS::Preprocessor::Preprocessor &pp)
 {
-    comp_opts.PrintToStdout();
-    AGS::Preprocessor::Preprocessor pp = AGS::Preprocessor::Preprocessor();
     std::vector<std::string> scriptAPIVersionMacros;
     std::vector<std::string> scriptCompatLevelMacros;
 
@@ -115,9 +225,6 @@ int Compile(const CompilerOptions& comp_opts)
         scriptCompatLevelMacros.emplace_back(std::string(PREFIX_SCRIPT_COMPAT) + ScriptAPIs[i]);
     }
 
-    //-----------------------------------------------------------------------//
-    // Configure macros
-    //-----------------------------------------------------------------------//
     pp.DefineMacro("AGS_NEW_STRINGS", "1");
     pp.DefineMacro("AGS_SUPPORTS_IFVER", "1");
 
@@ -167,10 +274,12 @@ int Compile(const CompilerOptions& comp_opts)
     {
         pp.DefineMacro(macro.first.c_str(), macro.second.c_str());
     }
+}
 
-    //-----------------------------------------------------------------------//
-    // Configure compiler
-    //-----------------------------------------------------------------------//
+// Sets the compiler options; the compiler keeps these per thread,
+// so this has to be called on each thread which compiles scripts
+static void ConfigureCompiler(const CompilerOptions& comp_opts)
+{
     ccSetSoftwareVersion(comp_opts.Version.c_str());
 
     ccSetOption(SCOPT_SHOWWARNINGS, comp_opts.Flags.ShowWarnings);
@@ -182,119 +291,336 @@ int Compile(const CompilerOptions& comp_opts)
 
     ccSetOption(SCOPT_LEFTTORIGHT, comp_opts.Flags.LeftToRightPrecedence);
     ccSetOption(SCOPT_OLDSTRINGS, !comp_opts.Flags.EnforceNewStrings);
+    ccSetOption(SCOPT_OPTIMIZE, comp_opts.Optimize);
+}
 
+// Headers prepared for compiling scripts; these are never modified after
+// preparation, and are shared by all the scripts compiled in a batch
+struct HeaderContext
+{
+    HeaderList PreprocessedHeads;
+    // macros defined after the headers, kept serialized, because the
+    // macro strings cannot be shared between threads
+    std::vector<uint8_t> Macros;
+    // compiled headers state, if precompiled headers are used
+    PPrecompiledHeaders Headers;
+    // key of the precompiled headers file, if one is used
+    uint64_t HeadersKey = 0;
+    // dependencies common to all the scripts, without the script's own source
+    ScriptDependencies Dependencies;
+};
+
+static bool ReadTextFile(const std::string &filename, String &text)
+{
+    std::unique_ptr<Stream> in (File::OpenFileRead(filename.c_str()));
+    if (!in)
+        return false;
+    TextStreamReader sr(in.get());
+    text = sr.ReadAll();
+    sr.ReleaseStream();
+    return true;
+}
+
+static void PrintError(std::ostream &err, const char *what, const char *script_name)
+{
+    const auto &error = cc_get_error();
+    err << "Error: " << what << " failed at " << script_name <<
+        ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
+}
+
+// Reads and preprocesses the headers, or loads them from the precompiled headers file;
+// with use_pch they have to be compiled by CompileHeaders before compiling any script
+static bool PrepareHeaders(const CompilerOptions& comp_opts, bool use_pch, HeaderContext &ctx)
+{
+    AGS::Preprocessor::Preprocessor pp = AGS::Preprocessor::Preprocessor();
+    ConfigurePreprocessor(comp_opts, pp);
     ccRemoveDefaultHeaders();
+    ccSetPrecompiledHeaders(use_pch);
 
-    //-----------------------------------------------------------------------//
-    // Read input files
-    //-----------------------------------------------------------------------//
-    std::vector<std::pair<String, String>> heads;
+    HeaderList heads;
     for(const auto& header: comp_opts.HeaderFiles)
     {
         if (header.empty())
         {
             std::cerr << "Error: empty header filename. Do you have a trailing `:` or `;`? "<< std::endl;
-            return -1;
+            return false;
         }
 
-        std::unique_ptr<Stream> in (File::OpenFileRead(header.c_str()));
-        if (!in)
+        String text;
+        if (!ReadTextFile(header, text))
         {
             std::cerr << "Error: failed to open header for reading: " << header << std::endl;
-            return -1;
+            return false;
         }
 
         String headername = Path::GetFilename(header.c_str());
         headername = Path::RemoveExtension(headername);
-
-        TextStreamReader sr(in.get());
-        heads.emplace_back(sr.ReadAll(), headername);
-        sr.ReleaseStream();
+        heads.emplace_back(text, headername);
     }
 
-    String script_input;
-    const char* src = nullptr;
+    //-----------------------------------------------------------------------//
+    // Preprocess headers and set them for use when compiling;
+    // precompiled headers, if they are up to date, already have these
+    //-----------------------------------------------------------------------//
+    const bool use_pch_file = use_pch && !comp_opts.PrecompiledHeadersFile.empty();
+    if (use_pch_file)
+    {
+        ctx.HeadersKey = GetHeadersKey(comp_opts, heads);
+        if (ReadPrecompiledHeaders(comp_opts.PrecompiledHeadersFile, ctx.HeadersKey, pp, ctx.PreprocessedHeads))
+            printf("\nUsing precompiled headers: %s\n", comp_opts.PrecompiledHeadersFile.c_str());
+        else
+            ccFreePrecompiledHeaders();
+    }
+    if (ctx.PreprocessedHeads.empty())
+    {
+        for(const auto& head: heads)
+        {
+            String preprocessed_header = pp.Preprocess(head.first,head.second);
+            ctx.PreprocessedHeads.emplace_back(preprocessed_header.GetCStr(),head.second);
+        }
+    }
+    for(const auto& head: ctx.PreprocessedHeads)
+    {
+        ccAddDefaultHeader((char *) head.first.GetCStr(), (char *) head.second.GetCStr());
+    }
+    heads.clear();
 
-    if (comp_opts.InputScriptFile.empty())
     {
-        std::cerr << "Error: empty script filename." << std::endl;
-        return -1;
+        VectorStream out(ctx.Macros, kStream_Write);
+        pp.GetMacros().write(&out);
     }
 
-    src = comp_opts.InputScriptFile.c_str();
-    std::unique_ptr<Stream> in (File::OpenFileRead(src));
-    if (!in)
+    // the scripts depend on the preprocessed headers, so that the changes
+    // in comments or in the skipped conditional blocks do not affect them
+    const std::string options = GetOptionsString(comp_opts) + (comp_opts.Optimize ? ";O" : "");
+    ctx.Dependencies.OptionsHash = HashDependency(options);
+    for (size_t i = 0; i < ctx.PreprocessedHeads.size(); ++i)
+        ctx.Dependencies.Headers.emplace_back(comp_opts.HeaderFiles[i].c_str(), HashDependency(ctx.PreprocessedHeads[i].first));
+    ctx.Dependencies.MacrosHash = HashDependency(reinterpret_cast<const char*>(ctx.Macros.data()), ctx.Macros.size());
+    return true;
+}
+
+// Compiles the prepared headers, unless their state was loaded from the file,
+// and saves the precompiled headers file if one was given
+static bool CompileHeaders(const CompilerOptions& comp_opts, HeaderContext &ctx)
+{
+    if (!ccPrecompileHeaders())
     {
-        std::cerr << "Error: failed to open script for reading: " << src << std::endl;
-        return -1;
+        PrintError(std::cerr, "compile", ccCurScriptName);
+        return false;
     }
-    TextStreamReader sr(in.get());
-    script_input = sr.ReadAll();
-    sr.ReleaseStream();
+    if (!comp_opts.PrecompiledHeadersFile.empty() && ccPrecompiledHeadersChanged())
+    {
+        if (!WritePrecompiledHeaders(comp_opts.PrecompiledHeadersFile, ctx.HeadersKey, ctx.Macros, ctx.PreprocessedHeads))
+            std::cerr << "Warning: failed to write precompiled headers: " << comp_opts.PrecompiledHeadersFile << std::endl;
+    }
+    ctx.Headers = ccGetPrecompiledHeaders();
+    return true;
+}
 
-    //-----------------------------------------------------------------------//
-    // Preprocess headers and set them for use when compiling
-    //-----------------------------------------------------------------------//
-    std::vector<std::pair<String, String>> preprocessed_heads;
-    for(const auto& head: heads)
+// Preprocesses and compiles a single script, using the prepared headers;
+// this may be called on any thread, the errors are printed to the given stream
+static bool CompileScript(const CompilerOptions& comp_opts, const HeaderContext &ctx,
+    const std::string &input_file, const std::string &output_file, std::ostream &err)
+{
+    if (input_file.empty())
     {
-        String preprocessed_header = pp.Preprocess(head.first,head.second);
-        preprocessed_heads.emplace_back(preprocessed_header.GetCStr(),head.second);
+        err << "Error: empty script filename." << std::endl;
+        return false;
+    }
 
-        ccAddDefaultHeader((char *) preprocessed_heads.back().first.GetCStr(), (char *) preprocessed_heads.back().second.GetCStr());
+    String script_input;
+    if (!ReadTextFile(input_file, script_input))
+    {
+        err << "Error: failed to open script for reading: " << input_file << std::endl;
+        return false;
     }
-    heads.clear();
 
     //-----------------------------------------------------------------------//
     // Preprocess script
     //-----------------------------------------------------------------------//
-    String script_pp = nullptr;
-    String filename = Path::GetFilename(comp_opts.InputScriptFile.c_str());
+    AGS::Preprocessor::Preprocessor pp = AGS::Preprocessor::Preprocessor();
+    {
+        MacroTable macros;
+        VectorStream in(ctx.Macros);
+        macros.read(&in);
+        pp.SetMacros(macros);
+    }
+
+    String filename = Path::GetFilename(input_file.c_str());
     String script_name = Path::RemoveExtension(filename);
 
-    script_pp = pp.Preprocess(script_input,script_name);
+    cc_clear_error();
+    String script_pp = pp.Preprocess(script_input,script_name);
     if ((script_pp == nullptr) || (cc_has_error()))
     {
-        const auto &error = cc_get_error();
-        std::cerr << "Error: preprocessor failed at " << script_name.GetCStr() <<
-            ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
-        return -1;
+        PrintError(err, "preprocessor", script_name.GetCStr());
+        return false;
     }
 
     if(comp_opts.PreprocessOnly)
     {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
+        std::unique_ptr<Stream> out (File::CreateFile(output_file.c_str()));
         if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
+            err << "Error: failed to open for writing: " << output_file << std::endl;
+            return false;
         }
         script_pp.Write(out.get());
-        return 0;
+        return true;
     }
 
     //-----------------------------------------------------------------------//
     // Compile script
     //-----------------------------------------------------------------------//
-    ccScript* script = ccCompileText(script_pp.GetCStr(), script_name.GetCStr());
+    std::unique_ptr<ccScript> script(ccCompileText(script_pp.GetCStr(), script_name.GetCStr()));
     if ((script == nullptr) || (cc_has_error()))
     {
-        const auto &error = cc_get_error();
-        std::cerr << "Error: compile failed at " << ccCurScriptName << ", line " << error.Line << " : " << error.ErrorString.GetCStr() << std::endl;
-        return -1;
+        PrintError(err, "compile", ccCurScriptName);
+        return false;
     }
 
     //-----------------------------------------------------------------------//
     // Write script object
     //-----------------------------------------------------------------------//
-    if(!comp_opts.OutputObjFile.empty())
+    if(!output_file.empty())
     {
-        std::unique_ptr<Stream> out (File::CreateFile(comp_opts.OutputObjFile.c_str()));
+        // the old dependencies must not describe the new object, if that fails to be written
+        const std::string deps_file = GetDependenciesFile(output_file);
+        if (comp_opts.Incremental && File::IsFile(deps_file.c_str()))
+            File::DeleteFile(deps_file.c_str());
+
+        std::unique_ptr<Stream> out (File::CreateFile(output_file.c_str()));
         if (!out || !(out->CanWrite())) {
-            std::cerr << "Error: failed to open for writing: " << comp_opts.OutputObjFile << std::endl;
-            return -1;
+            err << "Error: failed to open for writing: " << output_file << std::endl;
+            return false;
         }
         script->Write(out.get());
+        out.reset();
+
+        if (comp_opts.Incremental)
+        {
+            ScriptDependencies deps = ctx.Dependencies;
+            deps.SourceHash = HashDependency(script_input);
+            if (!WriteDependencies(deps_file, deps))
+                err << "Warning: failed to write dependencies: " << deps_file << std::endl;
+        }
     }
+    return true;
+}
 
+int Compile(const CompilerOptions& comp_opts)
+{
+    comp_opts.PrintToStdout();
+    ConfigureCompiler(comp_opts);
+
+    HeaderContext ctx;
+    const bool use_pch = !comp_opts.PrecompiledHeadersFile.empty() && !comp_opts.PreprocessOnly;
+    if (!PrepareHeaders(comp_opts, use_pch, ctx))
+        return -1;
+    if (comp_opts.Incremental && !comp_opts.PreprocessOnly && !comp_opts.OutputObjFile.empty())
+    {
+        String reason;
+        if (IsOutputUpToDate(ctx.Dependencies, comp_opts.InputScriptFile, comp_opts.OutputObjFile, reason))
+        {
+            printf("\n%s is up to date\n", comp_opts.OutputObjFile.c_str());
+            return 0;
+        }
+        printf("\nCompiling %s: %s\n", comp_opts.InputScriptFile.c_str(), reason.GetCStr());
+    }
+    if (use_pch && !CompileHeaders(comp_opts, ctx))
+        return -1;
+    if (!CompileScript(comp_opts, ctx, comp_opts.InputScriptFile, comp_opts.OutputObjFile, std::cerr))
+        return -1;
     return 0;
-}
\ No newline at end of file
+}
+
+int CompileBatch(const CompilerOptions& comp_opts)
+{
+    comp_opts.PrintToStdout();
+    ConfigureCompiler(comp_opts);
+
+    // Headers are compiled once, and their state is shared by all the workers
+    HeaderContext ctx;
+    const bool use_pch = !comp_opts.PreprocessOnly;
+    if (!PrepareHeaders(comp_opts, use_pch, ctx))
+        return -1;
+
+    // In the incremental mode only the scripts affected by the changes are compiled
+    std::vector<std::string> input_files;
+    size_t up_to_date_count = 0;
+    if (comp_opts.Incremental && !comp_opts.PreprocessOnly)
+        printf("\n");
+    for (const auto &input : comp_opts.BatchScriptFiles)
+    {
+        if (comp_opts.Incremental && !comp_opts.PreprocessOnly)
+        {
+            const std::string output = std::string(Path::RemoveExtension(input.c_str()).GetCStr()) + ".o";
+            String reason;
+            if (IsOutputUpToDate(ctx.Dependencies, input, output, reason))
+            {
+                up_to_date_count++;
+                continue;
+            }
+            printf("%s: %s\n", input.c_str(), reason.GetCStr());
+        }
+        input_files.push_back(input);
+    }
+    if (input_files.empty())
+    {
+        printf("\nAll %zu scripts are up to date\n", up_to_date_count);
+        return 0;
+    }
+    if (use_pch && !CompileHeaders(comp_opts, ctx))
+        return -1;
+
+    size_t job_count = comp_opts.Jobs > 0 ? comp_opts.Jobs : std::thread::hardware_concurrency();
+#if !defined(AGS_CC_THREADSAFE)
+    job_count = 1; // compiler state is global, scripts may only be compiled one at a time
+#endif
+    job_count = std::max<size_t>(1, std::min(job_count, input_files.size()));
+    printf("\nCompiling %zu scripts using %zu jobs\n", input_files.size(), job_count);
+
+    std::atomic<size_t> next_input(0);
+    std::atomic<size_t> failed_count(0);
+    std::mutex output_mutex;
+    auto worker = [&]()
+    {
+        // each thread has its own compiler state, set it up from the shared one
+        ConfigureCompiler(comp_opts);
+        ccRemoveDefaultHeaders();
+        for (const auto& head: ctx.PreprocessedHeads)
+            ccAddDefaultHeader((char *) head.first.GetCStr(), (char *) head.second.GetCStr());
+        ccSetPrecompiledHeaders(ctx.Headers != nullptr);
+        ccUsePrecompiledHeaders(ctx.Headers);
+
+        for (size_t i = next_input++; i < input_files.size(); i = next_input++)
+        {
+            const std::string &input = input_files[i];
+            const std::string output = std::string(Path::RemoveExtension(input.c_str()).GetCStr()) + ".o";
+            // errors are collected and printed at once, to not interleave with other threads
+            std::ostringstream err;
+            const bool result = CompileScript(comp_opts, ctx, input, output, err);
+            std::lock_guard<std::mutex> lock(output_mutex);
+            std::cerr << err.str();
+            if (result)
+                printf("%s -> %s\n", input.c_str(), output.c_str());
+            else
+                failed_count++;
+        }
+        ccUsePrecompiledHeaders(nullptr);
+        ccRemoveDefaultHeaders();
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < job_count; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+
+    printf("\n%zu scripts compiled, %zu failed", input_files.size() - failed_count, static_cast<size_t>(failed_count));
+    if (up_to_date_count > 0)
+        printf(", %zu up to date", up_to_date_count);
+    printf("\n");
+    return failed_count > 0 ? -1 : 0;
+}
@@ -50,10 +50,15 @@ public:
     Flags Flags;
     bool PreprocessOnly = false;
     bool DebugMode = false; // build for debug
+    bool Optimize = false; // optimize the compiled bytecode
     std::vector<std::pair<std::string, std::string>> Macros{};
     std::vector<std::string> HeaderFiles{};
     std::string InputScriptFile{};
     std::string OutputObjFile{};
+    std::vector<std::string> BatchScriptFiles{}; // scripts compiled in a batch, each into INPUT.o
+    int Jobs = 0; // number of threads compiling a batch, 0 for the number of cores
+    std::string PrecompiledHeadersFile{};
+    bool Incremental = false; // skip the scripts whose output is up to date
     std::string Version{};
     CompilerOptions() = default;
     ~CompilerOptions() = default;
@@ -61,6 +66,8 @@ public:
 };
 
 int Compile(const CompilerOptions& comp_opts);
+// compiles all the batch scripts, sharing the headers between them
+int CompileBatch(const CompilerOptions& comp_opts);
 std::vector<const char *> GetScriptAPIs();
 
 #endif //__CC_COMPILER_H
@@ -19,10 +19,9 @@
 const char*fmemcopyr="FMEM v1.00 (c) 2000 Chris Jones";
 #define FMEM_MAGIC 0xcddebeef
 
-FMEM*tempy;
 // fmem_create: create a blank FMEM file for writing
 FMEM*fmem_create() {
-  tempy=(FMEM*)malloc(sizeof(FMEM));
+  FMEM*tempy=(FMEM*)malloc(sizeof(FMEM));
   tempy->size=100;
   tempy->len=0;
   tempy->data=(char*)malloc(tempy->size+10);
@@ -34,7 +33,7 @@ FMEM*fmem_create() {
 
 // fmem_open: create an FMEM file for reading, using a string as the source
 FMEM*fmem_open(const char*sourc) {
-  tempy=(FMEM*)malloc(sizeof(FMEM));
+  FMEM*tempy=(FMEM*)malloc(sizeof(FMEM));
   tempy->size=strlen(sourc)+10;
   tempy->len=strlen(sourc);
   tempy->data=(char*)malloc(tempy->size+10);
@@ -5,13 +5,14 @@
 #include <map>
 #include "util/path.h"
 #include "util/cmdlineopts.h"
+#include "util/string_utils.h"
 #include "compiler.h"
 #include "core/def_version.h"
 
 using namespace AGS::Common;
 using namespace AGS::Common::CmdLineOpts;
 
-const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
+const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc> [<INPUT2.asc>...]
 -A <version>                 Script API Version               (default:Highest)
 -C <version>                 Script API Compatibility version (default:Highest)
 -H, --Headers <H1>[:<H2>...] Header Files in order  (; as separator in cmd.exe)
@@ -29,8 +30,18 @@ const char *HELP_STRING = R"EOS(Usage: agscc [options] <INPUT.asc>
 -fforcenewaudio[=0]          Enforce new audio system               (default:1)
 -foldcustomdialogopt[=0]     Use old custom dialog API
 -g                           Generate debug information
+-O                           Optimize the compiled bytecode
 --tell-api-versions          Returns supported Script API Versions
 -o <OUT.o>, --output <OUT.o> Place output in specified file.  (default:INPUT.o)
+                             Multiple inputs are compiled in a batch, each
+                             into its INPUT.o, sharing the compiled headers
+-j <N>                       Number of scripts compiled at once in a batch
+                                                    (default:number of cores)
+--pch <FILE>                 Use precompiled headers file, created or updated
+                             when headers or options change
+--incremental                Skip the scripts whose output is up to date;
+                             hashes of the script, headers and macros are
+                             kept next to each output, in OUT.o.dep
 --override-version <VERSION> Overrides editor version
 -h, --help                   Print this usage message
 )EOS";
@@ -87,6 +98,8 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
 
     compilerOptions.PreprocessOnly = parseResult.Opt.count("-E");
     compilerOptions.DebugMode = parseResult.Opt.count("-g");
+    compilerOptions.Optimize = parseResult.Opt.count("-O");
+    compilerOptions.Incremental = parseResult.Opt.count("--incremental");
 
     for(const auto& opt_with_value : parseResult.OptWithValue)
     {
@@ -160,6 +173,22 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
             continue;
         }
 
+        if(opt_with_value.first == "-j")
+        {
+            compilerOptions.Jobs = StrUtil::StringToInt(opt_with_value.second, -1);
+            if (compilerOptions.Jobs < 1) {
+                std::cerr << "Error: invalid number of jobs " << opt_with_value.second.GetCStr() << std::endl;
+                return ParsedOptions(-1);
+            }
+            continue;
+        }
+
+        if(opt_with_value.first == "--pch")
+        {
+            compilerOptions.PrecompiledHeadersFile = opt_with_value.second.GetCStr();
+            continue;
+        }
+
         if(opt_with_value.first == "--override-version")
         {
             compilerOptions.Version = opt_with_value.second.GetCStr();
@@ -227,6 +256,14 @@ ParsedOptions parser_to_compiler_opts(const ParseResult& parseResult)
     }
 
     compilerOptions.InputScriptFile = parseResult.PosArgs[0].GetCStr();
+    if(parseResult.PosArgs.size() > 1) {
+        if(!compilerOptions.OutputObjFile.empty()) {
+            std::cerr << "Error: cannot specify the output file with multiple inputs" << std::endl;
+            return ParsedOptions(-1);
+        }
+        for(const auto& arg : parseResult.PosArgs)
+            compilerOptions.BatchScriptFiles.push_back(arg.GetCStr());
+    }
 
     if(compilerOptions.OutputObjFile.empty()) {
         // no output file explicitly set, let's use input.o instead
@@ -252,11 +289,14 @@ Copyright (c) 2021 AGS Team and contributors
 )EOS"
     );
 
-    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f"});
+    ParseResult parseResult = Parse(argc,argv,{"-D", "-H", "--Headers", "-A", "-C", "-f", "-j",
+        "-o", "--output", "--pch", "--override-version"});
     ParsedOptions parsedOptions = parser_to_compiler_opts(parseResult);
 
     if(parsedOptions.Exit) return parsedOptions.ErrorCode;
 
     compilerOptions = parsedOptions.Options;
+    if(!compilerOptions.BatchScriptFiles.empty())
+        return CompileBatch(compilerOptions);
     return Compile(compilerOptions);
 }
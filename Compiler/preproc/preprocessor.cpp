@@ -1,77 +1,42 @@
+#include <ctype.h>
+#include <string.h>
 #include <algorithm>
+#include <string>
 #include "preproc/preprocessor.h"
 #include "script/cc_common.h"
-#include "util/textstreamwriter.h"
-#include "util/textreader.h"
 
 #define STRINGIFY2(X) #X
 #define STRINGIFY(X) STRINGIFY2(X)
 
 using namespace AGS::Common;
 
-extern int currentline; // in script/script_common
-
 namespace AGS {
 namespace Preprocessor {
 
-    static const size_t NOT_FOUND = -1;
-
 #if AGS_PLATFORM_OS_WINDOWS
     static const char * li_end = "\r\n";
 #else
     static const char * li_end = "\n";
 #endif
 
-    class StringBuilder : TextWriter {
-    private:
-        String _str = nullptr;
-    public:
-        explicit StringBuilder(size_t size) {
-            _str.Reserve(size);
-        }
-
-        void WriteLine(const String& str) override { _str.Append(str); _str.Append(li_end); }
-        bool IsValid() const override { return true; }
-        void WriteChar(char c) override {  _str.AppendChar(c); }
-        void WriteString(const String &str) override { _str.Append(str);}
-        void WriteFormat(const char *fmt, ...) override { va_list argptr; va_start(argptr, fmt); _str.Append(String::FromFormatV(fmt, argptr)); va_end(argptr);}
-        void WriteLineBreak() override { _str.Append(li_end); }
-
-        String GetString () {return _str;}
+    // Tells which characters make the words, same as is_alphanum
+    struct WordCharTable
+    {
+        bool Chars[256];
+        WordCharTable() { for (int c = 0; c < 256; ++c) Chars[c] = is_alphanum(static_cast<char>(c)) != 0; }
     };
+    static const WordCharTable WordChars;
 
-    class StringReader : TextReader{
-    private:
-        String _str = nullptr;
-        size_t _idx = 0;
-    public:
-        StringReader(const String& str) {
-            _str = str;
-            _idx = 0;
-        }
+    static inline bool IsWordChar(char c) {
+        return WordChars.Chars[static_cast<unsigned char>(c)];
+    }
 
-        bool IsValid() const override { return _idx < _str.GetLength(); }
-        char ReadChar() override { return _str.GetAt(_idx++); }
-        String ReadString(size_t length) override { String res = _str.Mid(_idx, length); _idx+=res.GetLength(); return res;}
-        String ReadLine() override {
-            if(_idx >= _str.GetLength()) return nullptr;
-
-            size_t newPos = _str.FindChar('\n', _idx);
-            if(newPos != NOT_FOUND) {
-                size_t length = newPos - _idx;
-                size_t idx = _idx;
-                _idx = newPos+1;
-                if (length == 0) return String("");
-                return _str.Mid(idx,length);
-            } else {
-                return ReadAll();
-            }
-        }
-        String ReadAll() override { size_t idx = _idx; _idx = _str.GetLength(); return _str.Mid(idx, _str.GetLength() - idx); }
-    };
+    static inline bool IsSpace(char c) {
+        return isspace(static_cast<unsigned char>(c)) != 0;
+    }
 
-    static bool Contains(const std::vector<String> &v, const String &s) {
-        return std::find(v.rbegin(), v.rend(), s) != v.rend();
+    static bool SpanEquals(const char *ptr, size_t len, const char *str) {
+        return (strlen(str) == len) && (memcmp(ptr, str, len) == 0);
     }
 
 
@@ -103,12 +68,13 @@ namespace Preprocessor {
         }
     }
 
-    void Preprocessor::ProcessConditionalDirective(String &directive, String &line)
+    void Preprocessor::ProcessConditionalDirective(const TextSpan &directive, TextSpan &line)
     {
-        String macroName = GetNextWord(line, true, true);
-        if (macroName.GetLength() == 0)
+        const TextSpan macroName = GetNextWord(line, true);
+        if (macroName.Len == 0)
         {
-            LogError(ErrorCode::MacroNameMissing, String::FromFormat("Expected something after '%s'", directive.GetCStr()));
+            LogError(ErrorCode::MacroNameMissing, String::FromFormat("Expected something after '%s'",
+                String(directive.Ptr, directive.Len).GetCStr()));
             return;
         }
 
@@ -118,23 +84,24 @@ namespace Preprocessor {
         {
             includeCodeBlock = false;
         }
-        else if (directive.CompareRight("def") == 0)
+        else if (SpanEquals(directive.Ptr, directive.Len, "ifdef") || SpanEquals(directive.Ptr, directive.Len, "ifndef"))
         {
-            includeCodeBlock = _macros.contains(macroName.GetCStr());
-            if (directive == "ifndef")
+            includeCodeBlock = _macros.find(macroName.Ptr, macroName.Len) != nullptr;
+            if (SpanEquals(directive.Ptr, directive.Len, "ifndef"))
             {
                 includeCodeBlock = !includeCodeBlock;
             }
         }
-        else if (directive == "ifver" || directive == "ifnver")
+        else
         {
             // Compare provided version number with the current application version
-            Version macroVersion = Version(macroName);
+            const String versionText(macroName.Ptr, macroName.Len);
+            Version macroVersion = Version(versionText);
             if(macroVersion.Major == 0) {
-                LogError(ErrorCode::InvalidVersionNumber, String::FromFormat("Cannot parse version number: %s", macroName.GetCStr()));
+                LogError(ErrorCode::InvalidVersionNumber, String::FromFormat("Cannot parse version number: %s", versionText.GetCStr()));
             }
             includeCodeBlock = _applicationVersion.AsLongNumber() >= macroVersion.AsLongNumber();
-            if(directive == "ifnver" )
+            if (SpanEquals(directive.Ptr, directive.Len, "ifnver"))
             {
                 includeCodeBlock = !includeCodeBlock;
             }
@@ -148,90 +115,103 @@ namespace Preprocessor {
         return ((!_conditionalStatements.empty()) && !_conditionalStatements.back());
     }
 
-    String Preprocessor::GetNextWord(String &text, bool trimText, bool includeDots) {
+    Preprocessor::TextSpan Preprocessor::GetNextWord(TextSpan &text, bool includeDots) {
         size_t i = 0;
-        while ((i < text.GetLength()) &&
-               (is_alphanum(text[i]) ||
-                (includeDots && (text[i] == '.')))
+        while ((i < text.Len) &&
+               (IsWordChar(text.Ptr[i]) ||
+                (includeDots && (text.Ptr[i] == '.')))
                 ) {
             i++;
         }
-        String word = text.Left(i);
-        text.ClipLeft(i);
-        if (trimText) {
-            text.Trim();
-        }
+        TextSpan word = { text.Ptr, i };
+        // the rest of the text is trimmed, its end has no spaces already
+        while ((i < text.Len) && IsSpace(text.Ptr[i]))
+            i++;
+        text.Ptr += i;
+        text.Len -= i;
         return word;
     }
 
-    String Preprocessor::RemoveComments(String text)
+    Preprocessor::TextSpan Preprocessor::RemoveComments(const char *line, size_t len)
     {
+        size_t i = 0;
         if (_inMultiLineComment)
         {
-            size_t commentEnd = text.FindString("*/",0);
-            if (commentEnd == NOT_FOUND)
+            for (; (i + 1 < len) && !((line[i] == '*') && (line[i + 1] == '/')); i++);
+            if (i + 1 >= len)
             {
-                return String("");
+                return TextSpan();
             }
-            text = text.Mid(commentEnd + 2, text.GetLength() - (commentEnd + 2));
+            i += 2;
             _inMultiLineComment = false;
         }
 
-        StringBuilder output = StringBuilder(text.GetLength());
-        for (size_t i = 0; i < text.GetLength(); i++)
+        // the text is used in place, unless the comments split it into
+        // several parts, which have to be joined in the line buffer
+        bool joined = false;
+        size_t copyFrom = i;
+        for (; i < len; i++)
         {
             if (!_inMultiLineComment)
             {
-                if ((text[i] == '"') || (text[i] == '\''))
-                {
-                    size_t endOfString = text.FindChar(text[i],i);
-                    if (endOfString == NOT_FOUND) //size_t is unsigned but it's alright
-                    {
-                        LogError(ErrorCode::UnterminatedString, "Unterminated string");
-                        break;
-                    }
-                    endOfString++;
-                    output.WriteString(text.Mid(i, endOfString - i));
-                    text = text.Mid(endOfString, text.GetLength() - endOfString);
-                    i = -1;
-                }
-                else if ((i < text.GetLength() - 1) && (text[i] == '/') && (text[i + 1] == '/'))
+                if ((i + 1 < len) && (line[i] == '/') && (line[i + 1] == '/'))
                 {
                     break;
                 }
-                else if ((i < text.GetLength() - 1) && (text[i] == '/') && (text[i + 1] == '*'))
+                else if ((i + 1 < len) && (line[i] == '/') && (line[i + 1] == '*'))
                 {
+                    if (!joined)
+                        _lineBuffer.clear();
+                    _lineBuffer.append(line + copyFrom, i - copyFrom);
+                    joined = true;
                     _inMultiLineComment = true;
                     i++;
                 }
-                else
-                {
-                    output.WriteChar(text[i]);
-                }
             }
-            else if ((i < text.GetLength() - 1) && (text[i] == '*') && (text[i + 1] == '/'))
+            else if ((i + 1 < len) && (line[i] == '*') && (line[i + 1] == '/'))
             {
                 _inMultiLineComment = false;
                 i++;
+                copyFrom = i + 1;
             }
         }
 
-        String out = output.GetString();
-        out.Trim();
-        return out;
+        TextSpan text = TextSpan();
+        if (!joined)
+        {
+            if (!_inMultiLineComment)
+                text = { line + copyFrom, i - copyFrom };
+        }
+        else
+        {
+            if (!_inMultiLineComment)
+                _lineBuffer.append(line + copyFrom, i - copyFrom);
+            text = { _lineBuffer.data(), _lineBuffer.size() };
+        }
+        while ((text.Len > 0) && IsSpace(text.Ptr[0]))
+        {
+            text.Ptr++;
+            text.Len--;
+        }
+        while ((text.Len > 0) && IsSpace(text.Ptr[text.Len - 1]))
+            text.Len--;
+        return text;
     }
 
-    String Preprocessor::PreProcessDirective(String &line)
+    void Preprocessor::PreProcessDirective(TextSpan line)
     {
-        line.ClipLeft(1);
-        String directive = GetNextWord(line);
-
-        if ((directive == "ifdef") || (directive == "ifndef") ||
-            (directive == "ifver") || (directive == "ifnver"))
+        line.Ptr++;
+        line.Len--;
+        const TextSpan directive = GetNextWord(line);
+        auto is_directive = [&directive](const char *name)
+            { return SpanEquals(directive.Ptr, directive.Len, name); };
+
+        if (is_directive("ifdef") || is_directive("ifndef") ||
+            is_directive("ifver") || is_directive("ifnver"))
         {
             ProcessConditionalDirective(directive, line);
         }
-        else if (directive == "endif")
+        else if (is_directive("endif"))
         {
             if (!_conditionalStatements.empty())
             {
@@ -246,61 +226,64 @@ namespace Preprocessor {
         {
             // allow the line to be deleted, we are inside a failed #ifdef
         }
-        else if (directive == "define")
+        else if (is_directive("define"))
         {
-            String macroName = GetNextWord(line);
-            if (macroName.GetLength() == 0)
+            const TextSpan macroName = GetNextWord(line);
+            if (macroName.Len == 0)
             {
                 LogError(ErrorCode::MacroNameMissing);
-                return String("");
             }
-            else if (is_digit(macroName[0]))
+            else if (is_digit(macroName.Ptr[0]))
             {
-                LogError(ErrorCode::MacroNameInvalid, String::FromFormat("Macro name '%s' cannot start with a digit", macroName.GetCStr()));
+                LogError(ErrorCode::MacroNameInvalid, String::FromFormat("Macro name '%s' cannot start with a digit",
+                    String(macroName.Ptr, macroName.Len).GetCStr()));
             }
-            else if (_macros.contains(macroName.GetCStr()))
+            else if (_macros.find(macroName.Ptr, macroName.Len))
             {
-                LogError(ErrorCode::MacroAlreadyExists, String::FromFormat("Macro '%s' is already defined", macroName.GetCStr()));
+                LogError(ErrorCode::MacroAlreadyExists, String::FromFormat("Macro '%s' is already defined",
+                    String(macroName.Ptr, macroName.Len).GetCStr()));
             }
             else
             {
-                _macros.add(macroName, line);
+                _macros.add(String(macroName.Ptr, macroName.Len), String(line.Ptr, line.Len));
             }
         }
-        else if (directive == "undef")
+        else if (is_directive("undef"))
         {
-            String macroName = GetNextWord(line);
-            if (macroName.GetLength() == 0)
+            const TextSpan macroName = GetNextWord(line);
+            if (macroName.Len == 0)
             {
                 LogError(ErrorCode::MacroNameMissing);
             }
-            else if (!_macros.contains(macroName))
+            else if (!_macros.find(macroName.Ptr, macroName.Len))
             {
-                LogError(ErrorCode::MacroDoesNotExist, String::FromFormat("Macro '%s' is not defined", macroName.GetCStr()));
+                LogError(ErrorCode::MacroDoesNotExist, String::FromFormat("Macro '%s' is not defined",
+                    String(macroName.Ptr, macroName.Len).GetCStr()));
             }
             else
             {
-                _macros.remove(macroName);
+                String name(macroName.Ptr, macroName.Len);
+                _macros.remove(name);
             }
         }
-        else if (directive == "error")
+        else if (is_directive("error"))
         {
-            LogError(ErrorCode::UserDefinedError, String::FromFormat("User error: %s", line.GetCStr()));
+            LogError(ErrorCode::UserDefinedError, String::FromFormat("User error: %s", String(line.Ptr, line.Len).GetCStr()));
         }
-        else if ((directive == "sectionstart") || (directive == "sectionend"))
+        else if (is_directive("sectionstart") || is_directive("sectionend"))
         {
             // do nothing -- 2.72 put these as markers in the script
         }
-        else if ((directive == "region") || (directive == "endregion"))
+        else if (is_directive("region") || is_directive("endregion"))
         {
             // do nothing -- scintilla can fold it, so it can be used to organize the code
         }
         else
         {
-            LogError(ErrorCode::UnknownPreprocessorDirective, String::FromFormat("Unknown preprocessor directive '%s'", directive.GetCStr()));
+            LogError(ErrorCode::UnknownPreprocessorDirective, String::FromFormat("Unknown preprocessor directive '%s'",
+                String(directive.Ptr, directive.Len).GetCStr()));
         }
-
-        return String("");  // replace the directive with a blank line
+        // the directive is replaced with a blank line
     }
 
     void Preprocessor::DefineMacro(const String& name, const String& value)
@@ -308,103 +291,99 @@ namespace Preprocessor {
         _macros.add(name, value);
     }
 
-    String Preprocessor::PreProcessLine(const String& lineToProcess)
+    void Preprocessor::PreProcessLine(const TextSpan &line, std::string &output)
     {
         if (DeletingCurrentLine())
         {
-            return String("");
+            return;
         }
 
-        std::vector<StringBuilder> previousOutput = std::vector<StringBuilder>();
-        std::vector<String> previousLine = std::vector<String>();
-        StringBuilder output = StringBuilder(lineToProcess.GetLength());
-        String line = lineToProcess;
-        std::vector<String> ignored = std::vector<String>();
-        while (line.GetLength() > 0)
+        // The words are looked up in place, without copying them. A macro's
+        // text is scanned instead of the rest of the line until it ends,
+        // and everything is written into the same output.
+        _expansions.clear();
+        _expanding.clear();
+        const char *str = line.Ptr;
+        const char *end = line.Ptr + line.Len;
+        for (;;)
         {
-            size_t i = 0;
-            while ((i < line.GetLength()) && (!is_alphanum(line[i])))
+            if (str == end)
             {
-                if ((line[i] == '"') || (line[i] == '\''))
-                {
-                    i = line.FindChar(line[i],i);
-                    if (i == NOT_FOUND)
-                    {
-                        i = line.GetLength();
-                        break;
-                    }
-                }
-                i++;
+                if (_expansions.empty())
+                    break;
+                str = _expansions.back().Ptr;
+                end = str + _expansions.back().Len;
+                _expansions.pop_back();
+                _expanding.pop_back();
+                continue;
             }
 
-            output.WriteString(line.Mid(0, i));
-
-            if (i < line.GetLength())
+            const char *word = str;
+            while ((word < end) && !IsWordChar(*word))
+                word++;
+            output.append(str, word - str);
+            if (word == end)
             {
-                bool precededByDot = false;
-                if (i > 0) precededByDot = (line[i - 1] == '.');
-
-                line = line.Mid(i, line.GetLength() - i);
-
-                String theWord = GetNextWord(line, false, false);
+                str = end;
+                continue;
+            }
 
-                if ((!precededByDot) && (!Contains(ignored, theWord)) && (_macros.contains(theWord.GetCStr())))
-                {
-                    previousOutput.push_back(output);
-                    previousLine.push_back(line);
-                    ignored.push_back(theWord);
-                    line = _macros.get_macro(theWord.GetCStr());
-                    output = StringBuilder(line.GetLength());
-                }
-                else
-                {
-                    output.WriteString(theWord);
-                }
+            const bool precededByDot = (word > str) && (word[-1] == '.');
+            const char *wordEnd = word;
+            while ((wordEnd < end) && IsWordChar(*wordEnd))
+                wordEnd++;
+            const size_t wordLen = wordEnd - word;
+            const String *macro = precededByDot ? nullptr : _macros.find(word, wordLen);
+            if (macro && std::none_of(_expanding.begin(), _expanding.end(), [word, wordLen](const TextSpan &name)
+                    { return (name.Len == wordLen) && (memcmp(name.Ptr, word, wordLen) == 0); }))
+            {
+                _expansions.push_back({ wordEnd, static_cast<size_t>(end - wordEnd) });
+                _expanding.push_back({ word, wordLen });
+                str = macro->GetCStr();
+                end = str + macro->GetLength();
             }
             else
-                line = "";
-
-            while (line.GetLength() == 0 && !previousOutput.empty())
             {
-                String result = output.GetString();
-                output = previousOutput.back();
-                previousOutput.pop_back();
-                line = previousLine.back();
-                previousLine.pop_back();
-                ignored.pop_back();
-                output.WriteString(result);
+                output.append(word, wordLen);
+                str = wordEnd;
             }
-
         }
-
-        return output.GetString();
     }
 
 
     String Preprocessor::Preprocess(const String& script, const String& scriptName)
     {
-        StringBuilder output = StringBuilder(script.GetLength());
+        // The script is scanned once, line by line, and the output is written
+        // into a single buffer; it is only larger than the script if the lines
+        // end with "\r\n", or the macros are longer than their names
+        const char *str = script.GetCStr();
+        const char *end = str + script.GetLength();
+        std::string output;
+        output.reserve(script.GetLength() + script.GetLength() / 8 + scriptName.GetLength() + 64);
         currentline = _lineNumber = 0;
-        output.WriteLine(String::FromFormat("%s%s\"", NEW_SCRIPT_TOKEN_PREFIX, scriptName.GetCStr()));
-        StringReader reader = StringReader(script);
+        output.append(String::FromFormat("%s%s\"", NEW_SCRIPT_TOKEN_PREFIX, scriptName.GetCStr()).GetCStr());
+        output.append(li_end);
         _scriptName = scriptName;
-        while (reader.IsValid())
+        while (str < end)
         {
             currentline = ++_lineNumber;
-            String thisLine = reader.ReadLine();
-            thisLine = RemoveComments(thisLine);
-            if (thisLine.GetLength() > 0)
+            const char *lineEnd = static_cast<const char*>(memchr(str, '\n', end - str));
+            if (!lineEnd)
+                lineEnd = end;
+            const TextSpan line = RemoveComments(str, lineEnd - str);
+            str = (lineEnd < end) ? lineEnd + 1 : end;
+            if (line.Len > 0)
             {
-                if (thisLine[0] != '#')
+                if (line.Ptr[0] != '#')
                 {
-                    thisLine = PreProcessLine(thisLine);
+                    PreProcessLine(line, output);
                 }
                 else
                 {
-                    thisLine = PreProcessDirective(thisLine);
+                    PreProcessDirective(line);
                 }
             }
-            output.WriteLine(thisLine);
+            output.append(li_end);
         }
 
 
@@ -413,7 +392,7 @@ namespace Preprocessor {
             LogError(ErrorCode::IfWithoutEndIf);
         }
 
-        return output.GetString();
+        return String(output.c_str(), output.size());
     }
 
     void Preprocessor::MergeMacros(MacroTable &macros) {
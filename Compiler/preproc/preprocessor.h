@@ -1,3 +1,5 @@
+#include <string>
+#include <vector>
 #include "script/cs_parser_common.h"
 #include "script/cc_macrotable.h"
 #include "util/string.h"
@@ -23,30 +25,44 @@ namespace Preprocessor {
 
     class Preprocessor {
     private:
+        // A part of the text, which is scanned in place, without copying it
+        struct TextSpan {
+            const char *Ptr;
+            size_t Len;
+        };
+
         bool _inMultiLineComment = false;
         MacroTable _macros = MacroTable();
         int _lineNumber;
         String _scriptName;
         Version _applicationVersion;
         std::vector<bool> _conditionalStatements = std::vector<bool>();
+        // Buffers reused by all the lines, so that these are not allocated per line
+        std::string _lineBuffer; // line joined around the comments
+        std::vector<TextSpan> _expansions; // rest of the text which used the macro
+        std::vector<TextSpan> _expanding; // macros being expanded, to prevent the recursion
 
         static void LogError(ErrorCode error, const String &message = nullptr);
 
-        void ProcessConditionalDirective(String &directive, String &line);
+        void ProcessConditionalDirective(const TextSpan &directive, TextSpan &line);
 
         bool DeletingCurrentLine();
 
-        static String GetNextWord(String &text, bool trimText = true, bool includeDots = false);
+        static TextSpan GetNextWord(TextSpan &text, bool includeDots = false);
 
-        String RemoveComments(String text);
+        TextSpan RemoveComments(const char *line, size_t len);
 
-        String PreProcessDirective(String &line);
+        void PreProcessDirective(TextSpan line);
 
-        String PreProcessLine(const String& lineToProcess);
+        void PreProcessLine(const TextSpan &line, std::string &output);
 
     public:
         void SetAppVersion(const String& version);
         void MergeMacros(MacroTable &macros);
+        // Gets all the currently defined macros
+        const MacroTable &GetMacros() const { return _macros; }
+        // Replaces all the defined macros with the given ones
+        void SetMacros(const MacroTable &macros) { _macros = macros; }
         void DefineMacro(const String &name, const String &value);
 
         String Preprocess(const String &script, const String &scriptName);
@@ -6,6 +6,11 @@
 #include "script/cc_internal.h"       // macro definitions
 #include "script/cc_symboltable.h"     // symbolTable
 #include "script/cc_common.h"      // ccGetOption
+#include "util/stream.h"
+#include "util/string_compat.h"
+#include "util/string_utils.h"
+
+using namespace AGS::Common;
 
 void ccCompiledScript::write_cmd(int cmdd) {
     write_code(cmdd);
@@ -42,10 +47,69 @@ ccCompiledScript::ccCompiledScript() {
     ax_val_type = 0;
     ax_val_scope = 0;
 }
+ccCompiledScript::ccCompiledScript(const ccCompiledScript &src)
+    : ccScript(src) {
+    codeallocated = codesize;
+    numfunctions = src.numfunctions;
+    memset(functions, 0, sizeof(functions));
+    for (int i = 0; i < numfunctions; i++) {
+        functions[i] = (char*)malloc(strlen(src.functions[i]) + 20);
+        strcpy(functions[i], src.functions[i]);
+    }
+    memcpy(funccodeoffs, src.funccodeoffs, sizeof(funccodeoffs));
+    memcpy(funcnumparams, src.funcnumparams, sizeof(funcnumparams));
+    cur_sp = src.cur_sp;
+    next_line = src.next_line;
+    ax_val_type = src.ax_val_type;
+    ax_val_scope = src.ax_val_scope;
+}
 ccCompiledScript::~ccCompiledScript() {
     shutdown();
 }
 
+void ccCompiledScript::write_state(Stream *out) const {
+    Write(out);
+    out->WriteInt32(numfunctions);
+    for (int i = 0; i < numfunctions; i++) {
+        StrUtil::WriteString(functions[i], out);
+        out->WriteInt32(funccodeoffs[i]);
+        out->WriteInt16(funcnumparams[i]);
+    }
+    out->WriteInt32(cur_sp);
+    out->WriteInt32(next_line);
+}
+
+bool ccCompiledScript::read_state(Stream *in) {
+    Free();
+    free_extra();
+    init();
+    if (!Read(in))
+        return false;
+    codeallocated = codesize;
+    importsCapacity = numimports;
+    exportsCapacity = numexports;
+    capacitySections = numSections;
+    // imports removed by the compiler are stored as empty names,
+    // but the compiler expects them to be valid strings
+    for (int i = 0; i < numimports; i++) {
+        if (!imports[i])
+            imports[i] = ags_strdup("");
+    }
+    int count = in->ReadInt32();
+    if ((count < 0) || (count > MAX_FUNCTIONS))
+        return false;
+    for (numfunctions = 0; numfunctions < count; numfunctions++) {
+        String name = StrUtil::ReadString(in);
+        functions[numfunctions] = (char*)malloc(name.GetLength() + 20);
+        strcpy(functions[numfunctions], name.GetCStr());
+        funccodeoffs[numfunctions] = in->ReadInt32();
+        funcnumparams[numfunctions] = in->ReadInt16();
+    }
+    cur_sp = in->ReadInt32();
+    next_line = in->ReadInt32();
+    return !in->HasErrors();
+}
+
 int ccCompiledScript::add_global(int siz,const char*vall) {
     //  printf("Add global size %d at %d\n",siz,globaldatasize);
     //  if (remove_any_import (vall)) return -2;
@@ -42,7 +42,13 @@ struct ccCompiledScript: public ccScript {
     void push_reg(int regg);
     void pop_reg(int regg);
 
+    // write the whole compilation state to the stream, and read it back;
+    // unlike ccScript::Write, this also keeps the functions and pending line number
+    void write_state(AGS::Common::Stream *out) const;
+    bool read_state(AGS::Common::Stream *in);
+
     ccCompiledScript();
+    ccCompiledScript(const ccCompiledScript &src);
     virtual ~ccCompiledScript();
 };
 
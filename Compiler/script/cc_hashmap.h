@@ -0,0 +1,152 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Hash table for the compiler's symbols and macros, keyed by names.
+//
+// Uses open addressing with linear probing, and keeps the hash of each key,
+// so that the lookups compare only a few names. The names may be looked up
+// by any part of the source text (pointer and length), and with the hash
+// calculated once by the caller, which saves creating a string per token.
+//
+//=============================================================================
+#ifndef __CC_HASHMAP_H
+#define __CC_HASHMAP_H
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "util/string_types.h"
+
+// Calculates the hash of the name, as used by ccHashMap
+inline uint32_t cc_hash_name(const char *name, size_t len) {
+    return (uint32_t)FNV::Hash(name, len);
+}
+
+template <typename TValue>
+class ccHashMap {
+public:
+    ccHashMap() = default;
+
+    size_t size() const { return _count; }
+
+    TValue *find(const char *key, size_t len, uint32_t hash) {
+        const size_t at = find_slot(key, len, hash);
+        return (at < _slots.size() && _slots[at].used) ? &_slots[at].value : nullptr;
+    }
+    const TValue *find(const char *key, size_t len, uint32_t hash) const {
+        return const_cast<ccHashMap*>(this)->find(key, len, hash);
+    }
+    TValue *find(const char *key) {
+        const size_t len = strlen(key);
+        return find(key, len, cc_hash_name(key, len));
+    }
+    const TValue *find(const char *key) const {
+        return const_cast<ccHashMap*>(this)->find(key);
+    }
+
+    // Adds the value, or replaces the existing one with the same key
+    void set(const char *key, size_t len, uint32_t hash, const TValue &value) {
+        // keep the table at most 3/4 full, so that the probe sequences stay short
+        if ((_count + 1) * 4 > _slots.size() * 3)
+            rehash(_slots.empty() ? 16 : _slots.size() * 2);
+        const size_t at = find_slot(key, len, hash);
+        Slot &slot = _slots[at];
+        if (!slot.used) {
+            slot.used = true;
+            slot.hash = hash;
+            slot.key.assign(key, len);
+            _count++;
+        }
+        slot.value = value;
+    }
+    void set(const char *key, const TValue &value) {
+        const size_t len = strlen(key);
+        set(key, len, cc_hash_name(key, len), value);
+    }
+
+    bool erase(const char *key, size_t len, uint32_t hash) {
+        size_t at = find_slot(key, len, hash);
+        if (at >= _slots.size() || !_slots[at].used)
+            return false;
+        // shift back the following entries of the probe sequence, which
+        // keeps them reachable without leaving the deleted markers
+        const size_t mask = _slots.size() - 1;
+        for (size_t next = (at + 1) & mask; _slots[next].used; next = (next + 1) & mask) {
+            const size_t home = _slots[next].hash & mask;
+            // move the entry if its home slot is not between the hole and itself
+            if (((next - home) & mask) >= ((next - at) & mask)) {
+                _slots[at] = std::move(_slots[next]);
+                at = next;
+            }
+        }
+        _slots[at] = Slot();
+        _count--;
+        return true;
+    }
+    bool erase(const char *key) {
+        const size_t len = strlen(key);
+        return erase(key, len, cc_hash_name(key, len));
+    }
+
+    void clear() {
+        _slots.clear();
+        _count = 0;
+    }
+
+    // Calls the function with each key and value, in no particular order
+    template <typename TFunc>
+    void for_each(TFunc func) const {
+        for (const auto &slot : _slots)
+            if (slot.used) func(slot.key, slot.value);
+    }
+
+private:
+    struct Slot {
+        bool used = false;
+        uint32_t hash = 0;
+        std::string key;
+        TValue value = TValue();
+    };
+
+    // Returns the slot with this key, or the free one where it should be added
+    size_t find_slot(const char *key, size_t len, uint32_t hash) const {
+        if (_slots.empty())
+            return 0;
+        const size_t mask = _slots.size() - 1;
+        for (size_t at = hash & mask;; at = (at + 1) & mask) {
+            const Slot &slot = _slots[at];
+            if (!slot.used ||
+                (slot.hash == hash && slot.key.size() == len && memcmp(slot.key.data(), key, len) == 0))
+                return at;
+        }
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old_slots(capacity);
+        old_slots.swap(_slots);
+        const size_t mask = _slots.size() - 1;
+        for (auto &slot : old_slots) {
+            if (!slot.used) continue;
+            size_t at = slot.hash & mask;
+            while (_slots[at].used)
+                at = (at + 1) & mask;
+            _slots[at] = std::move(slot);
+        }
+    }
+
+    std::vector<Slot> _slots; // size is always a power of two
+    size_t _count = 0;
+};
+
+#endif // __CC_HASHMAP_H
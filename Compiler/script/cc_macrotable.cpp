@@ -1,39 +1,76 @@
 
+#include <algorithm>
+#include <vector>
 #include "util/string.h"
 #include "script/cc_common.h"
 #include "script/cc_macrotable.h"
+#include "util/stream.h"
+#include "util/string_utils.h"
 
 using namespace AGS::Common;
 
 
 void MacroTable::merge(MacroTable &others) {
-    _macro_table.insert(others._macro_table.begin(), others._macro_table.end());
+    others._macro_table.for_each([this](const std::string &name, const String &value) {
+        if (!_macro_table.find(name.c_str(), name.size(), cc_hash_name(name.c_str(), name.size())))
+            _macro_table.set(name.c_str(), value);
+    });
 }
-bool MacroTable::contains(const String &name) {
-    return _macro_table.count(name) > 0;
+bool MacroTable::contains(const String &name) const {
+    return find(name.GetCStr(), name.GetLength()) != nullptr;
 }
-String MacroTable::get_macro(const String &name) {
-    if(_macro_table.count(name)) {
-        return _macro_table[name];
+String MacroTable::get_macro(const String &name) const {
+    const String *value = find(name.GetCStr(), name.GetLength());
+    if (value) {
+        return *value;
     }
     return nullptr;
 }
+const String *MacroTable::find(const char *name, size_t len) const {
+    return _macro_table.find(name, len, cc_hash_name(name, len));
+}
 void MacroTable::add(const String &macroname, const String &value) {
     if (this->contains(macroname)) {
         cc_error("macro '%s' already defined",macroname.GetCStr());
         return;
     }
 
-    _macro_table[macroname] = value;
+    _macro_table.set(macroname.GetCStr(), value);
 }
 void MacroTable::remove(String &macroname) {
     if (!this->contains(macroname)) {
         cc_error("MacroTable::Remove: macro '%s' not found", macroname.GetCStr());
         return;
     }
-    _macro_table.erase(macroname);
+    _macro_table.erase(macroname.GetCStr());
 }
 
 void MacroTable::clear() {
     _macro_table.clear();
 }
+
+void MacroTable::write(Stream *out) const {
+    // sorted by names, for the same output regardless of the table's layout
+    std::vector<std::pair<std::string, String>> macros;
+    macros.reserve(_macro_table.size());
+    _macro_table.for_each([&macros](const std::string &name, const String &value) {
+        macros.emplace_back(name, value);
+    });
+    std::sort(macros.begin(), macros.end(),
+        [](const std::pair<std::string, String> &a, const std::pair<std::string, String> &b)
+        { return a.first < b.first; });
+    out->WriteInt32(macros.size());
+    for (const auto &macro : macros) {
+        StrUtil::WriteString(macro.first.c_str(), macro.first.size(), out);
+        StrUtil::WriteString(macro.second, out);
+    }
+}
+
+void MacroTable::read(Stream *in) {
+    _macro_table.clear();
+    int count = in->ReadInt32();
+    for (int i = 0; i < count; i++) {
+        String name = StrUtil::ReadString(in);
+        _macro_table.set(name.GetCStr(), StrUtil::ReadString(in));
+    }
+}
@@ -1,21 +1,28 @@
 #ifndef __CC_MACROTABLE_H
 #define __CC_MACROTABLE_H
 
-#include <map>
+#include "script/cc_hashmap.h"
 #include "util/string.h"
 
+namespace AGS { namespace Common { class Stream; } }
+
 typedef AGS::Common::String AGString;
 
 struct MacroTable {
 private:
-    std::map<AGString,AGString> _macro_table;
+    ccHashMap<AGString> _macro_table;
 public:
-    bool contains(const AGString &name);
-    AGString get_macro(const AGString &name) ;
+    bool contains(const AGString &name) const;
+    AGString get_macro(const AGString &name) const;
+    // finds the macro named by a part of text, returns null if there's none
+    const AGString *find(const char *name, size_t len) const;
     void add(const AGString &macroname, const AGString &value);
     void remove(AGString &macroname);
     void merge(MacroTable & macro_table);
     void clear();
+    // write all the macros to the stream, and read them back, replacing current ones
+    void write(AGS::Common::Stream *out) const;
+    void read(AGS::Common::Stream *in);
 };
 
 #endif // __CC_MACROTABLE_H
\ No newline at end of file
@@ -0,0 +1,745 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "script/cc_optimizer.h"
+#include "script/cc_compiledscript.h"
+#include "script/cc_internal.h"
+
+// Number of arguments of each instruction
+static const int sccmd_argcount[CC_NUM_SCCMDS] = {
+    0, 2, 2, 2, 2, 0, 2, 1, 1, 2, // 0 - 9
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, // 10 - 19
+    2, 2, 2, 1, 1, 1, 1, 1, 1, 1, // 20 - 29
+    1, 1, 2, 1, 1, 1, 1, 1, 1, 1, // 30 - 39
+    2, 2, 1, 2, 2, 1, 2, 1, 1, 0, // 40 - 49
+    1, 1, 0, 2, 2, 2, 2, 2, 2, 2, // 50 - 59
+    2, 2, 2, 1, 1, 2, 2, 1, 0, 0, // 60 - 69
+    1, 1, 3, 2                    // 70 - 73
+};
+
+#define REGBIT(reg)    (1u << (reg))
+#define ALL_REGS       (((1u << CC_NUM_REGISTERS) - 1) & ~1u)
+// registers which only hold the intermediate values, writes to these may be removed
+#define GENERAL_REGS   (REGBIT(SREG_AX) | REGBIT(SREG_BX) | REGBIT(SREG_CX) | REGBIT(SREG_DX))
+
+// Instruction's effects on the virtual machine
+enum OpFlags {
+    kOp_Barrier  = 0x01, // calls, returns and unknown ops: may read and change anything
+    kOp_Jump     = 0x02, // has a target instruction
+    kOp_NoFallthrough = 0x04, // never continues to the next instruction
+    kOp_MemRead  = 0x08, // reads memory at MAR
+    kOp_MemWrite = 0x10, // writes memory at MAR
+    kOp_Stack    = 0x20  // pushes or pops the stack
+};
+
+struct OpEffect {
+    unsigned reads = 0;  // registers read
+    unsigned writes = 0; // registers written
+    int flags = 0;
+};
+
+struct Instr {
+    int32_t pos;  // position in the original code
+    int32_t cmd;
+    int32_t args[MAX_SCMD_ARGS];
+    char fixups[MAX_SCMD_ARGS]; // fixup type of each argument
+    int  target;  // index of the referenced instruction: jump target,
+                  // THISBASE or function address, -1 if none
+    bool label;   // control may arrive here from elsewhere than the previous instruction
+    bool entry;   // referenced from outside of the code: function, export or section start
+    bool removed;
+};
+
+struct OptimizerState {
+    std::vector<Instr> code;
+    std::vector<int> wordToInstr; // code position -> instruction index
+};
+
+static bool is_valid_reg(int32_t reg) {
+    return reg > 0 && reg < CC_NUM_REGISTERS;
+}
+
+static bool has_fixups(const Instr &ins) {
+    for (int a = 0; a < MAX_SCMD_ARGS; a++)
+        if (ins.fixups[a] != FIXUP_NOFIXUP) return true;
+    return false;
+}
+
+// Gets the bit of the register operand; an invalid register resets the valid flag
+static unsigned reg_bit(int32_t reg, bool &valid) {
+    if (is_valid_reg(reg))
+        return REGBIT(reg);
+    valid = false;
+    return 0u;
+}
+
+static OpEffect get_effect(const Instr &ins) {
+    OpEffect eff;
+    // the register bits are only taken for the operands which are registers,
+    // as the other operands may hold any literal value
+    bool valid = true;
+    switch (ins.cmd) {
+    case SCMD_ADD: case SCMD_SUB: case SCMD_MUL:
+    case SCMD_FADD: case SCMD_FSUB:
+    case SCMD_NOTREG:
+        eff.reads = eff.writes = reg_bit(ins.args[0], valid);
+        if (ins.args[0] == SREG_SP) eff.flags = kOp_Stack;
+        break;
+    case SCMD_REGTOREG:
+        eff.reads = reg_bit(ins.args[0], valid); eff.writes = reg_bit(ins.args[1], valid); break;
+    case SCMD_LITTOREG:
+        eff.writes = reg_bit(ins.args[0], valid); break;
+    case SCMD_MEMREAD: case SCMD_MEMREADB: case SCMD_MEMREADW: case SCMD_MEMREADPTR:
+        eff.reads = REGBIT(SREG_MAR); eff.writes = reg_bit(ins.args[0], valid);
+        eff.flags = kOp_MemRead; break;
+    case SCMD_MEMWRITE: case SCMD_MEMWRITEB: case SCMD_MEMWRITEW:
+    case SCMD_MEMWRITEPTR: case SCMD_MEMINITPTR:
+        eff.reads = reg_bit(ins.args[0], valid) | REGBIT(SREG_MAR); eff.flags = kOp_MemWrite; break;
+    case SCMD_WRITELIT: case SCMD_ZEROMEMORY: case SCMD_MEMZEROPTR:
+        eff.reads = REGBIT(SREG_MAR); eff.flags = kOp_MemWrite; break;
+    case SCMD_MEMZEROPTRND:
+        eff.reads = REGBIT(SREG_MAR) | REGBIT(SREG_AX); eff.flags = kOp_MemWrite; break;
+    case SCMD_MULREG: case SCMD_DIVREG: case SCMD_ADDREG: case SCMD_SUBREG:
+    case SCMD_BITAND: case SCMD_BITOR: case SCMD_ISEQUAL: case SCMD_NOTEQUAL:
+    case SCMD_GREATER: case SCMD_LESSTHAN: case SCMD_GTE: case SCMD_LTE:
+    case SCMD_AND: case SCMD_OR: case SCMD_MODREG: case SCMD_XORREG:
+    case SCMD_SHIFTLEFT: case SCMD_SHIFTRIGHT:
+    case SCMD_FMULREG: case SCMD_FDIVREG: case SCMD_FADDREG: case SCMD_FSUBREG:
+    case SCMD_FGREATER: case SCMD_FLESSTHAN: case SCMD_FGTE: case SCMD_FLTE:
+    case SCMD_STRINGSEQUAL: case SCMD_STRINGSNOTEQ:
+        eff.writes = reg_bit(ins.args[0], valid);
+        eff.reads = eff.writes | reg_bit(ins.args[1], valid); break;
+    case SCMD_JZ: case SCMD_JNZ:
+        eff.reads = REGBIT(SREG_AX); eff.flags = kOp_Jump; break;
+    case SCMD_JMP:
+        eff.flags = kOp_Jump | kOp_NoFallthrough; break;
+    case SCMD_PUSHREG:
+        eff.reads = reg_bit(ins.args[0], valid) | REGBIT(SREG_SP); eff.writes = REGBIT(SREG_SP);
+        eff.flags = kOp_Stack; break;
+    case SCMD_POPREG:
+        eff.reads = REGBIT(SREG_SP); eff.writes = reg_bit(ins.args[0], valid) | REGBIT(SREG_SP);
+        eff.flags = kOp_Stack; break;
+    case SCMD_PUSHREAL: case SCMD_CHECKBOUNDS: case SCMD_CHECKNULLREG:
+        eff.reads = reg_bit(ins.args[0], valid); break;
+    case SCMD_LOADSPOFFS:
+        eff.reads = REGBIT(SREG_SP); eff.writes = REGBIT(SREG_MAR); break;
+    case SCMD_CHECKNULL:
+        eff.reads = REGBIT(SREG_MAR); eff.flags = kOp_MemRead; break;
+    case SCMD_DYNAMICBOUNDS:
+        eff.reads = reg_bit(ins.args[0], valid) | REGBIT(SREG_MAR); eff.flags = kOp_MemRead; break;
+    case SCMD_CREATESTRING: case SCMD_NEWARRAY: case SCMD_NEWUSEROBJECT:
+        eff.reads = eff.writes = reg_bit(ins.args[0], valid); break;
+    case SCMD_SUBREALSTACK: case SCMD_NUMFUNCARGS:
+    case SCMD_LINENUM: case SCMD_THISBASE: case SCMD_LOOPCHECKOFF:
+        break;
+    case SCMD_RET:
+        eff.reads = ALL_REGS; eff.flags = kOp_Barrier | kOp_NoFallthrough; break;
+    default: // calls, and anything not known
+        eff.reads = ALL_REGS; eff.writes = ALL_REGS; eff.flags = kOp_Barrier; break;
+    }
+    if (!valid) {
+        // malformed instruction, assume that it may do anything
+        eff.reads = ALL_REGS; eff.writes = ALL_REGS; eff.flags |= kOp_Barrier;
+    }
+    return eff;
+}
+
+// Returns the first instruction at or after the given index which was not removed
+static int next_kept(const OptimizerState &st, int idx) {
+    const int count = (int)st.code.size();
+    while (idx < count && st.code[idx].removed)
+        idx++;
+    return idx;
+}
+
+static void remove_instr(OptimizerState &st, int idx) {
+    Instr &ins = st.code[idx];
+    ins.removed = true;
+    // whatever referenced this instruction will now arrive at the next one
+    if (ins.label || ins.entry) {
+        int next = next_kept(st, idx + 1);
+        if (next < (int)st.code.size()) {
+            st.code[next].label |= ins.label;
+            st.code[next].entry |= ins.entry;
+        }
+    }
+}
+
+// Marks the instructions which may be reached from elsewhere than the previous one;
+// the references change as the code is optimized, so this is redone on each pass
+static void update_labels(OptimizerState &st) {
+    const int count = (int)st.code.size();
+    for (int i = 0; i < count; i++)
+        st.code[i].label = st.code[i].entry;
+    for (int i = 0; i < count; i++) {
+        const Instr &ins = st.code[i];
+        if (ins.removed || ins.target < 0)
+            continue;
+        const int target = next_kept(st, ins.target);
+        if (target < count)
+            st.code[target].label = true;
+    }
+}
+
+static void replace_instr(Instr &ins, int32_t cmd, int32_t arg1, int32_t arg2) {
+    ins.cmd = cmd;
+    ins.args[0] = arg1;
+    ins.args[1] = arg2;
+    ins.args[2] = 0;
+    memset(ins.fixups, FIXUP_NOFIXUP, sizeof(ins.fixups));
+    ins.target = -1;
+}
+
+// Splits the code into instructions; fails if the code contains anything unexpected
+static bool decode(ccCompiledScript *scrip, OptimizerState &st) {
+    st.wordToInstr.assign(scrip->codesize + 1, -1);
+    for (int32_t pos = 0; pos < scrip->codesize;) {
+        Instr ins;
+        ins.pos = pos;
+        ins.cmd = scrip->code[pos];
+        if (ins.cmd < 0 || ins.cmd >= CC_NUM_SCCMDS)
+            return false;
+        const int argc = sccmd_argcount[ins.cmd];
+        if (pos + argc >= scrip->codesize)
+            return false;
+        for (int a = 0; a < MAX_SCMD_ARGS; a++) {
+            ins.args[a] = (a < argc) ? scrip->code[pos + 1 + a] : 0;
+            ins.fixups[a] = FIXUP_NOFIXUP;
+        }
+        ins.target = -1;
+        ins.label = false;
+        ins.entry = false;
+        ins.removed = false;
+        for (int w = 0; w <= argc; w++)
+            st.wordToInstr[pos + w] = (int)st.code.size();
+        st.code.push_back(ins);
+        pos += argc + 1;
+    }
+    st.wordToInstr[scrip->codesize] = (int)st.code.size(); // the end of code
+
+    for (int i = 0; i < scrip->numfixups; i++) {
+        if (scrip->fixuptypes[i] == FIXUP_DATADATA)
+            continue; // refers to global data
+        const int32_t pos = scrip->fixups[i];
+        if (pos < 0 || pos >= scrip->codesize)
+            return false;
+        Instr &ins = st.code[st.wordToInstr[pos]];
+        const int arg = pos - ins.pos - 1;
+        if (arg < 0)
+            return false;
+        ins.fixups[arg] = scrip->fixuptypes[i];
+    }
+    return true;
+}
+
+// Returns the instruction which begins at the given code address, -1 if there's none
+static int find_instr_at(const OptimizerState &st, int32_t addr) {
+    if (addr < 0 || addr >= (int32_t)st.wordToInstr.size())
+        return -1;
+    const int idx = st.wordToInstr[addr];
+    if (idx < 0 || (idx < (int)st.code.size() && st.code[idx].pos != addr))
+        return -1;
+    return idx;
+}
+
+static bool mark_entry(OptimizerState &st, int32_t addr) {
+    const int idx = find_instr_at(st, addr);
+    if (idx < 0)
+        return false;
+    if (idx < (int)st.code.size())
+        st.code[idx].entry = true;
+    return true;
+}
+
+// Resolves the code references: jumps, and the absolute code addresses
+static bool find_references(ccCompiledScript *scrip, OptimizerState &st) {
+    for (size_t i = 0; i < st.code.size(); i++) {
+        Instr &ins = st.code[i];
+        int32_t addr = -1;
+        if (ins.cmd == SCMD_JZ || ins.cmd == SCMD_JNZ || ins.cmd == SCMD_JMP)
+            addr = ins.pos + 2 + ins.args[0];
+        else if (ins.cmd == SCMD_THISBASE)
+            addr = ins.args[0];
+        else if (ins.cmd == SCMD_LITTOREG && ins.fixups[1] == FIXUP_FUNCTION)
+            addr = ins.args[1];
+        else if ((ins.fixups[0] == FIXUP_FUNCTION) || (ins.fixups[1] == FIXUP_FUNCTION) ||
+                 (ins.fixups[2] == FIXUP_FUNCTION))
+            return false; // function address in unexpected place
+        if (addr < 0)
+            continue;
+        ins.target = find_instr_at(st, addr);
+        if (ins.target < 0)
+            return false;
+    }
+
+    for (int i = 0; i < scrip->numfunctions; i++) {
+        if (!mark_entry(st, scrip->funccodeoffs[i])) return false;
+    }
+    for (int i = 0; i < scrip->numexports; i++) {
+        if (((scrip->export_addr[i] >> 24) & 0xff) != EXPORT_FUNCTION) continue;
+        if (!mark_entry(st, scrip->export_addr[i] & 0x00ffffff)) return false;
+    }
+    for (int i = 0; i < scrip->numSections; i++) {
+        if (!mark_entry(st, scrip->sectionOffsets[i])) return false;
+    }
+    return true;
+}
+
+// Redirects jumps which lead to another jump, and removes jumps to the next instruction
+static bool optimize_jumps(OptimizerState &st) {
+    bool changed = false;
+    const int count = (int)st.code.size();
+    for (int i = 0; i < count; i++) {
+        Instr &ins = st.code[i];
+        if (ins.removed || (ins.cmd != SCMD_JZ && ins.cmd != SCMD_JNZ && ins.cmd != SCMD_JMP))
+            continue;
+        // NOTE: the engine counts loop iterations on the backward JMP,
+        // so the threading should not change the number of these executed
+        const bool backward = next_kept(st, ins.target) <= i;
+        for (int hops = 0; hops < 16; hops++) {
+            const int t = next_kept(st, ins.target);
+            if (t >= count || t == i)
+                break;
+            const Instr &to = st.code[t];
+            const int t2 = next_kept(st, to.target);
+            int new_target = -1;
+            if (to.cmd == SCMD_JMP && t2 > t) {
+                if (ins.cmd != SCMD_JMP || ((t2 <= i) == backward))
+                    new_target = t2;
+            } else if (to.cmd == ins.cmd && ins.cmd != SCMD_JMP) {
+                new_target = t2; // same condition, same result
+            }
+            if (new_target < 0 || new_target == next_kept(st, ins.target))
+                break;
+            ins.target = new_target;
+            changed = true;
+        }
+
+        if (next_kept(st, ins.target) == next_kept(st, i + 1)) {
+            remove_instr(st, i);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Removes the instructions which cannot be reached
+static bool remove_unreachable(OptimizerState &st) {
+    bool changed = false;
+    bool reachable = true;
+    const int count = (int)st.code.size();
+    for (int i = 0; i < count; i++) {
+        Instr &ins = st.code[i];
+        if (ins.removed)
+            continue;
+        if (ins.label)
+            reachable = true;
+        if (!reachable) {
+            remove_instr(st, i);
+            changed = true;
+            continue;
+        }
+        if (get_effect(ins).flags & kOp_NoFallthrough)
+            reachable = false;
+    }
+    return changed;
+}
+
+// Replaces "push r1; <simple instructions>; pop r2" with "mov r1, r2; <simple instructions>"
+static bool optimize_push_pop(OptimizerState &st) {
+    bool changed = false;
+    const int count = (int)st.code.size();
+    for (int i = 0; i < count; i++) {
+        Instr &push = st.code[i];
+        if (push.removed || push.cmd != SCMD_PUSHREG || !is_valid_reg(push.args[0]) ||
+            push.args[0] == SREG_SP)
+            continue;
+        const unsigned r1 = REGBIT(push.args[0]);
+        unsigned reads = 0, writes = 0;
+        bool mar_set = false;
+        std::vector<int> spoffs; // stack accesses which should be adjusted
+        int pop_idx = -1;
+        for (int j = next_kept(st, i + 1); j < count; j = next_kept(st, j + 1)) {
+            const Instr &ins = st.code[j];
+            if (ins.label)
+                break;
+            if (ins.cmd == SCMD_POPREG) {
+                if (is_valid_reg(ins.args[0]) && ins.args[0] != SREG_SP)
+                    pop_idx = j;
+                break;
+            }
+            const OpEffect eff = get_effect(ins);
+            if ((eff.flags & (kOp_Barrier | kOp_Jump | kOp_MemWrite | kOp_Stack)) ||
+                ins.cmd == SCMD_PUSHREAL || ins.cmd == SCMD_SUBREALSTACK ||
+                ins.cmd == SCMD_NUMFUNCARGS || ins.cmd == SCMD_SUB || // SUB may use SP for stack pointers
+                ins.cmd == SCMD_CREATESTRING || ins.cmd == SCMD_NEWARRAY ||
+                ins.cmd == SCMD_NEWUSEROBJECT || ins.cmd == SCMD_THISBASE ||
+                ins.cmd == SCMD_LOOPCHECKOFF)
+                break;
+            if ((eff.writes & REGBIT(SREG_SP)) ||
+                (ins.fixups[0] == FIXUP_IMPORT) || (ins.fixups[1] == FIXUP_IMPORT))
+                break;
+            if (eff.reads & REGBIT(SREG_SP)) {
+                // the pushed value is not accessible this way, because the
+                // offsets at least 8 bytes deep point below it
+                if (ins.cmd != SCMD_LOADSPOFFS || ins.args[0] < 8)
+                    break;
+                spoffs.push_back(j);
+            }
+            // memory at MAR may only be read if MAR is set after the push
+            if ((eff.flags & kOp_MemRead) && !mar_set)
+                break;
+            if (eff.writes & REGBIT(SREG_MAR))
+                mar_set = true;
+            reads |= eff.reads;
+            writes |= eff.writes;
+        }
+        if (pop_idx < 0)
+            continue;
+        Instr &pop = st.code[pop_idx];
+        const unsigned r2 = REGBIT(pop.args[0]);
+        if ((reads | writes) & r2) {
+            // the popped register is used in between; only allowed if this is
+            // the same register, which keeps its value
+            if (r1 != r2 || (writes & r2))
+                continue;
+        }
+
+        if (r1 == r2)
+            remove_instr(st, i);
+        else
+            replace_instr(push, SCMD_REGTOREG, push.args[0], pop.args[0]);
+        remove_instr(st, pop_idx);
+        for (int j : spoffs)
+            st.code[j].args[0] -= 4;
+        changed = true;
+    }
+    return changed;
+}
+
+// Calculates the result of the integer operation; returns false if it
+// cannot be done at compile time (e.g. division by zero, which must fail at runtime)
+static bool calc_operation(int32_t cmd, int32_t a, int32_t b, int32_t &result) {
+    const uint32_t ua = (uint32_t)a, ub = (uint32_t)b;
+    switch (cmd) {
+    case SCMD_ADD: case SCMD_ADDREG: result = (int32_t)(ua + ub); return true;
+    case SCMD_SUB: case SCMD_SUBREG: result = (int32_t)(ua - ub); return true;
+    case SCMD_MUL: case SCMD_MULREG: result = (int32_t)(ua * ub); return true;
+    case SCMD_DIVREG:
+    case SCMD_MODREG:
+        if (b == 0 || (a == INT_MIN && b == -1))
+            return false;
+        result = (cmd == SCMD_DIVREG) ? (a / b) : (a % b);
+        return true;
+    case SCMD_BITAND: result = a & b; return true;
+    case SCMD_BITOR: result = a | b; return true;
+    case SCMD_XORREG: result = a ^ b; return true;
+    case SCMD_SHIFTLEFT:
+        if (b < 0 || b > 31) return false;
+        result = (int32_t)(ua << b);
+        return true;
+    case SCMD_SHIFTRIGHT:
+        if (b < 0 || b > 31) return false;
+        result = a >> b;
+        return true;
+    case SCMD_ISEQUAL: result = (a == b) ? 1 : 0; return true;
+    case SCMD_NOTEQUAL: result = (a != b) ? 1 : 0; return true;
+    case SCMD_GREATER: result = (a > b) ? 1 : 0; return true;
+    case SCMD_LESSTHAN: result = (a < b) ? 1 : 0; return true;
+    case SCMD_GTE: result = (a >= b) ? 1 : 0; return true;
+    case SCMD_LTE: result = (a <= b) ? 1 : 0; return true;
+    case SCMD_AND: result = (a && b) ? 1 : 0; return true;
+    case SCMD_OR: result = (a || b) ? 1 : 0; return true;
+    default: return false;
+    }
+}
+
+// Tracks the registers with known integer values within each block of code,
+// and precalculates the operations on them
+static bool fold_constants(OptimizerState &st) {
+    bool changed = false;
+    bool known[CC_NUM_REGISTERS] = {};
+    int32_t value[CC_NUM_REGISTERS] = {};
+    const int count = (int)st.code.size();
+    for (int i = 0; i < count; i++) {
+        Instr &ins = st.code[i];
+        if (ins.removed)
+            continue;
+        if (ins.label)
+            memset(known, 0, sizeof(known));
+
+        const int32_t reg1 = ins.args[0], reg2 = ins.args[1];
+        const bool general1 = is_valid_reg(reg1) && (REGBIT(reg1) & GENERAL_REGS);
+        const bool general2 = is_valid_reg(reg2) && (REGBIT(reg2) & GENERAL_REGS);
+        int32_t result;
+        switch (ins.cmd) {
+        case SCMD_LITTOREG:
+            if (general1 && !has_fixups(ins)) {
+                known[reg1] = true;
+                value[reg1] = ins.args[1];
+                continue;
+            }
+            break;
+        case SCMD_REGTOREG:
+            if (general1 && general2 && known[reg1]) {
+                replace_instr(ins, SCMD_LITTOREG, reg2, value[reg1]);
+                known[reg2] = true;
+                value[reg2] = value[reg1];
+                changed = true;
+                continue;
+            }
+            break;
+        case SCMD_ADD: case SCMD_SUB: case SCMD_MUL:
+            if (general1 && known[reg1] && !has_fixups(ins) &&
+                calc_operation(ins.cmd, value[reg1], ins.args[1], result)) {
+                replace_instr(ins, SCMD_LITTOREG, reg1, result);
+                value[reg1] = result;
+                changed = true;
+                continue;
+            }
+            break;
+        case SCMD_NOTREG:
+            if (general1 && known[reg1]) {
+                replace_instr(ins, SCMD_LITTOREG, reg1, value[reg1] ? 0 : 1);
+                value[reg1] = value[reg1] ? 0 : 1;
+                changed = true;
+                continue;
+            }
+            break;
+        case SCMD_ADDREG: case SCMD_SUBREG: case SCMD_MULREG: case SCMD_DIVREG:
+        case SCMD_MODREG: case SCMD_BITAND: case SCMD_BITOR: case SCMD_XORREG:
+        case SCMD_SHIFTLEFT: case SCMD_SHIFTRIGHT: case SCMD_ISEQUAL: case SCMD_NOTEQUAL:
+        case SCMD_GREATER: case SCMD_LESSTHAN: case SCMD_GTE: case SCMD_LTE:
+        case SCMD_AND: case SCMD_OR:
+            if (!general1 || !general2)
+                break;
+            if (known[reg1] && known[reg2] &&
+                calc_operation(ins.cmd, value[reg1], value[reg2], result)) {
+                replace_instr(ins, SCMD_LITTOREG, reg1, result);
+                value[reg1] = result;
+                changed = true;
+                continue;
+            }
+            // adding a constant does not need the second register
+            if (ins.cmd == SCMD_ADDREG && known[reg2] && !known[reg1]) {
+                if (value[reg2] == 0)
+                    remove_instr(st, i);
+                else
+                    replace_instr(ins, SCMD_ADD, reg1, value[reg2]);
+                changed = true;
+                continue;
+            }
+            break;
+        case SCMD_JZ: case SCMD_JNZ:
+            if (known[SREG_AX]) {
+                const bool taken = (ins.cmd == SCMD_JZ) == (value[SREG_AX] == 0);
+                if (!taken) {
+                    remove_instr(st, i);
+                    changed = true;
+                    continue;
+                }
+                // a backward JMP would count as a loop iteration, conditional jumps don't
+                if (next_kept(st, ins.target) > i) {
+                    ins.cmd = SCMD_JMP;
+                    changed = true;
+                }
+            }
+            break;
+        default:
+            break;
+        }
+
+        const OpEffect eff = get_effect(ins);
+        if (eff.flags & (kOp_Barrier | kOp_Jump)) {
+            memset(known, 0, sizeof(known));
+        } else {
+            for (int r = 0; r < CC_NUM_REGISTERS; r++)
+                if (eff.writes & REGBIT(r)) known[r] = false;
+        }
+    }
+    return changed;
+}
+
+// Removes the register loads which are overwritten before they are read,
+// using the registers' liveness across the whole code
+static bool remove_dead_stores(OptimizerState &st) {
+    const int count = (int)st.code.size();
+    std::vector<unsigned> live_in(count + 1, 0);
+    live_in[count] = ALL_REGS;
+    for (bool updated = true; updated;) {
+        updated = false;
+        for (int i = count - 1; i >= 0; i--) {
+            const Instr &ins = st.code[i];
+            if (ins.removed)
+                continue;
+            const OpEffect eff = get_effect(ins);
+            unsigned live_out = 0;
+            if (!(eff.flags & kOp_NoFallthrough))
+                live_out |= live_in[next_kept(st, i + 1)];
+            if (eff.flags & kOp_Jump)
+                live_out |= live_in[next_kept(st, ins.target)];
+            const unsigned live = eff.reads | (live_out & ~eff.writes);
+            if (live != live_in[i]) {
+                live_in[i] = live;
+                updated = true;
+            }
+        }
+    }
+
+    bool changed = false;
+    for (int i = 0; i < count; i++) {
+        const Instr &ins = st.code[i];
+        if (ins.removed || (ins.cmd != SCMD_LITTOREG && ins.cmd != SCMD_REGTOREG))
+            continue;
+        const int32_t dest = (ins.cmd == SCMD_LITTOREG) ? ins.args[0] : ins.args[1];
+        if (!is_valid_reg(dest) || !(REGBIT(dest) & GENERAL_REGS))
+            continue;
+        if ((live_in[next_kept(st, i + 1)] & REGBIT(dest)) == 0) {
+            remove_instr(st, i);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+// Removes the line numbers which are followed by another line number,
+// or repeat the current line
+static bool coalesce_line_numbers(OptimizerState &st) {
+    bool changed = false;
+    int32_t line = -1;
+    const int count = (int)st.code.size();
+    for (int i = 0; i < count; i++) {
+        Instr &ins = st.code[i];
+        if (ins.removed)
+            continue;
+        if (ins.label)
+            line = -1;
+        if (ins.cmd == SCMD_LINENUM) {
+            const int next = next_kept(st, i + 1);
+            if ((next < count && st.code[next].cmd == SCMD_LINENUM) ||
+                (ins.args[0] == line && !ins.label)) {
+                remove_instr(st, i);
+                changed = true;
+                continue;
+            }
+            line = ins.args[0];
+        }
+        // the called function changes the current line
+        else if (get_effect(ins).flags & kOp_Barrier) {
+            line = -1;
+        }
+    }
+    return changed;
+}
+
+// Writes the remaining instructions back, and updates all the code references
+static int encode(ccCompiledScript *scrip, OptimizerState &st) {
+    const int count = (int)st.code.size();
+    // new positions; removed instructions are replaced by the next remaining one
+    std::vector<int32_t> newpos(count + 1);
+    int32_t pos = 0;
+    for (int i = 0; i < count; i++) {
+        newpos[i] = pos;
+        if (!st.code[i].removed)
+            pos += sccmd_argcount[st.code[i].cmd] + 1;
+    }
+    newpos[count] = pos;
+    for (int i = count - 1; i >= 0; i--) {
+        if (st.code[i].removed)
+            newpos[i] = newpos[i + 1];
+    }
+    const int32_t new_codesize = pos;
+    auto map_addr = [&](int32_t addr) { return newpos[st.wordToInstr[addr]]; };
+
+    // fixups keep their order, those of the removed instructions are dropped
+    int numfixups = 0;
+    for (int i = 0; i < scrip->numfixups; i++) {
+        int32_t fixup = scrip->fixups[i];
+        if (scrip->fixuptypes[i] != FIXUP_DATADATA) {
+            const Instr &ins = st.code[st.wordToInstr[fixup]];
+            const int arg = fixup - ins.pos - 1;
+            if (ins.removed || ins.fixups[arg] == FIXUP_NOFIXUP)
+                continue;
+            fixup = map_addr(ins.pos) + 1 + arg;
+        }
+        scrip->fixups[numfixups] = fixup;
+        scrip->fixuptypes[numfixups] = scrip->fixuptypes[i];
+        numfixups++;
+    }
+    if (numfixups == 0 && scrip->numfixups > 0) {
+        free(scrip->fixups);
+        free(scrip->fixuptypes);
+        scrip->fixups = NULL;
+        scrip->fixuptypes = NULL;
+    }
+    scrip->numfixups = numfixups;
+
+    for (int i = 0; i < scrip->numfunctions; i++)
+        scrip->funccodeoffs[i] = map_addr(scrip->funccodeoffs[i]);
+    for (int i = 0; i < scrip->numexports; i++) {
+        if (((scrip->export_addr[i] >> 24) & 0xff) != EXPORT_FUNCTION) continue;
+        const int32_t addr = map_addr(scrip->export_addr[i] & 0x00ffffff);
+        scrip->export_addr[i] = (scrip->export_addr[i] & 0xff000000) | addr;
+    }
+    for (int i = 0; i < scrip->numSections; i++)
+        scrip->sectionOffsets[i] = map_addr(scrip->sectionOffsets[i]);
+
+    // the new code is never longer, so it is written over the old one
+    for (int i = 0; i < count; i++) {
+        Instr &ins = st.code[i];
+        if (ins.removed)
+            continue;
+        if (ins.target >= 0) {
+            const int32_t target = newpos[next_kept(st, ins.target)];
+            if (ins.cmd == SCMD_THISBASE)
+                ins.args[0] = target;
+            else if (ins.cmd == SCMD_LITTOREG)
+                ins.args[1] = target;
+            else
+                ins.args[0] = target - (newpos[i] + 2);
+        }
+        int32_t *dest = &scrip->code[newpos[i]];
+        dest[0] = ins.cmd;
+        for (int a = 0; a < sccmd_argcount[ins.cmd]; a++)
+            dest[1 + a] = ins.args[a];
+    }
+    const int removed = scrip->codesize - new_codesize;
+    scrip->codesize = new_codesize;
+    return removed;
+}
+
+int cc_optimize(ccCompiledScript *scrip) {
+    OptimizerState st;
+    if (!decode(scrip, st) || !find_references(scrip, st))
+        return -1;
+
+    // each optimization may let the others do more, so repeat them while
+    // anything changes (within a reasonable limit)
+    for (int pass = 0; pass < 8; pass++) {
+        bool changed = false;
+        update_labels(st);
+        changed |= optimize_push_pop(st);
+        changed |= fold_constants(st);
+        changed |= optimize_jumps(st);
+        changed |= remove_unreachable(st);
+        changed |= remove_dead_stores(st);
+        changed |= coalesce_line_numbers(st);
+        if (!changed)
+            break;
+    }
+    return encode(scrip, st);
+}
@@ -0,0 +1,43 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Bytecode optimizer: a pass over the compiled script's code, which
+// removes and simplifies the instructions without changing the result.
+//
+// The optimizations are:
+// * constant folding: operations on the registers with known values are
+//   replaced by loading the result;
+// * replacing push/pop pairs around simple instructions with a register move;
+// * removing register writes which are never read;
+// * jump threading, and removing jumps to the next instruction;
+// * removing unreachable instructions;
+// * coalescing line numbers which do not mark any code.
+//
+// All the code addresses (jumps, function offsets, exports, sections and
+// fixups) are updated to match the new code; each remaining instruction
+// keeps the line number it had.
+//
+//=============================================================================
+#ifndef __CC_OPTIMIZER_H
+#define __CC_OPTIMIZER_H
+
+struct ccCompiledScript;
+
+// Optimizes the script's code in place; should be called once the script
+// is compiled.
+// Returns the number of code words removed, or -1 if the code could not be
+// analyzed, in which case it is left unchanged.
+int cc_optimize(ccCompiledScript *scrip);
+
+#endif // __CC_OPTIMIZER_H
@@ -5,6 +5,9 @@
 #include "script/cc_symboltable.h"
 #include "script/cc_internal.h"      // macro definitions
 #include "script/cc_symboldef.h"   // macro definitions
+#include "util/stream.h"
+
+using AGS::Common::Stream;
 
 symbolTable::symbolTable() {
     normalIntSym = 0;
@@ -15,6 +18,32 @@ symbolTable::symbolTable() {
     stringStructSym = 0;
 }
 
+symbolTable::symbolTable(const symbolTable &other)
+    : normalIntSym(other.normalIntSym)
+    , normalStringSym(other.normalStringSym)
+    , normalFloatSym(other.normalFloatSym)
+    , normalVoidSym(other.normalVoidSym)
+    , nullSym(other.nullSym)
+    , stringStructSym(other.stringStructSym)
+    , entries(other.entries)
+    , symbolTree(other.symbolTree) {
+}
+
+symbolTable &symbolTable::operator =(const symbolTable &other) {
+    if (this == &other)
+        return *this;
+    clear_name_cache();
+    normalIntSym = other.normalIntSym;
+    normalStringSym = other.normalStringSym;
+    normalFloatSym = other.normalFloatSym;
+    normalVoidSym = other.normalVoidSym;
+    nullSym = other.nullSym;
+    stringStructSym = other.stringStructSym;
+    entries = other.entries;
+    symbolTree = other.symbolTree;
+    return *this;
+}
+
 int SymbolTableEntry::get_num_args() {
 	// TODO: assert is func?
     return sscope % 100;
@@ -50,11 +79,15 @@ int SymbolTableEntry::get_propset() {
     return toret;
 }
 
-void symbolTable::reset() {
+void symbolTable::clear_name_cache() {
 	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
 		free(it->second);
 	}
 	nameGenCache.clear();
+}
+
+void symbolTable::reset() {
+	clear_name_cache();
 
 	entries.clear();
 
@@ -152,6 +185,10 @@ int symbolTable::find(const char*ntf) {
     return symbolTree.findValue(ntf);
 }
 
+int symbolTable::find(const char *name, size_t len, uint32_t hash) {
+    return symbolTree.findValue(name, len, hash);
+}
+
 std::string symbolTable::get_friendly_name(int idx) {
 
     int actualIdx = idx & STYPE_MASK;
@@ -244,4 +281,75 @@ int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
     return nss;
 }
 
-symbolTable sym;
+void symbolTable::write_state(Stream *out) const {
+    out->WriteInt32(normalIntSym);
+    out->WriteInt32(normalStringSym);
+    out->WriteInt32(normalFloatSym);
+    out->WriteInt32(normalVoidSym);
+    out->WriteInt32(nullSym);
+    out->WriteInt32(stringStructSym);
+    out->WriteInt32(entries.size());
+    for (const auto &entry : entries) {
+        out->WriteInt32(entry.sname.size());
+        out->Write(entry.sname.c_str(), entry.sname.size());
+        out->WriteInt16(entry.stype);
+        out->WriteInt32(entry.flags);
+        out->WriteInt16(entry.vartype);
+        out->WriteInt32(entry.soffs);
+        out->WriteInt32(entry.ssize);
+        out->WriteInt16(entry.sscope);
+        out->WriteInt32(entry.arrsize);
+        out->WriteInt16(entry.extends);
+        for (int i = 0; i <= MAX_FUNCTION_PARAMETERS; i++) {
+            out->WriteInt32(entry.funcparamtypes[i]);
+            out->WriteInt32(entry.funcParamDefaultValues[i]);
+            out->WriteBool(entry.funcParamHasDefaultValues[i]);
+        }
+    }
+}
+
+bool symbolTable::read_state(Stream *in) {
+    clear_name_cache();
+    entries.clear();
+    symbolTree.clear();
+
+    normalIntSym = in->ReadInt32();
+    normalStringSym = in->ReadInt32();
+    normalFloatSym = in->ReadInt32();
+    normalVoidSym = in->ReadInt32();
+    nullSym = in->ReadInt32();
+    stringStructSym = in->ReadInt32();
+    int count = in->ReadInt32();
+    if (count < 0)
+        return false;
+    entries.resize(count);
+    for (int idx = 0; idx < count; idx++) {
+        SymbolTableEntry &entry = entries[idx];
+        int namelen = in->ReadInt32();
+        if (namelen < 0)
+            return false;
+        entry.sname.resize(namelen);
+        if (namelen > 0 && in->Read(&entry.sname[0], namelen) != (size_t)namelen)
+            return false;
+        entry.stype = in->ReadInt16();
+        entry.flags = in->ReadInt32();
+        entry.vartype = in->ReadInt16();
+        entry.soffs = in->ReadInt32();
+        entry.ssize = in->ReadInt32();
+        entry.sscope = in->ReadInt16();
+        entry.arrsize = in->ReadInt32();
+        entry.extends = in->ReadInt16();
+        entry.funcparamtypes = std::vector<unsigned long>(MAX_FUNCTION_PARAMETERS + 1);
+        entry.funcParamDefaultValues = std::vector<int>(MAX_FUNCTION_PARAMETERS + 1);
+        entry.funcParamHasDefaultValues = std::vector<bool>(MAX_FUNCTION_PARAMETERS + 1);
+        for (int i = 0; i <= MAX_FUNCTION_PARAMETERS; i++) {
+            entry.funcparamtypes[i] = static_cast<uint32_t>(in->ReadInt32());
+            entry.funcParamDefaultValues[i] = in->ReadInt32();
+            entry.funcParamHasDefaultValues[i] = in->ReadBool();
+        }
+        symbolTree.addEntry(entry.sname.c_str(), idx);
+    }
+    return !in->HasErrors();
+}
+
+CC_THREAD_LOCAL symbolTable sym;
@@ -2,12 +2,15 @@
 #define __CC_SYMBOLTABLE_H
 
 #include "cs_parser_common.h"   // macro definitions
+#include "script/cc_common.h"   // CC_THREAD_LOCAL
 #include "script/cc_treemap.h"
 
 #include <map>
 #include <string>
 #include <vector>
 
+namespace AGS { namespace Common { class Stream; } }
+
 // So there's another symbol definition in cc_symboldef.h
 struct SymbolTableEntry {
 	std::string sname;
@@ -51,8 +54,13 @@ struct symbolTable {
 	std::vector<SymbolTableEntry> entries;
 
     symbolTable();
+    // copies the symbols, but not the generated names cache
+    symbolTable(const symbolTable &other);
+    symbolTable &operator =(const symbolTable &other);
     void reset();    // clears table
     int  find(const char*);  // returns ID of symbol, or -1
+    // finds the symbol named by a part of text, with the hash from cc_hash_name
+    int  find(const char *name, size_t len, uint32_t hash);
     int  add_ex(const char*,int,char);  // adds new symbol of type and size
     int  add(const char*);   // adds new symbol, returns -1 if already exists
 
@@ -62,6 +70,11 @@ struct symbolTable {
 
     int  get_type(int ii);
 
+    // write the symbols to the stream, and read them back, replacing
+    // the current table contents; returns false if read data is not valid
+    void write_state(AGS::Common::Stream *out) const;
+    bool read_state(AGS::Common::Stream *in);
+
 
 private:
 
@@ -72,9 +85,10 @@ private:
 
     int  add_operator(const char*, int priority, int vcpucmd); // adds new operator
     std::string get_name_string(int idx);
+    void clear_name_cache();
 };
 
 
-extern symbolTable sym;
+extern CC_THREAD_LOCAL symbolTable sym;
 
 #endif //__CC_SYMBOLTABLE_H
@@ -17,16 +17,21 @@
 
 int ccTreeMap::findValue(const char *key) {
 	if (!key || strlen(key) <= 0) { return -1; }
-    std::string cppkey(key);
-    if (this->storage.count(cppkey) <= 0) { return -1; }
-    return this->storage[cppkey];
+    const int *value = this->storage.find(key);
+    return value ? *value : -1;
+}
+
+int ccTreeMap::findValue(const char *key, size_t len, uint32_t hash) {
+    if (len == 0) { return -1; }
+    const int *value = this->storage.find(key, len, hash);
+    return value ? *value : -1;
 }
 
 void ccTreeMap::addEntry(const char* ntx, int p_value) {
     // don't add if it's an empty string or if it's already here
     if (!ntx || strlen(ntx) <= 0) { return; }
 
-    this->storage[std::string(ntx)] = p_value;
+    this->storage.set(ntx, p_value);
 }
 
 void ccTreeMap::clear() {
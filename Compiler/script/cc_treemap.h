@@ -19,18 +19,19 @@
 #ifndef __CC_TREEMAP_H
 #define __CC_TREEMAP_H
 
-#include <map>
-#include <string>
+#include "script/cc_hashmap.h"
 
-// Mimics original interface but uses a std::map for storage
+// Mimics original interface but uses a hash table for storage
 struct ccTreeMap {
     int findValue(const char *key);
+    // finds the name given by a part of text, with the hash from cc_hash_name
+    int findValue(const char *key, size_t len, uint32_t hash);
     void addEntry(const char *ntx, int p_value);
     void clear();
     ~ccTreeMap();
 
 private:
-    std::map<std::string, int> storage;
+    ccHashMap<int> storage;
 };
 
 #endif // __CC_TREEMAP_H
\ No newline at end of file
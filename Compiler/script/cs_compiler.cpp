@@ -2,21 +2,77 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <chrono>
+#include <memory>
 #include "script/cs_compiler.h"
 #include "script/cc_macrotable.h"
 #include "script/cc_compiledscript.h"
 #include "script/cc_symboltable.h"
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
+#include "script/cc_optimizer.h"
 #include "script/cs_parser.h"
+#include "util/stream.h"
+#include "util/string_types.h"
 
-const char *ccSoftwareVersion = "1.0";
-const char *ccCurScriptName = "";
+using AGS::Common::Stream;
 
-std::vector<const char*> defaultheaders;
-std::vector<const char*> defaultHeaderNames;
+// Compilation state is kept per thread, see CC_THREAD_LOCAL
+CC_THREAD_LOCAL const char *ccSoftwareVersion = "1.0";
+CC_THREAD_LOCAL const char *ccCurScriptName = "";
 
-MacroTable predefinedMacros;
+CC_THREAD_LOCAL std::vector<const char*> defaultheaders;
+CC_THREAD_LOCAL std::vector<const char*> defaultHeaderNames;
+
+CC_THREAD_LOCAL MacroTable predefinedMacros;
+
+// Compiler state after compiling a sequence of default headers;
+// it is never modified once created, so may be shared between threads
+struct ccPrecompiledHeaders {
+    uint64_t optionsKey = 0;          // hash of the compiler options
+    std::vector<uint64_t> headerKeys; // hashes of the compiled headers, in order
+    symbolTable symbols;
+    std::unique_ptr<ccCompiledScript> script;
+};
+
+static const char pchSignature[] = "AGSPCH";
+static const int32_t pchVersion = 1;
+
+static CC_THREAD_LOCAL bool usePrecompiledHeaders = false;
+static CC_THREAD_LOCAL PPrecompiledHeaders precompiledHeaders;
+static CC_THREAD_LOCAL bool precompiledHeadersChanged = false;
+
+static uint64_t get_options_key() {
+    char options[64];
+    int len = snprintf(options, sizeof(options), "%d:", SCOM_VERSION);
+    for (int bit = SCOPT_EXPORTALL; bit <= SCOPT_UTF8; bit <<= 1)
+        options[len++] = ccGetOption(bit) ? '1' : '0';
+    return FNV::Hash64(options, len);
+}
+
+static std::vector<uint64_t> get_header_keys() {
+    std::vector<uint64_t> keys;
+    for (size_t t = 0; t < defaultheaders.size(); t++) {
+        const char *name = defaultHeaderNames[t] ? defaultHeaderNames[t] : "";
+        uint64_t hash = FNV::Hash64(name, strlen(name) + 1);
+        keys.push_back(FNV::Hash64(defaultheaders[t], strlen(defaultheaders[t]), hash));
+    }
+    return keys;
+}
+
+// Returns the number of headers which may be skipped using precompiled state
+static size_t match_precompiled_headers(const std::vector<uint64_t> &header_keys) {
+    if (!precompiledHeaders)
+        return 0;
+    const ccPrecompiledHeaders &pch = *precompiledHeaders;
+    if ((pch.optionsKey != get_options_key()) || (pch.headerKeys.size() > header_keys.size()))
+        return 0;
+    for (size_t t = 0; t < pch.headerKeys.size(); t++) {
+        if (pch.headerKeys[t] != header_keys[t])
+            return 0;
+    }
+    return pch.headerKeys.size();
+}
 
 int ccAddDefaultHeader(const char* nhead, const char *nName)
 {
@@ -34,18 +90,30 @@ void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
-
-    sym.reset();
+// Compiles the default headers, or restores their precompiled state;
+// returns the new script, or NULL on failure
+static ccCompiledScript *compile_headers() {
+    ccCompiledScript *cctemp;
+    std::vector<uint64_t> header_keys;
+    size_t first_header = 0;
+    if (usePrecompiledHeaders) {
+        header_keys = get_header_keys();
+        first_header = match_precompiled_headers(header_keys);
+    }
 
-    if (scriptName == NULL)
-        scriptName = "Main script";
+    if (first_header > 0) {
+        // start from the precompiled state, and compile only the headers left
+        cctemp = new ccCompiledScript(*precompiledHeaders->script);
+        sym = precompiledHeaders->symbols;
+    } else {
+        cctemp = new ccCompiledScript();
+        cctemp->init();
+        sym.reset();
+    }
 
     cc_clear_error();
 
-    for (size_t t=0;t<defaultheaders.size();t++) {
+    for (size_t t=first_header;t<defaultheaders.size();t++) {
         if (defaultHeaderNames[t])
             ccCurScriptName = defaultHeaderNames[t];
         else
@@ -56,18 +124,46 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
         if (cc_has_error()) break;
     }
 
-    if (!cc_has_error()) {
-        ccCurScriptName = scriptName;
-        cctemp->start_new_section(ccCurScriptName);
-        cc_compile(texo,cctemp);
+    if (cc_has_error()) {
+        cctemp->shutdown();
+        delete cctemp;
+        return NULL;
     }
 
+    if (usePrecompiledHeaders && (first_header < defaultheaders.size())) {
+        std::shared_ptr<ccPrecompiledHeaders> pch(new ccPrecompiledHeaders());
+        pch->optionsKey = get_options_key();
+        pch->headerKeys = header_keys;
+        pch->symbols = sym;
+        pch->script.reset(new ccCompiledScript(*cctemp));
+        precompiledHeaders = pch;
+        precompiledHeadersChanged = true;
+    }
+    return cctemp;
+}
+
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
+    if (scriptName == NULL)
+        scriptName = "Main script";
+
+    ccCompiledScript *cctemp = compile_headers();
+    if (cctemp == NULL)
+        return NULL;
+
+    ccCurScriptName = scriptName;
+    cctemp->start_new_section(ccCurScriptName);
+    cc_compile(texo,cctemp);
+
     if (cc_has_error()) {
         cctemp->shutdown();
         delete cctemp;
         return NULL;
     }
 
+    const auto finalize_start = std::chrono::steady_clock::now();
+    if (ccGetOption(SCOPT_OPTIMIZE))
+        cc_optimize(cctemp);
+
     for (size_t t=0; t<sym.entries.size();t++) {
         int stype = sym.get_type(t);
         // blank out the name for imports that are not used, to save space
@@ -112,5 +208,86 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
     }
 
     cctemp->free_extra();
+    compileTimings.Finalize += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - finalize_start).count();
     return cctemp;
 }
+
+ccCompileTimings ccGetCompileTimings() {
+    return compileTimings;
+}
+
+void ccResetCompileTimings() {
+    compileTimings = ccCompileTimings();
+}
+
+void ccSetPrecompiledHeaders(bool enable) {
+    usePrecompiledHeaders = enable;
+    if (!enable)
+        ccFreePrecompiledHeaders();
+}
+
+bool ccPrecompileHeaders() {
+    if (!usePrecompiledHeaders)
+        return false;
+    ccCompiledScript *cctemp = compile_headers();
+    if (cctemp == NULL)
+        return false;
+    cctemp->shutdown();
+    delete cctemp;
+    return true;
+}
+
+void ccFreePrecompiledHeaders() {
+    precompiledHeaders.reset();
+    precompiledHeadersChanged = false;
+}
+
+bool ccPrecompiledHeadersChanged() {
+    return precompiledHeadersChanged;
+}
+
+PPrecompiledHeaders ccGetPrecompiledHeaders() {
+    return precompiledHeaders;
+}
+
+void ccUsePrecompiledHeaders(PPrecompiledHeaders pch) {
+    precompiledHeaders = pch;
+    precompiledHeadersChanged = false;
+}
+
+bool ccWritePrecompiledHeaders(Stream *out) {
+    if (!precompiledHeaders)
+        return false;
+    const ccPrecompiledHeaders &pch = *precompiledHeaders;
+    out->Write(pchSignature, sizeof(pchSignature));
+    out->WriteInt32(pchVersion);
+    out->WriteInt64(pch.optionsKey);
+    out->WriteInt32(pch.headerKeys.size());
+    for (uint64_t key : pch.headerKeys)
+        out->WriteInt64(key);
+    pch.symbols.write_state(out);
+    pch.script->write_state(out);
+    precompiledHeadersChanged = false;
+    return !out->HasErrors();
+}
+
+bool ccReadPrecompiledHeaders(Stream *in) {
+    char sig[sizeof(pchSignature)] = {};
+    in->Read(sig, sizeof(sig));
+    if ((memcmp(sig, pchSignature, sizeof(sig)) != 0) || (in->ReadInt32() != pchVersion))
+        return false;
+    std::shared_ptr<ccPrecompiledHeaders> pch(new ccPrecompiledHeaders());
+    pch->optionsKey = in->ReadInt64();
+    int count = in->ReadInt32();
+    if (count < 0)
+        return false;
+    for (int i = 0; i < count; i++)
+        pch->headerKeys.push_back(in->ReadInt64());
+    pch->script.reset(new ccCompiledScript());
+    if (!pch->symbols.read_state(in) || !pch->script->read_state(in))
+        return false;
+    precompiledHeaders = pch;
+    precompiledHeadersChanged = false;
+    return true;
+}
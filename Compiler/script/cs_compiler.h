@@ -13,8 +13,12 @@
 #ifndef __CS_COMPILER_H
 #define __CS_COMPILER_H
 
+#include <memory>
+#include "script/cc_common.h"  // CC_THREAD_LOCAL
 #include "script/cc_script.h"  // ccScript
 
+namespace AGS { namespace Common { class Stream; } }
+
 // ********* SCRIPT COMPILATION FUNCTIONS **************
 // add a script that will be compiled as a header into every compilation
 // 'name' is the name of the header, used in error reports
@@ -34,6 +38,42 @@ extern void ccSetSoftwareVersion(const char *version);
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
 
-extern const char *ccSoftwareVersion;
+// ********* PRECOMPILED HEADERS **************
+// when enabled, the compiler state after the default headers is kept,
+// and the following compilations which begin with the same headers (and use
+// same options) start from that state instead of compiling headers again
+extern void ccSetPrecompiledHeaders(bool enable);
+// compile the default headers into the precompiled headers state, without
+// compiling any script; has effect only if precompiled headers are enabled
+extern bool ccPrecompileHeaders();
+// discard the kept precompiled headers state
+extern void ccFreePrecompiledHeaders();
+// the precompiled headers state is never modified, and may be shared with
+// the compilations on other threads; each thread will use it as a starting point
+struct ccPrecompiledHeaders;
+typedef std::shared_ptr<const ccPrecompiledHeaders> PPrecompiledHeaders;
+// get current precompiled headers state
+extern PPrecompiledHeaders ccGetPrecompiledHeaders();
+// use the given precompiled headers state, e.g. one made on another thread
+extern void ccUsePrecompiledHeaders(PPrecompiledHeaders pch);
+// tells if the precompiled headers were updated since last read or written
+extern bool ccPrecompiledHeadersChanged();
+// write the precompiled headers state to the stream; returns false if there's none
+extern bool ccWritePrecompiledHeaders(AGS::Common::Stream *out);
+// read the precompiled headers state from the stream, replacing the current one;
+// returns false if the data is not valid
+extern bool ccReadPrecompiledHeaders(AGS::Common::Stream *in);
+
+extern CC_THREAD_LOCAL const char *ccSoftwareVersion;
+
+// Time spent by the current thread in each compilation phase, in microseconds,
+// summed over all the scripts and headers compiled since the last reset
+struct ccCompileTimings {
+    int64_t Tokenize = 0;
+    int64_t Parse = 0;    // parsing and code generation
+    int64_t Finalize = 0; // optimization, exports and fixups of the compiled script
+};
+extern ccCompileTimings ccGetCompileTimings();
+extern void ccResetCompileTimings();
 
 #endif // __CS_COMPILER_H
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <cerrno>
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 #include "script/cs_parser.h"
@@ -12,13 +14,11 @@
 #include "script/cc_common.h"
 #include "script/cc_internal.h"
 #include "cc_variablesymlist.h"
-#include "fmem.h"
 #include "util/utf8.h"
 
-extern int currentline;
 
 char ccCopyright[]="ScriptCompiler32 v" SCOM_VERSIONSTR " (c) 2000-2007 Chris Jones and 2011-2023 others";
-static char scriptNameBuffer[256];
+static CC_THREAD_LOCAL char scriptNameBuffer[256];
 
 int  evaluate_expression(ccInternalList*,ccCompiledScript*,int,bool insideBracketedDeclaration);
 int  evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expectCloseBracket, int cursym, long lilen, long *vnlist, bool insideBracketedDeclaration);
@@ -70,8 +70,8 @@ void clear_chunk_list(std::vector<ccChunk> *list) {
 
 static int is_part_of_symbol(char thischar, char startchar) {
     // workaround for strings
-    static int sayno_next_char = 0;
-    static int next_is_escaped = 0;
+    static CC_THREAD_LOCAL int sayno_next_char = 0;
+    static CC_THREAD_LOCAL int next_is_escaped = 0;
     if (sayno_next_char) {
         sayno_next_char = 0;
         return 0;
@@ -135,10 +135,10 @@ static int is_part_of_symbol(char thischar, char startchar) {
 
 // NOTE: global buffers meant to store parsed lines and symbols;
 // most of these were local char arrays of fixed size, refactored into global std::string for convenience
-std::string constructedMemberName;
-std::string thissymbol;
-std::string thissymbol_mangled;
-std::string constructedFunctionName;
+CC_THREAD_LOCAL std::string constructedMemberName;
+CC_THREAD_LOCAL std::string thissymbol;
+CC_THREAD_LOCAL std::string thissymbol_mangled;
+CC_THREAD_LOCAL std::string constructedFunctionName;
 
 const char *get_member_full_name(int structSym, int memberSym) {
 
@@ -180,20 +180,30 @@ int sym_find_or_add(symbolTable &sym, const char *sname) {
     return symdex;
 }
 
+static int sym_find_or_add(symbolTable &sym, const std::string &sname) {
+    int symdex = sym.find(sname.c_str(), sname.size(), cc_hash_name(sname.c_str(), sname.size()));
+    if (symdex < 0) {
+        symdex = sym.add(sname.c_str());
+    }
+    return symdex;
+}
+
 int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
     // *** create the symbol table and parse the text code into symbol code
     int linenum=1,in_struct_declr=-1,bracedepth = 0, last_time=0;
     int parenthesisdepth = 0;
-    FMEM*iii=fmem_open(inpl);
+    // the symbols are read directly from the source text
+    const char *pos = inpl;
+    const char *const end = inpl + strlen(inpl);
     targ->write_meta(SMETA_LINENUM,1);
-    while (!fmem_eof(iii)) {
+    while (pos < end) {
         int thischar, waseof = 0;
         do {  // skip the whitespace
-            if (fmem_eof(iii)) {
+            if (pos >= end) {
                 waseof = 1;
                 break;
             }
-            thischar = fmem_getc(iii);
+            thischar = *pos++;
         } while (is_whitespace(thischar));
         // if it was the end of file, abort
         if (waseof)
@@ -202,21 +212,16 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
             // write the line number (for debugging)
             linenum++;
             targ->write_meta(SMETA_LINENUM,linenum);
-            if (fmem_peekc(iii) =='\n') fmem_getc(iii);
+            if (*pos =='\n') pos++;
             currentline=linenum;
             // go back and get the whitespace after the CRLF
             continue;
         }
         // it's some sort of symbol, so read it in
-        int symlen=1;
-        thissymbol.resize(0);
-        thissymbol.push_back(thischar);
-        int thisIsEscaped = 0;
-        while (is_part_of_symbol(fmem_peekc(iii),thischar)) {
-
-            thissymbol.push_back(fmem_getc(iii));
-            symlen++;
-        }
+        const char *symstart = pos - 1;
+        while (is_part_of_symbol(*pos,thischar) && (pos < end))
+            pos++;
+        thissymbol.assign(symstart, pos - symstart);
         if ((thissymbol[0] == '\'') && (thissymbol.back() == '\'')) {
             int chr = 0;
             if (ccGetOption(SCOPT_UTF8)) {
@@ -237,7 +242,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
             thissymbol = get_mangled_name(thissymbol.c_str());
         }
 
-        int towrite = sym_find_or_add(sym, thissymbol.c_str());
+        int towrite = sym_find_or_add(sym, thissymbol);
         if (towrite < 0) {
             cc_error("symbol table overflow - could not ensure new symbol.");
             return -1;
@@ -330,7 +335,6 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
         targ->write(towrite);
         last_time = towrite;
     }
-    fmem_close(iii);
     targ->write_meta(SMETA_END,0);
     // clear any temporary tpyes set
     for (int ii = 0; (size_t)ii < sym.entries.size(); ii++) {
@@ -387,6 +391,14 @@ void free_pointers_from_struct(int structVarSym, ccCompiledScript *scrip) {
     }
 }
 
+// Symbols which were declared as local variables; these are looked through
+// when leaving a scope, instead of the whole symbol table
+static CC_THREAD_LOCAL std::vector<int> localSymbols;
+
+static void add_local_symbol(int idx) {
+    localSymbols.push_back(idx);
+}
+
 // Removes local variables from tables, and returns number of bytes to
 // remove from stack
 // just_count: just returns number of bytes, doesn't actually remove any
@@ -396,7 +408,11 @@ int remove_locals(int from_level, int just_count, ccCompiledScript *scrip) {
     if (from_level == 0)
         zeroPtrCmd = SCMD_MEMZEROPTRND;
 
-    for (cc=0; (size_t)cc<sym.entries.size();cc++) {
+    // go in the order of symbols, as the whole table was scanned before
+    std::sort(localSymbols.begin(), localSymbols.end());
+    localSymbols.erase(std::unique(localSymbols.begin(), localSymbols.end()), localSymbols.end());
+    for (size_t li = 0; li < localSymbols.size(); li++) {
+        cc = localSymbols[li];
         if ((sym.entries[cc].sscope > from_level) && (sym.entries[cc].stype == SYM_LOCALVAR)) {
             // caller will sort out stack, so ignore parameters
             if ((sym.entries[cc].flags & SFLG_PARAMETER)==0) {
@@ -431,6 +447,10 @@ int remove_locals(int from_level, int just_count, ccCompiledScript *scrip) {
             }
         }
     }
+    if (just_count == 0) {
+        localSymbols.erase(std::remove_if(localSymbols.begin(), localSymbols.end(),
+            [](int idx) { return sym.entries[idx].stype != SYM_LOCALVAR; }), localSymbols.end());
+    }
     return totalsub;
 }
 
@@ -994,6 +1014,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
         }
         cursym = targ.getnext();
         sym.entries[cursym].stype = SYM_LOCALVAR;
+        add_local_symbol(cursym);
         sym.entries[cursym].extends = 0;
         sym.entries[cursym].arrsize = 1;
         sym.entries[cursym].vartype = vartypesym;
@@ -1636,7 +1657,7 @@ int extractPathIntoParts(VariableSymlist *variablePath, int slilen, long *syml)
   return variablePathSize;
 }
 
-int readcmd_lastcalledwith=0;
+CC_THREAD_LOCAL int readcmd_lastcalledwith=0;
 int get_readcmd_for_size(int sizz, int writeinstead) {
   int readcmd = SCMD_MEMREAD;
   if (writeinstead) {
@@ -2025,7 +2046,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
 
 // If the variable being read is actually a property, not a
 // member variable, then read_variable_into_ax sets this
-int readonly_cannot_cause_error = 0;
+CC_THREAD_LOCAL int readonly_cannot_cause_error = 0;
 
 int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int mustBeWritable, bool negateLiteral = false) {
   // read the various types of values into AX
@@ -3096,6 +3117,8 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
 
   sym.entries[cursym].extends = 0;
   sym.entries[cursym].stype = (isglobal != 0) ? SYM_GLOBALVAR : SYM_LOCALVAR;
+  if (isglobal == 0)
+    add_local_symbol(cursym);
   if (isPointer) {
     varsize = 4;
   }
@@ -3335,11 +3358,21 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
     return -1;\
     }\
 
+CC_THREAD_LOCAL ccCompileTimings compileTimings;
+
+static int64_t get_elapsed_us(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
 // compile the code in the INPL parameter into code in the scrip structure,
 // but don't reset anything because more files could follow
 int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
     ccInternalList targ;
-    if (cc_tokenize(inpl,&targ,scrip)) return -1;
+    const auto tokenize_start = std::chrono::steady_clock::now();
+    const int tokenize_result = cc_tokenize(inpl,&targ,scrip);
+    compileTimings.Tokenize += get_elapsed_us(tokenize_start);
+    if (tokenize_result) return -1;
 
     int aa,in_func = -1, nested_level = 0;
     int isMemberFunction = 0;
@@ -3440,6 +3473,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                         int varsize = 4;
                         // declare "this" inside member functions
                         sym.entries[thisSym].stype = SYM_LOCALVAR;
+                        add_local_symbol(thisSym);
                         sym.entries[thisSym].vartype = isMemberFunction;
                         sym.entries[thisSym].ssize = varsize; // pointer to struct
                         sym.entries[thisSym].sscope = nested_level;
@@ -4806,8 +4840,13 @@ startvarbit:
 // compile the specified code into the specified struct
 int cc_compile(const char*inpl, ccCompiledScript*scrip) {
     int toret = 0;
+    localSymbols.clear();
+    // the time spent in tokenizing is counted separately
+    const auto start = std::chrono::steady_clock::now();
+    const int64_t tokenize_was = compileTimings.Tokenize;
     if (__cc_compile_file(inpl,scrip))
         toret=-1;
+    compileTimings.Parse += get_elapsed_us(start) - (compileTimings.Tokenize - tokenize_was);
     return toret;
 }
 
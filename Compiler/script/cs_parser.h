@@ -35,10 +35,13 @@ start
 #define __CS_PARSER_H
 
 #include "cc_compiledscript.h"
+#include "cs_compiler.h"
 #include <vector>
 
 extern int cc_compile(const char*inpl, ccCompiledScript*scrip);
 
+extern CC_THREAD_LOCAL ccCompileTimings compileTimings;
+
 // A section of compiled code that needs to be moved or copied to a new location
 struct ccChunk {
     std::vector<int32_t> code;
@@ -0,0 +1,146 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <cstring>
+#include <memory>
+#include "script_deps.h"
+#include "util/file.h"
+#include "util/stream.h"
+#include "util/string_types.h"
+#include "util/string_utils.h"
+#include "util/textstreamreader.h"
+
+using namespace AGS::Common;
+
+static const char DEPS_FILE_SIGNATURE[] = "AGSCCDEP";
+
+uint64_t HashDependency(const char *data, size_t len)
+{
+    return FNV::Hash64(data, len);
+}
+
+std::string GetDependenciesFile(const std::string &output_file)
+{
+    return output_file + ".dep";
+}
+
+bool ReadDependencies(const std::string &filename, ScriptDependencies &deps)
+{
+    std::unique_ptr<Stream> in (File::OpenFileRead(filename.c_str()));
+    if (!in)
+        return false;
+    // reading past the end is not reported as an error by the file streams,
+    // so every size is tested against the remaining length before reading
+    const soff_t length = in->GetLength();
+    auto has_bytes = [&in, length](soff_t count) { return (count >= 0) && (count <= length - in->GetPosition()); };
+
+    char sig[sizeof(DEPS_FILE_SIGNATURE)] = {};
+    if (!has_bytes(sizeof(sig)))
+        return false;
+    in->Read(sig, sizeof(sig));
+    if (memcmp(sig, DEPS_FILE_SIGNATURE, sizeof(sig)) != 0)
+        return false;
+    if (!has_bytes(sizeof(int64_t) + sizeof(int32_t)))
+        return false;
+    ScriptDependencies read_deps;
+    read_deps.OptionsHash = in->ReadInt64();
+    const int32_t count = in->ReadInt32();
+    for (int32_t i = 0; i < count; ++i)
+    {
+        if (!has_bytes(sizeof(int32_t)))
+            return false;
+        const int32_t name_len = in->ReadInt32();
+        if (!has_bytes(static_cast<soff_t>(name_len) + sizeof(int64_t)))
+            return false;
+        String name = String::FromStreamCount(in.get(), name_len);
+        const uint64_t hash = in->ReadInt64();
+        read_deps.Headers.emplace_back(name, hash);
+    }
+    if (!has_bytes(sizeof(int64_t) * 2))
+        return false;
+    read_deps.MacrosHash = in->ReadInt64();
+    read_deps.SourceHash = in->ReadInt64();
+    if (in->HasErrors() || (in->GetPosition() != length))
+        return false;
+    deps = std::move(read_deps);
+    return true;
+}
+
+bool WriteDependencies(const std::string &filename, const ScriptDependencies &deps)
+{
+    std::unique_ptr<Stream> out (File::CreateFile(filename.c_str()));
+    if (!out || !(out->CanWrite()))
+        return false;
+    out->Write(DEPS_FILE_SIGNATURE, sizeof(DEPS_FILE_SIGNATURE));
+    out->WriteInt64(deps.OptionsHash);
+    out->WriteInt32(deps.Headers.size());
+    for (const auto &head : deps.Headers)
+    {
+        StrUtil::WriteString(head.first, out.get());
+        out->WriteInt64(head.second);
+    }
+    out->WriteInt64(deps.MacrosHash);
+    out->WriteInt64(deps.SourceHash);
+    return !out->HasErrors();
+}
+
+String FindChangedDependencies(const ScriptDependencies &was, const ScriptDependencies &now)
+{
+    if (was.OptionsHash != now.OptionsHash)
+        return "compiler options changed";
+    bool same_headers = was.Headers.size() == now.Headers.size();
+    for (size_t i = 0; same_headers && (i < now.Headers.size()); ++i)
+        same_headers = was.Headers[i].first == now.Headers[i].first;
+    if (!same_headers)
+        return "header list changed";
+    String changed_headers;
+    for (size_t i = 0; i < now.Headers.size(); ++i)
+    {
+        if (was.Headers[i].second == now.Headers[i].second)
+            continue;
+        changed_headers.Append(changed_headers.IsEmpty() ? "header changed: " : ", ");
+        changed_headers.Append(now.Headers[i].first);
+    }
+    if (!changed_headers.IsEmpty())
+        return changed_headers;
+    if (was.MacrosHash != now.MacrosHash)
+        return "macros changed";
+    if (was.SourceHash != now.SourceHash)
+        return "script changed";
+    return "";
+}
+
+bool IsOutputUpToDate(const ScriptDependencies &common_deps, const std::string &input_file,
+    const std::string &output_file, String &reason)
+{
+    ScriptDependencies was;
+    if (!File::IsFile(output_file.c_str()) || !ReadDependencies(GetDependenciesFile(output_file), was))
+    {
+        reason = "no previous output";
+        return false;
+    }
+    std::unique_ptr<Stream> in (File::OpenFileRead(input_file.c_str()));
+    if (!in)
+    {
+        reason = "script not found";
+        return false;
+    }
+    TextStreamReader sr(in.get());
+    const String script_input = sr.ReadAll();
+    sr.ReleaseStream();
+
+    ScriptDependencies now = common_deps;
+    now.SourceHash = HashDependency(script_input);
+    reason = FindChangedDependencies(was, now);
+    return reason.IsEmpty();
+}
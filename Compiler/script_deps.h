@@ -0,0 +1,59 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Script dependencies for the incremental compilation.
+//
+// Dependencies file is written next to each script object in the incremental
+// mode, and keeps the hashes of everything the object was compiled from:
+// the compiler options, the preprocessed headers, the macros defined after
+// the headers, and the script source.
+//
+//=============================================================================
+#ifndef __CC_SCRIPT_DEPS_H
+#define __CC_SCRIPT_DEPS_H
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "util/string.h"
+
+struct ScriptDependencies
+{
+    uint64_t OptionsHash = 0; // compiler options
+    std::vector<std::pair<AGS::Common::String, uint64_t>> Headers; // header files and hashes of their preprocessed text
+    uint64_t MacrosHash = 0; // macros defined after the headers
+    uint64_t SourceHash = 0; // script text
+};
+
+// Hashes the text or data which the script depends on
+uint64_t HashDependency(const char *data, size_t len);
+inline uint64_t HashDependency(const AGS::Common::String &text)
+    { return HashDependency(text.GetCStr(), text.GetLength()); }
+inline uint64_t HashDependency(const std::string &text)
+    { return HashDependency(text.c_str(), text.size()); }
+// Gets the dependencies file name for the given script object
+std::string GetDependenciesFile(const std::string &output_file);
+// Reads the dependencies file; fails if it's missing, malformed or truncated
+bool ReadDependencies(const std::string &filename, ScriptDependencies &deps);
+bool WriteDependencies(const std::string &filename, const ScriptDependencies &deps);
+// Compares the dependencies an object was compiled from with the current ones;
+// returns what has changed, or an empty string if the object is up to date
+AGS::Common::String FindChangedDependencies(const ScriptDependencies &was, const ScriptDependencies &now);
+// Tells if the script's object was compiled from the same script and the same
+// common dependencies (headers, macros and options); otherwise returns the reason to compile it
+bool IsOutputUpToDate(const ScriptDependencies &common_deps, const std::string &input_file,
+    const std::string &output_file, AGS::Common::String &reason);
+
+#endif // __CC_SCRIPT_DEPS_H
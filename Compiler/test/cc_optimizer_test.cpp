@@ -0,0 +1,178 @@
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cc_common.h"
+#include "script/cc_compiledscript.h"
+#include "script/cc_internal.h"
+#include "script/cc_optimizer.h"
+#include "script/cs_compiler.h"
+
+typedef std::vector<int32_t> Code;
+
+static Code GetCode(const ccScript *scrip) {
+    return Code(scrip->code, scrip->code + scrip->codesize);
+}
+
+TEST(Optimizer, ConstantFolding) {
+    // int f() { return 2 + 3 * 4; }
+    ccCompiledScript scrip;
+    scrip.add_new_function("f", nullptr);
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 2);
+    scrip.push_reg(SREG_AX);
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 3);
+    scrip.push_reg(SREG_AX);
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 4);
+    scrip.pop_reg(SREG_BX);
+    scrip.write_cmd2(SCMD_MULREG, SREG_BX, SREG_AX);
+    scrip.write_cmd2(SCMD_REGTOREG, SREG_BX, SREG_AX);
+    scrip.pop_reg(SREG_BX);
+    scrip.write_cmd2(SCMD_ADDREG, SREG_BX, SREG_AX);
+    scrip.write_cmd2(SCMD_REGTOREG, SREG_BX, SREG_AX);
+    scrip.write_cmd(SCMD_RET);
+
+    ASSERT_LT(0, cc_optimize(&scrip));
+    const Code expect = { SCMD_LITTOREG, SREG_BX, 14, SCMD_LITTOREG, SREG_AX, 14, SCMD_RET };
+    EXPECT_EQ(expect, GetCode(&scrip));
+    EXPECT_EQ(0, scrip.funccodeoffs[0]);
+}
+
+TEST(Optimizer, RuntimeErrorsKept) {
+    // division by zero must still fail when the script is run
+    ccCompiledScript scrip;
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 1);
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_BX, 0);
+    scrip.write_cmd2(SCMD_DIVREG, SREG_AX, SREG_BX);
+    scrip.write_cmd(SCMD_RET);
+    const Code expect = GetCode(&scrip);
+
+    ASSERT_EQ(0, cc_optimize(&scrip));
+    EXPECT_EQ(expect, GetCode(&scrip));
+}
+
+TEST(Optimizer, PushPopAroundStackAccess) {
+    ccCompiledScript scrip;
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_CX, 5);
+    scrip.push_reg(SREG_CX);
+    scrip.write_cmd1(SCMD_LOADSPOFFS, 12);
+    scrip.write_cmd1(SCMD_MEMREAD, SREG_AX);
+    scrip.pop_reg(SREG_BX);
+    scrip.write_cmd2(SCMD_ADDREG, SREG_AX, SREG_BX);
+    scrip.write_cmd(SCMD_RET);
+
+    ASSERT_LT(0, cc_optimize(&scrip));
+    // the pushed value is not on the stack anymore, so the offset is less by its size
+    const Code expect = { SCMD_LITTOREG, SREG_CX, 5, SCMD_LITTOREG, SREG_BX, 5,
+        SCMD_LOADSPOFFS, 8, SCMD_MEMREAD, SREG_AX, SCMD_ADD, SREG_AX, 5, SCMD_RET };
+    EXPECT_EQ(expect, GetCode(&scrip));
+}
+
+TEST(Optimizer, PushPopWithMemoryWriteKept) {
+    ccCompiledScript scrip;
+    scrip.write_cmd1(SCMD_LOADSPOFFS, 4);
+    scrip.push_reg(SREG_AX);
+    scrip.write_cmd1(SCMD_MEMWRITE, SREG_BX);
+    scrip.pop_reg(SREG_AX);
+    scrip.write_cmd(SCMD_RET);
+    const Code expect = GetCode(&scrip);
+
+    ASSERT_EQ(0, cc_optimize(&scrip));
+    EXPECT_EQ(expect, GetCode(&scrip));
+}
+
+TEST(Optimizer, JumpsAndAddresses) {
+    ccCompiledScript scrip;
+    scrip.start_new_section("Test");
+    scrip.add_new_function("f", nullptr);
+    scrip.write_cmd1(SCMD_LINENUM, 1);
+    scrip.write_cmd1(SCMD_LINENUM, 2);
+    scrip.write_cmd1(SCMD_MEMREAD, SREG_AX);  // 4
+    scrip.write_cmd1(SCMD_JZ, 2);             // 6: to 10
+    scrip.write_cmd1(SCMD_JMP, 2);            // 8: to 12
+    scrip.write_cmd1(SCMD_JMP, 5);            // 10: to 17
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 7); // 12
+    scrip.write_cmd(SCMD_RET);                // 15
+    scrip.write_cmd(SCMD_RET);                // 16: unreachable
+    int g;
+    scrip.add_new_function("g", &g);          // 17
+    scrip.write_cmd1(SCMD_THISBASE, 17);
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 0);
+    scrip.write_cmd2(SCMD_LITTOREG, SREG_AX, 17);
+    scrip.fixup_previous(FIXUP_FUNCTION);
+    scrip.write_cmd1(SCMD_CALL, SREG_AX);
+    scrip.write_cmd(SCMD_RET);
+    scrip.add_new_export("g", EXPORT_FUNCTION, scrip.funccodeoffs[g], 0);
+
+    ASSERT_LT(0, cc_optimize(&scrip));
+    // the conditional jump goes straight to the second function,
+    // and the jumps which only led to the next instruction are removed
+    const Code expect = { SCMD_LINENUM, 2, SCMD_MEMREAD, SREG_AX, SCMD_JZ, 4,
+        SCMD_LITTOREG, SREG_AX, 7, SCMD_RET,
+        SCMD_THISBASE, 10, SCMD_LITTOREG, SREG_AX, 10, SCMD_CALL, SREG_AX, SCMD_RET };
+    EXPECT_EQ(expect, GetCode(&scrip));
+    EXPECT_EQ(0, scrip.funccodeoffs[0]);
+    EXPECT_EQ(10, scrip.funccodeoffs[g]);
+    EXPECT_EQ(10, scrip.export_addr[0] & 0xffffff);
+    EXPECT_EQ(EXPORT_FUNCTION, (scrip.export_addr[0] >> 24) & 0xff);
+    EXPECT_EQ(0, scrip.sectionOffsets[0]);
+    ASSERT_EQ(1, scrip.numfixups);
+    EXPECT_EQ(14, scrip.fixups[0]);
+}
+
+TEST(Optimizer, BackwardJumpKept) {
+    // the engine counts loop iterations by the backward jumps
+    ccCompiledScript scrip;
+    scrip.write_cmd1(SCMD_MEMREAD, SREG_AX);  // 0
+    scrip.write_cmd1(SCMD_JZ, 2);             // 2: to 6
+    scrip.write_cmd1(SCMD_JMP, -8);           // 4: to 0
+    scrip.write_cmd(SCMD_RET);                // 6
+    const Code expect = GetCode(&scrip);
+
+    ASSERT_EQ(0, cc_optimize(&scrip));
+    EXPECT_EQ(expect, GetCode(&scrip));
+}
+
+TEST(Optimizer, CompiledScript) {
+    const char *script = ""
+        "int values[10];\n"
+        "import int GetValue(int a);\n"
+        "import void Display(const string text);\n"
+        "int Sum(int n) {\n"
+        "  int sum = 0;\n"
+        "  for (int i = 0; i < n; i++) {\n"
+        "    if (i > 2 * 3 + 1)\n"
+        "      sum += values[i] * (1 + 2);\n"
+        "    else\n"
+        "      sum += GetValue(i);\n"
+        "  }\n"
+        "  Display(\"abc\");\n"
+        "  return sum;\n"
+        "}\n";
+
+    ccRemoveDefaultHeaders();
+    ccSetOption(SCOPT_OPTIMIZE, false);
+    std::unique_ptr<ccScript> plain(ccCompileText(script, "Test"));
+    ASSERT_NE(nullptr, plain.get());
+    ccSetOption(SCOPT_OPTIMIZE, true);
+    std::unique_ptr<ccScript> optimized(ccCompileText(script, "Test"));
+    ccSetOption(SCOPT_OPTIMIZE, false);
+    ASSERT_NE(nullptr, optimized.get());
+
+    EXPECT_LT(optimized->codesize, plain->codesize);
+    ASSERT_EQ(plain->numexports, optimized->numexports);
+    for (int i = 0; i < optimized->numexports; ++i)
+        EXPECT_LT(optimized->export_addr[i] & 0xffffff, optimized->codesize);
+    // all the fixups remain, and point to the arguments of the same instructions
+    ASSERT_EQ(plain->numfixups, optimized->numfixups);
+    for (int i = 0; i < optimized->numfixups; ++i) {
+        EXPECT_EQ(plain->fixuptypes[i], optimized->fixuptypes[i]);
+        const int32_t fixup = optimized->fixups[i];
+        ASSERT_LT(fixup, optimized->codesize);
+        if (optimized->fixuptypes[i] == FIXUP_STRING ||
+            optimized->fixuptypes[i] == FIXUP_GLOBALDATA) {
+            EXPECT_EQ(SCMD_LITTOREG, optimized->code[fixup - 2]);
+        }
+        if (optimized->fixuptypes[i] == FIXUP_IMPORT) {
+            EXPECT_EQ(SCMD_CALLEXT, optimized->code[fixup + 1]);
+        }
+    }
+}
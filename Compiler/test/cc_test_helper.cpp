@@ -14,8 +14,7 @@
 #include <string>
 #include "util/string_compat.h"
 #include "util/string.h"
-
-extern int currentline; // in script/script_common
+#include "script/cc_common.h" // currentline
 
 typedef AGS::Common::String AGSString;
 
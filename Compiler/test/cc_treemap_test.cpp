@@ -1,3 +1,4 @@
+#include <cstdio>
 #include "gtest/gtest.h"
 #include "script/cc_treemap.h"
 
@@ -55,3 +56,51 @@ TEST(TreeMap, Clear) {
 	symbolTree.clear();
 	ASSERT_TRUE (symbolTree.findValue("a") == -1);
 }
+
+TEST(TreeMap, ManyEntries) {
+	ccTreeMap symbolTree;
+	char name[16];
+	for (int i = 0; i < 1000; i++) {
+		snprintf(name, sizeof(name), "sym%d", i);
+		symbolTree.addEntry(name, i);
+	}
+	for (int i = 0; i < 1000; i++) {
+		snprintf(name, sizeof(name), "sym%d", i);
+		ASSERT_TRUE (symbolTree.findValue(name) == i);
+	}
+	// lookup by a part of text
+	const char *text = "sym12 sym345";
+	ASSERT_TRUE (symbolTree.findValue(text, 5, cc_hash_name(text, 5)) == 12);
+	ASSERT_TRUE (symbolTree.findValue(text + 6, 6, cc_hash_name(text + 6, 6)) == 345);
+	ASSERT_TRUE (symbolTree.findValue(text, 4, cc_hash_name(text, 4)) == 1);
+	ASSERT_TRUE (symbolTree.findValue(text, 3, cc_hash_name(text, 3)) == -1);
+}
+
+TEST(HashMap, Erase) {
+	ccHashMap<int> map;
+	char name[16];
+	for (int i = 0; i < 100; i++) {
+		snprintf(name, sizeof(name), "n%d", i);
+		map.set(name, i);
+	}
+	// every other entry removed, the rest must stay reachable
+	for (int i = 0; i < 100; i += 2) {
+		snprintf(name, sizeof(name), "n%d", i);
+		ASSERT_TRUE (map.erase(name));
+	}
+	ASSERT_FALSE (map.erase("n0"));
+	ASSERT_EQ (map.size(), 50u);
+	for (int i = 0; i < 100; i++) {
+		snprintf(name, sizeof(name), "n%d", i);
+		const int *value = map.find(name);
+		if (i % 2 == 0) {
+			ASSERT_TRUE (value == nullptr);
+		} else {
+			ASSERT_TRUE (value != nullptr);
+			ASSERT_EQ (*value, i);
+		}
+	}
+	int count = 0;
+	map.for_each([&count](const std::string&, int) { count++; });
+	ASSERT_EQ (count, 50);
+}
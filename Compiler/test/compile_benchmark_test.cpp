@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "gtest/gtest.h"
+#include "preproc/preprocessor.h"
+#include "script/cc_common.h"
+#include "script/cs_compiler.h"
+#include "test/cc_test_helper.h"
+
+using namespace AGS::Common;
+typedef std::chrono::steady_clock Clock;
+
+// Generates a script with many symbols, macros and functions using them
+static std::string GenerateLargeScript(int blocks) {
+    std::string script =
+        "#define MAX_ITEMS 10\n"
+        "#define LIMIT 100\n";
+    char buf[1024];
+    for (int n = 0; n < blocks; n++) {
+        snprintf(buf, sizeof(buf),
+            "#define SCALE%d (%d + MAX_ITEMS)\n"
+            "struct Item%d {\n"
+            "  int value;\n"
+            "  int count;\n"
+            "  import int Total();\n"
+            "};\n"
+            "Item%d items%d[MAX_ITEMS];\n"
+            "int Item%d::Total() {\n"
+            "  return this.value * this.count + SCALE%d;\n"
+            "}\n"
+            "// Updates the items, and sums their totals\n"
+            "int Process%d(int a, int b) {\n"
+            "  int sum = 0; /* running sum */\n"
+            "  for (int i = 0; i < MAX_ITEMS; i++) {\n"
+            "    items%d[i].value = a + i;\n"
+            "    items%d[i].count = b;\n"
+            "    if (items%d[i].value > LIMIT)\n"
+            "      sum += items%d[i].Total();\n"
+            "    else\n"
+            "      sum -= i * SCALE%d;\n"
+            "  }\n"
+            "  return sum;\n"
+            "}\n",
+            n, n, n, n, n, n, n, n, n, n, n, n, n);
+        script += buf;
+    }
+    return script;
+}
+
+TEST(CompileSpeed, LargeScript) {
+    const std::string script = GenerateLargeScript(500);
+    clear_error();
+    ccRemoveDefaultHeaders();
+
+    const auto start = Clock::now();
+    AGS::Preprocessor::Preprocessor pp;
+    const String preprocessed = pp.Preprocess(script.c_str(), "Benchmark");
+    ASSERT_STREQ("", last_seen_cc_error());
+    const auto preprocessed_at = Clock::now();
+    std::unique_ptr<ccScript> scrip(ccCompileText(preprocessed.GetCStr(), "Benchmark"));
+    const auto compiled_at = Clock::now();
+    ASSERT_NE(nullptr, scrip.get()) << last_seen_cc_error();
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    printf("Compiled %u bytes of script: preprocess %.3f ms, compile %.3f ms\n",
+        (unsigned)script.size(),
+        duration_cast<microseconds>(preprocessed_at - start).count() / 1000.0,
+        duration_cast<microseconds>(compiled_at - preprocessed_at).count() / 1000.0);
+}
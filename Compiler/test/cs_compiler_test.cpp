@@ -0,0 +1,121 @@
+#include <memory>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cc_common.h"
+#include "script/cs_compiler.h"
+#include "util/memorystream.h"
+
+using namespace AGS::Common;
+
+static const char *pchHeader1 = ""
+    "struct Point { int x; int y; };\n"
+    "import int GetValue(int a);\n";
+
+static const char *pchHeader2 = ""
+    "import Point origin;\n"
+    "enum Color { eRed, eGreen };\n";
+
+static const char *pchScript = ""
+    "int counter;\n"
+    "int Sum(int a) { counter += GetValue(a) + eGreen; return counter + origin.x; }\n";
+
+// Compiles the test script, and serializes the result for comparison
+static std::vector<uint8_t> CompileToBytes(const char *script, size_t num_headers) {
+    const char *headers[] = { pchHeader1, pchHeader2 };
+    ccRemoveDefaultHeaders();
+    for (size_t i = 0; i < num_headers; ++i)
+        ccAddDefaultHeader(headers[i], "Header");
+    std::unique_ptr<ccScript> scrip(ccCompileText(script, "Test"));
+    EXPECT_NE(nullptr, scrip.get());
+    std::vector<uint8_t> data;
+    if (scrip) {
+        VectorStream out(data, kStream_Write);
+        scrip->Write(&out);
+    }
+    return data;
+}
+
+TEST(PrecompiledHeaders, SameResult) {
+    ccSetPrecompiledHeaders(false);
+    const auto reference = CompileToBytes(pchScript, 2);
+
+    ccSetPrecompiledHeaders(true);
+    // first header only, then both headers reusing the first one's state
+    CompileToBytes("int a;", 1);
+    EXPECT_TRUE(ccPrecompiledHeadersChanged());
+    EXPECT_EQ(reference, CompileToBytes(pchScript, 2));
+    // same headers again, using the whole precompiled state
+    std::vector<uint8_t> pch_data;
+    {
+        VectorStream out(pch_data, kStream_Write);
+        ASSERT_TRUE(ccWritePrecompiledHeaders(&out));
+    }
+    EXPECT_FALSE(ccPrecompiledHeadersChanged());
+    EXPECT_EQ(reference, CompileToBytes(pchScript, 2));
+    EXPECT_FALSE(ccPrecompiledHeadersChanged());
+
+    // state read back from the stream
+    ccFreePrecompiledHeaders();
+    {
+        VectorStream in(pch_data);
+        ASSERT_TRUE(ccReadPrecompiledHeaders(&in));
+    }
+    EXPECT_EQ(reference, CompileToBytes(pchScript, 2));
+    EXPECT_FALSE(ccPrecompiledHeadersChanged());
+
+    // changed options invalidate the state
+    ccSetOption(SCOPT_LINENUMBERS, !ccGetOption(SCOPT_LINENUMBERS));
+    CompileToBytes(pchScript, 2);
+    EXPECT_TRUE(ccPrecompiledHeadersChanged());
+    ccSetOption(SCOPT_LINENUMBERS, !ccGetOption(SCOPT_LINENUMBERS));
+
+    ccSetPrecompiledHeaders(false);
+    ccRemoveDefaultHeaders();
+}
+
+TEST(PrecompiledHeaders, InvalidData) {
+    std::vector<uint8_t> data(64, 0);
+    VectorStream in(data);
+    ASSERT_FALSE(ccReadPrecompiledHeaders(&in));
+}
+
+#if defined(AGS_CC_THREADSAFE)
+TEST(PrecompiledHeaders, SharedBetweenThreads) {
+    ccSetPrecompiledHeaders(false);
+    const auto reference = CompileToBytes(pchScript, 2);
+
+    // compile the headers once, and let each thread start from their state
+    ccSetPrecompiledHeaders(true);
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(pchHeader1, "Header");
+    ccAddDefaultHeader(pchHeader2, "Header");
+    ASSERT_TRUE(ccPrecompileHeaders());
+    const PPrecompiledHeaders pch = ccGetPrecompiledHeaders();
+    ASSERT_NE(nullptr, pch.get());
+    const int options = ccGetOption(SCOPT_LINENUMBERS);
+
+    std::vector<uint8_t> results[4];
+    std::vector<std::thread> threads;
+    for (auto &result : results) {
+        threads.emplace_back([&pch, &result, options]() {
+            ccSetOption(SCOPT_LINENUMBERS, options);
+            ccSetPrecompiledHeaders(true);
+            ccUsePrecompiledHeaders(pch);
+            result = CompileToBytes(pchScript, 2);
+            if (ccPrecompiledHeadersChanged())
+                result.clear(); // the shared state must have been used
+            ccUsePrecompiledHeaders(nullptr);
+            ccRemoveDefaultHeaders();
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    for (const auto &result : results)
+        EXPECT_EQ(reference, result);
+
+    ccSetPrecompiledHeaders(false);
+    ccFreePrecompiledHeaders();
+    ccRemoveDefaultHeaders();
+}
+#endif // AGS_CC_THREADSAFE
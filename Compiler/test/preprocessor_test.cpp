@@ -1,3 +1,8 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
 #include "gtest/gtest.h"
 #include "preproc/preprocessor.h"
 #include <util/string_compat.h>
@@ -391,5 +396,52 @@ Display("test");
 }
 
 
+TEST(Preprocess, Throughput) {
+    // Generates a script of several megabytes, with comments, directives
+    // and macros, which the preprocessor has to scan in full
+    std::string script =
+        "#define MAX_ITEMS 10\n"
+        "#define LIMIT (MAX_ITEMS * 10)\n";
+    char buf[1024];
+    for (int n = 0; script.size() < 4 * 1024 * 1024; n++) {
+        snprintf(buf, sizeof(buf),
+            "#define SCALE%d (%d + MAX_ITEMS)\n"
+            "#ifdef DEBUG\n"
+            "int debug%d;\n"
+            "#endif\n"
+            "// Updates the items, and sums their totals\n"
+            "int Process%d(int a, int b) {\n"
+            "  int sum = 0; /* running sum */\n"
+            "  /* the loop goes\n"
+            "     over all the items */\n"
+            "  for (int i = 0; i < MAX_ITEMS; i++) {\n"
+            "    if (items[i].value > LIMIT) // too large\n"
+            "      sum += items[i].Total() * SCALE%d;\n"
+            "  }\n"
+            "  return sum;\n"
+            "}\n",
+            n, n, n, n, n);
+        script += buf;
+    }
+    const AGSString input(script.c_str(), script.size());
+
+    Preprocessor pp = Preprocessor();
+    clear_error();
+    const auto start = std::chrono::steady_clock::now();
+    String res = pp.Preprocess(input, "Throughput");
+    const auto end = std::chrono::steady_clock::now();
+    ASSERT_STREQ(last_seen_cc_error(), "");
+
+    const size_t input_lines = std::count(script.begin(), script.end(), '\n');
+    const size_t output_lines = std::count(res.GetCStr(), res.GetCStr() + res.GetLength(), '\n');
+    EXPECT_EQ(input_lines + 1, output_lines);
+    EXPECT_EQ(nullptr, strstr(res.GetCStr(), "SCALE"));
+
+    const double ms = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000.0;
+    printf("Preprocessed %u bytes of script in %.3f ms (%.1f MB/s)\n",
+        (unsigned)script.size(), ms, ms > 0.0 ? script.size() / (ms * 1000.0) : 0.0);
+}
+
+
 } // Preprocessor
 } // AGS
\ No newline at end of file
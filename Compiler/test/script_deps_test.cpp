@@ -0,0 +1,194 @@
+#include <stdint.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script_deps.h"
+#include "util/file.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+static const char *ScriptFile = "deps_test.asc";
+static const char *ObjectFile = "deps_test.o";
+
+class ScriptDeps : public ::testing::Test {
+protected:
+    void SetUp() override {
+        DeleteFiles();
+        // dependencies common to all the scripts, as made from the headers
+        Common.OptionsHash = HashDependency(std::string("3.6.0;Highest;Highest;111011110"));
+        Common.Headers.emplace_back("agsdefns.sh", HashDependency(String("import void Wait(int);")));
+        Common.Headers.emplace_back("module.ash", HashDependency(String("import int GetScore();")));
+        Common.MacrosHash = HashDependency(std::string("AGS_NEW_STRINGS"));
+    }
+
+    void TearDown() override {
+        DeleteFiles();
+    }
+
+    static void DeleteFiles() {
+        File::DeleteFile(ScriptFile);
+        File::DeleteFile(ObjectFile);
+        File::DeleteFile(GetDependenciesFile(ObjectFile).c_str());
+    }
+
+    static void WriteText(const char *filename, const char *text) {
+        std::unique_ptr<Stream> out(File::CreateFile(filename));
+        ASSERT_TRUE(out != nullptr);
+        out->Write(text, strlen(text));
+    }
+
+    static std::vector<char> ReadBytes(const std::string &filename) {
+        std::unique_ptr<Stream> in(File::OpenFileRead(filename.c_str()));
+        std::vector<char> data;
+        if (in) {
+            data.resize(static_cast<size_t>(in->GetLength()));
+            in->Read(data.data(), data.size());
+        }
+        return data;
+    }
+
+    static void WriteBytes(const std::string &filename, const char *data, size_t size) {
+        std::unique_ptr<Stream> out(File::CreateFile(filename.c_str()));
+        ASSERT_TRUE(out != nullptr);
+        out->Write(data, size);
+    }
+
+    // Writes the script, its object and dependencies, as if it was just compiled
+    void Compile(const char *script) {
+        WriteText(ScriptFile, script);
+        WriteText(ObjectFile, "SCOM");
+        ScriptDependencies deps = Common;
+        deps.SourceHash = HashDependency(String(script));
+        ASSERT_TRUE(WriteDependencies(GetDependenciesFile(ObjectFile), deps));
+    }
+
+    bool IsUpToDate(String &reason) const {
+        return IsOutputUpToDate(Common, ScriptFile, ObjectFile, reason);
+    }
+
+    ScriptDependencies Common;
+};
+
+TEST_F(ScriptDeps, ReadWrite) {
+    ScriptDependencies deps = Common;
+    deps.SourceHash = 12345u;
+    ASSERT_TRUE(WriteDependencies(GetDependenciesFile(ObjectFile), deps));
+    ScriptDependencies read;
+    ASSERT_TRUE(ReadDependencies(GetDependenciesFile(ObjectFile), read));
+    EXPECT_EQ(deps.OptionsHash, read.OptionsHash);
+    ASSERT_EQ(deps.Headers.size(), read.Headers.size());
+    for (size_t i = 0; i < deps.Headers.size(); ++i) {
+        EXPECT_STREQ(deps.Headers[i].first.GetCStr(), read.Headers[i].first.GetCStr());
+        EXPECT_EQ(deps.Headers[i].second, read.Headers[i].second);
+    }
+    EXPECT_EQ(deps.MacrosHash, read.MacrosHash);
+    EXPECT_EQ(deps.SourceHash, read.SourceHash);
+}
+
+TEST_F(ScriptDeps, UpToDate) {
+    Compile("function game_start() {}");
+    String reason;
+    EXPECT_TRUE(IsUpToDate(reason));
+    EXPECT_STREQ("", reason.GetCStr());
+}
+
+TEST_F(ScriptDeps, NoPreviousOutput) {
+    Compile("function game_start() {}");
+    File::DeleteFile(ObjectFile);
+    String reason;
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("no previous output", reason.GetCStr());
+}
+
+TEST_F(ScriptDeps, SourceEdited) {
+    Compile("function game_start() {}");
+    WriteText(ScriptFile, "function game_start() { Wait(1); }");
+    String reason;
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("script changed", reason.GetCStr());
+}
+
+TEST_F(ScriptDeps, HeaderEdited) {
+    Compile("function game_start() {}");
+    Common.Headers[1].second = HashDependency(String("import int GetScore(int player);"));
+    String reason;
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("header changed: module.ash", reason.GetCStr());
+    // the header list itself changes
+    Common.Headers.pop_back();
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("header list changed", reason.GetCStr());
+}
+
+TEST_F(ScriptDeps, OptionsChanged) {
+    Compile("function game_start() {}");
+    Common.OptionsHash = HashDependency(std::string("3.6.0;Highest;Highest;011011110"));
+    String reason;
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("compiler options changed", reason.GetCStr());
+}
+
+TEST_F(ScriptDeps, MacrosChanged) {
+    Compile("function game_start() {}");
+    Common.MacrosHash = HashDependency(std::string("AGS_NEW_STRINGS;DEBUG"));
+    String reason;
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("macros changed", reason.GetCStr());
+}
+
+TEST_F(ScriptDeps, Truncated) {
+    Compile("function game_start() {}");
+    const std::string deps_file = GetDependenciesFile(ObjectFile);
+    const std::vector<char> data = ReadBytes(deps_file);
+    ASSERT_FALSE(data.empty());
+    // every shorter part of the valid file is rejected
+    for (size_t len = 0; len < data.size(); ++len) {
+        WriteBytes(deps_file, data.data(), len);
+        ScriptDependencies deps;
+        EXPECT_FALSE(ReadDependencies(deps_file, deps)) << "length " << len;
+        String reason;
+        EXPECT_FALSE(IsUpToDate(reason)) << "length " << len;
+        EXPECT_STREQ("no previous output", reason.GetCStr());
+    }
+}
+
+TEST_F(ScriptDeps, Corrupt) {
+    Compile("function game_start() {}");
+    const std::string deps_file = GetDependenciesFile(ObjectFile);
+    const std::vector<char> data = ReadBytes(deps_file);
+    const size_t sig_size = sizeof("AGSCCDEP");
+    const size_t count_pos = sig_size + sizeof(int64_t);
+    ASSERT_GT(data.size(), count_pos + sizeof(int32_t));
+    ScriptDependencies deps;
+
+    // wrong signature
+    std::vector<char> bad = data;
+    bad[0] = 'X';
+    WriteBytes(deps_file, bad.data(), bad.size());
+    EXPECT_FALSE(ReadDependencies(deps_file, deps));
+    // huge and negative header counts
+    for (const int32_t count : { INT32_MAX, -1, 3 }) {
+        bad = data;
+        memcpy(&bad[count_pos], &count, sizeof(count)); // assumes a little-endian host
+        WriteBytes(deps_file, bad.data(), bad.size());
+        EXPECT_FALSE(ReadDependencies(deps_file, deps)) << "count " << count;
+    }
+    // huge header name length
+    bad = data;
+    const int32_t name_len = INT32_MAX;
+    memcpy(&bad[count_pos + sizeof(int32_t)], &name_len, sizeof(name_len));
+    WriteBytes(deps_file, bad.data(), bad.size());
+    EXPECT_FALSE(ReadDependencies(deps_file, deps));
+    // extra data at the end
+    bad = data;
+    bad.push_back(0);
+    WriteBytes(deps_file, bad.data(), bad.size());
+    EXPECT_FALSE(ReadDependencies(deps_file, deps));
+
+    String reason;
+    EXPECT_FALSE(IsUpToDate(reason));
+    EXPECT_STREQ("no previous output", reason.GetCStr());
+}
@@ -71,6 +71,8 @@ namespace AGS
 			  ccSetOption(SCOPT_LEFTTORIGHT, game->Settings->LeftToRightPrecedence);
 			  ccSetOption(SCOPT_OLDSTRINGS, !game->Settings->EnforceNewStrings);
 			  ccSetOption(SCOPT_UTF8, game->UnicodeMode);
+			  // scripts are compiled in order, each reusing the previous one's headers state
+			  ccSetPrecompiledHeaders(true);
 
         if (exceptionToThrow == nullptr)
         {
@@ -952,6 +952,8 @@ void Character_StopMoving(CharacterInfo *charp) {
     }
     if (charp->walking) {
         // If the character is currently moving, stop them and reset their frame
+        if (charp->walking < TURNING_AROUND)
+            cancel_route_async(charp->walking);
         charp->walking = 0;
         if ((charp->flags & CHF_MOVENOTWALK) == 0)
             charp->frame = 0;
@@ -1666,7 +1668,7 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 // order of loops to turn character in circle from down to down
 int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
-void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
+void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims, bool allowAsync) {
     CharacterInfo*chin=&game.chars[chac];
     if (chin->room!=displayed_room)
         quit("!MoveCharacter: character not in current room");
@@ -1721,8 +1723,25 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
 
     set_route_move_speed(move_speed_x, move_speed_y);
     set_color_depth(8);
-    int mslot=find_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
+    int mslot = allowAsync ?
+        find_route_async(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal) :
+        find_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
     set_color_depth(game.GetColorDepth());
+    const bool pending = (mslot < 0);
+    if (pending) {
+        // the route is searched in background, meanwhile keep them standing
+        // at the start; see update_character_route
+        mslot = chac + CHMLSOFFS;
+        MoveList &holdml = mls[mslot];
+        holdml.numstage = 2;
+        holdml.pos[0] = holdml.pos[1] = (charX << 16) | charY;
+        holdml.xpermove[0] = holdml.ypermove[0] = 0;
+        holdml.fromx = charX;
+        holdml.fromy = charY;
+        holdml.onstage = holdml.onpart = 0;
+        holdml.doneflag = 0;
+        holdml.lastx = holdml.lasty = -1;
+    }
     if (mslot>0) {
         chin->walking = mslot;
         mls[mslot].direct = ignwal;
@@ -1748,6 +1767,35 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
         chin->frame = 0;
 }
 
+bool update_character_route(CharacterInfo *chi, bool wait) {
+    const int mslot = chi->walking;
+    if (!is_route_pending(mslot))
+        return true;
+
+    const int result = poll_route_async(mslot, wait);
+    if (result < 0)
+        return false; // still searching
+    if (result == 0) {
+        // pathfinder couldn't get a route, stand them still
+        StopMoving(chi->index_id);
+        return false;
+    }
+
+    convert_move_path_to_room_resolution(&mls[mslot]);
+    if (((chi->flags & CHF_MOVENOTWALK) == 0) && (mls[mslot].pos[0] != mls[mslot].pos[1]))
+        fix_player_sprite(&mls[mslot], chi);
+    // they may have to turn around first
+    return (chi->walking > 0) && (chi->walking < TURNING_AROUND);
+}
+
+void complete_character_routes() {
+    for (int i = 0; i < game.numcharacters; i++) {
+        CharacterInfo *chi = &game.chars[i];
+        if ((chi->walking > 0) && (chi->walking < TURNING_AROUND))
+            update_character_route(chi, true);
+    }
+}
+
 int find_looporder_index (int curloop) {
     int rr;
     for (rr = 0; rr < 8; rr++) {
@@ -2025,10 +2073,12 @@ void walk_or_move_character(CharacterInfo *chaa, int x, int y, int blocking, int
         return;
     }
 
+    // only let search the route in background when not blocking
+    const bool allow_async = (blocking == IN_BACKGROUND) || (blocking == 0);
     if ((direct == ANYWHERE) || (direct == 1))
-        walk_character(chaa->index_id, x, y, 1, isWalk);
+        walk_character(chaa->index_id, x, y, 1, isWalk, allow_async);
     else if ((direct == WALKABLE_AREAS) || (direct == 0))
-        walk_character(chaa->index_id, x, y, 0, isWalk);
+        walk_character(chaa->index_id, x, y, 0, isWalk, allow_async);
     else
         quit("!Character.Walk: Direct must be ANYWHERE or WALKABLE_AREAS");
 
@@ -168,7 +168,16 @@ void animate_character(CharacterInfo *chap, int loopn, int sppd, int rept,
     int noidleoverride = 0, int direction = 0, int sframe = 0, int volume = 100);
 // Clears up animation parameters
 void stop_character_anim(CharacterInfo *chap);
-void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
+// Starts character walking; if allowAsync is set, then the route may be
+// searched in background, and character will wait until it's found
+void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims, bool allowAsync = false);
+// Starts moving the character along the route found in background;
+// returns false if they should not move during this update. If wait is set,
+// then the search is completed right away.
+bool update_character_route(CharacterInfo *chi, bool wait = false);
+// Completes all the routes being searched in background, so that the characters
+// may continue walking after the game state is saved and restored
+void complete_character_routes();
 int  find_looporder_index (int curloop);
 // returns 0 to use diagonal, 1 to not
 int  useDiagonal (CharacterInfo *char1);
@@ -183,7 +192,6 @@ int  doNextCharMoveStep (CharacterInfo *chi, int &char_index, CharacterExtras *c
 bool is_char_walking_ndirect(CharacterInfo *chi);
 int  find_nearest_walkable_area_within(int *xx, int *yy, int range, int step);
 void find_nearest_walkable_area (int *xx, int *yy);
-void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
 void FindReasonableLoopForCharacter(CharacterInfo *chap);
 void walk_or_move_character(CharacterInfo *chaa, int x, int y, int blocking, int direct, bool isWalk);
 int  is_valid_character(int newchar);
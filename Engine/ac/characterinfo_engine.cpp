@@ -168,6 +168,11 @@ int CharacterInfo::update_character_walking(CharacterExtras *chex)
 
 void CharacterInfo::update_character_moving(int &char_index, CharacterExtras *chex, int &doing_nothing)
 {
+	// if their route is being searched in background, then wait for it
+	if ((walking > 0) && (walking < TURNING_AROUND) && (room == displayed_room) &&
+		!update_character_route(this))
+		return;
+
 	if ((walking > 0) && (room == displayed_room))
     {
       if (walkwait > 0) walkwait--;
@@ -420,7 +425,7 @@ void CharacterInfo::update_character_follower(int &aa, std::vector<int> &followi
         if (goxoffs < 0) goxoffs-=distaway;
         else goxoffs+=distaway;
         walk_character(aa,game.chars[following].x + goxoffs,
-          game.chars[following].y + (Random(50)-25),0, true);
+          game.chars[following].y + (Random(50)-25),0, true, true);
         doing_nothing = 0;
       }
     }
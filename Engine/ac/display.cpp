@@ -26,6 +26,7 @@
 #include "ac/gamestate.h"
 #include "ac/global_audio.h"
 #include "ac/global_game.h"
+#include "ac/glyph_atlas.h"
 #include "ac/gui.h"
 #include "ac/mouse.h"
 #include "ac/overlay.h"
@@ -71,7 +72,7 @@ struct DisplayVars
 // Generates a textual image and returns a disposable bitmap
 Bitmap *create_textual_image(const char *text, int asspch, int isThought,
     int &xx, int &yy, int &adjustedXX, int &adjustedYY, int wii, int usingfont, int allowShrink,
-    bool &alphaChannel)
+    bool &alphaChannel, std::shared_ptr<TextLayout> *text_layout)
 {
     //
     // Configure the textual image
@@ -188,6 +189,36 @@ Bitmap *create_textual_image(const char *text, int asspch, int isThought,
         else if ((ShouldAntiAliasText()) && (game.GetColorDepth() >= 24))
             alphaChannel = true;
 
+        // Plain text is arranged first, and may be left for the renderer to draw
+        if (!drawBackground)
+        {
+            auto layout = std::make_shared<TextLayout>();
+            layout->Width = text_window_ds->GetWidth();
+            layout->Height = text_window_ds->GetHeight();
+            layout->Font = usingfont;
+            layout->TextColor = text_window_ds->GetCompatibleColor((asspch < 0) ? -asspch : asspch);
+            layout->OutlineColor = text_window_ds->GetCompatibleColor(play.speech_text_shadow);
+            const int line_width = (asspch < 0) ? oriwid : wii;
+            const HorAlignment align = (asspch < 0) ? play.text_align : play.speech_text_align;
+            for (size_t ee = 0; ee < Lines.Count(); ee++) {
+                TextLayout::Line line;
+                line.X = ttxleft;
+                line.Y = ttxtop + ee * disp.linespacing;
+                line.Text = Lines[ee];
+                if (align & kMAlignHCenter)
+                    line.X += (line_width / 2) - (get_text_width_outlined(line.Text.GetCStr(), usingfont) / 2);
+                else if (align & kMAlignRight)
+                    line.X += (line_width - get_text_width_outlined(line.Text.GetCStr(), usingfont));
+                layout->Lines.push_back(line);
+            }
+
+            if (text_layout && glyph_atlas_can_draw(usingfont))
+                *text_layout = layout;
+            else
+                draw_text_layout(text_window_ds, *layout);
+            return text_window_ds;
+        }
+
         for (size_t ee = 0; ee<Lines.Count(); ee++) {
             //int ttxp=wii/2 - get_text_width_outlined(lines[ee], usingfont)/2;
             int ttyp = ttxtop + ee*disp.linespacing;
@@ -272,8 +303,9 @@ ScreenOverlay *_display_main(int xx, int yy, int wii, const char *text, int disp
 
     int adjustedXX, adjustedYY;
     bool alphaChannel;
+    std::shared_ptr<TextLayout> text_layout;
     Bitmap *text_window_ds = create_textual_image(text, asspch, isThought,
-        xx, yy, adjustedXX, adjustedYY, wii, usingfont, allowShrink, alphaChannel);
+        xx, yy, adjustedXX, adjustedYY, wii, usingfont, allowShrink, alphaChannel, &text_layout);
 
     //
     // Configure and create an overlay object
@@ -290,6 +322,8 @@ ScreenOverlay *_display_main(int xx, int yy, int wii, const char *text, int disp
 
     size_t nse = add_screen_overlay(roomlayer, xx, yy, ovrtype, text_window_ds, adjustedXX - xx, adjustedYY - yy, alphaChannel);
     // we should not delete text_window_ds here, because it is now owned by Overlay
+    if (text_layout)
+        screenover[nse].SetTextLayout(text_layout);
 
     // If it's a non-blocking overlay type, then we're done here
     if (disp_type >= DISPLAYTEXT_NORMALOVERLAY) {
@@ -588,12 +622,12 @@ void wouttextxy_AutoOutline(Bitmap *ds, size_t font, int32_t color, const char *
     }
 }
 
-// Draw an outline if requested, then draw the text on top 
-void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int font, color_t text_color, const char *texx) 
-{    
+// Draw an outline of the given color if requested, then draw the text on top
+static void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int font, color_t text_color,
+    color_t outline_color, const char *texx)
+{
     size_t const text_font = static_cast<size_t>(font);
     // Draw outline (a backdrop) if requested
-    color_t const outline_color = ds->GetCompatibleColor(play.speech_text_shadow);
     int const outline_font = get_font_outline(font);
     if (outline_font >= 0)
         wouttextxy(ds, xxp, yyp, static_cast<size_t>(outline_font), outline_color, texx);
@@ -606,6 +640,18 @@ void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int font, color_t te
     wouttextxy(ds, xxp, yyp, text_font, text_color, texx);
 }
 
+// Draw an outline if requested, then draw the text on top 
+void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int font, color_t text_color, const char *texx) 
+{    
+    wouttext_outline(ds, xxp, yyp, font, text_color, ds->GetCompatibleColor(play.speech_text_shadow), texx);
+}
+
+void draw_text_layout(Bitmap *ds, const TextLayout &layout)
+{
+    for (const auto &line : layout.Lines)
+        wouttext_outline(ds, line.X, line.Y, layout.Font, layout.TextColor, layout.OutlineColor, line.Text.GetCStr());
+}
+
 void wouttext_aligned (Bitmap *ds, int usexp, int yy, int oriwid, int usingfont, color_t text_color, const char *text, HorAlignment align) {
 
     if (align & kMAlignHCenter)
@@ -18,7 +18,10 @@
 #ifndef __AGS_EE_AC__DISPLAY_H
 #define __AGS_EE_AC__DISPLAY_H
 
+#include <memory>
+#include <vector>
 #include "gui/guimain.h"
+#include "util/string.h"
 
 using AGS::Common::GUIMain;
 
@@ -31,12 +34,36 @@ using AGS::Common::GUIMain;
 #define DISPLAYTEXT_NORMALOVERLAY 2
 // also accepts explicit overlay ID >= OVER_CUSTOM
 
+// TextLayout describes a plain text (without a text window) arranged on
+// the textual image: the lines of text with their final positions.
+struct TextLayout
+{
+    struct Line
+    {
+        int X = 0;
+        int Y = 0;
+        AGS::Common::String Text;
+    };
+
+    int Width = 0; // size of the image the text is arranged on
+    int Height = 0;
+    int Font = 0;
+    color_t TextColor = 0;
+    color_t OutlineColor = 0;
+    std::vector<Line> Lines;
+};
+
 struct ScreenOverlay;
 // Generates a textual image from the given text and parameters;
-// see _display_main's comment below for parameters description
+// see _display_main's comment below for parameters description.
+// If text_layout is passed, and the text may be drawn by the renderer using
+// the glyph atlas, then the text is not drawn on the returned image,
+// and its layout is returned instead.
 Common::Bitmap *create_textual_image(const char *text, int asspch, int isThought,
     int &xx, int &yy, int &adjustedXX, int &adjustedYY, int wii, int usingfont, int allowShrink,
-    bool &alphaChannel);
+    bool &alphaChannel, std::shared_ptr<TextLayout> *text_layout = nullptr);
+// Draws the text layout on the bitmap
+void draw_text_layout(Common::Bitmap *ds, const TextLayout &layout);
 // Creates a textual overlay using the given parameters;
 // Pass yy = -1 to find Y co-ord automatically
 // allowShrink = 0 for none, 1 for leftwards, 2 for rightwards
@@ -60,6 +87,9 @@ int GetTextDisplayLength(const char *text);
 int GetTextDisplayTime(const char *text, int canberel = 0);
 // Draw an outline if requested, then draw the text on top 
 void wouttext_outline(Common::Bitmap *ds, int xxp, int yyp, int usingfont, color_t text_color, const char *texx);
+// Draw outline that is calculated from the text font, not derived from an outline font;
+// xxp and yyp are adjusted to the position where the text itself should be drawn
+void wouttextxy_AutoOutline(Common::Bitmap *ds, size_t font, int32_t color, const char *texx, int &xxp, int &yyp);
 void wouttext_aligned (Common::Bitmap *ds, int usexp, int yy, int oriwid, int usingfont, color_t text_color, const char *text, HorAlignment align);
 void do_corner(Common::Bitmap *ds, int sprn,int xx1,int yy1,int typx,int typy);
 // Returns the image of a button control on the GUI under given child index
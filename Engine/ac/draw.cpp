@@ -30,6 +30,7 @@
 #include "ac/global_game.h"
 #include "ac/global_gui.h"
 #include "ac/global_region.h"
+#include "ac/glyph_atlas.h"
 #include "ac/gui.h"
 #include "ac/mouse.h"
 #include "ac/movelist.h"
@@ -169,6 +170,16 @@ std::vector<ObjTexture> guibg;
 std::vector<IDriverDependantBitmap*> gui_render_tex;
 // GUI control surfaces
 std::vector<ObjTexture> guiobjbg;
+// Last drawn state of a GUI control, used to tell which parts
+// of the GUI surface have to be redrawn in software mode
+struct GUIControlDrawState
+{
+    // Area occupied on the GUI surface
+    Rect Area;
+    int  Transparency = 0;
+    int  ZOrder = 0;
+};
+std::vector<GUIControlDrawState> guiobjdrawstate;
 // first control texture index of each GUI
 std::vector<int> guiobjddbref;
 // Overlay's cached transformed bitmap, for software mode
@@ -575,6 +586,7 @@ void init_game_drawdata()
         guio_num += gui.GetControlCount();
     }
     guiobjbg.resize(guio_num);
+    guiobjdrawstate.resize(guio_num);
 }
 
 void dispose_game_drawdata()
@@ -588,7 +600,9 @@ void dispose_game_drawdata()
     guibg.clear();
     gui_render_tex.clear();
     guiobjbg.clear();
+    guiobjdrawstate.clear();
     guiobjddbref.clear();
+    glyph_atlas_reset();
 }
 
 static void dispose_debug_room_drawdata()
@@ -630,6 +644,7 @@ void clear_drawobj_cache()
         tex = nullptr;
     }
     for (auto &o : guiobjbg) o = ObjTexture();
+    for (auto &st : guiobjdrawstate) st = GUIControlDrawState();
     // cleanup Overlay intermediate bitmaps
     overlaybmp.clear();
 
@@ -649,6 +664,16 @@ void release_drawobj_rendertargets()
             gfxDriver->DestroyDDB(tex);
         tex = nullptr;
     }
+    for (auto &over : screenover)
+    {
+        if (!over.ddbIsTextTarget)
+            continue;
+        if (over.ddb)
+            gfxDriver->DestroyDDB(over.ddb);
+        over.ddb = nullptr;
+        over.ddbIsTextTarget = false;
+        over.MarkChanged();
+    }
 }
 
 void on_mainviewport_changed()
@@ -2258,6 +2283,40 @@ static void construct_guictrl_tex(GUIMain &gui)
     }
 }
 
+// Updates the recorded draw state of GUI controls, and returns the area
+// of the GUI surface which has to be redrawn because of the changed controls
+static Rect update_guictrl_draw_state(GUIMain &gui)
+{
+    Rect dirty_area;
+    auto add_dirty_area = [&dirty_area](const Rect &area)
+    {
+        if (area.IsEmpty()) return;
+        dirty_area = dirty_area.IsEmpty() ? area : SumRects(dirty_area, area);
+    };
+
+    int draw_index = guiobjddbref[gui.ID];
+    for (int i = 0; i < gui.GetControlCount(); ++i, ++draw_index)
+    {
+        GUIObject *obj = gui.GetControl(i);
+        auto &state = guiobjdrawstate[draw_index];
+        const Rect area = gui.GetControlDrawArea(i);
+        if (obj->HasChanged() ||
+            (area.Left != state.Area.Left) || (area.Top != state.Area.Top) ||
+            (area.Right != state.Area.Right) || (area.Bottom != state.Area.Bottom) ||
+            (obj->GetTransparency() != state.Transparency) || (obj->ZOrder != state.ZOrder))
+        {
+            // Both the old and new control's place must be redrawn
+            add_dirty_area(state.Area);
+            add_dirty_area(area);
+            state.Area = area;
+            state.Transparency = obj->GetTransparency();
+            state.ZOrder = obj->ZOrder;
+        }
+        obj->ClearChanged();
+    }
+    return dirty_area;
+}
+
 // Push gui bg & controls textures for the render to the corresponding render target
 static void draw_gui_controls_batch(int gui_id)
 {
@@ -2340,22 +2399,31 @@ void draw_gui_and_overlays()
                 if (gui.HasChanged() || (draw_with_controls && gui.HasControlsChanged()))
                 {
                     auto &gbg = guibg[index];
-                    recycle_bitmap(gbg.Bmp, game.GetColorDepth(), gui.Width, gui.Height, true);
-                    if (draw_with_controls)
-                        gui.DrawWithControls(gbg.Bmp.get());
-                    else
-                        gui.DrawSelf(gbg.Bmp.get());
-
                     const bool is_alpha = gui.HasAlphaChannel();
-                    if (is_alpha)
+                    // old-style (pre-3.0.2) GUI alpha rendering
+                    const bool legacy_alpha = is_alpha && (game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy)
+                        && (gui.BgImage > 0);
+                    // In software mode try to only redraw the area of the changed controls
+                    const Rect ctrl_area = draw_with_controls ? update_guictrl_draw_state(gui) : Rect();
+                    const bool redraw_all = gui.HasChanged() || !draw_with_controls || legacy_alpha || !gbg.Bmp ||
+                        (gbg.Bmp->GetWidth() != gui.Width) || (gbg.Bmp->GetHeight() != gui.Height) ||
+                        (gbg.Bmp->GetColorDepth() != game.GetColorDepth());
+                    if (redraw_all)
                     {
-                        if ((game.options[OPT_NEWGUIALPHA] == kGuiAlphaRender_Legacy) && (gui.BgImage > 0))
-                        {
-                            // old-style (pre-3.0.2) GUI alpha rendering
+                        recycle_bitmap(gbg.Bmp, game.GetColorDepth(), gui.Width, gui.Height, true);
+                        if (draw_with_controls)
+                            gui.DrawWithControls(gbg.Bmp.get());
+                        else
+                            gui.DrawSelf(gbg.Bmp.get());
+                        if (legacy_alpha)
                             repair_alpha_channel(gbg.Bmp.get(), spriteset[gui.BgImage]);
-                        }
                     }
-                    sync_object_texture(gbg, is_alpha);
+                    else if (!ctrl_area.IsEmpty())
+                    {
+                        gui.DrawWithControls(gbg.Bmp.get(), ctrl_area);
+                    }
+                    if (redraw_all || !ctrl_area.IsEmpty())
+                        sync_object_texture(gbg, is_alpha);
                 }
 
                 our_eip = 373;
@@ -2537,21 +2605,51 @@ static void construct_overlays()
         overlaybmp.resize(screenover.size());
         screenovercache.resize(screenover.size());
     }
+    glyph_atlas_begin_frame();
     for (size_t i = 0; i < screenover.size(); ++i)
     {
         auto &over = screenover[i];
         if (over.transparency == 255) continue; // skip fully transparent
 
         bool has_changed = over.HasChanged();
-        if (over.IsRoomLayer() && (walkBehindMethod == DrawOverCharSprite))
+        const bool crop_walkbehinds = over.IsRoomLayer() && (walkBehindMethod == DrawOverCharSprite);
+        if (crop_walkbehinds)
         {
             Point pos = get_overlay_position(over);
             has_changed |= (pos.X != screenovercache[i].X || pos.Y != screenovercache[i].Y);
             screenovercache[i].X = pos.X; screenovercache[i].Y = pos.Y;
         }
 
-        if (has_changed)
+        // Plain text may be composed from the glyph atlas on a render target,
+        // in which case its image is neither drawn nor uploaded to a texture
+        const TextLayout *text = (is_software_mode || crop_walkbehinds) ? nullptr : over.GetTextLayout();
+        if (text && glyph_atlas_can_draw(text->Font))
+        {
+            if (has_changed || !over.ddb || !over.ddbIsTextTarget)
+            {
+                if (over.ddb)
+                    gfxDriver->DestroyDDB(over.ddb);
+                over.ddb = gfxDriver->CreateRenderTargetDDB(text->Width, text->Height,
+                    gfxDriver->GetCompatibleBitmapFormat(game.GetColorDepth()), false);
+                over.ddbIsTextTarget = true;
+                over.ClearChanged();
+            }
+            // The render target batch has to be pushed each frame, same as for GUI
+            gfxDriver->BeginSpriteBatch(over.ddb, RectWH(0, 0, text->Width, text->Height),
+                SpriteTransform(), kFlip_None);
+            glyph_atlas_draw_layout(*text);
+            gfxDriver->EndSpriteBatch();
+        }
+        else if (has_changed || over.ddbIsTextTarget)
         {
+            if (over.ddbIsTextTarget)
+            {
+                if (over.ddb)
+                    gfxDriver->DestroyDDB(over.ddb);
+                over.ddb = nullptr;
+                over.ddbIsTextTarget = false;
+            }
+
             // For software mode - prepare transformed bitmap if necessary
             Bitmap *use_bmp = is_software_mode ?
                 transform_sprite(over.GetImage(), over.HasAlphaChannel(), overlaybmp[i], Size(over.scaleWidth, over.scaleHeight)) :
@@ -87,9 +87,17 @@ struct GameSetup
     //
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     int   Supersampling;
+    bool  RenderThread = false; // submit frames on a separate render thread
+    bool  NavGraph = false; // let pathfinder use precomputed navigation graph
+    int   PathfinderThreads = 0; // threads for searching routes in background
     size_t SpriteCacheSize = 0u;
+    size_t TexturePoolSize = 0u;
     size_t SoundLoadAtOnceSize = 1024u * 1024;
     size_t SoundCacheSize = 0u;
+    size_t SoundDecodedCacheSize = 0u;
+    int   SoundDecodedMaxLength = 0; // in ms
+    int   AudioDecoderThreads = 0; // threads for decoding sounds in parallel
+    int   VoicePrefetch = 0; // number of voice-over clips to load in advance
     bool  clear_cache_on_room_change; // for low-end devices: clear resource caches on room change
     bool  load_latest_save; // load latest saved game on launch
     ScreenRotation rotation;
@@ -504,9 +504,17 @@ static bool play_voice_clip_on_channel(const String &voice_name)
 {
     stop_and_destroy_channel(SCHAN_SPEECH);
 
-    String asset_name = voice_name;
-    asset_name.Append(".wav");
-    SOUNDCLIP *speechmp3 = my_load_wave(get_voice_over_assetpath(asset_name), false);
+    SOUNDCLIP *speechmp3 = nullptr;
+    String asset_name;
+    std::shared_ptr<std::vector<uint8_t>> data;
+    if (take_prefetched_voice(voice_name, asset_name, data))
+        speechmp3 = my_load_data(asset_name, data, false);
+
+    if (speechmp3 == nullptr) {
+        asset_name = voice_name;
+        asset_name.Append(".wav");
+        speechmp3 = my_load_wave(get_voice_over_assetpath(asset_name), false);
+    }
 
     if (speechmp3 == nullptr) {
         asset_name.ReplaceMid(asset_name.GetLength() - 3, 3, "ogg");
@@ -536,6 +544,18 @@ static bool play_voice_clip_on_channel(const String &voice_name)
     return true;
 }
 
+// Schedules prefetching of the character's voice-over clips which follow
+// the given one. This is only a guess, that assumes the lines are numbered
+// in the order they are spoken, which is up to the game; the script's or
+// dialog's upcoming lines are not known in advance. Prefetching is
+// therefore disabled, unless enabled in the config.
+static void prefetch_next_voice_clips(int charid, int sndid)
+{
+    const int clips_ahead = get_voice_prefetch();
+    for (int i = 1; i <= clips_ahead; ++i)
+        prefetch_voice_clip(get_cue_filename(charid, sndid + i));
+}
+
 // Play voice-over clip and adjust audio volumes;
 // voice_name should be bare clip name without extension
 static bool play_voice_clip_impl(const String &voice_name, bool as_speech, bool is_blocking)
@@ -580,6 +600,7 @@ bool play_voice_speech(int charid, int sndid)
     String voice_file = get_cue_filename(charid, sndid);
     if (!play_voice_clip_impl(voice_file, true, true))
         return false;
+    prefetch_next_voice_clips(charid, sndid);
 
     int ii;  // Compare the base file name to the .pam file name
     curLipLine = -1;  // See if we have voice lip sync for this line
@@ -614,7 +635,10 @@ bool play_voice_nonblocking(int charid, int sndid, bool as_speech)
         return false;
 
     String voice_file = get_cue_filename(charid, sndid);
-    return play_voice_clip_impl(voice_file, as_speech, false);
+    if (!play_voice_clip_impl(voice_file, as_speech, false))
+        return false;
+    prefetch_next_voice_clips(charid, sndid);
+    return true;
 }
 
 void stop_voice_speech()
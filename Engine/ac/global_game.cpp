@@ -31,6 +31,7 @@
 #include "ac/global_hotspot.h"
 #include "ac/global_inventoryitem.h"
 #include "ac/global_translation.h"
+#include "ac/glyph_atlas.h"
 #include "ac/gui.h"
 #include "ac/hotspot.h"
 #include "ac/keycode.h"
@@ -40,6 +41,7 @@
 #include "ac/sys_events.h"
 #include "ac/room.h"
 #include "ac/roomstatus.h"
+#include "ac/speech.h"
 #include "ac/string.h"
 #include "ac/system.h"
 #include "debug/debugger.h"
@@ -306,7 +308,10 @@ int RunAGSGame(const String &newgame, unsigned int mode, int data) {
     // Adjust config (NOTE: normally, RunAGSGame would need a redesign to allow separate config etc per each game)
     usetup.translation = ""; // reset to default, prevent from trying translation file of game A in game B
 
+    // Drop the voice clips found in the old game's libraries
+    clear_voice_prefetch();
     AssetMgr->RemoveAllLibraries();
+    update_voice_prefetch_libs();
 
     // TODO: refactor and share same code with the startup!
     if (AssetMgr->AddLibrary(ResPaths.GamePak.Path) != Common::kAssetNoError)
@@ -465,6 +470,7 @@ int SetGameOption (int opt, int setting) {
             play.swap_portrait_side = 0;
     } else if (opt == OPT_ANTIALIASFONTS) {
         adjust_fonts_for_render_mode(setting != 0);
+        glyph_atlas_reset();
     }
 
     return oldval;
@@ -737,7 +743,7 @@ void RoomProcessClick(int xx,int yy,int mood) {
             yy=thisroom.Hotspots[hsnum].WalkTo.Y;
             debug_script_log("Move to walk-to point hotspot %d", hsnum);
         }
-        walk_character(game.playercharacter,xx,yy,0, true);
+        walk_character(game.playercharacter,xx,yy,0, true, true);
         return;
     }
     play.usedmode=mood;
@@ -0,0 +1,294 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "ac/glyph_atlas.h"
+#include "ac/display.h"
+#include "ac/gamesetupstruct.h"
+#include "font/fonts.h"
+#include "gfx/bitmap.h"
+#include "gfx/graphicsdriver.h"
+#include "util/utf8.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern GameSetupStruct game;
+extern IGraphicsDriver *gfxDriver;
+
+// Size of a single atlas image
+static const int AtlasPageSize = 512;
+// Max number of atlas images; when all of them are filled up, the glyphs
+// are disposed and generated anew, starting with the next frame
+static const size_t AtlasMaxPages = 8;
+
+struct GlyphKey
+{
+    int Font = 0;
+    int Code = 0;
+    color_t Color = 0;
+    bool AutoOutline = false;
+
+    GlyphKey(int font, int code, color_t color, bool auto_outline)
+        : Font(font), Code(code), Color(color), AutoOutline(auto_outline) {}
+
+    bool operator==(const GlyphKey &other) const
+    {
+        return (Font == other.Font) && (Code == other.Code) &&
+            (Color == other.Color) && (AutoOutline == other.AutoOutline);
+    }
+};
+
+struct GlyphKeyHash
+{
+    size_t operator()(const GlyphKey &key) const
+    {
+        size_t hash = std::hash<int>()(key.Code);
+        hash = hash * 31 + std::hash<int>()(key.Color);
+        hash = hash * 31 + std::hash<int>()(key.Font);
+        return hash * 2 + (key.AutoOutline ? 1 : 0);
+    }
+};
+
+struct Glyph
+{
+    // Sprite referencing the glyph's place in the atlas texture,
+    // null if the glyph could not be created
+    IDriverDependantBitmap *Ddb = nullptr;
+    // Sprite's offset relative to the text's drawing position
+    int OffX = 0;
+    int OffY = 0;
+};
+
+// A single atlas image, glyphs are placed on it in rows ("shelves")
+struct AtlasPage
+{
+    std::unique_ptr<Bitmap> Image;
+    IDriverDependantBitmap *Ddb = nullptr;
+    int ShelfX = 0;
+    int ShelfY = 0;
+    int ShelfHeight = 0;
+    // Areas of the image with glyphs which were not uploaded to texture
+    std::vector<Rect> DirtyRects;
+};
+
+static struct GlyphAtlas
+{
+    int Supported = -1; // -1 means not tested yet
+    bool HasAlpha = false;
+    bool ResetPending = false;
+    std::vector<AtlasPage> Pages;
+    std::unordered_map<GlyphKey, Glyph, GlyphKeyHash> Glyphs;
+} Atlas;
+
+
+static void DisposeAtlas()
+{
+    for (auto &glyph : Atlas.Glyphs)
+    {
+        if (glyph.second.Ddb)
+            gfxDriver->DestroyDDB(glyph.second.Ddb);
+    }
+    Atlas.Glyphs.clear();
+    for (auto &page : Atlas.Pages)
+    {
+        if (page.Ddb)
+            gfxDriver->DestroyDDB(page.Ddb);
+    }
+    Atlas.Pages.clear();
+    Atlas.ResetPending = false;
+}
+
+static void AddPage()
+{
+    AtlasPage page;
+    page.Image.reset(BitmapHelper::CreateTransparentBitmap(AtlasPageSize, AtlasPageSize, game.GetColorDepth()));
+    page.Ddb = gfxDriver->CreateDDBFromBitmap(page.Image.get(), Atlas.HasAlpha);
+    Atlas.Pages.push_back(std::move(page));
+}
+
+// Tests whether the current renderer is capable of the glyph atlas support
+static bool TestSupport()
+{
+    if (!gfxDriver || !gfxDriver->HasAcceleratedTransform() || (game.GetColorDepth() <= 8))
+        return false;
+    Atlas.HasAlpha = ShouldAntiAliasText();
+    AddPage();
+    IDriverDependantBitmap *test = gfxDriver->CreateSubDDB(Atlas.Pages[0].Ddb, RectWH(0, 0, 1, 1));
+    if (!test)
+    {
+        DisposeAtlas();
+        return false;
+    }
+    gfxDriver->DestroyDDB(test);
+    return true;
+}
+
+// Gets the transparent gap around the glyph, which lets accomodate
+// letters that do not fit into their advance, or have vertical offsets
+static int GetGlyphMargin(int font)
+{
+    return std::max(2, get_font_surface_height(font) / 4) + std::abs(get_fontinfo(font).YOffset);
+}
+
+// Allocates a place for the glyph of the given size, adding a new page if necessary
+static AtlasPage *AllocatePlace(int width, int height, Rect &place)
+{
+    if ((width > AtlasPageSize) || (height > AtlasPageSize))
+        return nullptr;
+    if (Atlas.Pages.empty())
+        AddPage();
+    AtlasPage *page = &Atlas.Pages.back();
+    if (page->ShelfX + width > AtlasPageSize)
+    {
+        // start a new shelf
+        page->ShelfX = 0;
+        page->ShelfY += page->ShelfHeight;
+        page->ShelfHeight = 0;
+    }
+    if (page->ShelfY + height > AtlasPageSize)
+    {
+        // The new page is added even if the limit is reached, because
+        // the existing glyphs may be in use by the current frame
+        if (Atlas.Pages.size() >= AtlasMaxPages)
+            Atlas.ResetPending = true;
+        AddPage();
+        page = &Atlas.Pages.back();
+    }
+    place = RectWH(page->ShelfX, page->ShelfY, width, height);
+    page->ShelfX += width;
+    page->ShelfHeight = std::max(page->ShelfHeight, height);
+    return page;
+}
+
+static Glyph CreateGlyph(const GlyphKey &key, const char *ch)
+{
+    Glyph glyph;
+    const int margin = GetGlyphMargin(key.Font);
+    const int thickness = key.AutoOutline ? get_font_outline_thickness(key.Font) : 0;
+    const int width = get_text_width(ch, key.Font) + 2 * (margin + thickness);
+    const int height = get_font_surface_height(key.Font) + 2 * (margin + thickness);
+    Rect place;
+    AtlasPage *page = AllocatePlace(width, height, place);
+    if (!page)
+        return glyph;
+
+    // Draw the glyph the same way as the whole text would be drawn
+    Bitmap *image = page->Image.get();
+    image->SetClip(place);
+    int x = place.Left + margin, y = place.Top + margin;
+    if (key.AutoOutline)
+        wouttextxy_AutoOutline(image, key.Font, key.Color, ch, x, y);
+    else
+        wouttextxy(image, x, y, key.Font, key.Color, ch);
+    image->ResetClip();
+    // Glyphs added one after another on the same shelf make a single area
+    if (!page->DirtyRects.empty() && (page->DirtyRects.back().Top == place.Top) &&
+        (page->DirtyRects.back().Right + 1 == place.Left))
+    {
+        Rect &dirty = page->DirtyRects.back();
+        dirty.Right = place.Right;
+        dirty.Bottom = std::max(dirty.Bottom, place.Bottom);
+    }
+    else
+    {
+        page->DirtyRects.push_back(place);
+    }
+
+    glyph.Ddb = gfxDriver->CreateSubDDB(page->Ddb, place);
+    glyph.OffX = -margin;
+    glyph.OffY = -margin;
+    return glyph;
+}
+
+static const Glyph &GetGlyph(int font, int code, const char *ch, color_t color, bool auto_outline)
+{
+    const GlyphKey key(font, code, color, auto_outline);
+    auto it = Atlas.Glyphs.find(key);
+    if (it != Atlas.Glyphs.end())
+        return it->second;
+    return Atlas.Glyphs.insert(std::make_pair(key, CreateGlyph(key, ch))).first->second;
+}
+
+// Adds sprites for a single line of text, placing them by the character advances
+static void DrawGlyphs(const char *text, int x, int y, int font, color_t color, bool auto_outline)
+{
+    for (const char *ptr = text; *ptr;)
+    {
+        char uch[Utf8::UtfSz + 1]{};
+        const int code = ugetxc(&ptr); // this advances ptr
+        usetc(uch, code);
+        const Glyph &glyph = GetGlyph(font, code, uch, color, auto_outline);
+        if (glyph.Ddb)
+            gfxDriver->DrawSprite(x + glyph.OffX, y + glyph.OffY, glyph.Ddb);
+        x += get_char_advance(font, code, uch);
+    }
+}
+
+bool glyph_atlas_can_draw(int font)
+{
+    if (Atlas.Supported < 0)
+        Atlas.Supported = TestSupport() ? 1 : 0;
+    if (Atlas.Supported == 0)
+        return false;
+    if ((font < 0) || !can_measure_by_advances(font))
+        return false;
+    // Only reasonably small fonts are worth putting into atlas
+    const int thickness = (get_font_outline(font) == FONT_OUTLINE_AUTO) ? get_font_outline_thickness(font) : 0;
+    const int cell_height = get_font_surface_height(font) + 2 * (GetGlyphMargin(font) + thickness);
+    return cell_height <= AtlasPageSize / 4;
+}
+
+void glyph_atlas_begin_frame()
+{
+    if (Atlas.ResetPending)
+    {
+        DisposeAtlas();
+        AddPage();
+    }
+}
+
+void glyph_atlas_draw_layout(const TextLayout &layout)
+{
+    const int font = layout.Font;
+    const int outline_font = get_font_outline(font);
+    const int thickness = (outline_font == FONT_OUTLINE_AUTO) ? get_font_outline_thickness(font) : 0;
+    for (const auto &line : layout.Lines)
+    {
+        // Draw outline first, then the text on top, same as wouttext_outline does
+        const char *text = line.Text.GetCStr();
+        if (outline_font >= 0)
+            DrawGlyphs(text, line.X, line.Y, outline_font, layout.OutlineColor, false);
+        else if (thickness > 0)
+            DrawGlyphs(text, line.X, line.Y, font, layout.OutlineColor, true);
+        DrawGlyphs(text, line.X + thickness, line.Y + thickness, font, layout.TextColor, false);
+    }
+
+    // Upload only the areas of the newly added glyphs
+    for (auto &page : Atlas.Pages)
+    {
+        for (const auto &dirty : page.DirtyRects)
+            gfxDriver->UpdateDDBRegionFromBitmap(page.Ddb, page.Image.get(), dirty, Atlas.HasAlpha);
+        page.DirtyRects.clear();
+    }
+}
+
+void glyph_atlas_reset()
+{
+    DisposeAtlas();
+    Atlas.Supported = -1;
+}
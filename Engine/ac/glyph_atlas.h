@@ -0,0 +1,49 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Glyph atlas: text drawing for the hardware-accelerated renderers.
+//
+// Characters are drawn once into the large atlas images, which are kept in
+// textures; each glyph is then referenced by a sprite pointing at its place
+// in the atlas texture. A text is displayed by adding the glyph sprites to
+// the renderer's sprite batch, usually the one rendering on a target texture.
+// This lets to change the displayed text without rasterizing it, and without
+// uploading a new texture each time.
+//
+// Glyphs are cached per font, color, and whether they are the auto-outline;
+// outlines made with a separate outline font are the glyphs of that font.
+//
+// GUI controls, such as labels, do not use the atlas: they are drawn onto
+// the GUI's own image, which is then uploaded as a single texture.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__GLYPHATLAS_H
+#define __AGS_EE_AC__GLYPHATLAS_H
+
+struct TextLayout;
+
+// Tells if the text in this font may be drawn using the glyph atlas
+// by the current renderer
+bool glyph_atlas_can_draw(int font);
+// Prepares the atlas for the new frame; this must be called before
+// any text is drawn during the frame
+void glyph_atlas_begin_frame();
+// Adds the glyph sprites for the given text layout to the active sprite batch,
+// creating any missing glyphs in the process
+void glyph_atlas_draw_layout(const TextLayout &layout);
+// Disposes all the atlases and glyphs; they will be regenerated on demand.
+// Should be called whenever fonts change, or the renderer is going to be reset.
+void glyph_atlas_reset();
+
+#endif // __AGS_EE_AC__GLYPHATLAS_H
@@ -71,13 +71,16 @@ void Overlay_SetText(ScriptOverlay *scover, int width, int fontid, int text_colo
     // Recreate overlay image
     int dummy_x = x, dummy_y = y, adj_x = x, adj_y = y;
     bool has_alpha = false;
+    std::shared_ptr<TextLayout> text_layout;
     // NOTE: we pass text_color negated to let optionally use textwindow (if applicable)
     // this is a generic ugliness of _display_main args, need to refactor later.
     Bitmap *image = create_textual_image(get_translation(text), -text_color, 0, dummy_x, dummy_y, adj_x, adj_y,
-        width, fontid, allow_shrink, has_alpha);
+        width, fontid, allow_shrink, has_alpha, &text_layout);
 
     // Update overlay properties
     over.SetImage(std::unique_ptr<Bitmap>(image), adj_x - dummy_x, adj_y - dummy_y);
+    if (text_layout)
+        over.SetTextLayout(text_layout);
     over.SetAlphaChannel(has_alpha);
     over.ddb = nullptr; // is generated during first draw pass
 }
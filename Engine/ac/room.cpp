@@ -39,6 +39,7 @@
 #include "ac/room.h"
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
+#include "ac/route_finder.h"
 #include "ac/screen.h"
 #include "ac/string.h"
 #include "ac/system.h"
@@ -273,6 +274,8 @@ void unload_old_room() {
     current_fade_out_effect();
 
     dispose_room_drawdata();
+    set_navgraph_mask(nullptr);
+    cancel_all_routes_async();
 
     for (uint32_t ff=0;ff<croom->numobj;ff++)
         objs[ff].moving = 0;
@@ -27,11 +27,20 @@ public:
     virtual void init_pathfinder() = 0;
     virtual void shutdown_pathfinder() = 0;
     virtual void set_wallscreen(Bitmap *wallscreen) = 0;
+    virtual void set_wallscreen_version(uint64_t version) = 0;
+    virtual void set_navgraph_mask(Bitmap *walkmask) = 0;
     virtual int can_see_from(int x1, int y1, int x2, int y2) = 0;
     virtual void get_lastcpos(int &lastcx, int &lastcy) = 0;
+    virtual size_t get_search_nodes(bool reset) = 0;
     virtual void set_route_move_speed(int speed_x, int speed_y) = 0;
     virtual int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) = 0;
     virtual void calculate_move_stage(MoveList * mlsp, int aaa) = 0;
+    virtual void set_async_threads(int count) = 0;
+    virtual int find_route_async(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) = 0;
+    virtual bool is_route_pending(int movlst) = 0;
+    virtual int poll_route_async(int movlst, bool wait) = 0;
+    virtual void cancel_route_async(int movlst) = 0;
+    virtual void cancel_all_routes_async() = 0;
 };
 
 class AGSRouteFinder : public IRouteFinder 
@@ -49,6 +58,14 @@ public:
     { 
         AGS::Engine::RouteFinder::set_wallscreen(wallscreen);
     }
+    void set_wallscreen_version(uint64_t version) override
+    {
+        AGS::Engine::RouteFinder::set_wallscreen_version(version);
+    }
+    void set_navgraph_mask(Bitmap *walkmask) override
+    { 
+        AGS::Engine::RouteFinder::set_navgraph_mask(walkmask);
+    }
     int can_see_from(int x1, int y1, int x2, int y2) override
     { 
         return AGS::Engine::RouteFinder::can_see_from(x1, y1, x2, y2); 
@@ -57,6 +74,10 @@ public:
     { 
         AGS::Engine::RouteFinder::get_lastcpos(lastcx, lastcy); 
     }
+    size_t get_search_nodes(bool reset) override
+    {
+        return AGS::Engine::RouteFinder::get_search_nodes(reset);
+    }
     void set_route_move_speed(int speed_x, int speed_y) override
     { 
         AGS::Engine::RouteFinder::set_route_move_speed(speed_x, speed_y); 
@@ -69,6 +90,30 @@ public:
     { 
         AGS::Engine::RouteFinder::calculate_move_stage(mlsp, aaa); 
     }
+    void set_async_threads(int count) override
+    {
+        AGS::Engine::RouteFinder::set_async_threads(count);
+    }
+    int find_route_async(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) override
+    {
+        return AGS::Engine::RouteFinder::find_route_async(srcx, srcy, xx, yy, onscreen, movlst, nocross, ignore_walls);
+    }
+    bool is_route_pending(int movlst) override
+    {
+        return AGS::Engine::RouteFinder::is_route_pending(movlst);
+    }
+    int poll_route_async(int movlst, bool wait) override
+    {
+        return AGS::Engine::RouteFinder::poll_route_async(movlst, wait);
+    }
+    void cancel_route_async(int movlst) override
+    {
+        AGS::Engine::RouteFinder::cancel_route_async(movlst);
+    }
+    void cancel_all_routes_async() override
+    {
+        AGS::Engine::RouteFinder::cancel_all_routes_async();
+    }
 };
 
 class AGSLegacyRouteFinder : public IRouteFinder 
@@ -86,6 +131,14 @@ public:
     { 
         AGS::Engine::RouteFinderLegacy::set_wallscreen(wallscreen); 
     }
+    void set_wallscreen_version(uint64_t /*version*/) override
+    {
+        // the legacy pathfinder does not cache routes
+    }
+    void set_navgraph_mask(Bitmap* /*walkmask*/) override
+    {
+        // not supported by the legacy pathfinder
+    }
     int can_see_from(int x1, int y1, int x2, int y2) override
     { 
         return AGS::Engine::RouteFinderLegacy::can_see_from(x1, y1, x2, y2); 
@@ -94,6 +147,10 @@ public:
     { 
         AGS::Engine::RouteFinderLegacy::get_lastcpos(lastcx, lastcy); 
     }
+    size_t get_search_nodes(bool reset) override
+    {
+        return AGS::Engine::RouteFinderLegacy::get_search_nodes(reset);
+    }
     void set_route_move_speed(int speed_x, int speed_y) override
     { 
         AGS::Engine::RouteFinderLegacy::set_route_move_speed(speed_x, speed_y); 
@@ -106,6 +163,28 @@ public:
     { 
         AGS::Engine::RouteFinderLegacy::calculate_move_stage(mlsp, aaa); 
     }
+    // the legacy pathfinder always searches synchronously
+    void set_async_threads(int /*count*/) override
+    {
+    }
+    int find_route_async(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0) override
+    {
+        return AGS::Engine::RouteFinderLegacy::find_route(srcx, srcy, xx, yy, onscreen, movlst, nocross, ignore_walls);
+    }
+    bool is_route_pending(int /*movlst*/) override
+    {
+        return false;
+    }
+    int poll_route_async(int /*movlst*/, bool /*wait*/) override
+    {
+        return 0;
+    }
+    void cancel_route_async(int /*movlst*/) override
+    {
+    }
+    void cancel_all_routes_async() override
+    {
+    }
 };
 
 std::unique_ptr<IRouteFinder> route_finder_impl;
@@ -137,6 +216,16 @@ void set_wallscreen(Bitmap *wallscreen)
     route_finder_impl->set_wallscreen(wallscreen);
 }
 
+void set_wallscreen_version(uint64_t version)
+{
+    route_finder_impl->set_wallscreen_version(version);
+}
+
+void set_navgraph_mask(Bitmap *walkmask)
+{
+    route_finder_impl->set_navgraph_mask(walkmask);
+}
+
 int can_see_from(int x1, int y1, int x2, int y2)
 {
     return route_finder_impl->can_see_from(x1, y1, x2, y2);
@@ -147,6 +236,11 @@ void get_lastcpos(int &lastcx, int &lastcy)
     route_finder_impl->get_lastcpos(lastcx, lastcy);
 }
 
+size_t get_route_search_nodes(bool reset)
+{
+    return route_finder_impl->get_search_nodes(reset);
+}
+
 void set_route_move_speed(int speed_x, int speed_y)
 {
     route_finder_impl->set_route_move_speed(speed_x, speed_y);
@@ -161,3 +255,33 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 {
     route_finder_impl->calculate_move_stage(mlsp, aaa);
 }
+
+void set_route_async_threads(int count)
+{
+    route_finder_impl->set_async_threads(count);
+}
+
+int find_route_async(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+    return route_finder_impl->find_route_async(srcx, srcy, xx, yy, onscreen, movlst, nocross, ignore_walls);
+}
+
+bool is_route_pending(int movlst)
+{
+    return route_finder_impl->is_route_pending(movlst);
+}
+
+int poll_route_async(int movlst, bool wait)
+{
+    return route_finder_impl->poll_route_async(movlst, wait);
+}
+
+void cancel_route_async(int movlst)
+{
+    route_finder_impl->cancel_route_async(movlst);
+}
+
+void cancel_all_routes_async()
+{
+    route_finder_impl->cancel_all_routes_async();
+}
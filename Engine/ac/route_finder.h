@@ -15,6 +15,8 @@
 #ifndef __AC_ROUTEFND_H
 #define __AC_ROUTEFND_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include "ac/game_version.h"
 
 // Forward declaration
@@ -25,13 +27,44 @@ void init_pathfinder(GameDataVersion game_file_version);
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
+// Sets the version of the walls masks passed to the pathfinder from now on,
+// which lets it tell whether a route found earlier may be reused; it must
+// change whenever the mask contents change. Pass 0 if the version is unknown,
+// then the pathfinder will have to check the mask contents.
+void set_wallscreen_version(uint64_t version);
+// Assigns the room's walkable mask, which the pathfinder may use to build
+// a navigation graph for searching long routes faster; the mask is copied,
+// so this should be called again whenever it changes. Pass null to dispose.
+void set_navgraph_mask(AGS::Common::Bitmap *walkmask);
 
 int can_see_from(int x1, int y1, int x2, int y2);
 void get_lastcpos(int &lastcx, int &lastcy);
+// Gets the number of search nodes expanded by the pathfinder on the game
+// thread, for profiling; optionally resets the counter
+size_t get_route_search_nodes(bool reset = false);
 // NOTE: pathfinder implementation mostly needs to know proportion between x and y speed
 void set_route_move_speed(int speed_x, int speed_y);
 
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
 
+// Sets the number of background threads which search for routes requested
+// with find_route_async; 0 (default) makes all searches synchronous
+void set_route_async_threads(int count);
+// Begins searching for a route in background. If the result is known right
+// away (e.g. when the destination is directly visible, or there are no
+// worker threads), then returns same as find_route; otherwise returns -1,
+// and the MoveList will be filled later, by poll_route_async.
+int find_route_async(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
+// Tells whether a background search is running for the given MoveList
+bool is_route_pending(int movlst);
+// Checks on the background search for the given MoveList; returns -1 if
+// it's still running, otherwise same as find_route. After few polls, or if
+// wait is set, the route is completed synchronously, to not delay the movement
+// too long.
+int poll_route_async(int movlst, bool wait = false);
+// Cancels pending background search for the given MoveList, or for all
+void cancel_route_async(int movlst);
+void cancel_all_routes_async();
+
 #endif // __AC_ROUTEFND_H
\ No newline at end of file
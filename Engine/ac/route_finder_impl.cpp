@@ -20,10 +20,16 @@
 
 #include <string.h>
 #include <math.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "ac/common.h"   // quit()
 #include "ac/movelist.h"     // MoveList
 #include "ac/common_defines.h"
+#include "ac/route_finder_navgraph.h"
 #include "gfx/bitmap.h"
 #include "debug/out.h"
 
@@ -45,16 +51,85 @@ static const int MAXNAVPOINTS = MAXNEEDSTAGES;
 static int navpoints[MAXNAVPOINTS];
 static int num_navpoints;
 static fixed move_speed_x, move_speed_y;
-static Navigation nav;
+
+// Search state and temporary buffers; each thread must have its own
+struct RouteSearch
+{
+  Navigation Nav;
+  std::vector<int> Path, CPath;
+  std::vector<int> Waypoints, LegPath;
+};
+
+static RouteSearch search; // used on the game thread
+static Navigation &nav = search.Nav;
+static NavGraph navgraph;
+static std::mutex navgraph_mutex; // navgraph is shared with the async workers
 static Bitmap *wallscreen;
+static uint64_t wallscreen_version; // assigned by the engine, 0 if unknown
+static uint64_t wallscreen_hash;
+static bool wallscreen_hashed;
 static int lastcx, lastcy;
 
+// Recently found routes, reused when a character walks again to the same
+// place from about the same position (e.g. when following someone,
+// or when player clicks repeatedly). Routes are identified by the walls mask
+// key (see get_wallscreen_key) and the start and end coordinates quantized
+// to a small grid.
+struct RouteCacheEntry
+{
+  uint64_t MaskKey = 0;
+  int SrcCell = -1;
+  int DstCell = -1;
+  std::vector<int> Navpoints; // in MAKE_INTCOORD format
+  uint32_t LastUse = 0;
+};
+
+static const size_t ROUTE_CACHE_SIZE = 32;
+static const int ROUTE_CACHE_CELL_SHIFT = 3; // 8x8 pixel cells
+static RouteCacheEntry route_cache[ROUTE_CACHE_SIZE];
+static uint32_t route_cache_counter;
+
+// Route search request, processed on a worker thread. The worker gets
+// a copy of the walls mask, so that the game may continue to change it.
+struct AsyncRoute
+{
+  int MoveList = 0;
+  short SrcX = 0, SrcY = 0, DstX = 0, DstY = 0;
+  fixed SpeedX = 0, SpeedY = 0; // move speeds at the time of request
+  uint64_t MaskKey = 0;
+  int Width = 0, Height = 0;
+  std::vector<uint8_t> Mask;
+  int Polls = 0; // number of times the game checked for result
+  // Following are guarded by async_mutex
+  bool Started = false;
+  bool Cancelled = false;
+  bool Done = false;
+  std::vector<int> Navpoints; // found route, in MAKE_INTCOORD format
+};
+
+// Number of result polls after which the game stops waiting for
+// the worker and gets the route right away
+static const int ASYNC_ROUTE_MAX_POLLS = 2;
+static std::vector<std::thread> async_workers;
+static std::mutex async_mutex;
+static std::condition_variable async_cv; // signals new requests
+static std::condition_variable async_done_cv; // signals finished requests
+static std::deque<std::shared_ptr<AsyncRoute>> async_queue;
+static bool async_exit;
+// Unfinished requests, indexed by MoveList; accessed only by the game thread
+static std::vector<std::shared_ptr<AsyncRoute>> async_routes;
+
+static void stop_async_workers();
+
 void init_pathfinder()
 {
 }
 
 void shutdown_pathfinder()
 {
+  stop_async_workers();
+  for (auto &entry : route_cache)
+    entry = RouteCacheEntry();
 }
 
 void set_wallscreen(Bitmap *wallscreen_) 
@@ -62,6 +137,26 @@ void set_wallscreen(Bitmap *wallscreen_)
   wallscreen = wallscreen_;
 }
 
+void set_wallscreen_version(uint64_t version)
+{
+  wallscreen_version = version;
+}
+
+void set_navgraph_mask(Bitmap *walkmask)
+{
+  std::lock_guard<std::mutex> lock(navgraph_mutex);
+  if (!walkmask)
+  {
+    navgraph.Clear();
+    return;
+  }
+
+  std::vector<const uint8_t*> rows(walkmask->GetHeight());
+  for (int y = 0; y < walkmask->GetHeight(); y++)
+    rows[y] = walkmask->GetScanLine(y);
+  navgraph.SetMask(walkmask->GetWidth(), walkmask->GetHeight(), rows.data());
+}
+
 static void sync_nav_wallscreen()
 {
   // FIXME: this is dumb, but...
@@ -69,9 +164,42 @@ static void sync_nav_wallscreen()
 
   for (int y=0; y<wallscreen->GetHeight(); y++)
     nav.SetMapRow(y, wallscreen->GetScanLine(y));
+
+  wallscreen_hashed = false;
 }
 
-int can_see_from(int x1, int y1, int x2, int y2)
+// Returns the key identifying the walls mask contents in the route cache:
+// the mask version assigned by the engine, or, if there's none, the hash
+// of the mask contents, calculated once per sync and only when needed
+static uint64_t get_wallscreen_key()
+{
+  if (wallscreen_version != 0)
+    return wallscreen_version;
+  if (wallscreen_hashed)
+    return wallscreen_hash;
+
+  const int width = wallscreen->GetWidth();
+  uint64_t hash = ((uint64_t)width << 32) | (uint32_t)wallscreen->GetHeight();
+  for (int y=0; y<wallscreen->GetHeight(); y++)
+  {
+    const uint8_t *row = wallscreen->GetScanLine(y);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+      uint64_t v;
+      memcpy(&v, row + x, sizeof(v));
+      hash = (hash ^ v) * 0x100000001B3ull;
+      hash ^= hash >> 29;
+    }
+    for (; x < width; x++)
+      hash = (hash ^ row[x]) * 0x100000001B3ull;
+  }
+  wallscreen_hash = hash;
+  wallscreen_hashed = true;
+  return hash;
+}
+
+static int can_see_from_synced(int x1, int y1, int x2, int y2)
 {
   lastcx = x1;
   lastcy = y1;
@@ -79,9 +207,17 @@ int can_see_from(int x1, int y1, int x2, int y2)
   if ((x1 == x2) && (y1 == y2))
     return 1;
 
+  return !nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
+}
+
+int can_see_from(int x1, int y1, int x2, int y2)
+{
+  if ((x1 == x2) && (y1 == y2))
+    return can_see_from_synced(x1, y1, x2, y2);
+
   sync_nav_wallscreen();
 
-  return !nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
+  return can_see_from_synced(x1, y1, x2, y2);
 }
 
 void get_lastcpos(int &lastcx_, int &lastcy_) 
@@ -90,32 +226,145 @@ void get_lastcpos(int &lastcx_, int &lastcy_)
   lastcy_ = lastcy;
 }
 
-// new routing using JPS
-static int find_route_jps(int fromx, int fromy, int destx, int desty)
+size_t get_search_nodes(bool reset)
 {
-  sync_nav_wallscreen();
+  const size_t count = nav.GetExpandedNodes();
+  if (reset)
+    nav.ResetExpandedNodes();
+  return count;
+}
+
+// routing over the navigation graph: the coarse route found in graph
+// is refined with JPS between each pair of consecutive waypoints;
+// the walls mask must be synced with rs.Nav prior to calling this
+static bool find_route_navgraph(RouteSearch &rs, int width, int height,
+  int fromx, int fromy, int destx, int desty, std::vector<int> &cpath)
+{
+  Navigation &rnav = rs.Nav;
+  {
+    // the graph is built from the room's walkable areas, while the walls mask
+    // may also have areas blocked by characters and objects; graph only
+    // suggests the route, and if that is blocked we let full JPS decide
+    std::lock_guard<std::mutex> lock(navgraph_mutex);
+    if (navgraph.IsEmpty() || (navgraph.GetWidth() != width) || (navgraph.GetHeight() != height))
+      return false;
+    if (!navgraph.FindWaypoints(fromx, fromy, destx, desty, rs.Waypoints))
+      return false;
+  }
+
+  const std::vector<int> &waypoints = rs.Waypoints;
+  cpath.clear();
+  cpath.push_back(waypoints[0]);
+  for (size_t i = 1; i < waypoints.size(); i++)
+  {
+    int fx, fy, tx, ty;
+    rnav.UnpackSquare(waypoints[i - 1], fx, fy);
+    rnav.UnpackSquare(waypoints[i], tx, ty);
+    if ((rnav.NavigateRefined(fx, fy, tx, ty, rs.Path, rs.LegPath) == Navigation::NAV_UNREACHABLE) ||
+        rs.LegPath.empty() || (rs.LegPath.back() != waypoints[i]))
+      return false;
+    cpath.insert(cpath.end(), rs.LegPath.begin() + 1, rs.LegPath.end());
+  }
 
-  static std::vector<int> path, cpath;
+  // pull the joined path straight, skipping the points which
+  // are directly visible from the previous kept point
+  size_t count = 0;
+  for (size_t i = 0; i < cpath.size();)
+  {
+    cpath[count++] = cpath[i];
+    int fx, fy, tx, ty;
+    rnav.UnpackSquare(cpath[i], fx, fy);
+    size_t next = i + 1;
+    for (; next + 1 < cpath.size(); next++)
+    {
+      rnav.UnpackSquare(cpath[next + 1], tx, ty);
+      if (rnav.TraceLine(fx, fy, tx, ty))
+        break;
+    }
+    i = next;
+  }
+  cpath.resize(count);
+  return true;
+}
+
+// new routing using JPS; fills the route points in MAKE_INTCOORD format
+// and returns their number, or 0 if no route was found
+static int find_route_jps(RouteSearch &rs, int width, int height,
+  int fromx, int fromy, int destx, int desty, int *points)
+{
+  std::vector<int> &path = rs.Path, &cpath = rs.CPath;
   path.clear();
   cpath.clear();
 
-  if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
+  if (!find_route_navgraph(rs, width, height, fromx, fromy, destx, desty, cpath) &&
+      (rs.Nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE))
     return 0;
 
-  num_navpoints = 0;
-
   // new behavior: cut path if too complex rather than abort with error message
   int count = std::min<int>((int)cpath.size(), MAXNAVPOINTS);
 
   for (int i = 0; i<count; i++)
   {
     int x, y;
-    nav.UnpackSquare(cpath[i], x, y);
+    rs.Nav.UnpackSquare(cpath[i], x, y);
 
-    navpoints[num_navpoints++] = MAKE_INTCOORD(x, y);
+    points[i] = MAKE_INTCOORD(x, y);
   }
 
-  return 1;
+  return count;
+}
+
+// tries to reuse a route found earlier on the same walls mask, between
+// the nearby points; the route's ends are moved to the requested points,
+// if these are directly reachable from the route's inner waypoints
+static bool find_route_cached(int fromx, int fromy, int destx, int desty)
+{
+  const uint64_t key = get_wallscreen_key();
+  const int src_cell = MAKE_INTCOORD(fromx >> ROUTE_CACHE_CELL_SHIFT, fromy >> ROUTE_CACHE_CELL_SHIFT);
+  const int dst_cell = MAKE_INTCOORD(destx >> ROUTE_CACHE_CELL_SHIFT, desty >> ROUTE_CACHE_CELL_SHIFT);
+  for (auto &entry : route_cache)
+  {
+    if ((entry.MaskKey != key) || (entry.SrcCell != src_cell) || (entry.DstCell != dst_cell))
+      continue;
+
+    const std::vector<int> &points = entry.Navpoints;
+    const size_t count = points.size();
+    if (count < 3)
+      continue; // straight line, will be found without cache
+    const int firstx = (points[1] >> 16) & 0xffff, firsty = points[1] & 0xffff;
+    const int lastx = (points[count - 2] >> 16) & 0xffff, lasty = points[count - 2] & 0xffff;
+    if (nav.TraceLine(fromx, fromy, firstx, firsty) || nav.TraceLine(lastx, lasty, destx, desty))
+      continue;
+
+    num_navpoints = (int)count;
+    std::copy(points.begin(), points.end(), navpoints);
+    navpoints[0] = MAKE_INTCOORD(fromx, fromy);
+    navpoints[count - 1] = MAKE_INTCOORD(destx, desty);
+    entry.LastUse = ++route_cache_counter;
+    return true;
+  }
+  return false;
+}
+
+// stores the last found route in cache, replacing the least recently used one
+static void add_route_to_cache(uint64_t mask_key, int fromx, int fromy, int destx, int desty)
+{
+  // only cache the complete routes, but not those leading to the
+  // closest point near unreachable destination, or cut for being too long
+  if ((num_navpoints < 3) || (navpoints[num_navpoints - 1] != MAKE_INTCOORD(destx, desty)))
+    return;
+
+  RouteCacheEntry *entry = &route_cache[0];
+  for (auto &e : route_cache)
+  {
+    if (e.LastUse < entry->LastUse)
+      entry = &e;
+  }
+  entry->MaskKey = mask_key;
+  entry->SrcCell = MAKE_INTCOORD(fromx >> ROUTE_CACHE_CELL_SHIFT, fromy >> ROUTE_CACHE_CELL_SHIFT);
+  entry->DstCell = MAKE_INTCOORD(destx >> ROUTE_CACHE_CELL_SHIFT, desty >> ROUTE_CACHE_CELL_SHIFT);
+  entry->Navpoints.assign(navpoints, navpoints + num_navpoints);
+  entry->LastUse = ++route_cache_counter;
 }
 
 void set_route_move_speed(int speed_x, int speed_y)
@@ -214,26 +463,11 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 }
 
 
-int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+// fills the MoveList with the found route
+static int fill_move_list(int movlst, short srcx, short srcy)
 {
   int i;
 
-  wallscreen = onscreen;
-
-  num_navpoints = 0;
-
-  if (ignore_walls || can_see_from(srcx, srcy, xx, yy))
-  {
-    num_navpoints = 2;
-    navpoints[0] = MAKE_INTCOORD(srcx, srcy);
-    navpoints[1] = MAKE_INTCOORD(xx, yy);
-  } else {
-    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
-      return 0; // clicked on a wall
-
-    find_route_jps(srcx, srcy, xx, yy);
-  }
-
   if (!num_navpoints)
     return 0;
 
@@ -244,7 +478,7 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   assert(num_navpoints <= MAXNAVPOINTS);
 
 #ifdef DEBUG_PATHFINDER
-  AGS::Common::Debug::Printf("Route from %d,%d to %d,%d - %d stages", srcx,srcy,xx,yy,num_navpoints);
+  AGS::Common::Debug::Printf("Route from %d,%d - %d stages", srcx,srcy,num_navpoints);
 #endif
 
   int mlist = movlst;
@@ -255,7 +489,7 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
 #endif
 
   for (i=0; i<num_navpoints-1; i++)
-    calculate_move_stage(&mls[mlist], i);
+    RouteFinder::calculate_move_stage(&mls[mlist], i);
 
   mls[mlist].fromx = srcx;
   mls[mlist].fromy = srcy;
@@ -267,6 +501,210 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   return mlist;
 }
 
+static int submit_route_async(short srcx, short srcy, short xx, short yy, int movlst);
+
+// finds route on the walls mask, which is already synced with nav;
+// if async is set, then the full search is passed to the worker threads,
+// and -1 is returned
+static int find_route_synced(short srcx, short srcy, short xx, short yy, int movlst, int nocross, int ignore_walls,
+  bool async = false)
+{
+  num_navpoints = 0;
+
+  if (ignore_walls || can_see_from_synced(srcx, srcy, xx, yy))
+  {
+    num_navpoints = 2;
+    navpoints[0] = MAKE_INTCOORD(srcx, srcy);
+    navpoints[1] = MAKE_INTCOORD(xx, yy);
+  } else {
+    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
+      return 0; // clicked on a wall
+
+    if (!find_route_cached(srcx, srcy, xx, yy))
+    {
+      if (async)
+        return submit_route_async(srcx, srcy, xx, yy, movlst);
+      num_navpoints = find_route_jps(search, wallscreen->GetWidth(), wallscreen->GetHeight(),
+        srcx, srcy, xx, yy, navpoints);
+      if (num_navpoints)
+        add_route_to_cache(get_wallscreen_key(), srcx, srcy, xx, yy);
+    }
+  }
+
+  return fill_move_list(movlst, srcx, srcy);
+}
+
+int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+  cancel_route_async(movlst);
+  wallscreen = onscreen;
+  sync_nav_wallscreen();
+  return find_route_synced(srcx, srcy, xx, yy, movlst, nocross, ignore_walls);
+}
+
+// Asynchronous route search
+
+static void run_route_search(RouteSearch &rs, AsyncRoute &req, std::vector<int> &points)
+{
+  rs.Nav.Resize(req.Width, req.Height);
+  for (int y = 0; y < req.Height; y++)
+    rs.Nav.SetMapRow(y, &req.Mask[y * req.Width]);
+  points.resize(MAXNAVPOINTS);
+  points.resize(find_route_jps(rs, req.Width, req.Height, req.SrcX, req.SrcY, req.DstX, req.DstY, points.data()));
+}
+
+static void async_route_worker()
+{
+  RouteSearch rs;
+  std::vector<int> points;
+  std::unique_lock<std::mutex> lk(async_mutex);
+  for (;;)
+  {
+    async_cv.wait(lk, []() { return async_exit || !async_queue.empty(); });
+    if (async_exit)
+      break;
+    std::shared_ptr<AsyncRoute> req = async_queue.front();
+    async_queue.pop_front();
+    if (req->Cancelled)
+      continue;
+    req->Started = true;
+    lk.unlock();
+    run_route_search(rs, *req, points);
+    lk.lock();
+    req->Navpoints.swap(points);
+    req->Done = true;
+    async_done_cv.notify_all();
+  }
+}
+
+static void stop_async_workers()
+{
+  cancel_all_routes_async();
+  {
+    std::lock_guard<std::mutex> lock(async_mutex);
+    async_exit = true;
+  }
+  async_cv.notify_all();
+  for (auto &worker : async_workers)
+    worker.join();
+  async_workers.clear();
+  async_queue.clear();
+  async_exit = false;
+}
+
+void set_async_threads(int count)
+{
+  stop_async_workers();
+  for (int i = 0; i < count; i++)
+    async_workers.emplace_back(async_route_worker);
+}
+
+static int submit_route_async(short srcx, short srcy, short xx, short yy, int movlst)
+{
+  auto req = std::make_shared<AsyncRoute>();
+  req->MoveList = movlst;
+  req->SrcX = srcx;
+  req->SrcY = srcy;
+  req->DstX = xx;
+  req->DstY = yy;
+  req->SpeedX = move_speed_x;
+  req->SpeedY = move_speed_y;
+  req->MaskKey = get_wallscreen_key();
+  req->Width = wallscreen->GetWidth();
+  req->Height = wallscreen->GetHeight();
+  req->Mask.resize(req->Width * req->Height);
+  for (int y = 0; y < req->Height; y++)
+    memcpy(&req->Mask[y * req->Width], wallscreen->GetScanLine(y), req->Width);
+
+  if (async_routes.size() <= (size_t)movlst)
+    async_routes.resize(movlst + 1);
+  async_routes[movlst] = req;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex);
+    async_queue.push_back(req);
+  }
+  async_cv.notify_one();
+  return -1;
+}
+
+int find_route_async(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+  cancel_route_async(movlst);
+  wallscreen = onscreen;
+  sync_nav_wallscreen();
+  return find_route_synced(srcx, srcy, xx, yy, movlst, nocross, ignore_walls, !async_workers.empty());
+}
+
+bool is_route_pending(int movlst)
+{
+  return ((size_t)movlst < async_routes.size()) && async_routes[movlst];
+}
+
+int poll_route_async(int movlst, bool wait)
+{
+  if (!is_route_pending(movlst))
+    return 0;
+
+  std::shared_ptr<AsyncRoute> req = async_routes[movlst];
+  {
+    std::unique_lock<std::mutex> lk(async_mutex);
+    if (!req->Done)
+    {
+      if (!wait && (++req->Polls < ASYNC_ROUTE_MAX_POLLS))
+        return -1;
+      // don't make them wait any longer: take the request back if no worker
+      // got to it yet, or wait for the worker to finish
+      if (req->Started)
+      {
+        async_done_cv.wait(lk, [&req]() { return req->Done; });
+      }
+      else
+      {
+        // search on a separate state, as the request's mask is disposed
+        // right after, while the game thread's search must stay synced
+        // with the walls mask
+        req->Cancelled = true;
+        lk.unlock();
+        RouteSearch rs;
+        run_route_search(rs, *req, req->Navpoints);
+        lk.lock();
+        req->Done = true;
+      }
+    }
+  }
+  async_routes[movlst].reset();
+
+  num_navpoints = (int)req->Navpoints.size();
+  std::copy(req->Navpoints.begin(), req->Navpoints.end(), navpoints);
+  if (num_navpoints)
+    add_route_to_cache(req->MaskKey, req->SrcX, req->SrcY, req->DstX, req->DstY);
+  // build the move list using the speeds that were set for this request
+  const fixed speed_x = move_speed_x, speed_y = move_speed_y;
+  move_speed_x = req->SpeedX;
+  move_speed_y = req->SpeedY;
+  const int result = fill_move_list(movlst, req->SrcX, req->SrcY);
+  move_speed_x = speed_x;
+  move_speed_y = speed_y;
+  return result;
+}
+
+void cancel_route_async(int movlst)
+{
+  if (!is_route_pending(movlst))
+    return;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex);
+    async_routes[movlst]->Cancelled = true;
+  }
+  async_routes[movlst].reset();
+}
+
+void cancel_all_routes_async()
+{
+  for (size_t i = 0; i < async_routes.size(); i++)
+    cancel_route_async((int)i);
+}
+
 
 } // namespace RouteFinder
 } // namespace Engine
@@ -15,6 +15,8 @@
 #ifndef __AC_ROUTE_FINDER_IMPL
 #define __AC_ROUTE_FINDER_IMPL
 
+#include <stddef.h>
+#include <stdint.h>
 #include "ac/game_version.h"
 
 // Forward declaration
@@ -29,15 +31,27 @@ void init_pathfinder();
 void shutdown_pathfinder();
 
 void set_wallscreen(AGS::Common::Bitmap *wallscreen);
+void set_wallscreen_version(uint64_t version);
+// Assigns the walkable mask for building the navigation graph; pass null to dispose
+void set_navgraph_mask(AGS::Common::Bitmap *walkmask);
 
 int can_see_from(int x1, int y1, int x2, int y2);
 void get_lastcpos(int &lastcx, int &lastcy);
+size_t get_search_nodes(bool reset);
 
 void set_route_move_speed(int speed_x, int speed_y);
 
 int find_route(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
 void calculate_move_stage(MoveList * mlsp, int aaa);
 
+// Sets the number of worker threads for the asynchronous search; 0 disables it
+void set_async_threads(int count);
+int find_route_async(short srcx, short srcy, short xx, short yy, AGS::Common::Bitmap *onscreen, int movlst, int nocross = 0, int ignore_walls = 0);
+bool is_route_pending(int movlst);
+int poll_route_async(int movlst, bool wait = false);
+void cancel_route_async(int movlst);
+void cancel_all_routes_async();
+
 } // namespace RouteFinder
 } // namespace Engine
 } // namespace AGS
@@ -256,6 +256,7 @@ static int nesting = 0;
 static int pathbackstage = 0;
 static int finalpartx = 0;
 static int finalparty = 0;
+static size_t expanded_nodes = 0; // for profiling
 static short **beenhere = nullptr;     //[200][320];
 static int beenhere_array_size = 0;
 static const int BEENHERE_SIZE = 2;
@@ -274,6 +275,8 @@ static int try_this_square(int srcx, int srcy, int tox, int toy)
   if (beenhere[srcy][srcx] & 0x80)
     return 0;
 
+  expanded_nodes++;
+
   // nesting of 8040 leads to stack overflow
   if (nesting > 7000)
     return 0;
@@ -460,6 +463,7 @@ static int find_route_dijkstra(int fromx, int fromy, int destx, int desty)
     for (int n = 0; n < iteration; n++) {
       if (visited[n] == -1)
         continue;
+      expanded_nodes++;
 
       i = visited[n] % wallscreen->GetWidth();
       j = visited[n] / wallscreen->GetWidth();
@@ -891,6 +895,14 @@ stage_again:
 #endif
 }
 
+size_t get_search_nodes(bool reset)
+{
+  const size_t count = expanded_nodes;
+  if (reset)
+    expanded_nodes = 0;
+  return count;
+}
+
 void shutdown_pathfinder()
 {
   if (pathbackx != nullptr) 
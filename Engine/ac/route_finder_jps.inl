@@ -59,6 +59,10 @@ public:
 
 	inline void SetMapRow(int y, const unsigned char *row) {map[y] = row;}
 
+	// number of nodes taken from the open list, counted for profiling
+	inline size_t GetExpandedNodes() const {return expandedNodes;}
+	inline void ResetExpandedNodes() {expandedNodes = 0;}
+
 	inline static int PackSquare(int x, int y);
 	inline static void UnpackSquare(int sq, int &x, int &y);
 
@@ -134,6 +138,8 @@ private:
 
 	bool navLock;
 
+	size_t expandedNodes;
+
 	void IncFrameId();
 
 	// outside map test
@@ -190,6 +196,7 @@ Navigation::Navigation()
 	// no diagonal route - this should correspond to what AGS does
 	, nodiag(true)
 	, navLock(false)
+	, expandedNodes(0)
 {
 }
 
@@ -381,6 +388,7 @@ Navigation::NavResult Navigation::Navigate(int sx, int sy, int ex, int ey, std::
 	{
 		Entry e = pq.top();
 		pq.pop();
+		expandedNodes++;
 
 		int x, y;
 		UnpackSquare(e.index, x, y);
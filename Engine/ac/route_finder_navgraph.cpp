@@ -0,0 +1,289 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "ac/route_finder_navgraph.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <math.h>
+#include <queue>
+
+namespace AGS
+{
+namespace Engine
+{
+namespace RouteFinder
+{
+
+NavGraph::NavGraph(int cluster_size)
+    : _clusterSize(std::max(cluster_size, 2))
+{
+}
+
+void NavGraph::SetMask(int width, int height, const uint8_t *const *rows)
+{
+    Clear();
+    if (width <= 0 || height <= 0)
+        return;
+    _width = width;
+    _height = height;
+    _walkable.resize(width * height);
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t *dst = &_walkable[y * width];
+        const uint8_t *src = rows[y];
+        for (int x = 0; x < width; ++x)
+            dst[x] = src[x] != 0;
+    }
+    _clustersX = (width + _clusterSize - 1) / _clusterSize;
+    _clustersY = (height + _clusterSize - 1) / _clusterSize;
+}
+
+void NavGraph::Clear()
+{
+    _width = _height = 0;
+    _clustersX = _clustersY = 0;
+    _walkable.clear();
+    _nodes.clear();
+    _clusterNodes.clear();
+    _built = false;
+}
+
+size_t NavGraph::GetNodeCount()
+{
+    Build();
+    return _nodes.size();
+}
+
+int NavGraph::AddNode(int x, int y)
+{
+    auto &cluster = _clusterNodes[ClusterAt(x, y)];
+    for (int n : cluster)
+    {
+        if (_nodes[n].X == x && _nodes[n].Y == y)
+            return n;
+    }
+    _nodes.emplace_back(x, y);
+    cluster.push_back((int)_nodes.size() - 1);
+    return (int)_nodes.size() - 1;
+}
+
+void NavGraph::AddEdge(int from, int to, float cost)
+{
+    _nodes[from].Edges.emplace_back(to, cost);
+}
+
+void NavGraph::FindPortals(int x, int y, int len, int dx, int dy, int nx, int ny)
+{
+    int run_start = -1;
+    for (int i = 0; i <= len; ++i)
+    {
+        const int cx = x + dx * i, cy = y + dy * i;
+        const bool open = (i < len) && Walkable(cx, cy) && Walkable(cx + nx, cy + ny);
+        if (open)
+        {
+            if (run_start < 0)
+                run_start = i;
+            continue;
+        }
+        if (run_start < 0)
+            continue;
+        // Put a portal in the middle of the passage
+        const int mid = (run_start + i - 1) / 2;
+        const int px = x + dx * mid, py = y + dy * mid;
+        const int a = AddNode(px, py);
+        const int b = AddNode(px + nx, py + ny);
+        AddEdge(a, b, 1.f);
+        AddEdge(b, a, 1.f);
+        run_start = -1;
+    }
+}
+
+void NavGraph::FloodCluster(int x, int y)
+{
+    _floodX0 = (x / _clusterSize) * _clusterSize;
+    _floodY0 = (y / _clusterSize) * _clusterSize;
+    _floodW = std::min(_clusterSize, _width - _floodX0);
+    _floodH = std::min(_clusterSize, _height - _floodY0);
+    _distances.assign(_floodW * _floodH, -1);
+    _queue.clear();
+    if (!Walkable(x, y))
+        return;
+
+    _distances[(y - _floodY0) * _floodW + (x - _floodX0)] = 0;
+    _queue.push_back((y - _floodY0) * _floodW + (x - _floodX0));
+    for (size_t head = 0; head < _queue.size(); ++head)
+    {
+        const int index = _queue[head];
+        const int lx = index % _floodW, ly = index / _floodW;
+        const int dist = _distances[index] + 1;
+        const int neighbours[4][2] = { { lx - 1, ly }, { lx + 1, ly }, { lx, ly - 1 }, { lx, ly + 1 } };
+        for (const auto &n : neighbours)
+        {
+            if (n[0] < 0 || n[0] >= _floodW || n[1] < 0 || n[1] >= _floodH)
+                continue;
+            const int n_index = n[1] * _floodW + n[0];
+            if (_distances[n_index] >= 0 || !Walkable(_floodX0 + n[0], _floodY0 + n[1]))
+                continue;
+            _distances[n_index] = dist;
+            _queue.push_back(n_index);
+        }
+    }
+}
+
+inline int NavGraph::GetDistance(int x, int y) const
+{
+    x -= _floodX0;
+    y -= _floodY0;
+    if (x < 0 || x >= _floodW || y < 0 || y >= _floodH)
+        return -1;
+    return _distances[y * _floodW + x];
+}
+
+void NavGraph::Build()
+{
+    if (_built || IsEmpty())
+        return;
+
+    _nodes.clear();
+    _clusterNodes.assign(_clustersX * _clustersY, std::vector<int>());
+    // Find passages between the neighbouring clusters
+    for (int cy = 0; cy < _clustersY; ++cy)
+    {
+        for (int cx = 0; cx < _clustersX; ++cx)
+        {
+            const int x0 = cx * _clusterSize, y0 = cy * _clusterSize;
+            const int w = std::min(_clusterSize, _width - x0);
+            const int h = std::min(_clusterSize, _height - y0);
+            if (cx + 1 < _clustersX)
+                FindPortals(x0 + w - 1, y0, h, 0, 1, 1, 0);
+            if (cy + 1 < _clustersY)
+                FindPortals(x0, y0 + h - 1, w, 1, 0, 0, 1);
+        }
+    }
+    // Connect portals within each cluster
+    for (const auto &cluster : _clusterNodes)
+    {
+        for (int from : cluster)
+        {
+            FloodCluster(_nodes[from].X, _nodes[from].Y);
+            for (int to : cluster)
+            {
+                if (to == from)
+                    continue;
+                const int dist = GetDistance(_nodes[to].X, _nodes[to].Y);
+                if (dist >= 0)
+                    AddEdge(from, to, (float)dist);
+            }
+        }
+    }
+    _built = true;
+}
+
+bool NavGraph::FindWaypoints(int sx, int sy, int ex, int ey, std::vector<int> &waypoints)
+{
+    waypoints.clear();
+    if (IsEmpty() || !Walkable(sx, sy) || !Walkable(ex, ey))
+        return false;
+    Build();
+
+    // Link start to the portals of its cluster
+    FloodCluster(sx, sy);
+    if ((ClusterAt(sx, sy) == ClusterAt(ex, ey)) && (GetDistance(ex, ey) >= 0))
+        return false; // local route, no use of the graph
+    _startEdges.clear();
+    for (int n : _clusterNodes[ClusterAt(sx, sy)])
+    {
+        const int dist = GetDistance(_nodes[n].X, _nodes[n].Y);
+        if (dist >= 0)
+            _startEdges.emplace_back(n, (float)dist);
+    }
+    if (_startEdges.empty())
+        return false;
+    // Link the portals of the end's cluster to the end
+    const size_t node_count = _nodes.size();
+    _goalCost.assign(node_count, -1.f);
+    bool has_goal_links = false;
+    FloodCluster(ex, ey);
+    for (int n : _clusterNodes[ClusterAt(ex, ey)])
+    {
+        const int dist = GetDistance(_nodes[n].X, _nodes[n].Y);
+        if (dist >= 0)
+        {
+            _goalCost[n] = (float)dist;
+            has_goal_links = true;
+        }
+    }
+    if (!has_goal_links)
+        return false;
+
+    // A* search over the graph; start and end are two extra nodes
+    const int start = (int)node_count, goal = (int)node_count + 1;
+    _cost.assign(node_count + 2, std::numeric_limits<float>::infinity());
+    _prev.assign(node_count + 2, -1);
+    _closed.assign(node_count + 2, 0);
+    auto heuristic = [this, sx, sy, ex, ey, start](int n)
+    {
+        const int x = (n < start) ? _nodes[n].X : sx;
+        const int y = (n < start) ? _nodes[n].Y : sy;
+        return sqrtf((float)((x - ex) * (x - ex) + (y - ey) * (y - ey)));
+    };
+    typedef std::pair<float, int> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+    _cost[start] = 0.f;
+    open.push(QueueEntry(heuristic(start), start));
+    while (!open.empty())
+    {
+        const int n = open.top().second;
+        open.pop();
+        if (n == goal)
+            break;
+        if (_closed[n])
+            continue;
+        _closed[n] = 1;
+
+        auto relax = [&](int to, float cost)
+        {
+            const float new_cost = _cost[n] + cost;
+            if (_closed[to] || new_cost >= _cost[to])
+                return;
+            _cost[to] = new_cost;
+            _prev[to] = n;
+            open.push(QueueEntry(new_cost + ((to == goal) ? 0.f : heuristic(to)), to));
+        };
+        const auto &edges = (n == start) ? _startEdges : _nodes[n].Edges;
+        for (const auto &e : edges)
+            relax(e.To, e.Cost);
+        if ((n != start) && (_goalCost[n] >= 0.f))
+            relax(goal, _goalCost[n]);
+    }
+    if (_prev[goal] < 0)
+        return false;
+
+    // Gather the waypoints, from the end to the start
+    waypoints.push_back((ey << 16) | ex);
+    for (int n = _prev[goal]; n != start; n = _prev[n])
+    {
+        const int sq = (_nodes[n].Y << 16) | _nodes[n].X;
+        if (waypoints.back() != sq)
+            waypoints.push_back(sq);
+    }
+    if (waypoints.back() != ((sy << 16) | sx))
+        waypoints.push_back((sy << 16) | sx);
+    std::reverse(waypoints.begin(), waypoints.end());
+    return true;
+}
+
+} // namespace RouteFinder
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,135 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Hierarchical navigation graph over the walkable mask.
+//
+// The mask is split into square clusters; each walkable passage between
+// two neighbouring clusters becomes a pair of graph nodes ("portals"), and
+// the portals within one cluster are connected by edges if one may walk
+// between them without leaving the cluster. The graph is built once per
+// mask, and lets find a coarse route over the whole room by searching
+// only few nodes; the actual path is then refined by the grid pathfinder
+// between the consecutive waypoints.
+//
+// Walkability is tested with 4-connectivity, matching the grid pathfinder
+// which does not allow to cut corners diagonally.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__ROUTEFINDERNAVGRAPH_H
+#define __AGS_EE_AC__ROUTEFINDERNAVGRAPH_H
+
+#include <vector>
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace RouteFinder
+{
+
+class NavGraph
+{
+public:
+    // Default size of a cluster side, in mask pixels
+    static const int DefaultClusterSize = 32;
+
+    NavGraph(int cluster_size = DefaultClusterSize);
+
+    // Assigns a new walkable mask, where non-zero pixels are walkable;
+    // the mask is copied, and the graph is built on the next query
+    void SetMask(int width, int height, const uint8_t *const *rows);
+    // Disposes the mask and the graph
+    void Clear();
+    // Tells whether the graph has a mask assigned
+    bool IsEmpty() const { return _width == 0 || _height == 0; }
+    int  GetWidth() const { return _width; }
+    int  GetHeight() const { return _height; }
+    // Builds the graph now, if it's not up to date
+    void Build();
+    // Gets the number of graph nodes, building the graph if necessary
+    size_t GetNodeCount();
+
+    // Finds a coarse route from start to end, fills the waypoints in
+    // mask coordinates, packed as (y << 16) | x, beginning with start and
+    // finishing with end. Returns false if the graph may not help here:
+    // when either point is not walkable, the end is not reachable, or
+    // both points lie within the same cluster and are connected there.
+    bool FindWaypoints(int sx, int sy, int ex, int ey, std::vector<int> &waypoints);
+
+private:
+    struct Edge
+    {
+        int   To;
+        float Cost;
+        Edge(int to, float cost) : To(to), Cost(cost) {}
+    };
+
+    struct Node
+    {
+        int X, Y;
+        std::vector<Edge> Edges;
+        Node(int x, int y) : X(x), Y(y) {}
+    };
+
+    inline bool Walkable(int x, int y) const
+    {
+        return (unsigned)x < (unsigned)_width && (unsigned)y < (unsigned)_height &&
+            _walkable[y * _width + x] != 0;
+    }
+    inline int ClusterAt(int x, int y) const
+    {
+        return (y / _clusterSize) * _clustersX + (x / _clusterSize);
+    }
+
+    // Gets or creates node at the given position
+    int  AddNode(int x, int y);
+    void AddEdge(int from, int to, float cost);
+    // Creates portals along the border between the two neighbouring clusters;
+    // (x, y) is the first cell of the border on the cluster's side,
+    // (dx, dy) is the direction along the border, (nx, ny) is the offset
+    // to the neighbour cluster.
+    void FindPortals(int x, int y, int len, int dx, int dy, int nx, int ny);
+    // Calculates walking distances from the given cell to all the cells
+    // of its cluster, using breadth-first search; fills _distances
+    void FloodCluster(int x, int y);
+    inline int GetDistance(int x, int y) const;
+
+    int _clusterSize;
+    int _width = 0;
+    int _height = 0;
+    int _clustersX = 0;
+    int _clustersY = 0;
+    std::vector<uint8_t> _walkable;
+    bool _built = false;
+
+    std::vector<Node> _nodes;
+    // Nodes belonging to each cluster
+    std::vector<std::vector<int>> _clusterNodes;
+    // Temporary buffers
+    std::vector<int> _distances; // BFS distances within a cluster
+    std::vector<int> _queue;
+    int _floodX0 = 0, _floodY0 = 0, _floodW = 0, _floodH = 0;
+    std::vector<Edge> _startEdges;
+    std::vector<float> _goalCost;
+    std::vector<float> _cost;
+    std::vector<int> _prev;
+    std::vector<uint8_t> _closed;
+};
+
+} // namespace RouteFinder
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_AC__ROUTEFINDERNAVGRAPH_H
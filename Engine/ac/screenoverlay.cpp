@@ -11,7 +11,9 @@
 // http://www.opensource.org/licenses/artistic-license-2.0.php
 //
 //=============================================================================
+#include <cassert>
 #include "ac/screenoverlay.h"
+#include "ac/display.h"
 #include "ac/spritecache.h"
 #include "gfx/bitmap.h"
 #include "util/stream.h"
@@ -20,6 +22,12 @@ using namespace AGS::Common;
 
 Bitmap *ScreenOverlay::GetImage() const
 {
+    // The plain text may be left undrawn until its image is actually needed
+    if (_textPending)
+    {
+        draw_text_layout(_pic.get(), *_text);
+        _textPending = false;
+    }
     return IsSpriteReference() ?
         spriteset[_sprnum] :
         _pic.get();
@@ -30,6 +38,8 @@ void ScreenOverlay::SetImage(std::unique_ptr<Common::Bitmap> pic, int offx, int
     _flags &= ~kOver_SpriteReference;
     _pic = std::move(pic);
     _sprnum = -1;
+    _text.reset();
+    _textPending = false;
     offsetX = offx;
     offsetY = offy;
     scaleWidth = scaleHeight = 0;
@@ -47,6 +57,8 @@ void ScreenOverlay::SetSpriteNum(int sprnum, int offx, int offy)
     _flags |= kOver_SpriteReference;
     _pic.reset();
     _sprnum = sprnum;
+    _text.reset();
+    _textPending = false;
     offsetX = offx;
     offsetY = offy;
     scaleWidth = scaleHeight = 0;
@@ -59,9 +71,19 @@ void ScreenOverlay::SetSpriteNum(int sprnum, int offx, int offy)
     MarkChanged();
 }
 
+void ScreenOverlay::SetTextLayout(std::shared_ptr<TextLayout> layout)
+{
+    assert(!IsSpriteReference() && _pic);
+    _text = layout;
+    _textPending = (layout != nullptr);
+    MarkChanged();
+}
+
 void ScreenOverlay::ReadFromFile(Stream *in, bool &has_bitmap, int32_t cmp_ver)
 {
     _pic.reset();
+    _text.reset();
+    _textPending = false;
     ddb = nullptr;
     in->ReadInt32(); // ddb 32-bit pointer value (nasty legacy format)
     int pic = in->ReadInt32();
@@ -27,6 +27,7 @@
 // Forward declaration
 namespace AGS { namespace Common { class Bitmap; class Stream; } }
 namespace AGS { namespace Engine { class IDriverDependantBitmap; }}
+struct TextLayout;
 using namespace AGS; // FIXME later
 
 enum OverlayFlags
@@ -41,6 +42,8 @@ struct ScreenOverlay
 {
     // Texture
     Engine::IDriverDependantBitmap *ddb = nullptr;
+    // Tells that the texture is a render target, with the text composed of glyphs
+    bool ddbIsTextTarget = false;
     int type = 0, timeout = 0;
     // Note that x,y are overlay's properties, that define its position in script;
     // but real drawn position is x + offsetX, y + offsetY;
@@ -71,6 +74,11 @@ struct ScreenOverlay
     int GetSpriteNum() const { return _sprnum; }
     void SetImage(std::unique_ptr<Common::Bitmap> pic, int offx = 0, int offy = 0);
     void SetSpriteNum(int sprnum, int offx = 0, int offy = 0);
+    // Gets the layout of a plain text, which the owned image consists of, if known
+    const TextLayout *GetTextLayout() const { return _text.get(); }
+    // Assigns the layout of a plain text to the owned image, which is not drawn
+    // on it yet; the text will be drawn when the image is requested
+    void SetTextLayout(std::shared_ptr<TextLayout> layout);
     // Tells if Overlay has graphically changed recently
     bool HasChanged() const { return _hasChanged; }
     // Manually marks GUI as graphically changed
@@ -85,6 +93,8 @@ private:
     int _flags = 0; // OverlayFlags
     std::unique_ptr<Common::Bitmap> _pic; // owned bitmap
     int _sprnum = -1; // sprite reference
+    std::shared_ptr<TextLayout> _text; // plain text layout
+    mutable bool _textPending = false; // text is not drawn on the image yet
 
     bool _hasChanged = false;
 };
@@ -12,6 +12,13 @@
 //
 //=============================================================================
 #include "ac/speech.h"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include "ac/asset_helper.h"
 #include "ac/common.h"
 #include "ac/runtime_defines.h"
@@ -21,7 +28,10 @@
 #include "core/assetmanager.h"
 #include "debug/debug_log.h"
 #include "main/engine.h"
+#include "util/file.h"
 #include "util/path.h"
+#include "util/string_compat.h"
+#include "util/stream.h"
 
 using namespace AGS::Common;
 
@@ -102,6 +112,9 @@ bool init_voicepak(const String &name)
     if (ResPaths.SpeechPak.Name.CompareNoCase(speech_file) == 0)
         return true; // same pak already assigned
 
+    // Prefetched and scheduled clips were found in the old pack
+    clear_voice_prefetch();
+
     // First remove existing voice packs
     play.voice_avail = false;
     AssetMgr->RemoveLibrary(ResPaths.SpeechPak.Path);
@@ -140,6 +153,7 @@ bool init_voicepak(const String &name)
     ResPaths.VoiceDirSub = speech_subdir;
     AssetMgr->AddLibrary(ResPaths.VoiceDirSub, "voice");
     AssetMgr->AddLibrary(ResPaths.SpeechPak.Path, "voice");
+    update_voice_prefetch_libs();
     return play.voice_avail;
 }
 
@@ -153,6 +167,259 @@ String get_voice_assetpath()
     return VoiceAssetPath;
 }
 
+//=============================================================================
+//
+// Voice-over prefetching
+//
+//=============================================================================
+
+// Max size of a voice-over clip which may be prefetched
+const size_t VoicePrefetchMaxSize = 4u * 1024 * 1024;
+
+// The prefetching thread must not share any String or asset manager data
+// with the game thread. Instead, whenever the voice-over libraries change,
+// the game thread makes a copy of their tables made of std::string, and
+// the clips are looked up in that copy on the prefetching thread.
+struct VoiceAssetLocation
+{
+    std::string FileName; // real file containing the asset
+    soff_t Offset = 0;
+    soff_t Size = 0;
+};
+
+struct VoiceLibIndex
+{
+    std::string Dir; // set for a directory, where the files are looked up on disk
+    std::unordered_map<std::string, VoiceAssetLocation> Assets; // by lowercase asset name
+};
+
+// Voice-over libraries, in the order in which they are searched
+typedef std::vector<VoiceLibIndex> VoiceAssetIndex;
+
+struct PrefetchedVoice
+{
+    std::string VoiceName; // bare clip name
+    std::string AssetName; // found asset name, with extension
+    std::shared_ptr<std::vector<uint8_t>> Data;
+};
+
+static struct
+{
+    int ClipsAhead = 0;
+    std::thread Thread;
+    std::mutex Mutex;
+    std::condition_variable CV;
+    std::condition_variable IdleCV;
+    bool Running = false;
+    bool Busy = false; // loading a clip right now
+    std::shared_ptr<const VoiceAssetIndex> Index; // where to look for the clips
+    std::deque<std::string> Queue; // names of the clips to load
+    std::deque<PrefetchedVoice> Ready; // loaded clips, oldest first
+    // Statistics
+    size_t Hits = 0u;
+    size_t Misses = 0u;
+} VoicePrefetch;
+
+static std::string to_lower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return (char)tolower(c); });
+    return str;
+}
+
+// Finds the asset in the voice-over libraries, the same way as the asset manager
+static bool find_voice_asset(const VoiceAssetIndex &index, const std::string &asset_name, VoiceAssetLocation &loc)
+{
+    const std::string key = to_lower(asset_name);
+    for (const auto &lib : index)
+    {
+        if (!lib.Dir.empty())
+        {
+            const String found_file = File::FindFileCI(lib.Dir.c_str(), asset_name.c_str());
+            if (found_file.IsEmpty())
+                continue;
+            loc.FileName = found_file.GetCStr();
+            loc.Offset = 0;
+            loc.Size = File::GetFileSize(found_file);
+            return true;
+        }
+        const auto found = lib.Assets.find(key);
+        if (found != lib.Assets.end())
+        {
+            loc = found->second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Finds the voice-over clip, testing the same file types as when playing it,
+// and reads its data; returns false if it was not found or is too large
+static bool load_voice_clip(const VoiceAssetIndex &index, const std::string &voice_name, PrefetchedVoice &voice)
+{
+    const char *exts[] = { "wav", "ogg", "mp3" };
+    for (const char *ext : exts)
+    {
+        const std::string asset_name = voice_name + "." + ext;
+        VoiceAssetLocation loc;
+        if (!find_voice_asset(index, asset_name, loc))
+            continue;
+        if (loc.Size <= 0 || static_cast<size_t>(loc.Size) > VoicePrefetchMaxSize)
+            return false;
+        std::unique_ptr<Stream> in(File::OpenFile(loc.FileName.c_str(), loc.Offset, loc.Offset + loc.Size));
+        if (!in)
+            return false;
+        auto data = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(loc.Size));
+        if (in->Read(data->data(), data->size()) != data->size())
+            return false;
+        voice.VoiceName = voice_name;
+        voice.AssetName = asset_name;
+        voice.Data = data;
+        return true;
+    }
+    return false;
+}
+
+static void voice_prefetch_thread()
+{
+    std::unique_lock<std::mutex> lk(VoicePrefetch.Mutex);
+    for (;;)
+    {
+        VoicePrefetch.CV.wait(lk, []() { return !VoicePrefetch.Running || !VoicePrefetch.Queue.empty(); });
+        if (!VoicePrefetch.Running)
+            return;
+        const std::string voice_name = std::move(VoicePrefetch.Queue.front());
+        VoicePrefetch.Queue.pop_front();
+        const auto index = VoicePrefetch.Index;
+        VoicePrefetch.Busy = true;
+        lk.unlock();
+
+        PrefetchedVoice voice;
+        const bool found = index && load_voice_clip(*index, voice_name, voice);
+
+        lk.lock();
+        VoicePrefetch.Busy = false;
+        if (found)
+        {
+            // Keep only a limited number of clips, dropping the oldest
+            VoicePrefetch.Ready.push_back(std::move(voice));
+            while (VoicePrefetch.Ready.size() > static_cast<size_t>(VoicePrefetch.ClipsAhead * 2))
+                VoicePrefetch.Ready.pop_front();
+        }
+        VoicePrefetch.IdleCV.notify_all();
+    }
+}
+
+void set_voice_prefetch(int clips_ahead)
+{
+#if defined(AGS_DISABLE_THREADS)
+    clips_ahead = 0;
+#endif
+    clear_voice_prefetch();
+    VoicePrefetch.ClipsAhead = std::max(0, clips_ahead);
+    update_voice_prefetch_libs();
+}
+
+int get_voice_prefetch()
+{
+    return VoicePrefetch.ClipsAhead;
+}
+
+void update_voice_prefetch_libs()
+{
+    std::shared_ptr<VoiceAssetIndex> index;
+    if (VoicePrefetch.ClipsAhead > 0)
+    {
+        std::vector<AssetLibLocations> libs;
+        AssetMgr->GetLibraryLocations(libs, "voice");
+        index = std::make_shared<VoiceAssetIndex>(libs.size());
+        for (size_t i = 0; i < libs.size(); ++i)
+        {
+            auto &lib_index = (*index)[i];
+            lib_index.Dir = libs[i].BaseDir.GetCStr();
+            for (const auto &asset : libs[i].Assets)
+            {
+                VoiceAssetLocation loc;
+                loc.FileName = asset.second.FileName.GetCStr();
+                loc.Offset = asset.second.Offset;
+                loc.Size = asset.second.Size;
+                // the first one is found by the asset manager, if names repeat
+                lib_index.Assets.emplace(to_lower(asset.first.GetCStr()), loc);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lk(VoicePrefetch.Mutex);
+    VoicePrefetch.Index = index;
+}
+
+void prefetch_voice_clip(const String &voice_name)
+{
+    if (VoicePrefetch.ClipsAhead <= 0)
+        return;
+    std::lock_guard<std::mutex> lk(VoicePrefetch.Mutex);
+    // Skip if the clip is already loaded or scheduled
+    for (const auto &voice : VoicePrefetch.Ready)
+        if (ags_stricmp(voice.VoiceName.c_str(), voice_name.GetCStr()) == 0)
+            return;
+    for (const auto &name : VoicePrefetch.Queue)
+        if (ags_stricmp(name.c_str(), voice_name.GetCStr()) == 0)
+            return;
+    // The clip is looked up on the prefetching thread
+    VoicePrefetch.Queue.push_back(voice_name.GetCStr());
+    if (!VoicePrefetch.Running)
+    {
+        VoicePrefetch.Running = true;
+        VoicePrefetch.Thread = std::thread(voice_prefetch_thread);
+    }
+    VoicePrefetch.CV.notify_one();
+}
+
+bool take_prefetched_voice(const String &voice_name, String &asset_name,
+    std::shared_ptr<std::vector<uint8_t>> &data)
+{
+    if (VoicePrefetch.ClipsAhead <= 0)
+        return false;
+    std::lock_guard<std::mutex> lk(VoicePrefetch.Mutex);
+    for (auto it = VoicePrefetch.Ready.begin(); it != VoicePrefetch.Ready.end(); ++it)
+    {
+        if (ags_stricmp(it->VoiceName.c_str(), voice_name.GetCStr()) != 0)
+            continue;
+        asset_name = it->AssetName.c_str();
+        data = it->Data;
+        VoicePrefetch.Ready.erase(it);
+        VoicePrefetch.Hits++;
+        return true;
+    }
+    VoicePrefetch.Misses++;
+    return false;
+}
+
+void clear_voice_prefetch()
+{
+    std::unique_lock<std::mutex> lk(VoicePrefetch.Mutex);
+    VoicePrefetch.Queue.clear();
+    // Wait for the clip being loaded, as it may be reading a library file
+    VoicePrefetch.IdleCV.wait(lk, []() { return !VoicePrefetch.Busy; });
+    VoicePrefetch.Ready.clear();
+}
+
+void shutdown_voice_prefetch()
+{
+    {
+        std::lock_guard<std::mutex> lk(VoicePrefetch.Mutex);
+        VoicePrefetch.ClipsAhead = 0;
+        VoicePrefetch.Running = false;
+        VoicePrefetch.Queue.clear();
+        VoicePrefetch.Ready.clear();
+        VoicePrefetch.Index = nullptr;
+    }
+    VoicePrefetch.CV.notify_all();
+    if (VoicePrefetch.Thread.joinable())
+        VoicePrefetch.Thread.join();
+    if (VoicePrefetch.Hits + VoicePrefetch.Misses > 0)
+        Debug::Printf(kDbgMsg_Debug, "Voice prefetch: %zu hits, %zu misses",
+            VoicePrefetch.Hits, VoicePrefetch.Misses);
+}
+
 //=============================================================================
 //
 // Script API Functions
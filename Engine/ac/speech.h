@@ -14,6 +14,8 @@
 #ifndef __AGS_EE_AC__SPEECH_H
 #define __AGS_EE_AC__SPEECH_H
 
+#include <memory>
+#include <vector>
 #include "util/string.h"
 
 enum SkipSpeechStyle
@@ -51,4 +53,26 @@ AGS::Common::String get_voicepak_name();
 // Gets an asset's parent path for voice-over clips and data files
 AGS::Common::String get_voice_assetpath();
 
+// Voice-over prefetching: loads the clips which are likely to be played next
+// into memory on a background thread.
+//
+// Sets how many following voice-over clips to load whenever a voice line
+// is played; 0 disables prefetching.
+void set_voice_prefetch(int clips_ahead);
+int  get_voice_prefetch();
+// Passes the current voice-over libraries to the prefetching thread;
+// must be called whenever the voice-over libraries change
+void update_voice_prefetch_libs();
+// Schedules loading of the voice-over clip; voice_name is a bare
+// clip name without extension
+void prefetch_voice_clip(const AGS::Common::String &voice_name);
+// Takes the prefetched voice-over clip out of the prefetcher; on success
+// fills the asset's name (with extension) and its data
+bool take_prefetched_voice(const AGS::Common::String &voice_name,
+    AGS::Common::String &asset_name, std::shared_ptr<std::vector<uint8_t>> &data);
+// Cancels pending loading, disposes all prefetched clips
+void clear_voice_prefetch();
+// Stops the prefetching thread
+void shutdown_voice_prefetch();
+
 #endif // __AGS_EE_AC__SPEECH_H
@@ -15,11 +15,13 @@
 #include "ac/common.h"
 #include "ac/object.h"
 #include "ac/character.h"
+#include "ac/gamesetup.h"
 #include "ac/gamestate.h"
 #include "ac/gamesetupstruct.h"
 #include "ac/object.h"
 #include "ac/room.h"
 #include "ac/roomobject.h"
+#include "ac/route_finder.h"
 #include "ac/roomstatus.h"
 #include "ac/walkablearea.h"
 #include "game/roomstruct.h"
@@ -35,6 +37,9 @@ extern RoomStatus*croom;
 extern RoomObject*objs;
 
 Bitmap *walkareabackup=nullptr, *walkable_areas_temp = nullptr;
+// Version of the room's walkable areas, changed whenever they are modified;
+// together with the blocking areas it identifies the pathfinder's walls mask
+static uint64_t walkable_areas_version;
 
 void redo_walkable_areas()
 {
@@ -49,6 +54,15 @@ void redo_walkable_areas()
                 walls_scanline[w] = 0;
         }
     }
+    mark_walkable_areas_changed();
+}
+
+void mark_walkable_areas_changed(bool update_navgraph)
+{
+    walkable_areas_version++;
+    // Let pathfinder update its navigation graph
+    if (update_navgraph && usetup.NavGraph)
+        set_navgraph_mask(thisroom.WalkAreaMask.get());
 }
 
 int get_walkable_area_pixel(int x, int y)
@@ -133,13 +147,28 @@ int is_point_in_rect(int x, int y, int left, int top, int right, int bottom) {
     return 0;
 }
 
+// Adds the blocking area to the walls mask version
+static uint64_t add_blocking_area_to_version(uint64_t version, int fromx, int cwidth, int starty, int endy)
+{
+    const uint64_t area = ((uint64_t)(uint16_t)fromx << 48) | ((uint64_t)(uint16_t)cwidth << 32) |
+        ((uint64_t)(uint16_t)starty << 16) | (uint64_t)(uint16_t)endy;
+    version = (version ^ area) * 0x100000001B3ull;
+    return version ^ (version >> 29);
+}
+
 Bitmap *prepare_walkable_areas (int sourceChar) {
     // copy the walkable areas to the temp bitmap
     walkable_areas_temp->Blit(thisroom.WalkAreaMask.get(), 0,0,0,0,thisroom.WalkAreaMask->GetWidth(),thisroom.WalkAreaMask->GetHeight());
+    // the temp mask's version is made of the walkable areas version and the blocking
+    // areas removed from it, which lets pathfinder reuse routes without checking the mask
+    uint64_t version = walkable_areas_version;
     // if the character who's moving doesn't block, don't bother checking
     if (sourceChar < 0) ;
     else if (game.chars[sourceChar].flags & CHF_NOBLOCKING)
+    {
+        set_wallscreen_version(version);
         return walkable_areas_temp;
+    }
 
     // for each character in the current room, make the area under them unwalkable
     for (int ww = 0; ww < game.numcharacters; ww++) {
@@ -160,6 +189,7 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
             continue;
 
         remove_walkable_areas_from_temp(fromx, cwidth, char1->get_blocking_top(), char1->get_blocking_bottom());
+        version = add_blocking_area_to_version(version, fromx, cwidth, char1->get_blocking_top(), char1->get_blocking_bottom());
     }
 
     // check for any blocking objects in the room, and deal with them as well
@@ -182,8 +212,10 @@ Bitmap *prepare_walkable_areas (int sourceChar) {
             continue;
 
         remove_walkable_areas_from_temp(x1, width, y1, y2);
+        version = add_blocking_area_to_version(version, x1, width, y1, y2);
     }
 
+    set_wallscreen_version(version);
     return walkable_areas_temp;
 }
 
@@ -19,6 +19,9 @@
 #define __AGS_EE_AC__WALKABLEAREA_H
 
 void  redo_walkable_areas();
+// Notifies that the room's walkable areas have changed, updating
+// the pathfinder's data; call this after modifying the mask directly
+void  mark_walkable_areas_changed(bool update_navgraph = true);
 int   get_walkable_area_pixel(int x, int y);
 int   get_area_scaling (int onarea, int xx, int yy);
 void  scale_sprite_size(int sppic, int zoom_level, int *newwidth, int *newheight);
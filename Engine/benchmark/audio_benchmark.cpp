@@ -0,0 +1,243 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Audio stress benchmark: plays a number of simultaneous looping sounds
+// through the engine's audio core, while querying their state each frame,
+// same as the game does, and reports playback underruns and the time
+// spent by the "game thread" in the audio calls.
+//
+// Sounds are loaded from the given files (ogg, mp3, wav, etc), or
+// generated if no files are given; each stream is given the next file
+// from the list in turn.
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "media/audio/audio_core.h"
+#include "platform/base/sys_main.h"
+#include "util/path.h"
+#include "util/string_compat.h"
+
+using namespace AGS::Common;
+
+const char *HELP_STRING = "Usage: audio_benchmark [options] [<sound file> ...]\n"
+    "Options:\n"
+    "  --driver <name>     SDL audio driver to use (default: system default)\n"
+    "  --seconds <N>       duration of the test, in seconds (default: 10)\n"
+    "  --streams <N>       number of simultaneously playing sounds (default: 8)\n"
+    "  --threads <N>       number of decoder threads (default: 0)\n";
+
+struct SoundData
+{
+    String Ext;
+    std::shared_ptr<std::vector<uint8_t>> Data;
+};
+
+static void WriteLE(std::vector<uint8_t> &buf, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i)
+        buf.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// Generates a 16-bit stereo wave with a sine tone
+static SoundData GenerateWave(float freq, float duration_s)
+{
+    const double pi = 3.14159265358979323846;
+    const uint32_t rate = 44100, channels = 2;
+    const uint32_t samples = static_cast<uint32_t>(rate * duration_s);
+    const uint32_t data_size = samples * channels * 2;
+    auto buf = std::make_shared<std::vector<uint8_t>>();
+    buf->reserve(44 + data_size);
+    buf->insert(buf->end(), { 'R', 'I', 'F', 'F' });
+    WriteLE(*buf, 36 + data_size, 4);
+    buf->insert(buf->end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+    WriteLE(*buf, 16, 4); // fmt chunk size
+    WriteLE(*buf, 1, 2); // PCM
+    WriteLE(*buf, channels, 2);
+    WriteLE(*buf, rate, 4);
+    WriteLE(*buf, rate * channels * 2, 4); // byte rate
+    WriteLE(*buf, channels * 2, 2); // block align
+    WriteLE(*buf, 16, 2); // bits per sample
+    buf->insert(buf->end(), { 'd', 'a', 't', 'a' });
+    WriteLE(*buf, data_size, 4);
+    for (uint32_t i = 0; i < samples; ++i)
+    {
+        const int16_t value = static_cast<int16_t>(8000.0 * sin(2.0 * pi * freq * i / rate));
+        for (uint32_t c = 0; c < channels; ++c)
+            WriteLE(*buf, static_cast<uint16_t>(value), 2);
+    }
+    SoundData sound;
+    sound.Ext = "wav";
+    sound.Data = buf;
+    return sound;
+}
+
+static bool LoadSound(const char *filename, SoundData &sound)
+{
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    fseek(f, 0, SEEK_END);
+    const long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    auto buf = std::make_shared<std::vector<uint8_t>>(size > 0 ? size : 0);
+    const bool res = (size > 0) && (fread(buf->data(), 1, size, f) == (size_t)size);
+    fclose(f);
+    sound.Ext = Path::GetFileExtension(filename);
+    sound.Data = buf;
+    return res;
+}
+
+int main(int argc, char *argv[])
+{
+    printf("audio_benchmark v0.1.0 - AGS audio core stress benchmark\n");
+
+    std::vector<const char *> files;
+    String driver;
+    int seconds = 10;
+    int stream_count = 8;
+    int threads = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (ags_stricmp(arg, "--help") == 0 || ags_stricmp(arg, "/?") == 0 || ags_stricmp(arg, "-?") == 0)
+        {
+            printf("%s\n", HELP_STRING);
+            return 0; // display help and bail out
+        }
+        else if (ags_stricmp(arg, "--driver") == 0 && has_value)
+        {
+            driver = argv[++i];
+        }
+        else if (ags_stricmp(arg, "--seconds") == 0 && has_value)
+        {
+            seconds = std::max(1, atoi(argv[++i]));
+        }
+        else if (ags_stricmp(arg, "--streams") == 0 && has_value)
+        {
+            stream_count = std::max(1, atoi(argv[++i]));
+        }
+        else if (ags_stricmp(arg, "--threads") == 0 && has_value)
+        {
+            threads = std::max(0, atoi(argv[++i]));
+        }
+        else if (arg[0] == '-')
+        {
+            printf("Error: unknown or incomplete option '%s'\n", arg);
+            printf("%s\n", HELP_STRING);
+            return -1;
+        }
+        else
+        {
+            files.push_back(arg);
+        }
+    }
+
+    std::vector<SoundData> sounds;
+    for (const char *file : files)
+    {
+        SoundData sound;
+        if (!LoadSound(file, sound))
+        {
+            printf("Error: failed to read '%s'\n", file);
+            return -1;
+        }
+        sounds.push_back(sound);
+    }
+    if (sounds.empty())
+    {
+        for (int i = 0; i < 4; ++i)
+            sounds.push_back(GenerateWave(220.f * (i + 1), 3.f));
+    }
+
+    if (!sys_audio_init(driver))
+    {
+        printf("Error: failed to initialize audio driver\n");
+        return -1;
+    }
+    try {
+        audio_core_init(threads);
+    } catch (const std::exception &e) {
+        printf("Error: failed to initialize audio core: %s\n", e.what());
+        sys_audio_shutdown();
+        return -1;
+    }
+
+    printf("Playing %d stream(s) of %zu sound(s) for %d second(s), with %d decoder thread(s)\n",
+        stream_count, sounds.size(), seconds, threads);
+    std::vector<int> slots;
+    for (int i = 0; i < stream_count; ++i)
+    {
+        auto &sound = sounds[i % sounds.size()];
+        const int slot = audio_core_slot_init(sound.Data, sound.Ext, true);
+        if (slot < 0)
+        {
+            printf("Error: failed to open sound %d (%s)\n", i, sound.Ext.GetCStr());
+            continue;
+        }
+        audio_core_slot_configure(slot, 1.f / stream_count, 1.f, 0.f);
+        audio_core_slot_play(slot);
+        slots.push_back(slot);
+    }
+
+    // Simulate game frames, querying each slot, like the engine does
+    typedef std::chrono::steady_clock Clock;
+    const auto frame_time = std::chrono::microseconds(1000000 / 40);
+    const auto start = Clock::now();
+    const auto end = start + std::chrono::seconds(seconds);
+    size_t frames = 0, not_playing = 0;
+    double query_total_us = 0.0, query_max_us = 0.0;
+    for (auto frame_start = start; frame_start < end; frame_start += frame_time)
+    {
+        const auto t0 = Clock::now();
+        for (int slot : slots)
+        {
+            float pos_ms;
+            const PlaybackState state = audio_core_slot_get_play_state(slot, pos_ms);
+            if (state == PlayStateInitial)
+                audio_core_slot_play(slot);
+            else if (state != PlayStatePlaying)
+                not_playing++;
+        }
+        const double query_us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        query_total_us += query_us;
+        query_max_us = std::max(query_max_us, query_us);
+        frames++;
+        std::this_thread::sleep_until(frame_start + frame_time);
+    }
+
+    for (int slot : slots)
+        audio_core_slot_stop(slot);
+    const unsigned underruns = audio_core_get_underruns();
+    audio_core_shutdown();
+    sys_audio_shutdown();
+
+    printf("\n");
+    printf("Streams:             %zu\n", slots.size());
+    printf("Frames:              %zu\n", frames);
+    printf("Underruns:           %u (%.2f per stream-minute)\n", underruns,
+        slots.empty() ? 0.0 : underruns * 60.0 / (slots.size() * seconds));
+    printf("Stopped streams:     %zu slot-frames\n", not_playing);
+    printf("Query time (frame):  mean %.1f us, max %.1f us\n",
+        frames > 0 ? query_total_us / frames : 0.0, query_max_us);
+    return 0;
+}
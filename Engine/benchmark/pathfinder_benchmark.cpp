@@ -0,0 +1,471 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Pathfinder benchmark: runs route queries with the engine's pathfinders
+// over the walkable masks loaded from the compiled room files, or over
+// generated mazes, and reports the search time, number of the expanded
+// search nodes and the quality of the found paths.
+//
+// Random queries may be saved to a file, and replayed later, to compare
+// the changes to a pathfinder on exactly the same data.
+//
+//=============================================================================
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <memory>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "ac/movelist.h"
+#include "ac/route_finder.h"
+#include "game/room_file.h"
+#include "game/roomstruct.h"
+#include "gfx/bitmap.h"
+#include "util/string_compat.h"
+
+using namespace AGS::Common;
+
+extern std::vector<MoveList> mls;
+
+const char *HELP_STRING = "Usage: pathfinder_benchmark [options] [<room.crm> ...]\n"
+    "Options:\n"
+    "  --count <N>         number of random queries per mask (default: 1000)\n"
+    "  --finders <list>    comma-separated pathfinders to test: jps, navgraph, legacy\n"
+    "                      (default: all)\n"
+    "  --maze <W>x<H>      add generated maze of the given size; used when no rooms\n"
+    "                      are given (default: 640x400)\n"
+    "  --queries <file>    replay queries from the file instead of random ones\n"
+    "  --record <file>     save the random queries to the file\n"
+    "  --seed <N>          random seed (default: 1)\n"
+    "\n"
+    "Query file contains one query per line, as \"srcx srcy dstx dsty\" in mask\n"
+    "coordinates. A line \"[name]\" starts the queries for the mask of this name\n"
+    "(room file name, or \"maze WxH\"); queries before any such line are used\n"
+    "for all masks. Lines beginning with '#' are ignored.\n";
+
+struct RouteQuery
+{
+    int SrcX, SrcY, DstX, DstY;
+};
+
+struct TestMask
+{
+    String Name;
+    std::shared_ptr<Bitmap> Mask;
+    std::vector<RouteQuery> Queries;
+};
+
+struct FinderResults
+{
+    std::vector<double> Times; // in microseconds
+    size_t Skipped = 0; // queries out of mask bounds
+    size_t Found = 0; // routes found
+    size_t Exact = 0; // routes which end at the destination
+    size_t Nodes = 0; // expanded search nodes
+    size_t Stages = 0; // route stages
+    double Length = 0.0; // total length of the routes
+    double Straight = 0.0; // total distance between routes' ends
+};
+
+enum FinderType
+{
+    kFinder_JPS,
+    kFinder_NavGraph,
+    kFinder_Legacy,
+    kNumFinders
+};
+
+static const char *FinderNames[kNumFinders] = { "jps", "navgraph", "legacy" };
+
+
+static bool LoadRoomMask(const char *filename, TestMask &mask)
+{
+    RoomDataSource src;
+    RoomStruct room;
+    HRoomFileError err = OpenRoomFile(filename, src);
+    if (err)
+        err = ReadRoomData(&room, src.InputStream.get(), src.DataVersion);
+    if (!err)
+    {
+        printf("Error: failed to load room '%s':\n%s\n", filename, err->FullMessage().GetCStr());
+        return false;
+    }
+    if (!room.WalkAreaMask)
+    {
+        printf("Error: room '%s' has no walkable area mask\n", filename);
+        return false;
+    }
+    mask.Name = filename;
+    mask.Mask = room.WalkAreaMask;
+    return true;
+}
+
+// Generates a maze with some loops in it, made of the square cells
+// separated by thin walls
+static std::shared_ptr<Bitmap> GenerateMaze(int width, int height, std::mt19937 &rng)
+{
+    const int cell = 20, wall = 2;
+    std::shared_ptr<Bitmap> maze(BitmapHelper::CreateBitmap(width, height, 8));
+    maze->Clear(0);
+    const int cols = std::max(1, width / cell), rows = std::max(1, height / cell);
+    auto cell_rect = [cell, wall](int cx, int cy)
+        { return Rect(cx * cell + wall, cy * cell + wall, (cx + 1) * cell - wall - 1, (cy + 1) * cell - wall - 1); };
+    auto carve = [&](int cx1, int cy1, int cx2, int cy2)
+    {
+        Rect r1 = cell_rect(cx1, cy1), r2 = cell_rect(cx2, cy2);
+        maze->FillRect(Rect(std::min(r1.Left, r2.Left), std::min(r1.Top, r2.Top),
+            std::max(r1.Right, r2.Right), std::max(r1.Bottom, r2.Bottom)), 1);
+    };
+
+    // Recursive backtracker, made iterative
+    std::vector<uint8_t> visited(cols * rows, 0);
+    std::vector<int> stack;
+    stack.push_back(0);
+    visited[0] = 1;
+    maze->FillRect(cell_rect(0, 0), 1);
+    while (!stack.empty())
+    {
+        const int cx = stack.back() % cols, cy = stack.back() / cols;
+        int next[4], count = 0;
+        if (cx > 0 && !visited[cy * cols + cx - 1]) next[count++] = cy * cols + cx - 1;
+        if (cx + 1 < cols && !visited[cy * cols + cx + 1]) next[count++] = cy * cols + cx + 1;
+        if (cy > 0 && !visited[(cy - 1) * cols + cx]) next[count++] = (cy - 1) * cols + cx;
+        if (cy + 1 < rows && !visited[(cy + 1) * cols + cx]) next[count++] = (cy + 1) * cols + cx;
+        if (count == 0)
+        {
+            stack.pop_back();
+            continue;
+        }
+        const int n = next[rng() % count];
+        carve(cx, cy, n % cols, n / cols);
+        visited[n] = 1;
+        stack.push_back(n);
+    }
+    // Open some extra passages, so that there's more than one way
+    for (int i = 0; i < cols * rows / 8; ++i)
+    {
+        const int cx = rng() % cols, cy = rng() % rows;
+        if (rng() % 2)
+        {
+            if (cx + 1 < cols)
+                carve(cx, cy, cx + 1, cy);
+        }
+        else if (cy + 1 < rows)
+        {
+            carve(cx, cy, cx, cy + 1);
+        }
+    }
+    return maze;
+}
+
+static bool IsWalkable(Bitmap *mask, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < mask->GetWidth() && y < mask->GetHeight() &&
+        mask->GetScanLine(y)[x] != 0;
+}
+
+static void GenerateQueries(TestMask &mask, size_t count, std::mt19937 &rng)
+{
+    Bitmap *bmp = mask.Mask.get();
+    const int max_attempts = 1000;
+    for (size_t i = 0; i < count; ++i)
+    {
+        RouteQuery q;
+        int attempts = 0;
+        do
+        {
+            q.SrcX = rng() % bmp->GetWidth();
+            q.SrcY = rng() % bmp->GetHeight();
+            q.DstX = rng() % bmp->GetWidth();
+            q.DstY = rng() % bmp->GetHeight();
+        } while ((!IsWalkable(bmp, q.SrcX, q.SrcY) || !IsWalkable(bmp, q.DstX, q.DstY)) &&
+            (++attempts < max_attempts));
+        if (attempts == max_attempts)
+            break; // hardly anything walkable here
+        mask.Queries.push_back(q);
+    }
+}
+
+static bool LoadQueries(const char *filename, std::vector<TestMask> &masks)
+{
+    FILE *f = fopen(filename, "r");
+    if (!f)
+    {
+        printf("Error: failed to open queries file '%s'\n", filename);
+        return false;
+    }
+    char line[1024];
+    TestMask *section = nullptr;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#')
+            continue;
+        if (line[0] == '[')
+        {
+            char *end = strchr(line, ']');
+            if (end)
+                *end = 0;
+            section = nullptr;
+            for (auto &mask : masks)
+                if (mask.Name.Compare(line + 1) == 0)
+                    section = &mask;
+            if (!section)
+                printf("Warning: no mask called '%s', skipping its queries\n", line + 1);
+            continue;
+        }
+        RouteQuery q;
+        if (sscanf(line, "%d %d %d %d", &q.SrcX, &q.SrcY, &q.DstX, &q.DstY) != 4)
+            continue;
+        if (section)
+        {
+            section->Queries.push_back(q);
+        }
+        else
+        {
+            for (auto &mask : masks)
+                mask.Queries.push_back(q);
+        }
+    }
+    fclose(f);
+    return true;
+}
+
+static bool SaveQueries(const char *filename, const std::vector<TestMask> &masks)
+{
+    FILE *f = fopen(filename, "w");
+    if (!f)
+    {
+        printf("Error: failed to create queries file '%s'\n", filename);
+        return false;
+    }
+    fprintf(f, "# pathfinder_benchmark queries: srcx srcy dstx dsty\n");
+    for (const auto &mask : masks)
+    {
+        fprintf(f, "[%s]\n", mask.Name.GetCStr());
+        for (const auto &q : mask.Queries)
+            fprintf(f, "%d %d %d %d\n", q.SrcX, q.SrcY, q.DstX, q.DstY);
+    }
+    fclose(f);
+    return true;
+}
+
+static void RunQueries(const TestMask &mask, FinderResults &res)
+{
+    Bitmap *bmp = mask.Mask.get();
+    const int movlst = 1;
+    get_route_search_nodes(true);
+    for (const auto &q : mask.Queries)
+    {
+        if (q.SrcX < 0 || q.SrcY < 0 || q.SrcX >= bmp->GetWidth() || q.SrcY >= bmp->GetHeight() ||
+            q.DstX < 0 || q.DstY < 0 || q.DstX >= bmp->GetWidth() || q.DstY >= bmp->GetHeight())
+        {
+            res.Skipped++;
+            continue;
+        }
+
+        // Search same way as for the walking characters
+        const auto t0 = std::chrono::steady_clock::now();
+        const int result = find_route(q.SrcX, q.SrcY, q.DstX, q.DstY, bmp, movlst, 1, 0);
+        const auto t1 = std::chrono::steady_clock::now();
+        res.Times.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        res.Nodes += get_route_search_nodes(true);
+        if (result <= 0)
+            continue;
+
+        const MoveList &ml = mls[movlst];
+        res.Found++;
+        res.Stages += ml.numstage;
+        for (int i = 1; i < ml.numstage; ++i)
+        {
+            const int dx = ((ml.pos[i] >> 16) & 0xFFFF) - ((ml.pos[i - 1] >> 16) & 0xFFFF);
+            const int dy = (ml.pos[i] & 0xFFFF) - (ml.pos[i - 1] & 0xFFFF);
+            res.Length += sqrt((double)(dx * dx + dy * dy));
+        }
+        const int endx = (ml.pos[ml.numstage - 1] >> 16) & 0xFFFF;
+        const int endy = ml.pos[ml.numstage - 1] & 0xFFFF;
+        res.Straight += sqrt((double)((endx - q.SrcX) * (endx - q.SrcX) + (endy - q.SrcY) * (endy - q.SrcY)));
+        if (endx == q.DstX && endy == q.DstY)
+            res.Exact++;
+    }
+}
+
+static double Percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+static void PrintResults(const char *finder, FinderResults &res)
+{
+    std::vector<double> &t = res.Times;
+    std::sort(t.begin(), t.end());
+    double total = 0.0;
+    for (double v : t)
+        total += v;
+    const size_t num = t.size();
+    printf("  %-10s %6zu %6zu %6zu %9.1f %9.1f %9.1f %9.1f %9.1f %10.1f %6.2f %7.3f\n",
+        finder, num, res.Found, res.Exact,
+        num ? total / num : 0.0, Percentile(t, 0.5), Percentile(t, 0.9), Percentile(t, 0.99), num ? t.back() : 0.0,
+        num ? (double)res.Nodes / num : 0.0,
+        res.Found ? (double)res.Stages / res.Found : 0.0,
+        res.Straight > 0.0 ? res.Length / res.Straight : 0.0);
+    if (res.Skipped)
+        printf("  %-10s %zu queries were out of mask bounds\n", "", res.Skipped);
+}
+
+static bool ParseMazeSize(const char *arg, int &width, int &height)
+{
+    return (sscanf(arg, "%dx%d", &width, &height) == 2) && (width > 0) && (height > 0);
+}
+
+int main(int argc, char *argv[])
+{
+    printf("pathfinder_benchmark v0.1.0 - AGS pathfinder benchmark\n");
+
+    std::vector<const char *> rooms;
+    std::vector<std::pair<int, int>> mazes;
+    const char *queries_file = nullptr;
+    const char *record_file = nullptr;
+    size_t query_count = 1000;
+    unsigned seed = 1;
+    bool finders[kNumFinders] = { true, true, true };
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (ags_stricmp(arg, "--help") == 0 || ags_stricmp(arg, "/?") == 0 || ags_stricmp(arg, "-?") == 0)
+        {
+            printf("%s\n", HELP_STRING);
+            return 0; // display help and bail out
+        }
+        else if (ags_stricmp(arg, "--count") == 0 && has_value)
+        {
+            query_count = (size_t)std::max(0, atoi(argv[++i]));
+        }
+        else if (ags_stricmp(arg, "--finders") == 0 && has_value)
+        {
+            const String list = argv[++i];
+            for (int f = 0; f < kNumFinders; ++f)
+                finders[f] = false;
+            for (const auto &name : list.Split(','))
+            {
+                int f = 0;
+                for (; f < kNumFinders && name.CompareNoCase(FinderNames[f]) != 0; ++f);
+                if (f == kNumFinders)
+                {
+                    printf("Error: unknown pathfinder '%s'\n", name.GetCStr());
+                    return -1;
+                }
+                finders[f] = true;
+            }
+        }
+        else if (ags_stricmp(arg, "--maze") == 0 && has_value)
+        {
+            int width, height;
+            if (!ParseMazeSize(argv[++i], width, height))
+            {
+                printf("Error: invalid maze size '%s'\n", argv[i]);
+                return -1;
+            }
+            mazes.push_back(std::make_pair(width, height));
+        }
+        else if (ags_stricmp(arg, "--queries") == 0 && has_value)
+        {
+            queries_file = argv[++i];
+        }
+        else if (ags_stricmp(arg, "--record") == 0 && has_value)
+        {
+            record_file = argv[++i];
+        }
+        else if (ags_stricmp(arg, "--seed") == 0 && has_value)
+        {
+            seed = (unsigned)atoi(argv[++i]);
+        }
+        else if (arg[0] == '-')
+        {
+            printf("Error: unknown or incomplete option '%s'\n", arg);
+            printf("%s\n", HELP_STRING);
+            return -1;
+        }
+        else
+        {
+            rooms.push_back(arg);
+        }
+    }
+    if (rooms.empty() && mazes.empty())
+        mazes.push_back(std::make_pair(640, 400));
+
+    // Prepare masks and queries
+    std::mt19937 rng(seed);
+    std::vector<TestMask> masks;
+    for (const char *room : rooms)
+    {
+        TestMask mask;
+        if (!LoadRoomMask(room, mask))
+            return -1;
+        masks.push_back(mask);
+    }
+    for (const auto &size : mazes)
+    {
+        TestMask mask;
+        mask.Name = String::FromFormat("maze %dx%d", size.first, size.second);
+        mask.Mask = GenerateMaze(size.first, size.second, rng);
+        masks.push_back(mask);
+    }
+
+    if (queries_file)
+    {
+        if (!LoadQueries(queries_file, masks))
+            return -1;
+    }
+    else
+    {
+        for (auto &mask : masks)
+            GenerateQueries(mask, query_count, rng);
+    }
+    if (record_file && !SaveQueries(record_file, masks))
+        return -1;
+
+    // Run the pathfinders over each mask in turn
+    mls.resize(2);
+    for (const auto &mask : masks)
+    {
+        printf("\n%s (%dx%d), %zu queries\n", mask.Name.GetCStr(),
+            mask.Mask->GetWidth(), mask.Mask->GetHeight(), mask.Queries.size());
+        printf("  %-10s %6s %6s %6s %9s %9s %9s %9s %9s %10s %6s %7s\n",
+            "finder", "total", "found", "exact", "mean(us)", "p50(us)", "p90(us)", "p99(us)", "max(us)",
+            "nodes/q", "stages", "detour");
+        for (int f = 0; f < kNumFinders; ++f)
+        {
+            if (!finders[f])
+                continue;
+            init_pathfinder(f == kFinder_Legacy ? kGameVersion_341_2 : kGameVersion_Current);
+            set_route_move_speed(1, 1);
+            if (f == kFinder_NavGraph)
+                set_navgraph_mask(mask.Mask.get());
+            FinderResults res;
+            RunQueries(mask, res);
+            if (f == kFinder_NavGraph)
+                set_navgraph_mask(nullptr);
+            shutdown_pathfinder();
+            PrintResults(FinderNames[f], res);
+        }
+    }
+    return 0;
+}
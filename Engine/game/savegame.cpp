@@ -22,6 +22,7 @@
 #include "ac/gamesetup.h"
 #include "ac/global_audio.h"
 #include "ac/global_character.h"
+#include "ac/glyph_atlas.h"
 #include "ac/gui.h"
 #include "ac/mouse.h"
 #include "ac/overlay.h"
@@ -666,6 +667,7 @@ HSaveError DoAfterRestore(const PreservedParams &pp, const RestoredData &r_data)
     update_directional_sound_vol();
 
     adjust_fonts_for_render_mode(game.options[OPT_ANTIALIASFONTS] != 0);
+    glyph_atlas_reset();
 
     recreate_overlay_ddbs();
 
@@ -773,6 +775,9 @@ Stream *StartSavegame(const String &filename, const String &user_text, const Bit
 
 void DoBeforeSave()
 {
+    // routes searched in background are not saved, get them now
+    complete_character_routes();
+
     if (play.cur_music_number >= 0)
     {
         if (IsMusicPlaying() == 0)
@@ -17,6 +17,7 @@
 #include "gfx/ali3dogl.h"
 #include <algorithm>
 #include <stack>
+#include <string.h>
 #include <SDL.h>
 #include "ac/sys_events.h"
 #include "ac/timer.h"
@@ -74,8 +75,12 @@ OGLTextureData::~OGLTextureData()
 {
     if (_tiles)
     {
-        for (size_t i = 0; i < _numTiles; ++i)
-            glDeleteTextures(1, &(_tiles[i].texture));
+        // textures referenced from the parent are deleted by the parent
+        if (!Parent)
+        {
+            for (size_t i = 0; i < _numTiles; ++i)
+                glDeleteTextures(1, &(_tiles[i].texture));
+        }
         delete[] _tiles;
     }
     if (_vertex)
@@ -145,6 +150,7 @@ void OGLGraphicsDriver::SetupDefaultVertices()
 
 void OGLGraphicsDriver::UpdateDeviceScreen(const Size &/*screen_size*/)
 {
+    WaitForRenderThread();
     SDL_GL_GetDrawableSize(_sdlWindow, &device_screen_physical_width, &device_screen_physical_height);
     Debug::Printf("OGL: notified of device screen updated to %d x %d, resizing viewport", device_screen_physical_width, device_screen_physical_height);
     _mode.Width = device_screen_physical_width;
@@ -153,6 +159,7 @@ void OGLGraphicsDriver::UpdateDeviceScreen(const Size &/*screen_size*/)
 
 void OGLGraphicsDriver::RenderSpritesAtScreenResolution(bool enabled, int supersampling)
 {
+  WaitForRenderThread();
   if (_can_render_to_texture)
   {
     _do_render_to_texture = !enabled;
@@ -189,12 +196,14 @@ void OGLGraphicsDriver::SetGamma(int /*newGamma*/)
 
 void OGLGraphicsDriver::SetGraphicsFilter(POGLFilter filter)
 {
+  WaitForRenderThread();
   _filter = filter;
   OnSetFilter();
 }
 
 void OGLGraphicsDriver::SetTintMethod(TintMethod method)
 {
+  WaitForRenderThread();
   _legacyPixelShader = (method == TintReColourise);
 }
 
@@ -230,6 +239,7 @@ bool OGLGraphicsDriver::FirstTimeInit()
   Debug::Printf(kDbgMsg_Info, "Running OpenGL: %s", ogl_v_str.GetCStr());
 
   TestRenderToTexture();
+  TestPixelBuffers();
 
   if(!CreateShaders()) { // requires glad Load successful
     SDL_SetError("Failed to create Shaders.");
@@ -404,6 +414,32 @@ void OGLGraphicsDriver::TestSupersampling()
 }
 
 
+void OGLGraphicsDriver::TestPixelBuffers()
+{
+#if AGS_OPENGL_ES2
+  // GLES2 does not support pixel unpack buffers
+  _can_use_pbo = false;
+#else
+  _can_use_pbo = GLAD_GL_VERSION_2_1 != 0;
+  if (_can_use_pbo)
+  {
+    glGenBuffers(PixelBufferCount, _pbo);
+    _pboIndex = 0;
+  }
+  else
+  {
+    Debug::Printf(kDbgMsg_Warn, "WARNING: OpenGL pixel buffer objects not supported, textures will be uploaded synchronously.");
+  }
+#endif
+}
+
+void OGLGraphicsDriver::DeletePixelBuffers()
+{
+  if (_can_use_pbo)
+    glDeleteBuffers(PixelBufferCount, _pbo);
+  std::fill(_pbo, _pbo + PixelBufferCount, 0u);
+  _can_use_pbo = false;
+}
 
 bool CreateTransparencyShader(ShaderProgram &prg);
 bool CreateTintShader(ShaderProgram &prg);
@@ -822,6 +858,7 @@ void OGLGraphicsDriver::CreateVirtualScreen()
 
 bool OGLGraphicsDriver::SetNativeResolution(const GraphicResolution &native_res)
 {
+  WaitForRenderThread();
   OnSetNativeRes(native_res);
   SetupBackbufferTexture();
   // If we already have a gfx mode set, then update virtual screen immediately
@@ -834,6 +871,7 @@ bool OGLGraphicsDriver::SetRenderFrame(const Rect &dst_rect)
 {
   if (!IsNativeSizeValid())
     return false;
+  WaitForRenderThread();
   OnSetRenderFrame(dst_rect);
   // Also make sure viewport and backbuffer mappings are updated using new native & destination rectangles
   SetupViewport();
@@ -866,6 +904,8 @@ PGfxFilter OGLGraphicsDriver::GetGraphicsFilter() const
 
 void OGLGraphicsDriver::ReleaseDisplayMode()
 {
+  StopRenderThread();
+  _framePacket.Clear();
   if (!IsModeSet())
     return;
 
@@ -875,6 +915,7 @@ void OGLGraphicsDriver::ReleaseDisplayMode()
   DeleteBackbufferTexture();
   DestroyFxPool();
   DestroyAllStageScreens();
+  DestroyTexturePool();
 
   sys_window_set_style(kWnd_Windowed);
 }
@@ -887,6 +928,7 @@ void OGLGraphicsDriver::UnInit()
   DeleteShaderProgram(_transparencyShader);
   DeleteShaderProgram(_tintShader);
   DeleteShaderProgram(_lightShader);
+  DeletePixelBuffers();
 
   DeleteWindowAndGlContext();
   sys_window_destroy();
@@ -905,6 +947,7 @@ void OGLGraphicsDriver::ClearRectangle(int /*x1*/, int /*y1*/, int /*x2*/, int /
 bool OGLGraphicsDriver::GetCopyOfScreenIntoBitmap(Bitmap *destination, bool at_native_res, GraphicResolution *want_fmt)
 {
   (void)at_native_res; // TODO: support this at some point
+  WaitForRenderThread();
 
   // TODO: following implementation currently only reads GL pixels in 32-bit RGBA.
   // this **should** work regardless of actual display mode because OpenGL is
@@ -974,7 +1017,79 @@ void OGLGraphicsDriver::Render()
 
 void OGLGraphicsDriver::Render(int /*xoff*/, int /*yoff*/, GraphicFlip /*flip*/)
 {
-  _render(true);
+  if (IsRenderThreadRunning())
+    RenderOnThread();
+  else
+    _render(true);
+}
+
+void OGLGraphicsDriver::RenderOnThread()
+{
+  // Stage callbacks run engine and plugin code in the middle of a render pass,
+  // so frames which have them must be rendered on this thread
+  for (const auto &e : _spriteList)
+  {
+    if (reinterpret_cast<intptr_t>(e.ddb) == DRAWENTRY_STAGECALLBACK)
+    {
+      _render(true);
+      return;
+    }
+  }
+
+  WaitForRenderThread();
+  // Close unended batches, and issue a warning
+  assert(_actSpriteBatch == UINT32_MAX);
+  while (_actSpriteBatch != UINT32_MAX)
+    EndSpriteBatch();
+
+  BackupDrawLists();
+  _framePacket.Clear();
+  SwapFrameLists(_framePacket);
+  // Copy sprites' drawing parameters, as these may be changed by the game
+  // while the frame is rendered
+  _framePacket.Sprites.reserve(_framePacket.SpriteList.size());
+  for (auto &e : _framePacket.SpriteList)
+  {
+    if (e.skip)
+      continue;
+    _framePacket.Sprites.push_back(*e.ddb);
+    _framePacket.Sprites.back()._fbo = 0u; // frame buffer is owned by the original
+    e.ddb = &_framePacket.Sprites.back();
+  }
+  _framePacket.OnRenderThread = true;
+  ClearDrawLists();
+  ResetFxPool();
+  SubmitToRenderThread();
+}
+
+void OGLGraphicsDriver::RenderSubmittedFrame()
+{
+  // Release the sprite copies as soon as the frame is rendered, as they keep
+  // references to the textures, which prevents recycling the ones that
+  // the game has destroyed in the meantime
+  try
+  {
+    RenderFrame(_framePacket);
+  }
+  catch (...)
+  {
+    _framePacket.Clear();
+    throw;
+  }
+  _framePacket.Clear();
+}
+
+void OGLGraphicsDriver::SetRenderContextCurrent(bool current)
+{
+  SDL_GL_MakeCurrent(_sdlWindow, current ? _sdlGlContext : nullptr);
+}
+
+void OGLGraphicsDriver::SwapFrameLists(OGLFramePacket &frame)
+{
+  std::swap(_spriteBatchDesc, frame.BatchDescs);
+  std::swap(_spriteBatchRange, frame.BatchRange);
+  std::swap(_spriteBatches, frame.Batches);
+  std::swap(_spriteList, frame.SpriteList);
 }
 
 void OGLGraphicsDriver::_reDrawLastFrame()
@@ -1171,6 +1286,27 @@ void OGLGraphicsDriver::_renderSprite(const OGLDrawListEntry *drawListEntry,
 }
 
 void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
+{
+  WaitForRenderThread();
+  // Close unended batches, and issue a warning
+  assert(_actSpriteBatch == UINT32_MAX);
+  while (_actSpriteBatch != UINT32_MAX)
+    EndSpriteBatch();
+
+  _framePacket.Clear();
+  SwapFrameLists(_framePacket);
+  RenderFrame(_framePacket);
+  SwapFrameLists(_framePacket);
+
+  if (clearDrawListAfterwards)
+  {
+    BackupDrawLists();
+    ClearDrawLists();
+  }
+  ResetFxPool();
+}
+
+void OGLGraphicsDriver::RenderFrame(const OGLFramePacket &frame)
 {
 #if 0
   // TODO:
@@ -1211,9 +1347,10 @@ void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
     projection = glm::ortho(0.0f, (float)_srcRect.GetWidth(), 0.0f, (float)_srcRect.GetHeight(), 0.0f, 1.0f);
   }
   // Save Projection
-  _stageMatrixes.Projection = projection;
+  if (!frame.OnRenderThread)
+    _stageMatrixes.Projection = projection;
 
-  RenderSpriteBatches(projection);
+  RenderSpriteBatches(frame, projection);
 
   if (_do_render_to_texture)
   {
@@ -1264,13 +1401,6 @@ void OGLGraphicsDriver::_render(bool clearDrawListAfterwards)
   glFinish();
 
   SDL_GL_SwapWindow(_sdlWindow);
-
-  if (clearDrawListAfterwards)
-  {
-    BackupDrawLists();
-    ClearDrawLists();
-  }
-  ResetFxPool();
 }
 
 void OGLGraphicsDriver::SetScissor(const Rect &clip, bool render_on_texture, const Size &surface_size)
@@ -1329,14 +1459,13 @@ void OGLGraphicsDriver::SetRenderTarget(const OGLSpriteBatch *batch, Size &surfa
     }
 }
 
-void OGLGraphicsDriver::RenderSpriteBatches(const glm::mat4 &projection)
+void OGLGraphicsDriver::RenderSpriteBatches(const OGLFramePacket &frame, const glm::mat4 &projection)
 {
-    // Close unended batches, and issue a warning
-    assert(_actSpriteBatch == UINT32_MAX);
-    while (_actSpriteBatch != UINT32_MAX)
-        EndSpriteBatch();
-
-    if (_spriteBatchDesc.size() == 0)
+    const auto &batch_descs = frame.BatchDescs;
+    const auto &batch_range = frame.BatchRange;
+    const auto &batches = frame.Batches;
+    const auto &sprites = frame.SpriteList;
+    if (batch_descs.size() == 0)
     {
         return; // no batches - no render
     }
@@ -1356,12 +1485,12 @@ void OGLGraphicsDriver::RenderSpriteBatches(const glm::mat4 &projection)
     Size surface_sz = _srcRect.GetSize(); // current rt surface size
     glm::mat4 use_projection = projection;
 
-    const size_t last_batch_to_rend = _spriteBatchDesc.size() - 1;
+    const size_t last_batch_to_rend = batch_descs.size() - 1;
     for (size_t cur_bat = 0u, last_bat = 0u, cur_spr = 0u; last_bat <= last_batch_to_rend;)
     {
         // Test if we are entering this batch (and not continuing after coming back from nested)
-        const auto &batch = _spriteBatches[cur_bat];
-        if (cur_spr <= _spriteBatchRange[cur_bat].first)
+        const auto &batch = batches[cur_bat];
+        if (cur_spr <= batch_range[cur_bat].first)
         {
             // If batch introduces a new render target, or the first using backbuffer, then remember it
             if (rt_parents.empty() || batch.RenderTarget)
@@ -1371,10 +1500,10 @@ void OGLGraphicsDriver::RenderSpriteBatches(const glm::mat4 &projection)
         }
 
         // Render immediate batch sprites, if any, update cur_spr iterator
-        if ((cur_spr < _spriteList.size()) && (cur_bat == _spriteList[cur_spr].node))
+        if ((cur_spr < sprites.size()) && (cur_bat == sprites[cur_spr].node))
         {
             // If render target is different in this batch, then set it up
-            const auto &rt_parent = _spriteBatches[rt_parents.top()];
+            const auto &rt_parent = batches[rt_parents.top()];
             if ((rt_parent.Fbo > 0u) && (cur_rt != rt_parent.Fbo) ||
                 (rt_parent.Fbo == 0u) && (cur_rt != back_buffer))
             {
@@ -1384,21 +1513,24 @@ void OGLGraphicsDriver::RenderSpriteBatches(const glm::mat4 &projection)
             // Now set clip (scissor), and render sprites
             const bool render_to_texture = (_do_render_to_texture) || (cur_rt != back_buffer);
             SetScissor(batch.Viewport, render_to_texture, surface_sz);
-            _stageMatrixes.World = batch.Matrix;
-            _rendSpriteBatch = batch.ID;
-            cur_spr = RenderSpriteBatch(batch, cur_spr, use_projection, surface_sz);
+            if (!frame.OnRenderThread)
+            {
+                _stageMatrixes.World = batch.Matrix;
+                _rendSpriteBatch = batch.ID;
+            }
+            cur_spr = RenderSpriteBatch(frame, batch, cur_spr, use_projection, surface_sz);
         }
 
         // Test if we're exiting current batch (and not going into nested ones):
         // if there's no sprites belonging to this batch (direct, or nested),
         // and if there's no nested batches (even if empty ones)
         const uint32_t was_bat = cur_bat;
-        while ((cur_bat != UINT32_MAX) && (cur_spr >= _spriteBatchRange[cur_bat].second) &&
-            ((last_bat == last_batch_to_rend) || (_spriteBatchDesc[last_bat + 1].Parent != cur_bat)))
+        while ((cur_bat != UINT32_MAX) && (cur_spr >= batch_range[cur_bat].second) &&
+            ((last_bat == last_batch_to_rend) || (batch_descs[last_bat + 1].Parent != cur_bat)))
         {
             rt_parents.pop(); // pop RT ref from the history
             // Back to the parent batch
-            cur_bat = _spriteBatchDesc[cur_bat].Parent;
+            cur_bat = batch_descs[cur_bat].Parent;
         }
 
         // If we stayed at the same batch, this means that there are still nested batches;
@@ -1410,19 +1542,23 @@ void OGLGraphicsDriver::RenderSpriteBatches(const glm::mat4 &projection)
     }
 
     SetRenderTarget(nullptr, surface_sz, use_projection);
-    _rendSpriteBatch = UINT32_MAX;
-    _stageMatrixes.World = _spriteBatches[0].Matrix;
+    if (!frame.OnRenderThread)
+    {
+        _rendSpriteBatch = UINT32_MAX;
+        _stageMatrixes.World = batches[0].Matrix;
+    }
     SetScissor(Rect(), _do_render_to_texture, _srcRect.GetSize()); // TODO: simply disable scissor test?
     if (_do_render_to_texture)
         glDisable(GL_SCISSOR_TEST);
 }
 
-size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLSpriteBatch &batch, size_t from,
-    const glm::mat4 &projection, const Size &surface_size)
+size_t OGLGraphicsDriver::RenderSpriteBatch(const OGLFramePacket &frame, const OGLSpriteBatch &batch,
+    size_t from, const glm::mat4 &projection, const Size &surface_size)
 {
-    for (; (from < _spriteList.size()) && (_spriteList[from].node == batch.ID); ++from)
+    const auto &sprites = frame.SpriteList;
+    for (; (from < sprites.size()) && (sprites[from].node == batch.ID); ++from)
     {
-        const auto &e = _spriteList[from];
+        const auto &e = sprites[from];
         if (e.skip)
             continue;
 
@@ -1610,7 +1746,10 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
   }
 
   const bool usingLinearFiltering = _filter->UseLinearFiltering();
-  char *origPtr = new char[sizeof(int) * tileWidth * tileHeight];
+  const size_t buf_size = sizeof(int) * tileWidth * tileHeight;
+  // Edge pixels are copied from the converted ones, which requires reading the buffer back
+  const bool has_edges = (tile->width < tileWidth) || (tile->height < tileHeight);
+  char *origPtr = BeginTextureUpload(buf_size, has_edges);
   const int pitch = tileWidth * sizeof(int);
   char *memPtr = origPtr + pitch * tiley + tilex * sizeof(int);
 
@@ -1664,13 +1803,87 @@ void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap
   }
 
   glBindTexture(GL_TEXTURE_2D, tile->texture);
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tileWidth, tileHeight, GL_RGBA, GL_UNSIGNED_BYTE, origPtr);
+  EndTextureUpload(origPtr, 0, 0, tileWidth, tileHeight);
+}
+
+void OGLGraphicsDriver::UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, const Rect &area, bool opaque, bool hasAlpha)
+{
+  int textureHeight = tile->height;
+  int textureWidth = tile->width;
+  AdjustSizeToNearestSupportedByCard(&textureWidth, &textureHeight);
+  // The tile edges are copied around the tile when the texture is larger,
+  // update the whole tile to keep them in sync
+  if ((textureWidth > tile->width) || (textureHeight > tile->height))
+  {
+    UpdateTextureRegion(tile, bitmap, opaque, hasAlpha);
+    return;
+  }
+
+  TextureTile fixedTile;
+  fixedTile.x = std::max(area.Left, tile->x);
+  fixedTile.y = std::max(area.Top, tile->y);
+  fixedTile.width = std::min(area.Right + 1, tile->x + tile->width) - fixedTile.x;
+  fixedTile.height = std::min(area.Bottom + 1, tile->y + tile->height) - fixedTile.y;
+  if ((fixedTile.width <= 0) || (fixedTile.height <= 0))
+    return; // area does not intersect this tile
+
+  const size_t buf_size = sizeof(int) * fixedTile.width * fixedTile.height;
+  char *memPtr = BeginTextureUpload(buf_size, false);
+  const int pitch = fixedTile.width * sizeof(int);
+  if (opaque)
+    BitmapToVideoMemOpaque(bitmap, hasAlpha, &fixedTile, memPtr, pitch);
+  else
+    BitmapToVideoMem(bitmap, hasAlpha, &fixedTile, memPtr, pitch, _filter->UseLinearFiltering());
+
+  glBindTexture(GL_TEXTURE_2D, tile->texture);
+  EndTextureUpload(memPtr, fixedTile.x - tile->x, fixedTile.y - tile->y, fixedTile.width, fixedTile.height);
+}
 
-  delete []origPtr;
+char *OGLGraphicsDriver::BeginTextureUpload(size_t buf_size, bool read_back)
+{
+#if !AGS_OPENGL_ES2
+  if (_can_use_pbo)
+  {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pbo[_pboIndex]);
+    _pboIndex = (_pboIndex + 1) % PixelBufferCount;
+    // Orphan the buffer's previous storage, in case it is still used by
+    // a pending upload, and let the driver provide a new one without waiting
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, buf_size, nullptr, GL_STREAM_DRAW);
+    void *pbo_ptr = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, read_back ? GL_READ_WRITE : GL_WRITE_ONLY);
+    if (pbo_ptr)
+    {
+      _pboMapped = true;
+      return static_cast<char*>(pbo_ptr);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+#else
+  (void)read_back;
+#endif
+  if (_stagingBuf.size() < buf_size)
+    _stagingBuf.resize(buf_size);
+  return &_stagingBuf.front();
+}
+
+void OGLGraphicsDriver::EndTextureUpload(const char *pixels, int x, int y, int width, int height)
+{
+#if !AGS_OPENGL_ES2
+  if (_pboMapped)
+  {
+    // Texture is updated from the bound buffer asynchronously
+    _pboMapped = false;
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return;
+  }
+#endif
+  glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
 }
 
 void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
 {
+  WaitForRenderThread();
   OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
   if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
     throw Ali3DException("UpdateDDBFromBitmap: mismatched bitmap size");
@@ -1682,8 +1895,32 @@ void OGLGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
   UpdateTextureData(target->_data.get(), bitmap, target->_opaque, hasAlpha);
 }
 
+void OGLGraphicsDriver::UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap,
+    const Rect &area, bool hasAlpha)
+{
+  WaitForRenderThread();
+  OGLBitmap *target = (OGLBitmap*)bitmapToUpdate;
+  if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched bitmap size");
+  const int color_depth = bitmap->GetColorDepth();
+  if (color_depth != target->_colDepth)
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched colour depths");
+
+  target->_hasAlpha = hasAlpha;
+  if (color_depth == 8)
+      select_palette(palette);
+  auto *ogldata = reinterpret_cast<OGLTextureData*>(target->_data.get());
+  for (size_t i = 0; i < ogldata->_numTiles; ++i)
+  {
+    UpdateTextureRegion(&ogldata->_tiles[i], bitmap, area, target->_opaque, hasAlpha);
+  }
+  if (color_depth == 8)
+      unselect_palette();
+}
+
 void OGLGraphicsDriver::UpdateTextureData(TextureData *txdata, Bitmap *bitmap, bool opaque, bool hasAlpha)
 {
+  WaitForRenderThread();
   const int color_depth = bitmap->GetColorDepth();
   if (color_depth == 8)
       select_palette(palette);
@@ -1739,25 +1976,27 @@ IDriverDependantBitmap* OGLGraphicsDriver::CreateDDB(int width, int height, int
     if (color_depth != GetCompatibleBitmapFormat(color_depth))
         throw Ali3DException("CreateDDB: bitmap colour depth not supported");
     OGLBitmap *ddb = new OGLBitmap(width, height, color_depth, opaque);
-    ddb->_data.reset(reinterpret_cast<OGLTextureData*>(CreateTextureData(width, height, opaque)));
+    ddb->_data = std::static_pointer_cast<OGLTextureData>(AcquireTextureData(width, height, opaque));
     return ddb;
 }
 
 IDriverDependantBitmap *OGLGraphicsDriver::CreateDDB(std::shared_ptr<TextureData> txdata,
     int width, int height, int color_depth, bool opaque)
 {
-    auto *ddb = reinterpret_cast<OGLBitmap*>(CreateDDB(width, height, color_depth, opaque));
-    if (ddb)
-        ddb->_data = std::static_pointer_cast<OGLTextureData>(txdata);
+    if (color_depth != GetCompatibleBitmapFormat(color_depth))
+        throw Ali3DException("CreateDDB: bitmap colour depth not supported");
+    OGLBitmap *ddb = new OGLBitmap(width, height, color_depth, opaque);
+    ddb->_data = std::static_pointer_cast<OGLTextureData>(txdata);
     return ddb;
 }
 
 IDriverDependantBitmap* OGLGraphicsDriver::CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque)
 {
+    WaitForRenderThread();
     if (color_depth != GetCompatibleBitmapFormat(color_depth))
         throw Ali3DException("CreateDDB: bitmap colour depth not supported");
     OGLBitmap *ddb = new OGLBitmap(width, height, color_depth, opaque);
-    ddb->_data.reset(reinterpret_cast<OGLTextureData*>(CreateTextureData(width, height, opaque, true)));
+    ddb->_data = std::static_pointer_cast<OGLTextureData>(AcquireTextureData(width, height, opaque, true));
     glGenFramebuffersEXT(1, &ddb->_fbo);
     glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, ddb->_fbo);
     // FIXME: this ugly accessing internal texture members
@@ -1768,6 +2007,47 @@ IDriverDependantBitmap* OGLGraphicsDriver::CreateRenderTargetDDB(int width, int
     return ddb;
 }
 
+IDriverDependantBitmap *OGLGraphicsDriver::CreateSubDDB(IDriverDependantBitmap *parent, const Rect &area)
+{
+    OGLBitmap *parent_ddb = (OGLBitmap*)parent;
+    const auto &parent_data = parent_ddb->_data;
+    // Only the single-tile regular textures may be shared; render targets
+    // have their vertices inverted, which would complicate things
+    if (!parent_data || parent_data->RenderTarget || (parent_data->_numTiles != 1))
+        return nullptr;
+    const Rect parent_rc = RectWH(0, 0, parent_ddb->GetWidth(), parent_ddb->GetHeight());
+    if (area.IsEmpty() || !IsRectInsideRect(parent_rc, area))
+        return nullptr;
+
+    const OGLTextureTile &parent_tile = parent_data->_tiles[0];
+    const OGLCUSTOMVERTEX *parent_vx = parent_data->_vertex ?
+        parent_data->_vertex : defaultVertices;
+    // Texture coordinates of the parent image's corners
+    const float u1 = parent_vx[0].tu, v1 = parent_vx[0].tv;
+    const float u2 = parent_vx[3].tu, v2 = parent_vx[3].tv;
+    const float su = (u2 - u1) / parent_tile.width, sv = (v2 - v1) / parent_tile.height;
+
+    auto txdata = std::make_shared<OGLTextureData>();
+    txdata->Parent = parent_data;
+    txdata->_numTiles = 1;
+    txdata->_tiles = new OGLTextureTile[1];
+    txdata->_tiles[0].width = area.GetWidth();
+    txdata->_tiles[0].height = area.GetHeight();
+    txdata->_tiles[0].texture = parent_tile.texture;
+    txdata->_vertex = new OGLCUSTOMVERTEX[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        txdata->_vertex[i] = defaultVertices[i];
+        txdata->_vertex[i].tu = u1 + su * ((defaultVertices[i].tu > 0.f) ? (area.Right + 1) : area.Left);
+        txdata->_vertex[i].tv = v1 + sv * ((defaultVertices[i].tv > 0.f) ? (area.Bottom + 1) : area.Top);
+    }
+
+    OGLBitmap *ddb = new OGLBitmap(area.GetWidth(), area.GetHeight(), parent_ddb->GetColorDepth(), parent_ddb->_opaque);
+    ddb->_hasAlpha = parent_ddb->_hasAlpha;
+    ddb->_data = txdata;
+    return ddb;
+}
+
 std::shared_ptr<TextureData> OGLGraphicsDriver::GetTextureData(IDriverDependantBitmap *ddb)
 {
     return std::static_pointer_cast<TextureData>((reinterpret_cast<OGLBitmap*>(ddb))->_data);
@@ -1775,6 +2055,7 @@ std::shared_ptr<TextureData> OGLGraphicsDriver::GetTextureData(IDriverDependantB
 
 TextureData *OGLGraphicsDriver::CreateTextureData(int width, int height, bool /*opaque*/, bool as_render_target)
 {
+  WaitForRenderThread();
   assert(width > 0);
   assert(height > 0);
   int allocatedWidth = width;
@@ -1914,6 +2195,7 @@ TextureData *OGLGraphicsDriver::CreateTextureData(int width, int height, bool /*
 
   txdata->_numTiles = numTiles;
   txdata->_tiles = tiles;
+  txdata->RenderTarget = as_render_target;
   return txdata;
 }
 
@@ -2063,6 +2345,7 @@ void OGLGraphicsDriver::SetScreenTint(int red, int green, int blue)
 
 bool OGLGraphicsDriver::SetVsyncImpl(bool enabled, bool &vsync_res)
 {
+    WaitForRenderThread();
     if (SDL_GL_SetSwapInterval(enabled) != 0)
     {
         Debug::Printf(kDbgMsg_Warn, "OGL: SetVsync (%d) failed: %s", enabled, SDL_GetError());
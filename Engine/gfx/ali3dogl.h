@@ -153,6 +153,31 @@ struct OGLSpriteBatch : VMSpriteBatch
 typedef SpriteDrawListEntry<OGLBitmap> OGLDrawListEntry;
 typedef std::vector<OGLSpriteBatch>    OGLSpriteBatches;
 
+// A recorded frame: sprite batches and the list of sprites to draw.
+// When recorded for the render thread, it also keeps copies of the sprites,
+// so that the game may modify or delete the original ones in the meantime;
+// the packet is cleared by the render thread once the frame is rendered.
+struct OGLFramePacket
+{
+    SpriteBatchDescs BatchDescs;
+    std::vector<std::pair<size_t, size_t>> BatchRange;
+    OGLSpriteBatches Batches;
+    std::vector<OGLDrawListEntry> SpriteList;
+    std::vector<OGLBitmap> Sprites;
+    // Tells that the frame is rendered on the render thread
+    bool OnRenderThread = false;
+
+    void Clear()
+    {
+        BatchDescs.clear();
+        BatchRange.clear();
+        Batches.clear();
+        SpriteList.clear();
+        Sprites.clear();
+        OnRenderThread = false;
+    }
+};
+
 
 class OGLDisplayModeList : public IGfxModeList
 {
@@ -220,7 +245,9 @@ public:
     int  GetCompatibleBitmapFormat(int color_depth) override;
     IDriverDependantBitmap* CreateDDB(int width, int height, int color_depth, bool opaque) override;
     IDriverDependantBitmap* CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque) override;
+    IDriverDependantBitmap *CreateSubDDB(IDriverDependantBitmap *parent, const Rect &area) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, bool hasAlpha) override;
+    void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, const Rect &area, bool hasAlpha) override;
     void DestroyDDBImpl(IDriverDependantBitmap* ddb) override;
     void DrawSprite(int x, int y, IDriverDependantBitmap* ddb) override;
     void RenderToBackBuffer() override;
@@ -250,6 +277,9 @@ public:
 
 protected:
     bool SetVsyncImpl(bool vsync, bool &vsync_res) override;
+    bool CanRenderOnThread() const override { return true; }
+    void RenderSubmittedFrame() override;
+    void SetRenderContextCurrent(bool current) override;
 
     // Create texture data with the given parameters
     TextureData *CreateTextureData(int width, int height, bool opaque, bool as_render_target = false) override;
@@ -314,6 +344,21 @@ private:
     std::vector<std::pair<size_t, size_t>> _backupBatchRange;
     OGLSpriteBatches _backupBatches;
     std::vector<OGLDrawListEntry> _backupSpriteList;
+    // The frame being rendered
+    OGLFramePacket _framePacket;
+
+    // Pixel buffer objects, used as a staging memory for uploading textures;
+    // the buffers are cycled, so that a new upload does not have to wait
+    // for the previous one to complete.
+    static const size_t PixelBufferCount = 3;
+    bool _can_use_pbo {};
+    GLuint _pbo[PixelBufferCount] {};
+    size_t _pboIndex {};
+    // Tells if the current pixel buffer is mapped for the texture upload
+    bool _pboMapped {};
+    // Buffer for converting bitmaps into the texture format,
+    // used when the pixel buffer objects are not available
+    std::vector<char> _stagingBuf;
 
     // Saved blend settings exclusive for alpha channel; for convenience,
     // because GL does not have functions for setting ONLY RGB or ONLY alpha ops.
@@ -338,6 +383,16 @@ private:
     void TestRenderToTexture();
     // Test if supersampling should be allowed with the current setup
     void TestSupersampling();
+    // Test if pixel buffer objects are supported, and create them if they are
+    void TestPixelBuffers();
+    void DeletePixelBuffers();
+    // Returns a buffer to convert the texture pixels into: a mapped pixel buffer
+    // if one is available, or the staging buffer otherwise;
+    // read_back tells that the pixels will be read after writing them
+    char *BeginTextureUpload(size_t buf_size, bool read_back);
+    // Uploads the pixels returned by BeginTextureUpload into the currently bound texture,
+    // at the given texture position
+    void EndTextureUpload(const char *pixels, int x, int y, int width, int height);
     // Create shader programs for sprite tinting and changing light level
     bool CreateShaders();
     // Configure backbuffer texture, that is used in render-to-texture mode
@@ -347,6 +402,8 @@ private:
     void ReleaseDisplayMode();
     void AdjustSizeToNearestSupportedByCard(int *width, int *height);
     void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, bool opaque, bool hasAlpha);
+    // Updates the part of the texture tile, which corresponds to the bitmap's area
+    void UpdateTextureRegion(OGLTextureTile *tile, Bitmap *bitmap, const Rect &area, bool opaque, bool hasAlpha);
     void CreateVirtualScreen();
     void do_fade(bool fadingOut, int speed, int targetColourRed, int targetColourGreen, int targetColourBlue);
     void _renderSprite(const OGLDrawListEntry *entry, const glm::mat4 &projection, const glm::mat4 &matGlobal,
@@ -369,15 +426,21 @@ private:
     // Deletes draw list backups
     void ClearDrawBackups();
     void _render(bool clearDrawListAfterwards);
+    // Records current draw lists into the frame packet and passes it to the render thread
+    void RenderOnThread();
+    // Exchanges current draw lists with the ones in the frame packet
+    void SwapFrameLists(OGLFramePacket &frame);
+    // Draws the recorded frame and presents it on screen
+    void RenderFrame(const OGLFramePacket &frame);
     // Sets the scissor (render clip), clip rect is passed in the "native" coordinates.
     // Optionally pass surface_size if the rendering is done to texture, in native coords,
     // otherwise we assume it is set on a whole screen, scaled to the screen coords.
     void SetScissor(const Rect &clip, bool render_on_texture, const Size &surface_size);
     // Configures rendering mode for the render target, depending on its properties
     void SetRenderTarget(const OGLSpriteBatch *batch, Size &surface_sz, glm::mat4 &projection);
-    void RenderSpriteBatches(const glm::mat4 &projection);
-    size_t RenderSpriteBatch(const OGLSpriteBatch &batch, size_t from, const glm::mat4 &projection,
-        const Size &surface_size);
+    void RenderSpriteBatches(const OGLFramePacket &frame, const glm::mat4 &projection);
+    size_t RenderSpriteBatch(const OGLFramePacket &frame, const OGLSpriteBatch &batch, size_t from,
+        const glm::mat4 &projection, const Size &surface_size);
     void _reDrawLastFrame();
 };
 
@@ -163,6 +163,9 @@ public:
     IDriverDependantBitmap* CreateDDBFromBitmap(Bitmap *bitmap, bool hasAlpha, bool opaque) override;
     IDriverDependantBitmap* CreateRenderTargetDDB(int width, int height, int color_depth, bool opaque) override;
     void UpdateDDBFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, bool hasAlpha) override;
+    // Software bitmaps reference the source bitmap, so there's nothing to copy
+    void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* ddb, Bitmap *bitmap, const Rect & /*area*/, bool hasAlpha) override
+        { UpdateDDBFromBitmap(ddb, bitmap, hasAlpha); }
     void DestroyDDB(IDriverDependantBitmap* ddb) override;
 
     IDriverDependantBitmap *GetSharedDDB(uint32_t /*sprite_id*/,
@@ -173,6 +176,7 @@ public:
     void UpdateSharedDDB(uint32_t /*sprite_id*/, Common::Bitmap * /*bitmap*/, bool /*hasAlpha*/, bool /*opaque*/)
         override { /* do nothing */ }
     void ClearSharedDDB(uint32_t /*sprite_id*/) override { /* do nothing */ }
+    void SetTexturePoolSize(size_t /*max_size*/) override { /* do nothing */ }
 
     void DrawSprite(int x, int y, IDriverDependantBitmap* ddb) override;
     void SetScreenFade(int red, int green, int blue) override;
@@ -22,6 +22,9 @@ namespace AGS
 namespace Engine
 {
 
+// Default max size of the released textures kept by the driver for reuse
+const size_t DEFAULT_TEXTUREPOOLSIZE_KB = 1024u * 16; // 16 MB
+
 // GraphicResolution struct determines image size and color depth
 struct GraphicResolution : Size
 {
@@ -17,6 +17,7 @@
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter.h"
 #include "gfx/gfx_util.h"
+#include "gfx/pixel_conv.h"
 
 using namespace AGS::Common;
 
@@ -192,9 +193,19 @@ VideoMemoryGraphicsDriver::VideoMemoryGraphicsDriver()
 
 VideoMemoryGraphicsDriver::~VideoMemoryGraphicsDriver()
 {
+    StopRenderThread();
     DestroyAllStageScreens();
 }
 
+void VideoMemoryGraphicsDriver::OnUnInit()
+{
+    GraphicsDriverBase::OnUnInit();
+    // The pool may be destroyed and recreated several times during the driver's
+    // lifetime (mode changes, device resets), so only report totals at shutdown
+    Debug::Printf("Texture pool: created %u, reused %u, released %u, trimmed %u",
+        _txPoolStats.Created, _txPoolStats.Reused, _txPoolStats.Released, _txPoolStats.Trimmed);
+}
+
 bool VideoMemoryGraphicsDriver::UsesMemoryBackBuffer()
 {
     // Although we do use ours, we do not let engine draw upon it;
@@ -249,7 +260,8 @@ IDriverDependantBitmap *VideoMemoryGraphicsDriver::GetSharedDDB(uint32_t sprite_
     }
 
     // Create and add a new element
-    std::shared_ptr<TextureData> txdata(CreateTextureData(bitmap->GetWidth(), bitmap->GetHeight(), opaque));
+    WaitForRenderThread();
+    std::shared_ptr<TextureData> txdata = AcquireTextureData(bitmap->GetWidth(), bitmap->GetHeight(), opaque);
     txdata->ID = sprite_id;
     UpdateTextureData(txdata.get(), bitmap, opaque, hasAlpha);
     // only add into the map when has valid sprite ID
@@ -268,7 +280,10 @@ void VideoMemoryGraphicsDriver::UpdateSharedDDB(uint32_t sprite_id, Common::Bitm
     {
         auto txdata = found->second.Data.lock();
         if (txdata)
+        {
+            WaitForRenderThread();
             UpdateTextureData(txdata.get(), bitmap, opaque, hasAlpha);
+        }
     }
 }
 
@@ -289,12 +304,180 @@ void VideoMemoryGraphicsDriver::ClearSharedDDB(uint32_t sprite_id)
 
 void VideoMemoryGraphicsDriver::DestroyDDB(IDriverDependantBitmap* ddb)
 {
+    WaitForRenderThread();
     uint32_t sprite_id = ddb->GetRefID();
+    // Keep the texture data reference, in case it may be recycled
+    std::shared_ptr<TextureData> txdata = GetTextureData(ddb);
+    const int width = ddb->GetWidth(), height = ddb->GetHeight();
+    const bool opaque = static_cast<BaseDDB*>(ddb)->_opaque;
     DestroyDDBImpl(ddb);
     // Remove shared object from ref list if no more active refs left
     const auto found = _txRefs.find(sprite_id);
-    if (found != _txRefs.end() && found->second.Data.expired())
+    if (found != _txRefs.end() && (!txdata || txdata.use_count() == 1))
         _txRefs.erase(found);
+    // If this was the last reference to the texture data, then put it into the pool
+    if (txdata && (txdata.use_count() == 1))
+        ReleaseToTexturePool(txdata, width, height, opaque);
+}
+
+void VideoMemoryGraphicsDriver::SetTexturePoolSize(size_t max_size)
+{
+    WaitForRenderThread();
+    _txPoolMaxSize = max_size;
+    TrimTexturePool(_txPoolMaxSize);
+}
+
+std::shared_ptr<TextureData> VideoMemoryGraphicsDriver::AcquireTextureData(int width, int height,
+    bool opaque, bool as_render_target)
+{
+    const auto found = _txPoolLookup.find(MakeTexturePoolKey(width, height, opaque, as_render_target));
+    if (found != _txPoolLookup.end())
+    {
+        auto item = found->second;
+        std::shared_ptr<TextureData> txdata = item->Data;
+        _txPoolSize -= item->Size;
+        _txPool.erase(item);
+        _txPoolLookup.erase(found);
+        _txPoolStats.Reused++;
+        return txdata;
+    }
+    _txPoolStats.Created++;
+    return std::shared_ptr<TextureData>(CreateTextureData(width, height, opaque, as_render_target));
+}
+
+uint64_t VideoMemoryGraphicsDriver::MakeTexturePoolKey(int width, int height, bool opaque, bool as_render_target)
+{
+    return (static_cast<uint64_t>(width) << 32) | (static_cast<uint64_t>(height) << 2)
+        | (opaque ? 0x2 : 0x0) | (as_render_target ? 0x1 : 0x0);
+}
+
+void VideoMemoryGraphicsDriver::ReleaseToTexturePool(std::shared_ptr<TextureData> txdata,
+    int width, int height, bool opaque)
+{
+    // NOTE: textures are always in 32-bit format in video memory;
+    // this does not account for the driver's texture size alignment
+    const size_t size = width * height * sizeof(uint32_t);
+    if (!IsModeSet() || (size > _txPoolMaxSize) || txdata->Parent)
+        return; // let it be disposed
+    txdata->ID = UINT32_MAX;
+    const uint64_t key = MakeTexturePoolKey(width, height, opaque, txdata->RenderTarget);
+    TrimTexturePool(_txPoolMaxSize - size);
+    _txPool.push_back(TexturePoolItem(key, size, txdata));
+    _txPoolLookup.insert(std::make_pair(key, std::prev(_txPool.end())));
+    _txPoolSize += size;
+    _txPoolStats.Released++;
+}
+
+void VideoMemoryGraphicsDriver::TrimTexturePool(size_t max_size)
+{
+    while (!_txPool.empty() && (_txPoolSize > max_size))
+    {
+        const auto oldest = _txPool.begin();
+        const auto range = _txPoolLookup.equal_range(oldest->Key);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == oldest)
+            {
+                _txPoolLookup.erase(it);
+                break;
+            }
+        }
+        _txPoolSize -= oldest->Size;
+        _txPool.erase(oldest);
+        _txPoolStats.Trimmed++;
+    }
+}
+
+void VideoMemoryGraphicsDriver::DestroyTexturePool()
+{
+    _txPoolLookup.clear();
+    _txPool.clear();
+    _txPoolSize = 0u;
+}
+
+bool VideoMemoryGraphicsDriver::SetRenderThread(bool enabled)
+{
+    if (enabled == _renderThreadRunning)
+        return _renderThreadRunning;
+    if (!enabled)
+    {
+        StopRenderThread();
+        return false;
+    }
+    if (!IsModeSet() || !CanRenderOnThread())
+        return false;
+
+    _renderThreadExit = false;
+    _renderFramePending = false;
+    _renderThread = std::thread(&VideoMemoryGraphicsDriver::RenderThreadLoop, this);
+    _renderThreadRunning = true;
+    Debug::Printf("%s: started render thread", GetDriverName());
+    return true;
+}
+
+void VideoMemoryGraphicsDriver::StopRenderThread()
+{
+    if (!_renderThreadRunning)
+        return;
+    WaitForRenderThread();
+    {
+        std::lock_guard<std::mutex> lk(_renderMutex);
+        _renderThreadExit = true;
+    }
+    _renderCv.notify_all();
+    if (_renderThread.joinable())
+        _renderThread.join();
+    _renderThreadRunning = false;
+    Debug::Printf("%s: stopped render thread", GetDriverName());
+}
+
+void VideoMemoryGraphicsDriver::SubmitToRenderThread()
+{
+    assert(_renderThreadRunning && !_renderFrameSubmitted);
+    SetRenderContextCurrent(false);
+    {
+        std::lock_guard<std::mutex> lk(_renderMutex);
+        _renderFramePending = true;
+    }
+    _renderFrameSubmitted = true;
+    _renderCv.notify_all();
+}
+
+void VideoMemoryGraphicsDriver::WaitForRenderThread()
+{
+    if (!_renderFrameSubmitted)
+        return;
+    {
+        std::unique_lock<std::mutex> lk(_renderMutex);
+        _renderCv.wait(lk, [this]() { return !_renderFramePending; });
+    }
+    _renderFrameSubmitted = false;
+    SetRenderContextCurrent(true);
+}
+
+void VideoMemoryGraphicsDriver::RenderThreadLoop()
+{
+    std::unique_lock<std::mutex> lk(_renderMutex);
+    while (true)
+    {
+        _renderCv.wait(lk, [this]() { return _renderFramePending || _renderThreadExit; });
+        if (!_renderFramePending)
+            break; // asked to exit, and no frames left
+        lk.unlock();
+        SetRenderContextCurrent(true);
+        try
+        {
+            RenderSubmittedFrame();
+        }
+        catch (Ali3DException &e)
+        {
+            Debug::Printf(kDbgMsg_Error, "Render thread: %s", e.Message.GetCStr());
+        }
+        SetRenderContextCurrent(false);
+        lk.lock();
+        _renderFramePending = false;
+        _renderCv.notify_all();
+    }
 }
 
 void VideoMemoryGraphicsDriver::SetStageScreen(const Size &sz, int x, int y)
@@ -413,15 +596,6 @@ void VideoMemoryGraphicsDriver::DestroyFxPool()
 }
 
 
-#define algetr32(c) getr32(c)
-#define algetg32(c) getg32(c)
-#define algetb32(c) getb32(c)
-#define algeta32(c) geta32(c)
-
-#define algetr16(c) getr16(c)
-#define algetg16(c) getg16(c)
-#define algetb16(c) getb16(c)
-
 #define algetr8(c)  getr8(c)
 #define algetg8(c)  getg8(c)
 #define algetb8(c)  getb8(c)
@@ -438,33 +612,29 @@ __inline void get_pixel_if_not_transparent8(unsigned char *pixel, unsigned char
   }
 }
 
-__inline void get_pixel_if_not_transparent16(unsigned short *pixel, unsigned short *red, unsigned short *green, unsigned short *blue, unsigned short *divisor)
-{
-  if (pixel[0] != MASK_COLOR_16)
-  {
-    *red += algetr16(pixel[0]);
-    *green += algetg16(pixel[0]);
-    *blue += algetb16(pixel[0]);
-    divisor[0]++;
-  }
-}
-
-__inline void get_pixel_if_not_transparent32(unsigned int *pixel, unsigned int *red, unsigned int *green, unsigned int *blue, unsigned int *divisor)
-{
-  if (pixel[0] != MASK_COLOR_32)
-  {
-    *red += algetr32(pixel[0]);
-    *green += algetg32(pixel[0]);
-    *blue += algetb32(pixel[0]);
-    divisor[0]++;
-  }
-}
-
 
 #define VMEMCOLOR_RGBA(r,g,b,a) \
     ( (((a) & 0xFF) << _vmem_a_shift_32) | (((r) & 0xFF) << _vmem_r_shift_32) | (((g) & 0xFF) << _vmem_g_shift_32) | (((b) & 0xFF) << _vmem_b_shift_32) )
 
 
+// Gathers pixel formats of the source bitmaps and video memory
+static PixelConv::PixelFormat GetVMemPixelFormat(int a_shift, int r_shift, int g_shift, int b_shift)
+{
+    PixelConv::PixelFormat fmt;
+    fmt.SrcR16 = _rgb_r_shift_16;
+    fmt.SrcG16 = _rgb_g_shift_16;
+    fmt.SrcB16 = _rgb_b_shift_16;
+    fmt.SrcR32 = _rgb_r_shift_32;
+    fmt.SrcG32 = _rgb_g_shift_32;
+    fmt.SrcB32 = _rgb_b_shift_32;
+    fmt.SrcA32 = _rgb_a_shift_32;
+    fmt.DstR = r_shift;
+    fmt.DstG = g_shift;
+    fmt.DstB = b_shift;
+    fmt.DstA = a_shift;
+    return fmt;
+}
+
 void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const bool has_alpha, const TextureTile *tile,
     char *dst_ptr, const int dst_pitch, const bool usingLinearFiltering)
 {
@@ -523,104 +693,31 @@ void VideoMemoryGraphicsDriver::BitmapToVideoMem(const Bitmap *bitmap, const boo
         }
         break;
         case 16: {
+            const PixelConv::PixelFormat fmt = GetVMemPixelFormat(
+                _vmem_a_shift_32, _vmem_r_shift_32, _vmem_g_shift_32, _vmem_b_shift_32);
             for (int y = 0; y < tile->height; y++) {
-                lastPixelWasTransparent = false;
-                const uint8_t *scanline_before = (y > 0) ? bitmap->GetScanLine(y + tile->y - 1) : nullptr;
-                const uint8_t *scanline_at = bitmap->GetScanLine(y + tile->y);
-                const uint8_t *scanline_after = (y < tile->height - 1) ? bitmap->GetScanLine(y + tile->y + 1) : nullptr;
-                unsigned int *memPtrLong = (unsigned int *) dst_ptr;
-
-                for (int x = 0; x < tile->width; x++) {
-                    unsigned short *srcData = (unsigned short *) &scanline_at[(x + tile->x) * sizeof(short)];
-                    if (*srcData == MASK_COLOR_16) {
-                        if (!usingLinearFiltering)
-                            memPtrLong[x] = 0;
-                            // set to transparent, but use the colour from the neighbouring
-                            // pixel to stop the linear filter doing black outlines
-                        else {
-                            unsigned short red = 0, green = 0, blue = 0, divisor = 0;
-                            if (x > 0)
-                                get_pixel_if_not_transparent16(&srcData[-1], &red, &green, &blue, &divisor);
-                            if (x < tile->width - 1)
-                                get_pixel_if_not_transparent16(&srcData[1], &red, &green, &blue, &divisor);
-                            if (y > 0)
-                                get_pixel_if_not_transparent16(
-                                        (unsigned short *) &scanline_before[(x + tile->x) * sizeof(short)], &red,
-                                        &green, &blue, &divisor);
-                            if (y < tile->height - 1)
-                                get_pixel_if_not_transparent16(
-                                        (unsigned short *) &scanline_after[(x + tile->x) * sizeof(short)], &red, &green,
-                                        &blue, &divisor);
-                            if (divisor > 0)
-                                memPtrLong[x] = VMEMCOLOR_RGBA(red / divisor, green / divisor, blue / divisor, 0);
-                            else
-                                memPtrLong[x] = 0;
-                        }
-                        lastPixelWasTransparent = true;
-                    } else {
-                        memPtrLong[x] = VMEMCOLOR_RGBA(algetr16(*srcData), algetg16(*srcData), algetb16(*srcData),
-                                                       0xFF);
-                        if (lastPixelWasTransparent) {
-                            // update the colour of the previous tranparent pixel, to
-                            // stop black outlines when linear filtering
-                            memPtrLong[x - 1] = memPtrLong[x] & 0x00FFFFFF;
-                            lastPixelWasTransparent = false;
-                        }
-                    }
-                }
+                const uint16_t *scanline_before = (y > 0) ?
+                    reinterpret_cast<const uint16_t*>(bitmap->GetScanLine(y + tile->y - 1)) + tile->x : nullptr;
+                const uint16_t *scanline_at = reinterpret_cast<const uint16_t*>(bitmap->GetScanLine(y + tile->y)) + tile->x;
+                const uint16_t *scanline_after = (y < tile->height - 1) ?
+                    reinterpret_cast<const uint16_t*>(bitmap->GetScanLine(y + tile->y + 1)) + tile->x : nullptr;
+                PixelConv::Row16ToVMem(scanline_at, scanline_before, scanline_after,
+                    reinterpret_cast<uint32_t*>(dst_ptr), tile->width, usingLinearFiltering, fmt);
                 dst_ptr += dst_pitch;
             }
         }
         break;
         case 32: {
+            const PixelConv::PixelFormat fmt = GetVMemPixelFormat(
+                _vmem_a_shift_32, _vmem_r_shift_32, _vmem_g_shift_32, _vmem_b_shift_32);
             for (int y = 0; y < tile->height; y++) {
-                lastPixelWasTransparent = false;
-                const uint8_t *scanline_before = (y > 0) ? bitmap->GetScanLine(y + tile->y - 1) : nullptr;
-                const uint8_t *scanline_at = bitmap->GetScanLine(y + tile->y);
-                const uint8_t *scanline_after = (y < tile->height - 1) ? bitmap->GetScanLine(y + tile->y + 1) : nullptr;
-                unsigned int *memPtrLong = (unsigned int *) dst_ptr;
-
-                for (int x = 0; x < tile->width; x++) {
-                    unsigned int *srcData = (unsigned int *) &scanline_at[(x + tile->x) * sizeof(int)];
-                    if (*srcData == MASK_COLOR_32) {
-                        if (!usingLinearFiltering)
-                            memPtrLong[x] = 0;
-                            // set to transparent, but use the colour from the neighbouring
-                            // pixel to stop the linear filter doing black outlines
-                        else {
-                            unsigned int red = 0, green = 0, blue = 0, divisor = 0;
-                            if (x > 0)
-                                get_pixel_if_not_transparent32(&srcData[-1], &red, &green, &blue, &divisor);
-                            if (x < tile->width - 1)
-                                get_pixel_if_not_transparent32(&srcData[1], &red, &green, &blue, &divisor);
-                            if (y > 0)
-                                get_pixel_if_not_transparent32(
-                                        (unsigned int *) &scanline_before[(x + tile->x) * sizeof(int)], &red, &green,
-                                        &blue, &divisor);
-                            if (y < tile->height - 1)
-                                get_pixel_if_not_transparent32(
-                                        (unsigned int *) &scanline_after[(x + tile->x) * sizeof(int)], &red, &green,
-                                        &blue, &divisor);
-                            if (divisor > 0)
-                                memPtrLong[x] = VMEMCOLOR_RGBA(red / divisor, green / divisor, blue / divisor, 0);
-                            else
-                                memPtrLong[x] = 0;
-                        }
-                        lastPixelWasTransparent = true;
-                    } else if (has_alpha) {
-                        memPtrLong[x] = VMEMCOLOR_RGBA(algetr32(*srcData), algetg32(*srcData), algetb32(*srcData),
-                                                       algeta32(*srcData));
-                    } else {
-                        memPtrLong[x] = VMEMCOLOR_RGBA(algetr32(*srcData), algetg32(*srcData), algetb32(*srcData),
-                                                       0xFF);
-                        if (lastPixelWasTransparent) {
-                            // update the colour of the previous tranparent pixel, to
-                            // stop black outlines when linear filtering
-                            memPtrLong[x - 1] = memPtrLong[x] & 0x00FFFFFF;
-                            lastPixelWasTransparent = false;
-                        }
-                    }
-                }
+                const uint32_t *scanline_before = (y > 0) ?
+                    reinterpret_cast<const uint32_t*>(bitmap->GetScanLine(y + tile->y - 1)) + tile->x : nullptr;
+                const uint32_t *scanline_at = reinterpret_cast<const uint32_t*>(bitmap->GetScanLine(y + tile->y)) + tile->x;
+                const uint32_t *scanline_after = (y < tile->height - 1) ?
+                    reinterpret_cast<const uint32_t*>(bitmap->GetScanLine(y + tile->y + 1)) + tile->x : nullptr;
+                PixelConv::Row32ToVMem(scanline_at, scanline_before, scanline_after,
+                    reinterpret_cast<uint32_t*>(dst_ptr), tile->width, has_alpha, usingLinearFiltering, fmt);
                 dst_ptr += dst_pitch;
             }
         }
@@ -652,44 +749,22 @@ void VideoMemoryGraphicsDriver::BitmapToVideoMemOpaque(const Bitmap *bitmap, con
         }
         break;
         case 16: {
+            const PixelConv::PixelFormat fmt = GetVMemPixelFormat(
+                _vmem_a_shift_32, _vmem_r_shift_32, _vmem_g_shift_32, _vmem_b_shift_32);
             for (int y = 0; y < tile->height; y++) {
-                const uint8_t *scanline_at = bitmap->GetScanLine(y + tile->y);
-                unsigned int *memPtrLong = (unsigned int *) dst_ptr;
-
-                for (int x = 0; x < tile->width; x++) {
-                    unsigned short *srcData = (unsigned short *) &scanline_at[(x + tile->x) * sizeof(short)];
-                    memPtrLong[x] = VMEMCOLOR_RGBA(algetr16(*srcData), algetg16(*srcData), algetb16(*srcData), 0xFF);
-                }
-
+                const uint16_t *scanline_at = reinterpret_cast<const uint16_t*>(bitmap->GetScanLine(y + tile->y)) + tile->x;
+                PixelConv::Row16ToVMemOpaque(scanline_at, reinterpret_cast<uint32_t*>(dst_ptr), tile->width, fmt);
                 dst_ptr += dst_pitch;
             }
         }
         break;
         case 32: {
-            if (has_alpha) {
-                for (int y = 0; y < tile->height; y++) {
-                    const uint8_t* scanline_at = bitmap->GetScanLine(y + tile->y);
-                    unsigned int* memPtrLong = (unsigned int*)dst_ptr;
-
-                    for (int x = 0; x < tile->width; x++) {
-                        unsigned int* srcData = (unsigned int*)&scanline_at[(x + tile->x) * sizeof(int)];
-                        memPtrLong[x] = VMEMCOLOR_RGBA(algetr32(*srcData), algetg32(*srcData), algetb32(*srcData),
-                            algeta32(*srcData));
-                    }
-                    dst_ptr += dst_pitch;
-                }
-            } else {
-                for (int y = 0; y < tile->height; y++) {
-                    const uint8_t* scanline_at = bitmap->GetScanLine(y + tile->y);
-                    unsigned int* memPtrLong = (unsigned int*)dst_ptr;
-
-                    for (int x = 0; x < tile->width; x++) {
-                        unsigned int* srcData = (unsigned int*)&scanline_at[(x + tile->x) * sizeof(int)];
-                        memPtrLong[x] = VMEMCOLOR_RGBA(algetr32(*srcData), algetg32(*srcData), algetb32(*srcData),
-                            0xFF);
-                    }
-                    dst_ptr += dst_pitch;
-                }
+            const PixelConv::PixelFormat fmt = GetVMemPixelFormat(
+                _vmem_a_shift_32, _vmem_r_shift_32, _vmem_g_shift_32, _vmem_b_shift_32);
+            for (int y = 0; y < tile->height; y++) {
+                const uint32_t *scanline_at = reinterpret_cast<const uint32_t*>(bitmap->GetScanLine(y + tile->y)) + tile->x;
+                PixelConv::Row32ToVMemOpaque(scanline_at, reinterpret_cast<uint32_t*>(dst_ptr), tile->width, has_alpha, fmt);
+                dst_ptr += dst_pitch;
             }
         }
         break;
@@ -18,7 +18,11 @@
 #ifndef __AGS_EE_GFX__GFXDRIVERBASE_H
 #define __AGS_EE_GFX__GFXDRIVERBASE_H
 
+#include <condition_variable>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include "gfx/ddb.h"
@@ -113,6 +117,8 @@ public:
 
     bool        SetVsync(bool enabled) override;
     bool        GetVsync() const override;
+    bool        SetRenderThread(bool /*enabled*/) override { return false; }
+    IDriverDependantBitmap *CreateSubDDB(IDriverDependantBitmap * /*parent*/, const Rect & /*area*/) override { return nullptr; }
 
     void        BeginSpriteBatch(const Rect &viewport, const SpriteTransform &transform,
                     Common::GraphicFlip flip = Common::kFlip_None, PBitmap surface = nullptr) override;
@@ -220,6 +226,9 @@ struct TextureData
 {
     uint32_t ID = UINT32_MAX;
     bool RenderTarget = false; // replace with flags later
+    // Texture data which resources this one refers to; such texture data
+    // does not own the resources, and may not be recycled
+    std::shared_ptr<TextureData> Parent;
     virtual ~TextureData() = default;
 protected:
     TextureData() = default;
@@ -239,6 +248,15 @@ enum TextureHint
     kTxHint_PremulAlpha  // texture pixels contain premultiplied alpha
 };
 
+// Texture recycling statistics
+struct TexturePoolStats
+{
+    uint32_t Created = 0u;  // new textures allocated by the driver
+    uint32_t Reused = 0u;   // allocations avoided by reusing pooled textures
+    uint32_t Released = 0u; // textures put into the pool after their last use
+    uint32_t Trimmed = 0u;  // pooled textures disposed to fit into the size limit
+};
+
 // Sprite batch's internal parameters for the hardware-accelerated renderer
 struct VMSpriteBatch
 {
@@ -299,7 +317,36 @@ public:
     // Sets stage screen parameters for the current batch.
     void SetStageScreen(const Size &sz, int x = 0, int y = 0) override;
 
+    // Sets the max size of the released textures kept for reuse, in bytes
+    void SetTexturePoolSize(size_t max_size) override;
+    // Gets the texture recycling statistics
+    const TexturePoolStats &GetTexturePoolStats() const { return _txPoolStats; }
+
+    // Starts or stops the render thread, if the renderer supports one
+    bool SetRenderThread(bool enabled) override;
+
 protected:
+    // Called just before the driver is uninitialized; reports texture pool statistics
+    void OnUnInit() override;
+
+    // Tells if this renderer is able to submit frames on a separate thread
+    virtual bool CanRenderOnThread() const { return false; }
+    // Renders and presents the last submitted frame; called on the render thread
+    virtual void RenderSubmittedFrame() {}
+    // Attaches or detaches the rendering context to the calling thread
+    virtual void SetRenderContextCurrent(bool /*current*/) {}
+    // Tells if the render thread is currently running
+    bool IsRenderThreadRunning() const { return _renderThreadRunning; }
+    // Stops the render thread, if it was running, after it finishes the last frame
+    void StopRenderThread();
+    // Passes the recorded frame to the render thread; the rendering context
+    // is detached from the calling thread until WaitForRenderThread is called
+    void SubmitToRenderThread();
+    // Waits until the render thread finishes the submitted frame, if any,
+    // and attaches the rendering context back to the calling thread.
+    // Must be called before any operation on the renderer's resources.
+    void WaitForRenderThread();
+
     // Create texture data with the given parameters
     virtual TextureData *CreateTextureData(int width, int height, bool opaque, bool as_render_target = false) = 0;
     // Update texture data from the given bitmap
@@ -311,6 +358,12 @@ protected:
     virtual std::shared_ptr<TextureData> GetTextureData(IDriverDependantBitmap *ddb) = 0;
     virtual void DestroyDDBImpl(IDriverDependantBitmap* ddb) = 0;
 
+    // Gets a released texture data of matching size and format from the pool,
+    // or creates a new one if there's none available
+    std::shared_ptr<TextureData> AcquireTextureData(int width, int height, bool opaque, bool as_render_target = false);
+    // Disposes all the textures in the pool
+    void DestroyTexturePool();
+
     // Stage screens are raw bitmap buffers meant to be sent to plugins on demand
     // at certain drawing stages. If used at least once these buffers are then
     // rendered as additional sprites in their respected order.
@@ -354,6 +407,19 @@ protected:
     int _vmem_b_shift_32;
 
 private:
+    // Render thread's entry point
+    void RenderThreadLoop();
+
+    // Render thread receives recorded frames from the game thread, then draws
+    // and presents them, while the game thread may proceed with the next update.
+    std::thread _renderThread;
+    std::mutex _renderMutex;
+    std::condition_variable _renderCv;
+    bool _renderThreadRunning = false; // accessed only by the game thread
+    bool _renderFrameSubmitted = false; // accessed only by the game thread
+    bool _renderFramePending = false; // frame waiting to be rendered, guarded by mutex
+    bool _renderThreadExit = false; // guarded by mutex
+
     // Stage virtual screens are used to let plugins draw custom graphics
     // in between render stages (between room and GUI, after GUI, and so on).
     // TODO: possibly may be optimized further by having only 1 bitmap/ddb
@@ -386,8 +452,6 @@ private:
     // - this lets to share same texture data among multiple sprites on screen.
     // TextureCacheItem stores weak references to the existing texture tiles,
     // identified by an arbitrary uint32 number.
-    // TODO: a curious topic to consider: reuse released TextureData for
-    // textures of the same size (research potential performance impact).
     struct TextureCacheItem
     {
         GraphicResolution Res;
@@ -397,6 +461,37 @@ private:
             : Data(data), Res(res) {}
     };
     std::unordered_map<uint32_t, TextureCacheItem> _txRefs;
+
+    // Texture recycling pool:
+    // - keeps texture data released by the last DDB that referenced it;
+    // - lets reuse it for the new texture of the same size and format,
+    //   instead of allocating video memory again.
+    // The list is ordered from the least to the most recently released item,
+    // and is trimmed starting from the oldest when exceeding the size limit.
+    struct TexturePoolItem
+    {
+        uint64_t Key = 0u;
+        size_t Size = 0u; // approximate size in video memory
+        std::shared_ptr<TextureData> Data;
+        TexturePoolItem() = default;
+        TexturePoolItem(uint64_t key, size_t size, std::shared_ptr<TextureData> data)
+            : Key(key), Size(size), Data(data) {}
+    };
+    typedef std::list<TexturePoolItem> TexturePoolList;
+
+    // Makes a pool's key from texture parameters
+    static uint64_t MakeTexturePoolKey(int width, int height, bool opaque, bool as_render_target);
+    // Puts the released texture data into the pool, trims the pool if necessary
+    void ReleaseToTexturePool(std::shared_ptr<TextureData> txdata, int width, int height, bool opaque);
+    // Disposes the oldest pooled items until the pool's size fits in the given limit
+    void TrimTexturePool(size_t max_size);
+
+    TexturePoolList _txPool;
+    // Lookup of pooled items by their size and format
+    std::unordered_multimap<uint64_t, TexturePoolList::iterator> _txPoolLookup;
+    size_t _txPoolSize = 0u;
+    size_t _txPoolMaxSize = 0u;
+    TexturePoolStats _txPoolStats;
 };
 
 } // namespace Engine
@@ -135,8 +135,17 @@ public:
   // Updates DBB using the given bitmap; bitmap must have same size and format
   // as the one that this DDB was initialized with.
   virtual void UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap, bool hasAlpha) = 0;
+  // Updates only the given area of the DDB from the same area of the bitmap;
+  // bitmap must have same size and format as the one that this DDB was initialized with.
+  virtual void UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Common::Bitmap *bitmap,
+      const Rect &area, bool hasAlpha) = 0;
   // Destroy the DDB.
   virtual void DestroyDDB(IDriverDependantBitmap* bitmap) = 0;
+  // Creates DDB which displays a part of another DDB's texture, without copying it;
+  // any updates to the parent's texture are seen by this DDB too.
+  // Returns null if the driver does not support this, or the parent's texture
+  // is not suitable for sharing (e.g. is split into several tiles).
+  virtual IDriverDependantBitmap *CreateSubDDB(IDriverDependantBitmap *parent, const Rect &area) = 0;
 
   // Get shared texture from cache, or create from bitmap and assign ID
   // FIXME: opaque should be either texture data's flag, - in which case same sprite_id
@@ -148,6 +157,10 @@ public:
   virtual void UpdateSharedDDB(uint32_t sprite_id, Common::Bitmap *bitmap = nullptr, bool hasAlpha = true, bool opaque = false) = 0;
   // Removes the shared texture reference, will force the texture to recreate next time
   virtual void ClearSharedDDB(uint32_t sprite_id) = 0;
+  // Sets the max size of the released textures that may be kept for reuse, in bytes;
+  // textures of the same size and format are then recycled instead of allocated anew.
+  // Passing 0 disables texture recycling.
+  virtual void SetTexturePoolSize(size_t max_size) = 0;
 
   // Prepares next sprite batch, a list of sprites with defined viewport and optional
   // global model transformation; all subsequent calls to DrawSprite will be adding
@@ -195,6 +208,10 @@ public:
   virtual bool SetVsync(bool enabled) = 0;
   // Tells if the renderer currently has vsync enabled.
   virtual bool GetVsync() const = 0;
+  // Enables or disables submitting frames on a separate render thread, if renderer
+  // supports one; returns the *new state*. When enabled, Render() records the
+  // frame and returns without waiting for it to be drawn and presented.
+  virtual bool SetRenderThread(bool enabled) = 0;
   // Enables or disables rendering mode that draws sprite list directly into
   // the final resolution, as opposed to drawing to native-resolution buffer
   // and scaling to final frame. The effect may be that sprites that are
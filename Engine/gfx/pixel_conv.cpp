@@ -0,0 +1,503 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+#include "gfx/pixel_conv.h"
+#include <algorithm>
+#include <SDL_cpuinfo.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define AGS_PIXELCONV_SSE2 1
+#include <emmintrin.h>
+#else
+#define AGS_PIXELCONV_SSE2 0
+#endif
+
+namespace AGS
+{
+namespace Engine
+{
+namespace PixelConv
+{
+
+// NOTE: these are the "magic pink" colors, same as allegro's MASK_COLOR_16/32
+const uint16_t MaskColor16 = 0xF81F;
+const uint32_t MaskColor32 = 0x00FF00FF;
+
+static SimdLevel UseSimd = DetectSimdLevel();
+
+SimdLevel DetectSimdLevel()
+{
+#if AGS_PIXELCONV_SSE2
+    if (SDL_HasSSE2())
+        return kSimd_SSE2;
+#endif
+    return kSimd_None;
+}
+
+SimdLevel GetSimdLevel()
+{
+    return UseSimd;
+}
+
+void SetSimdLevel(SimdLevel level)
+{
+    UseSimd = std::min(level, DetectSimdLevel());
+}
+
+
+//-----------------------------------------------------------------------------
+// Plain implementation
+//-----------------------------------------------------------------------------
+
+inline uint32_t VMemColor(const PixelFormat &fmt, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    return ((a & 0xFF) << fmt.DstA) | ((r & 0xFF) << fmt.DstR) | ((g & 0xFF) << fmt.DstG) | ((b & 0xFF) << fmt.DstB);
+}
+
+// 5 and 6 bit components are expanded to 8 bit by replicating their high bits;
+// this gives same results as allegro's _rgb_scale_5 and _rgb_scale_6 tables.
+inline uint32_t Scale5(uint32_t c) { return (c << 3) | (c >> 2); }
+inline uint32_t Scale6(uint32_t c) { return (c << 2) | (c >> 4); }
+
+inline uint32_t GetR16(const PixelFormat &fmt, uint16_t c) { return Scale5((c >> fmt.SrcR16) & 0x1F); }
+inline uint32_t GetG16(const PixelFormat &fmt, uint16_t c) { return Scale6((c >> fmt.SrcG16) & 0x3F); }
+inline uint32_t GetB16(const PixelFormat &fmt, uint16_t c) { return Scale5((c >> fmt.SrcB16) & 0x1F); }
+inline uint32_t GetR32(const PixelFormat &fmt, uint32_t c) { return (c >> fmt.SrcR32) & 0xFF; }
+inline uint32_t GetG32(const PixelFormat &fmt, uint32_t c) { return (c >> fmt.SrcG32) & 0xFF; }
+inline uint32_t GetB32(const PixelFormat &fmt, uint32_t c) { return (c >> fmt.SrcB32) & 0xFF; }
+inline uint32_t GetA32(const PixelFormat &fmt, uint32_t c) { return (c >> fmt.SrcA32) & 0xFF; }
+
+inline void AddPixel16(const PixelFormat &fmt, uint16_t c, uint32_t &r, uint32_t &g, uint32_t &b, uint32_t &div)
+{
+    if (c != MaskColor16)
+    {
+        r += GetR16(fmt, c);
+        g += GetG16(fmt, c);
+        b += GetB16(fmt, c);
+        div++;
+    }
+}
+
+inline void AddPixel32(const PixelFormat &fmt, uint32_t c, uint32_t &r, uint32_t &g, uint32_t &b, uint32_t &div)
+{
+    if (c != MaskColor32)
+    {
+        r += GetR32(fmt, c);
+        g += GetG32(fmt, c);
+        b += GetB32(fmt, c);
+        div++;
+    }
+}
+
+// Returns a transparent pixel of an average colour of the 16-bit pixel's
+// non-transparent neighbours; used to stop the linear filter doing black outlines
+static uint32_t Neighbours16(const uint16_t *src, const uint16_t *src_before, const uint16_t *src_after,
+    int width, int x, const PixelFormat &fmt)
+{
+    uint32_t r = 0, g = 0, b = 0, div = 0;
+    if (x > 0)
+        AddPixel16(fmt, src[x - 1], r, g, b, div);
+    if (x < width - 1)
+        AddPixel16(fmt, src[x + 1], r, g, b, div);
+    if (src_before)
+        AddPixel16(fmt, src_before[x], r, g, b, div);
+    if (src_after)
+        AddPixel16(fmt, src_after[x], r, g, b, div);
+    return (div > 0) ? VMemColor(fmt, r / div, g / div, b / div, 0) : 0;
+}
+
+// Same as Neighbours16, but for a 32-bit pixel
+static uint32_t Neighbours32(const uint32_t *src, const uint32_t *src_before, const uint32_t *src_after,
+    int width, int x, const PixelFormat &fmt)
+{
+    uint32_t r = 0, g = 0, b = 0, div = 0;
+    if (x > 0)
+        AddPixel32(fmt, src[x - 1], r, g, b, div);
+    if (x < width - 1)
+        AddPixel32(fmt, src[x + 1], r, g, b, div);
+    if (src_before)
+        AddPixel32(fmt, src_before[x], r, g, b, div);
+    if (src_after)
+        AddPixel32(fmt, src_after[x], r, g, b, div);
+    return (div > 0) ? VMemColor(fmt, r / div, g / div, b / div, 0) : 0;
+}
+
+// Converts pixels in the [from, to) range of a 16-bit row
+static void Span16ToVMem(const uint16_t *src, const uint16_t *src_before, const uint16_t *src_after,
+    uint32_t *dst, int width, int from, int to, bool linear_filter, const PixelFormat &fmt)
+{
+    bool last_transparent = (from > 0) && (src[from - 1] == MaskColor16);
+    for (int x = from; x < to; ++x)
+    {
+        const uint16_t c = src[x];
+        if (c == MaskColor16)
+        {
+            if (!linear_filter)
+            {
+                dst[x] = 0;
+            }
+            else
+            {
+                dst[x] = Neighbours16(src, src_before, src_after, width, x, fmt);
+            }
+            last_transparent = true;
+        }
+        else
+        {
+            dst[x] = VMemColor(fmt, GetR16(fmt, c), GetG16(fmt, c), GetB16(fmt, c), 0xFF);
+            if (last_transparent)
+            {
+                // update the colour of the previous tranparent pixel, to
+                // stop black outlines when linear filtering
+                dst[x - 1] = dst[x] & 0x00FFFFFF;
+                last_transparent = false;
+            }
+        }
+    }
+}
+
+// Converts pixels in the [from, to) range of a 32-bit row
+static void Span32ToVMem(const uint32_t *src, const uint32_t *src_before, const uint32_t *src_after,
+    uint32_t *dst, int width, int from, int to, bool has_alpha, bool linear_filter, const PixelFormat &fmt)
+{
+    bool last_transparent = (from > 0) && (src[from - 1] == MaskColor32);
+    for (int x = from; x < to; ++x)
+    {
+        const uint32_t c = src[x];
+        if (c == MaskColor32)
+        {
+            if (!linear_filter)
+            {
+                dst[x] = 0;
+            }
+            else
+            {
+                dst[x] = Neighbours32(src, src_before, src_after, width, x, fmt);
+            }
+            last_transparent = true;
+        }
+        else if (has_alpha)
+        {
+            dst[x] = VMemColor(fmt, GetR32(fmt, c), GetG32(fmt, c), GetB32(fmt, c), GetA32(fmt, c));
+        }
+        else
+        {
+            dst[x] = VMemColor(fmt, GetR32(fmt, c), GetG32(fmt, c), GetB32(fmt, c), 0xFF);
+            if (last_transparent)
+            {
+                // update the colour of the previous tranparent pixel, to
+                // stop black outlines when linear filtering
+                dst[x - 1] = dst[x] & 0x00FFFFFF;
+                last_transparent = false;
+            }
+        }
+    }
+}
+
+static void Span16ToVMemOpaque(const uint16_t *src, uint32_t *dst, int from, int to, const PixelFormat &fmt)
+{
+    for (int x = from; x < to; ++x)
+        dst[x] = VMemColor(fmt, GetR16(fmt, src[x]), GetG16(fmt, src[x]), GetB16(fmt, src[x]), 0xFF);
+}
+
+static void Span32ToVMemOpaque(const uint32_t *src, uint32_t *dst, int from, int to, bool has_alpha, const PixelFormat &fmt)
+{
+    if (has_alpha)
+    {
+        for (int x = from; x < to; ++x)
+            dst[x] = VMemColor(fmt, GetR32(fmt, src[x]), GetG32(fmt, src[x]), GetB32(fmt, src[x]), GetA32(fmt, src[x]));
+    }
+    else
+    {
+        for (int x = from; x < to; ++x)
+            dst[x] = VMemColor(fmt, GetR32(fmt, src[x]), GetG32(fmt, src[x]), GetB32(fmt, src[x]), 0xFF);
+    }
+}
+
+
+//-----------------------------------------------------------------------------
+// SSE2 implementation
+//-----------------------------------------------------------------------------
+#if AGS_PIXELCONV_SSE2
+
+// Prepared shift counts and constants for SSE2 conversion
+struct SSE2Format
+{
+    __m128i SrcR16, SrcG16, SrcB16;
+    __m128i SrcR32, SrcG32, SrcB32, SrcA32;
+    __m128i DstR, DstG, DstB, DstA;
+    __m128i OpaqueAlpha;
+
+    SSE2Format(const PixelFormat &fmt)
+    {
+        SrcR16 = _mm_cvtsi32_si128(fmt.SrcR16);
+        SrcG16 = _mm_cvtsi32_si128(fmt.SrcG16);
+        SrcB16 = _mm_cvtsi32_si128(fmt.SrcB16);
+        SrcR32 = _mm_cvtsi32_si128(fmt.SrcR32);
+        SrcG32 = _mm_cvtsi32_si128(fmt.SrcG32);
+        SrcB32 = _mm_cvtsi32_si128(fmt.SrcB32);
+        SrcA32 = _mm_cvtsi32_si128(fmt.SrcA32);
+        DstR = _mm_cvtsi32_si128(fmt.DstR);
+        DstG = _mm_cvtsi32_si128(fmt.DstG);
+        DstB = _mm_cvtsi32_si128(fmt.DstB);
+        DstA = _mm_cvtsi32_si128(fmt.DstA);
+        OpaqueAlpha = _mm_set1_epi32(static_cast<int>(0xFFu << fmt.DstA));
+    }
+};
+
+inline __m128i Channel(__m128i c, __m128i shift, __m128i mask)
+{
+    return _mm_and_si128(_mm_srl_epi32(c, shift), mask);
+}
+
+// Converts 4 32-bit pixels into video memory format
+inline __m128i Conv32x4(__m128i c, const SSE2Format &f, bool has_alpha)
+{
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+    __m128i res = _mm_or_si128(
+        _mm_or_si128(_mm_sll_epi32(Channel(c, f.SrcR32, mask8), f.DstR),
+                     _mm_sll_epi32(Channel(c, f.SrcG32, mask8), f.DstG)),
+        _mm_sll_epi32(Channel(c, f.SrcB32, mask8), f.DstB));
+    if (has_alpha)
+        return _mm_or_si128(res, _mm_sll_epi32(Channel(c, f.SrcA32, mask8), f.DstA));
+    return _mm_or_si128(res, f.OpaqueAlpha);
+}
+
+// Converts 4 16-bit pixels, zero-extended to 32 bits, into video memory format
+inline __m128i Conv16x4(__m128i c, const SSE2Format &f)
+{
+    const __m128i mask5 = _mm_set1_epi32(0x1F);
+    const __m128i mask6 = _mm_set1_epi32(0x3F);
+    __m128i r = Channel(c, f.SrcR16, mask5);
+    __m128i g = Channel(c, f.SrcG16, mask6);
+    __m128i b = Channel(c, f.SrcB16, mask5);
+    r = _mm_or_si128(_mm_slli_epi32(r, 3), _mm_srli_epi32(r, 2));
+    g = _mm_or_si128(_mm_slli_epi32(g, 2), _mm_srli_epi32(g, 4));
+    b = _mm_or_si128(_mm_slli_epi32(b, 3), _mm_srli_epi32(b, 2));
+    return _mm_or_si128(
+        _mm_or_si128(_mm_sll_epi32(r, f.DstR), _mm_sll_epi32(g, f.DstG)),
+        _mm_or_si128(_mm_sll_epi32(b, f.DstB), f.OpaqueAlpha));
+}
+
+static void Row16ToVMemSSE2(const uint16_t *src, const uint16_t *src_before, const uint16_t *src_after,
+    uint32_t *dst, int width, bool linear_filter, const PixelFormat &fmt)
+{
+    const SSE2Format f(fmt);
+    const __m128i mask_color = _mm_set1_epi16(static_cast<short>(MaskColor16));
+    const __m128i last_lane = _mm_set_epi16(-1, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i first_mask = _mm_set_epi16(0, 0, 0, 0, 0, 0, 0, static_cast<short>(MaskColor16));
+    const __m128i last_mask = _mm_set_epi16(static_cast<short>(MaskColor16), 0, 0, 0, 0, 0, 0, 0);
+    const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i lo = Conv16x4(_mm_unpacklo_epi16(c, zero), f);
+        __m128i hi = Conv16x4(_mm_unpackhi_epi16(c, zero), f);
+        const __m128i is_mask = _mm_cmpeq_epi16(c, mask_color);
+        if (_mm_movemask_epi8(is_mask) != 0)
+        {
+            // Transparent pixels are zeroed, except those followed by an opaque
+            // pixel, which receive its colour to stop black outlines when linear
+            // filtering; the last pixel is fixed up when the next block is done.
+            const __m128i next_mask = _mm_or_si128(_mm_srli_si128(is_mask, 2), last_lane);
+            const __m128i fixup = _mm_andnot_si128(next_mask, is_mask);
+            const __m128i next_lo = _mm_or_si128(_mm_srli_si128(lo, 4), _mm_slli_si128(hi, 12));
+            const __m128i next_hi = _mm_srli_si128(hi, 4);
+            const __m128i fill_lo = _mm_and_si128(_mm_unpacklo_epi16(fixup, fixup), _mm_and_si128(next_lo, rgb_mask));
+            const __m128i fill_hi = _mm_and_si128(_mm_unpackhi_epi16(fixup, fixup), _mm_and_si128(next_hi, rgb_mask));
+            lo = _mm_or_si128(_mm_andnot_si128(_mm_unpacklo_epi16(is_mask, is_mask), lo), fill_lo);
+            hi = _mm_or_si128(_mm_andnot_si128(_mm_unpackhi_epi16(is_mask, is_mask), hi), fill_hi);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4), hi);
+            if (linear_filter)
+            {
+                // Transparent pixels which are not fixed up, but have opaque
+                // neighbours, receive their average colour
+                const __m128i left = (x > 0) ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x - 1)) :
+                    _mm_or_si128(_mm_slli_si128(c, 2), first_mask);
+                const __m128i right = (x + 8 < width) ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 1)) :
+                    _mm_or_si128(_mm_srli_si128(c, 2), last_mask);
+                __m128i all_masked = _mm_and_si128(_mm_cmpeq_epi16(left, mask_color), _mm_cmpeq_epi16(right, mask_color));
+                if (src_before)
+                    all_masked = _mm_and_si128(all_masked,
+                        _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_before + x)), mask_color));
+                if (src_after)
+                    all_masked = _mm_and_si128(all_masked,
+                        _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_after + x)), mask_color));
+                const __m128i blend = _mm_andnot_si128(_mm_or_si128(all_masked, fixup), is_mask);
+                for (int lanes = _mm_movemask_epi8(blend), i = 0; lanes != 0; lanes >>= 2, ++i)
+                {
+                    if (lanes & 0x1)
+                        dst[x + i] = Neighbours16(src, src_before, src_after, width, x + i, fmt);
+                }
+            }
+        }
+        else
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4), hi);
+        }
+        // update the colour of the previous tranparent pixel
+        if ((x > 0) && (src[x - 1] == MaskColor16) && (src[x] != MaskColor16))
+            dst[x - 1] = dst[x] & 0x00FFFFFF;
+    }
+    Span16ToVMem(src, src_before, src_after, dst, width, x, width, linear_filter, fmt);
+}
+
+static void Row32ToVMemSSE2(const uint32_t *src, const uint32_t *src_before, const uint32_t *src_after,
+    uint32_t *dst, int width, bool has_alpha, bool linear_filter, const PixelFormat &fmt)
+{
+    const SSE2Format f(fmt);
+    const __m128i mask_color = _mm_set1_epi32(static_cast<int>(MaskColor32));
+    const __m128i last_lane = _mm_set_epi32(-1, 0, 0, 0);
+    const __m128i first_mask = _mm_set_epi32(0, 0, 0, static_cast<int>(MaskColor32));
+    const __m128i last_mask = _mm_set_epi32(static_cast<int>(MaskColor32), 0, 0, 0);
+    const __m128i rgb_mask = _mm_set1_epi32(0x00FFFFFF);
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        __m128i res = Conv32x4(c, f, has_alpha);
+        const __m128i is_mask = _mm_cmpeq_epi32(c, mask_color);
+        if (_mm_movemask_epi8(is_mask) != 0)
+        {
+            // Transparent pixels are zeroed; without alpha channel those followed
+            // by an opaque pixel receive its colour, see Row16ToVMemSSE2
+            __m128i fixup = _mm_setzero_si128();
+            res = _mm_andnot_si128(is_mask, res);
+            if (!has_alpha)
+            {
+                fixup = _mm_andnot_si128(_mm_or_si128(_mm_srli_si128(is_mask, 4), last_lane), is_mask);
+                res = _mm_or_si128(res, _mm_and_si128(fixup, _mm_and_si128(_mm_srli_si128(res, 4), rgb_mask)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), res);
+            if (linear_filter)
+            {
+                const __m128i left = (x > 0) ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x - 1)) :
+                    _mm_or_si128(_mm_slli_si128(c, 4), first_mask);
+                const __m128i right = (x + 4 < width) ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x + 1)) :
+                    _mm_or_si128(_mm_srli_si128(c, 4), last_mask);
+                __m128i all_masked = _mm_and_si128(_mm_cmpeq_epi32(left, mask_color), _mm_cmpeq_epi32(right, mask_color));
+                if (src_before)
+                    all_masked = _mm_and_si128(all_masked,
+                        _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_before + x)), mask_color));
+                if (src_after)
+                    all_masked = _mm_and_si128(all_masked,
+                        _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src_after + x)), mask_color));
+                const __m128i blend = _mm_andnot_si128(_mm_or_si128(all_masked, fixup), is_mask);
+                for (int lanes = _mm_movemask_epi8(blend), i = 0; lanes != 0; lanes >>= 4, ++i)
+                {
+                    if (lanes & 0x1)
+                        dst[x + i] = Neighbours32(src, src_before, src_after, width, x + i, fmt);
+                }
+            }
+        }
+        else
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), res);
+        }
+        // update the colour of the previous tranparent pixel
+        if (!has_alpha && (x > 0) && (src[x - 1] == MaskColor32) && (src[x] != MaskColor32))
+            dst[x - 1] = dst[x] & 0x00FFFFFF;
+    }
+    Span32ToVMem(src, src_before, src_after, dst, width, x, width, has_alpha, linear_filter, fmt);
+}
+
+static void Row16ToVMemOpaqueSSE2(const uint16_t *src, uint32_t *dst, int width, const PixelFormat &fmt)
+{
+    const SSE2Format f(fmt);
+    const __m128i zero = _mm_setzero_si128();
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), Conv16x4(_mm_unpacklo_epi16(c, zero), f));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x + 4), Conv16x4(_mm_unpackhi_epi16(c, zero), f));
+    }
+    Span16ToVMemOpaque(src, dst, x, width, fmt);
+}
+
+static void Row32ToVMemOpaqueSSE2(const uint32_t *src, uint32_t *dst, int width, bool has_alpha, const PixelFormat &fmt)
+{
+    const SSE2Format f(fmt);
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), Conv32x4(c, f, has_alpha));
+    }
+    Span32ToVMemOpaque(src, dst, x, width, has_alpha, fmt);
+}
+
+#endif // AGS_PIXELCONV_SSE2
+
+
+//-----------------------------------------------------------------------------
+// Dispatch
+//-----------------------------------------------------------------------------
+
+void Row16ToVMem(const uint16_t *src, const uint16_t *src_before, const uint16_t *src_after,
+    uint32_t *dst, int width, bool linear_filter, const PixelFormat &fmt)
+{
+#if AGS_PIXELCONV_SSE2
+    if (UseSimd == kSimd_SSE2)
+    {
+        Row16ToVMemSSE2(src, src_before, src_after, dst, width, linear_filter, fmt);
+        return;
+    }
+#endif
+    Span16ToVMem(src, src_before, src_after, dst, width, 0, width, linear_filter, fmt);
+}
+
+void Row32ToVMem(const uint32_t *src, const uint32_t *src_before, const uint32_t *src_after,
+    uint32_t *dst, int width, bool has_alpha, bool linear_filter, const PixelFormat &fmt)
+{
+#if AGS_PIXELCONV_SSE2
+    if (UseSimd == kSimd_SSE2)
+    {
+        Row32ToVMemSSE2(src, src_before, src_after, dst, width, has_alpha, linear_filter, fmt);
+        return;
+    }
+#endif
+    Span32ToVMem(src, src_before, src_after, dst, width, 0, width, has_alpha, linear_filter, fmt);
+}
+
+void Row16ToVMemOpaque(const uint16_t *src, uint32_t *dst, int width, const PixelFormat &fmt)
+{
+#if AGS_PIXELCONV_SSE2
+    if (UseSimd == kSimd_SSE2)
+    {
+        Row16ToVMemOpaqueSSE2(src, dst, width, fmt);
+        return;
+    }
+#endif
+    Span16ToVMemOpaque(src, dst, 0, width, fmt);
+}
+
+void Row32ToVMemOpaque(const uint32_t *src, uint32_t *dst, int width, bool has_alpha, const PixelFormat &fmt)
+{
+#if AGS_PIXELCONV_SSE2
+    if (UseSimd == kSimd_SSE2)
+    {
+        Row32ToVMemOpaqueSSE2(src, dst, width, has_alpha, fmt);
+        return;
+    }
+#endif
+    Span32ToVMemOpaque(src, dst, 0, width, has_alpha, fmt);
+}
+
+} // namespace PixelConv
+} // namespace Engine
+} // namespace AGS
@@ -0,0 +1,76 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Pixel row conversion from 16-bit and 32-bit bitmaps into the 32-bit
+// video memory format, used when filling hardware textures.
+//
+// Each function has a plain implementation and a vectorized one, which
+// produce identical results; the vectorized variant is selected at runtime
+// depending on the CPU features.
+//
+//=============================================================================
+#ifndef __AGS_EE_GFX__PIXELCONV_H
+#define __AGS_EE_GFX__PIXELCONV_H
+
+#include "core/types.h"
+
+namespace AGS
+{
+namespace Engine
+{
+namespace PixelConv
+{
+
+// Vector instruction sets, supported by the conversion functions
+enum SimdLevel
+{
+    kSimd_None,
+    kSimd_SSE2
+};
+
+// Component shifts of the source bitmap pixels and video memory pixels
+struct PixelFormat
+{
+    int SrcR16 = 11, SrcG16 = 5, SrcB16 = 0;
+    int SrcR32 = 16, SrcG32 = 8, SrcB32 = 0, SrcA32 = 24;
+    int DstR = 16, DstG = 8, DstB = 0, DstA = 24;
+};
+
+// Tells the best instruction set supported by both this build and the CPU
+SimdLevel DetectSimdLevel();
+// Gets the instruction set currently used by the conversion functions
+SimdLevel GetSimdLevel();
+// Sets the instruction set to use; the level is limited by the detected one
+void SetSimdLevel(SimdLevel level);
+
+// Converts a row of 16-bit pixels, turning "mask color" into transparency.
+// If the linear filtering is used, then transparent pixels receive the
+// average color of their non-transparent neighbours, which requires previous
+// and next source rows (may be null if there's none).
+void Row16ToVMem(const uint16_t *src, const uint16_t *src_before, const uint16_t *src_after,
+    uint32_t *dst, int width, bool linear_filter, const PixelFormat &fmt);
+// Converts a row of 32-bit pixels, turning "mask color" into transparency;
+// see Row16ToVMem for the meaning of arguments.
+void Row32ToVMem(const uint32_t *src, const uint32_t *src_before, const uint32_t *src_after,
+    uint32_t *dst, int width, bool has_alpha, bool linear_filter, const PixelFormat &fmt);
+// Converts a row of 16-bit pixels, ignoring "mask color"
+void Row16ToVMemOpaque(const uint16_t *src, uint32_t *dst, int width, const PixelFormat &fmt);
+// Converts a row of 32-bit pixels, ignoring "mask color"
+void Row32ToVMemOpaque(const uint32_t *src, uint32_t *dst, int width, bool has_alpha, const PixelFormat &fmt);
+
+} // namespace PixelConv
+} // namespace Engine
+} // namespace AGS
+
+#endif // __AGS_EE_GFX__PIXELCONV_H
@@ -327,6 +327,7 @@ void apply_config(const ConfigTree &cfg)
         usetup.Screen.Params.VSync = CfgReadBoolInt(cfg, "graphics", "vsync");
         usetup.RenderAtScreenRes = CfgReadBoolInt(cfg, "graphics", "render_at_screenres");
         usetup.Supersampling = CfgReadInt(cfg, "graphics", "supersampling", 1);
+        usetup.RenderThread = CfgReadBoolInt(cfg, "graphics", "render_thread", usetup.RenderThread);
         usetup.software_render_driver = CfgReadString(cfg, "graphics", "software_driver");
 
         usetup.rotation = (ScreenRotation)CfgReadInt(cfg, "graphics", "rotation", usetup.rotation);
@@ -342,6 +343,8 @@ void apply_config(const ConfigTree &cfg)
         usetup.user_data_dir = CfgReadString(cfg, "misc", "user_data_dir");
         usetup.shared_data_dir = CfgReadString(cfg, "misc", "shared_data_dir");
         usetup.show_fps = CfgReadBoolInt(cfg, "misc", "show_fps");
+        usetup.NavGraph = CfgReadBoolInt(cfg, "misc", "pathfinder_graph", usetup.NavGraph);
+        usetup.PathfinderThreads = CfgReadInt(cfg, "misc", "pathfinder_threads", usetup.PathfinderThreads);
 
         // Translation / localization
         usetup.translation = CfgReadString(cfg, "language", "translation");
@@ -351,12 +354,21 @@ void apply_config(const ConfigTree &cfg)
         int size_kb = CfgReadInt(cfg, "misc", "cachemax", DEFAULTCACHESIZE_KB);
         if (size_kb > 0)
             usetup.SpriteCacheSize = size_kb * 1024;
+        size_kb = CfgReadInt(cfg, "graphics", "texture_pool", DEFAULT_TEXTUREPOOLSIZE_KB);
+        if (size_kb >= 0)
+            usetup.TexturePoolSize = size_kb * 1024;
         size_kb = CfgReadInt(cfg, "sound", "cache_size", DEFAULT_SOUNDCACHESIZE_KB);
         if (size_kb > 0)
             usetup.SoundCacheSize = size_kb * 1024;
         size_kb = CfgReadInt(cfg, "sound", "stream_threshold", DEFAULT_SOUNDLOADATONCE_KB);
         if (size_kb > 0)
             usetup.SoundLoadAtOnceSize = size_kb * 1024;
+        size_kb = CfgReadInt(cfg, "sound", "decoded_cache_size", DEFAULT_SOUNDDECODEDCACHE_KB);
+        if (size_kb >= 0)
+            usetup.SoundDecodedCacheSize = size_kb * 1024;
+        usetup.SoundDecodedMaxLength = CfgReadInt(cfg, "sound", "decoded_max_length", DEFAULT_SOUNDDECODEDMAXLEN_MS);
+        usetup.AudioDecoderThreads = CfgReadInt(cfg, "sound", "decoder_threads", usetup.AudioDecoderThreads);
+        usetup.VoicePrefetch = CfgReadInt(cfg, "sound", "voice_prefetch", usetup.VoicePrefetch);
 
         // Mouse options
         usetup.mouse_auto_lock = CfgReadBoolInt(cfg, "mouse", "auto_lock");
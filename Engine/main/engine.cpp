@@ -386,7 +386,7 @@ void engine_init_audio()
         if (res)
         {
             try {
-                audio_core_init(); // audio core system
+                audio_core_init(usetup.AudioDecoderThreads); // audio core system
             }
             catch (std::runtime_error ex) {
                 Debug::Printf(kDbgMsg_Error, "Failed to initialize audio system: %s", ex.what());
@@ -399,6 +399,8 @@ void engine_init_audio()
     if (usetup.audio_enabled)
     {
         soundcache_set_rules(usetup.SoundLoadAtOnceSize, usetup.SoundCacheSize);
+        soundcache_set_decoded_rules(usetup.SoundDecodedCacheSize, (float)usetup.SoundDecodedMaxLength);
+        set_voice_prefetch(usetup.VoicePrefetch);
     }
     else
     {
@@ -449,6 +451,11 @@ void engine_init_rand()
 void engine_init_pathfinder()
 {
     init_pathfinder(loaded_game_file_version);
+    if (usetup.PathfinderThreads > 0)
+    {
+        Debug::Printf(kDbgMsg_Info, "Pathfinder: using %d background thread(s)", usetup.PathfinderThreads);
+        set_route_async_threads(usetup.PathfinderThreads);
+    }
 }
 
 void engine_pre_init_gfx()
@@ -166,6 +166,9 @@ void engine_post_gfxmode_driver_setup()
     gfxDriver->SetCallbackForPolling(update_polled_stuff);
     gfxDriver->SetCallbackToDrawScreen(draw_game_screen_callback, construct_engine_overlay);
     gfxDriver->SetCallbackOnSpriteEvt(GfxDriverSpriteEvtCallback);
+    gfxDriver->SetTexturePoolSize(usetup.TexturePoolSize);
+    if (usetup.RenderThread && !gfxDriver->SetRenderThread(true))
+        Debug::Printf(kDbgMsg_Warn, "Render thread is not supported by the %s renderer", gfxDriver->GetDriverName());
 }
 
 // Reset gfx driver callbacks
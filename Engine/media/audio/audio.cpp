@@ -684,6 +684,7 @@ void stop_all_sound_and_music()
 void shutdown_sound() 
 {
     stop_all_sound_and_music(); // game logic
+    shutdown_voice_prefetch(); // voice-over loading
     audio_core_shutdown(); // audio core system
     soundcache_clear(); // clear cached data
     sys_audio_shutdown(); // backend
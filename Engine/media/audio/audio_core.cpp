@@ -18,9 +18,15 @@
 
 #include "media/audio/audio_core.h"
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <mutex>
 #include <stdexcept>
+#include <string>
 #include <thread>
 #include <unordered_map>
 #include "debug/out.h"
@@ -34,6 +40,73 @@ using namespace AGS::Engine;
 const auto GlobalGainScaling = 0.7f; // TODO: find out why 0.7f is here?
 
 static void audio_core_entry();
+class AudioCoreSlot;
+// Tells if the decoding is done by the worker threads
+static bool has_decode_workers();
+// Passes the slot to the decoder workers
+static void schedule_decode(AudioCoreSlot *slot);
+// Removes the slot from the decoder workers' queue, if it's not taken yet
+static bool cancel_decode(AudioCoreSlot *slot);
+// Wakes the audio thread to process new commands or decoded data
+static void wake_audio_thread();
+// Decodes the next requested complete sound; returns if there are more
+static bool decode_next_sound();
+
+// Time reserved for decoding the next buffer before the queued data runs out
+const float DecodeMarginMs = 150.f;
+// Min time between the polls of a playing slot
+const float MinPollIntervalMs = 5.f;
+// Total number of the playback underruns, for the statistics
+static std::atomic<unsigned> g_acore_underruns{ 0u };
+
+// Slot status, published by the audio thread for the game thread's queries,
+// so that the latter never has to wait for the audio thread.
+struct AudioSlotStatus
+{
+    // Written by the audio thread
+    std::atomic<int> State{ PlayStateInitial };
+    // Position in ms and the time it was taken at, packed together
+    // for the reader to get a consistent pair without a lock
+    std::atomic<uint64_t> PosStamp{ 0u };
+    // Sequence number of the last processed command for this slot
+    std::atomic<uint32_t> AckSeq{ 0u };
+    // Set on creation, constant after
+    float DurationMs = 0.f;
+    int Freq = 0;
+    bool Repeat = false;
+
+    // Game thread only: prediction of the slot's state
+    // while its commands are still waiting in the queue
+    uint32_t Seq = 0u;
+    PlaybackState PendingState = PlayStateInitial;
+    uint32_t SeekSeq = 0u; // sequence number of the last seek command
+    float SeekPosMs = 0.f;
+    float Speed = 1.f;
+};
+
+// Timestamp for the position updates, in ms; wraps around, but only the
+// short differences between the two timestamps are ever used
+static uint32_t status_time_ms()
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+static uint64_t pack_pos_stamp(float pos_ms, uint32_t time_ms)
+{
+    uint32_t pos_bits;
+    std::memcpy(&pos_bits, &pos_ms, sizeof(pos_bits));
+    return (static_cast<uint64_t>(pos_bits) << 32) | time_ms;
+}
+
+static float unpack_pos_stamp(uint64_t stamp, uint32_t &time_ms)
+{
+    const uint32_t pos_bits = static_cast<uint32_t>(stamp >> 32);
+    float pos_ms;
+    std::memcpy(&pos_ms, &pos_bits, sizeof(pos_ms));
+    time_ms = static_cast<uint32_t>(stamp);
+    return pos_ms;
+}
 
 // AudioCoreSlot is a single playback manager, that handles two components:
 // decoder and "player"; controls the current playback state, passes data
@@ -41,7 +114,9 @@ static void audio_core_entry();
 class AudioCoreSlot
 {
 public:
-    AudioCoreSlot(int handle, std::unique_ptr<SDLDecoder> decoder);
+    AudioCoreSlot(int handle, std::unique_ptr<SDLDecoder> decoder,
+        std::shared_ptr<AudioSlotStatus> status);
+    ~AudioCoreSlot();
 
     // Gets current playback state
     PlaybackState GetPlayState() const { return _playState; }
@@ -54,8 +129,10 @@ public:
     // Gives access to the "player" object
     OpenAlSource &GetAlSource() const { return *_source; }
 
-    // Update state, transfer data from decoder to player if possible
-    void Poll();
+    // Update state, transfer data from decoder to player if possible;
+    // returns the time in ms until the slot has to be polled again,
+    // or negative value if it does not need polling until next command
+    float Poll();
     // Begin playback
     void Play();
     // Pause playback
@@ -64,10 +141,18 @@ public:
     void Stop();
     // Seek to the given time position
     void Seek(float pos_ms);
+    // Publish current state for the game thread; optionally acknowledges
+    // the processed command
+    void PublishStatus(uint32_t ack_seq = 0u);
+    // Decodes the next buffer; called by a decoder worker
+    void DecodeJob();
 
 private:
     // Opens decoder and sets up playback state
     void Init();
+    // Waits until the scheduled decoding is complete, or cancels it
+    // if it's not started yet; must be called before accessing decoder
+    void WaitDecode();
 
     int handle_ = -1;
     std::unique_ptr<SDLDecoder> _decoder;
@@ -76,15 +161,58 @@ private:
     PlaybackState _onLoadPlayState = PlayStatePaused;
     float _onLoadPositionMs = 0.0f;
     SoundBuffer _bufferPending{};
+    unsigned _underruns = 0u;
+    std::shared_ptr<AudioSlotStatus> _status;
+    // Decoding job: while it's scheduled, only the job may access
+    // the decoder and the pending buffer
+    std::atomic<bool> _decoding{ false };
+    std::mutex _decodeMutex;
+    std::condition_variable _decodeCv;
 };
 
-AudioCoreSlot::AudioCoreSlot(int handle, std::unique_ptr<SDLDecoder> decoder)
-    : handle_(handle), _decoder(std::move(decoder))
+AudioCoreSlot::AudioCoreSlot(int handle, std::unique_ptr<SDLDecoder> decoder,
+    std::shared_ptr<AudioSlotStatus> status)
+    : handle_(handle), _decoder(std::move(decoder)), _status(status)
 {
     _source = std::make_unique<OpenAlSource>(
         _decoder->GetFormat(), _decoder->GetChannels(), _decoder->GetFreq());
 }
 
+AudioCoreSlot::~AudioCoreSlot()
+{
+    WaitDecode();
+}
+
+void AudioCoreSlot::DecodeJob()
+{
+    std::lock_guard<std::mutex> lk(_decodeMutex);
+    _bufferPending = _decoder->GetData();
+    _decoding.store(false, std::memory_order_release);
+    _decodeCv.notify_all();
+}
+
+void AudioCoreSlot::WaitDecode()
+{
+    if (_decoding.load(std::memory_order_acquire) && cancel_decode(this))
+    {
+        _decoding = false;
+        return;
+    }
+    // The lock is taken even if the job is seen as complete, because the
+    // worker may still be finishing DecodeJob, using the mutex and condvar
+    std::unique_lock<std::mutex> lk(_decodeMutex);
+    _decodeCv.wait(lk, [this]() { return !_decoding.load(std::memory_order_acquire); });
+}
+
+void AudioCoreSlot::PublishStatus(uint32_t ack_seq)
+{
+    _status->State.store(_playState, std::memory_order_relaxed);
+    _status->PosStamp.store(pack_pos_stamp(_source->GetPositionMs(), status_time_ms()),
+        std::memory_order_relaxed);
+    if (ack_seq > 0u)
+        _status->AckSeq.store(ack_seq, std::memory_order_release);
+}
+
 void AudioCoreSlot::Init()
 {
     bool success;
@@ -97,34 +225,65 @@ void AudioCoreSlot::Init()
         _source->Play();
 }
 
-void AudioCoreSlot::Poll()
+float AudioCoreSlot::Poll()
 {
     if (_playState == PlaybackState::PlayStateInitial)
         Init();
     if (_playState != PlayStatePlaying)
-        return;
+        return -1.f;
 
-    // Read data from Decoder and pass into the Al Source
-    if (!_bufferPending.Data && !_decoder->EOS())
-    { // if no buffer saved, and still something to decode, then read a buffer
-        _bufferPending = _decoder->GetData();
-        assert(_bufferPending.Data || (_bufferPending.Size == 0));
-    }
-    if (_bufferPending.Data && (_bufferPending.Size > 0))
-    { // if having a buffer already, then try to put into source
-        if (_source->PutData(_bufferPending) > 0)
-            _bufferPending = SoundBuffer(); // clear buffer on success
+    // Read data from Decoder and pass into the Al Source,
+    // only as much as needed to keep the source busy for a while
+    while (!_source->IsFull() && (_source->GetQueuedMs() < OpenAlSource::QueueAheadMs))
+    {
+        if (_decoding.load(std::memory_order_acquire))
+            break; // wait for the scheduled decoding to complete
+        if (!_bufferPending.Data && !_decoder->EOS())
+        { // if no buffer saved, and still something to decode, then read a buffer
+            if (has_decode_workers())
+            { // let the workers decode, and put the result on one of the next polls
+                _decoding = true;
+                schedule_decode(this);
+                break;
+            }
+            _bufferPending = _decoder->GetData();
+            assert(_bufferPending.Data || (_bufferPending.Size == 0));
+        }
+        if (!_bufferPending.Data || (_bufferPending.Size == 0))
+        {
+            _bufferPending = SoundBuffer();
+            break; // nothing to put
+        }
+        // if having a buffer already, then try to put into source
+        if (_source->PutData(_bufferPending) == 0)
+            break;
+        _bufferPending = SoundBuffer(); // clear buffer on success
     }
     _source->Poll();
+    if (_source->GetUnderruns() != _underruns)
+    {
+        g_acore_underruns += _source->GetUnderruns() - _underruns;
+        _underruns = _source->GetUnderruns();
+        Debug::Printf("AudioCore: slot %d ran out of data (%u times)", handle_, _underruns);
+    }
     // If both finished decoding and playing, we done here.
-    if (_decoder->EOS() && _source->IsEmpty())
+    const bool decoder_eos = !_decoding.load(std::memory_order_acquire) && _decoder->EOS();
+    if (decoder_eos && _source->IsEmpty())
     {
         _playState = PlayStateFinished;
+        return -1.f;
     }
+    // Wake up in time to decode more data before the queued one runs out;
+    // if decoding is finished, then only to see the playback end.
+    // Completed decoding job will also wake the audio thread.
+    const float queued_ms = _source->GetQueuedMs();
+    const float wait_ms = decoder_eos ? queued_ms : (queued_ms - DecodeMarginMs);
+    return std::max(wait_ms, MinPollIntervalMs);
 }
 
 void AudioCoreSlot::Play()
 {
+    WaitDecode();
     switch (_playState)
     {
     case PlayStateInitial:
@@ -160,6 +319,7 @@ void AudioCoreSlot::Pause()
 
 void AudioCoreSlot::Stop()
 {
+    WaitDecode();
     switch (_playState)
     {
     case PlayStateInitial:
@@ -178,6 +338,7 @@ void AudioCoreSlot::Stop()
 
 void AudioCoreSlot::Seek(float pos_ms)
 {
+    WaitDecode();
     switch (_playState)
     {
     case PlayStateInitial:
@@ -199,6 +360,73 @@ void AudioCoreSlot::Seek(float pos_ms)
 }
 
 
+// A command from the game thread to the audio thread
+struct AudioCommand
+{
+    enum Type
+    {
+        kInit,
+        kPlay,
+        kPause,
+        kStop,
+        kSeek,
+        kConfigure
+    };
+
+    Type Cmd = kInit;
+    int Handle = -1;
+    uint32_t Seq = 0u;
+    float Args[3] = {};
+    AudioCoreSlot *Slot = nullptr; // a new slot, owned by the command
+};
+
+// Fixed-size lock-free queue with a single producer and a single consumer;
+// the producer only writes the tail, the consumer only writes the head.
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+public:
+    // Adds an item, returns false if the queue is full
+    bool Push(const T &item)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        _items[tail & (Capacity - 1)] = item;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Takes the oldest item, returns false if the queue is empty
+    bool Pop(T &item)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        item = _items[head & (Capacity - 1)];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T _items[Capacity];
+    std::atomic<size_t> _head{ 0u };
+    std::atomic<size_t> _tail{ 0u };
+};
+
+// A request to decode a complete sound; names are kept in std::string,
+// because String's data may not be shared between threads
+struct SoundDecodeJob
+{
+    std::string Name;
+    std::shared_ptr<std::vector<uint8_t>> Data;
+    std::string ExtHint;
+    float MaxDurationMs = 0.f;
+    uint32_t Generation = 0u;
+    std::shared_ptr<DecodedSound> Result;
+};
+
 // Global audio core state and resources
 static struct 
 {
@@ -210,16 +438,39 @@ static struct
     // Audio thread: polls sound decoders, feeds OpenAL sources
     std::thread audio_core_thread;
     bool audio_core_thread_running = false;
+    // Tells that the audio thread has to wake up and process new commands
+    bool wake_pending = false;
 
     // Sound slot id counter
     int nextId = 0;
 
-    // One mutex to lock them all... any operation on individual decoders
-    // is done under this only mutex, which means that they are currently
-    // polled one by one, any action like pause/resume is also synced.
+    // The game thread never accesses the slots directly: it passes commands
+    // through the queue, and reads the status published by each slot.
+    SpscQueue<AudioCommand, 1024> commands;
+    // Slot status, accessed only by the game thread
+    std::unordered_map<int, std::shared_ptr<AudioSlotStatus>> status_;
+
+    // Audio thread's mutex, only used to wait for the new commands;
+    // it's never locked for longer than to set or check the wake flag
     std::mutex mixer_mutex_m;
     std::condition_variable mixer_cv;
+    // Slots are owned and accessed only by the audio thread
     std::unordered_map<int, std::unique_ptr<AudioCoreSlot>> slots_;
+
+    // Decoder workers: decode the next buffers for the playing slots in
+    // parallel, while the audio thread passes the results to OpenAL
+    std::vector<std::thread> decode_workers;
+    bool decode_running = false;
+    std::mutex decode_mutex;
+    std::condition_variable decode_cv;
+    std::deque<AudioCoreSlot*> decode_jobs;
+    // Complete sounds requested for decoding, and the decoded ones; these
+    // have lower priority than the playing slots' jobs. Generation is
+    // increased when the requests are cancelled, so that the results of
+    // the jobs which were in progress at the time are discarded.
+    std::deque<SoundDecodeJob> sound_jobs;
+    std::vector<SoundDecodeJob> sound_results;
+    uint32_t sound_generation = 0u;
 } g_acore;
 
 // Prints any OpenAL errors to the log
@@ -235,7 +486,83 @@ void dump_al_errors()
 // INIT / SHUTDOWN
 // -------------------------------------------------------------------------------------------------
 
-void audio_core_init() 
+static void decode_worker_entry()
+{
+    for (;;)
+    {
+        AudioCoreSlot *slot;
+        {
+            std::unique_lock<std::mutex> lk(g_acore.decode_mutex);
+            g_acore.decode_cv.wait(lk, []()
+                { return !g_acore.decode_running || !g_acore.decode_jobs.empty()
+                    || !g_acore.sound_jobs.empty(); });
+            if (!g_acore.decode_running)
+                return;
+            if (g_acore.decode_jobs.empty())
+            { // no playback is waiting for data, take a complete sound
+                lk.unlock();
+                decode_next_sound();
+                continue;
+            }
+            slot = g_acore.decode_jobs.front();
+            g_acore.decode_jobs.pop_front();
+        }
+        try {
+            slot->DecodeJob();
+        } catch (const std::exception& e) {
+            Debug::Printf(kDbgMsg_Error, "AudioCore decode exception: %s", e.what());
+        }
+        wake_audio_thread();
+    }
+}
+
+static bool has_decode_workers()
+{
+    return !g_acore.decode_workers.empty();
+}
+
+static void schedule_decode(AudioCoreSlot *slot)
+{
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+        g_acore.decode_jobs.push_back(slot);
+    }
+    g_acore.decode_cv.notify_one();
+}
+
+static bool cancel_decode(AudioCoreSlot *slot)
+{
+    std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+    auto it = std::find(g_acore.decode_jobs.begin(), g_acore.decode_jobs.end(), slot);
+    if (it == g_acore.decode_jobs.end())
+        return false;
+    g_acore.decode_jobs.erase(it);
+    return true;
+}
+
+static bool decode_next_sound()
+{
+    SoundDecodeJob job;
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+        if (g_acore.sound_jobs.empty())
+            return false;
+        job = std::move(g_acore.sound_jobs.front());
+        g_acore.sound_jobs.pop_front();
+    }
+    try {
+        job.Result = DecodeSound(job.Data, String(job.ExtHint.c_str()), job.MaxDurationMs);
+    } catch (const std::exception& e) {
+        Debug::Printf(kDbgMsg_Error, "AudioCore decode exception: %s", e.what());
+    }
+    job.Data = nullptr;
+    std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+    if (job.Generation == g_acore.sound_generation)
+        g_acore.sound_results.push_back(std::move(job));
+    return !g_acore.sound_jobs.empty();
+}
+
+void audio_core_init(int decoder_threads)
 {
     /* InitAL opens a device and sets up a context using default attributes, making
      * the program ready to call OpenAL functions. */
@@ -269,20 +596,46 @@ void audio_core_init()
 
     g_acore.audio_core_thread_running = true;
 #if !defined(AGS_DISABLE_THREADS)
+    if (decoder_threads > 0)
+    {
+        g_acore.decode_running = true;
+        for (int i = 0; i < decoder_threads; ++i)
+            g_acore.decode_workers.emplace_back(decode_worker_entry);
+        Debug::Printf(kDbgMsg_Info, "AudioCore: started %d decoder thread(s)", decoder_threads);
+    }
     g_acore.audio_core_thread = std::thread(audio_core_entry);
 #endif
 }
 
 void audio_core_shutdown()
 {
-    g_acore.audio_core_thread_running = false;
+    {
+        std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
+        g_acore.audio_core_thread_running = false;
+    }
+    g_acore.mixer_cv.notify_all();
 #if !defined(AGS_DISABLE_THREADS)
     if (g_acore.audio_core_thread.joinable())
         g_acore.audio_core_thread.join();
 #endif
-
-    // dispose all the active slots
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+        g_acore.decode_running = false;
+    }
+    g_acore.decode_cv.notify_all();
+    for (auto &worker : g_acore.decode_workers)
+        worker.join();
+    g_acore.decode_workers.clear();
+    audio_core_clear_decoded_sounds();
+    if (g_acore_underruns > 0)
+        Debug::Printf(kDbgMsg_Warn, "AudioCore: playback ran out of data %u times", g_acore_underruns.load());
+
+    // dispose all the active slots, and any slots still waiting in queue
+    AudioCommand cmd;
+    while (g_acore.commands.Pop(cmd))
+        delete cmd.Slot;
     g_acore.slots_.clear();
+    g_acore.status_.clear();
 
     // SDL_Sound
     Sound_Quit();
@@ -309,12 +662,64 @@ static int avail_slot_id()
     return g_acore.nextId++;
 }
 
-static int audio_core_slot_init(std::unique_ptr<SDLDecoder> decoder)
+static void wake_audio_thread()
 {
-    auto handle = avail_slot_id();
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[handle] = std::make_unique<AudioCoreSlot>(handle, std::move(decoder));
+    {
+        std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
+        g_acore.wake_pending = true;
+    }
     g_acore.mixer_cv.notify_all();
+}
+
+// Passes a command to the audio thread; normally never waits, unless
+// the queue is completely full, in which case the audio thread is urged
+// to process it. Commands for the same slot must be passed in order.
+static void push_command(AudioCommand &cmd)
+{
+    auto found = g_acore.status_.find(cmd.Handle);
+    if (found != g_acore.status_.end())
+        cmd.Seq = ++found->second->Seq;
+    while (!g_acore.commands.Push(cmd))
+    {
+#if defined(AGS_DISABLE_THREADS)
+        audio_core_entry_poll(); // no other thread to do this
+#else
+        wake_audio_thread();
+        std::this_thread::yield();
+#endif
+    }
+    wake_audio_thread();
+}
+
+static std::shared_ptr<AudioSlotStatus> get_slot_status(int slot_handle)
+{
+    auto found = g_acore.status_.find(slot_handle);
+    return found != g_acore.status_.end() ? found->second : nullptr;
+}
+
+// Gets the latest known state of the slot: either the one published by
+// the audio thread, or, if there are unprocessed commands, the prediction
+static PlaybackState get_slot_state(const AudioSlotStatus &status)
+{
+    if (status.AckSeq.load(std::memory_order_acquire) != status.Seq)
+        return status.PendingState;
+    return static_cast<PlaybackState>(status.State.load(std::memory_order_relaxed));
+}
+
+static int audio_core_slot_init(std::unique_ptr<SDLDecoder> decoder, bool repeat)
+{
+    auto handle = avail_slot_id();
+    auto status = std::make_shared<AudioSlotStatus>();
+    status->DurationMs = decoder->GetDurationMs();
+    status->Freq = decoder->GetFreq();
+    status->Repeat = repeat;
+    g_acore.status_[handle] = status;
+
+    AudioCommand cmd;
+    cmd.Cmd = AudioCommand::kInit;
+    cmd.Handle = handle;
+    cmd.Slot = new AudioCoreSlot(handle, std::move(decoder), status);
+    push_command(cmd);
     return handle;
 }
 
@@ -323,7 +728,7 @@ int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const Stri
     auto decoder = std::make_unique<SDLDecoder>(data, extension_hint, repeat);
     if (!decoder->Open())
         return -1;
-    return audio_core_slot_init(std::move(decoder));
+    return audio_core_slot_init(std::move(decoder), repeat);
 }
 
 int audio_core_slot_init(std::unique_ptr<Stream> in, const String &extension_hint, bool repeat)
@@ -331,7 +736,15 @@ int audio_core_slot_init(std::unique_ptr<Stream> in, const String &extension_hin
     auto decoder = std::make_unique<SDLDecoder>(std::move(in), extension_hint, repeat);
     if (!decoder->Open())
         return -1;
-    return audio_core_slot_init(std::move(decoder));
+    return audio_core_slot_init(std::move(decoder), repeat);
+}
+
+int audio_core_slot_init(std::shared_ptr<const DecodedSound> pcm, bool repeat)
+{
+    auto decoder = std::make_unique<SDLDecoder>(pcm, repeat);
+    if (!decoder->Open())
+        return -1;
+    return audio_core_slot_init(std::move(decoder), repeat);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -340,35 +753,59 @@ int audio_core_slot_init(std::unique_ptr<Stream> in, const String &extension_hin
 
 PlaybackState audio_core_slot_play(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[slot_handle]->Play();
-    auto state = g_acore.slots_[slot_handle]->GetPlayState();
-    g_acore.mixer_cv.notify_all();
-    return state;
+    auto status = get_slot_status(slot_handle);
+    if (!status)
+        return PlayStateInvalid;
+    // Predict the result, following AudioCoreSlot::Play
+    const PlaybackState state = get_slot_state(*status);
+    if (state == PlayStatePaused || state == PlayStateStopped)
+        status->PendingState = PlayStatePlaying;
+    else
+        status->PendingState = state;
+    AudioCommand cmd;
+    cmd.Cmd = AudioCommand::kPlay;
+    cmd.Handle = slot_handle;
+    push_command(cmd);
+    return status->PendingState;
 }
 
 PlaybackState audio_core_slot_pause(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[slot_handle]->Pause();
-    auto state = g_acore.slots_[slot_handle]->GetPlayState();
-    g_acore.mixer_cv.notify_all();
-    return state;
+    auto status = get_slot_status(slot_handle);
+    if (!status)
+        return PlayStateInvalid;
+    // Predict the result, following AudioCoreSlot::Pause
+    const PlaybackState state = get_slot_state(*status);
+    status->PendingState = (state == PlayStatePlaying) ? PlayStatePaused : state;
+    AudioCommand cmd;
+    cmd.Cmd = AudioCommand::kPause;
+    cmd.Handle = slot_handle;
+    push_command(cmd);
+    return status->PendingState;
 }
 
 void audio_core_slot_stop(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[slot_handle]->Stop();
-    g_acore.slots_.erase(slot_handle);
-    g_acore.mixer_cv.notify_all();
+    AudioCommand cmd;
+    cmd.Cmd = AudioCommand::kStop;
+    cmd.Handle = slot_handle;
+    push_command(cmd);
+    g_acore.status_.erase(slot_handle);
 }
 
 void audio_core_slot_seek_ms(int slot_handle, float pos_ms)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    g_acore.slots_[slot_handle]->Seek(pos_ms);
-    g_acore.mixer_cv.notify_all();
+    auto status = get_slot_status(slot_handle);
+    if (!status)
+        return;
+    status->PendingState = get_slot_state(*status);
+    status->SeekPosMs = pos_ms;
+    AudioCommand cmd;
+    cmd.Cmd = AudioCommand::kSeek;
+    cmd.Handle = slot_handle;
+    cmd.Args[0] = pos_ms;
+    push_command(cmd);
+    status->SeekSeq = cmd.Seq;
 }
 
 
@@ -384,55 +821,87 @@ void audio_core_set_master_volume(float newvol)
 
 void audio_core_slot_configure(int slot_handle, float volume, float speed, float panning)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto &player = g_acore.slots_[slot_handle]->GetAlSource();
-    player.SetVolume(volume * GlobalGainScaling);
-    player.SetSpeed(speed);
-    player.SetPanning(panning);
+    auto status = get_slot_status(slot_handle);
+    if (!status)
+        return;
+    status->PendingState = get_slot_state(*status);
+    status->Speed = speed;
+    AudioCommand cmd;
+    cmd.Cmd = AudioCommand::kConfigure;
+    cmd.Handle = slot_handle;
+    cmd.Args[0] = volume * GlobalGainScaling;
+    cmd.Args[1] = speed;
+    cmd.Args[2] = panning;
+    push_command(cmd);
 }
 
 // -------------------------------------------------------------------------------------------------
 // SLOT STATUS
 // -------------------------------------------------------------------------------------------------
 
+// Gets the slot's position, extrapolating the last published one if playing
+static float get_slot_pos_ms(const AudioSlotStatus &status, PlaybackState state)
+{
+    const uint32_t ack_seq = status.AckSeq.load(std::memory_order_acquire);
+    if (static_cast<int32_t>(status.SeekSeq - ack_seq) > 0)
+        return status.SeekPosMs; // seek request is not processed yet
+    uint32_t time_ms;
+    float pos_ms = unpack_pos_stamp(status.PosStamp.load(std::memory_order_relaxed), time_ms);
+    if (state == PlayStatePlaying)
+    {
+        // The status is updated at least once per poll, and the playing slot
+        // is polled before its queued data runs out; limit the difference
+        // in case the audio thread was stalled
+        const uint32_t elapsed = std::min<uint32_t>(status_time_ms() - time_ms,
+            static_cast<uint32_t>(OpenAlSource::QueueAheadMs));
+        pos_ms += elapsed * status.Speed;
+        if (status.DurationMs > 0.f)
+        { // the looping playback has restarted if it went past the end
+            if (status.Repeat)
+                pos_ms = fmodf(pos_ms, status.DurationMs);
+            else
+                pos_ms = std::min(pos_ms, status.DurationMs);
+        }
+    }
+    return pos_ms;
+}
+
 float audio_core_slot_get_pos_ms(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto pos = g_acore.slots_[slot_handle]->GetAlSource().GetPositionMs();
-    g_acore.mixer_cv.notify_all();
-    return pos;
+    auto status = get_slot_status(slot_handle);
+    if (!status)
+        return 0.f;
+    return get_slot_pos_ms(*status, get_slot_state(*status));
 }
 
 float audio_core_slot_get_duration(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto dur = g_acore.slots_[slot_handle]->GetDecoder().GetDurationMs();
-    g_acore.mixer_cv.notify_all();
-    return dur;
+    auto status = get_slot_status(slot_handle);
+    return status ? status->DurationMs : 0.f;
 }
 
 int audio_core_slot_get_freq(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto dur = g_acore.slots_[slot_handle]->GetDecoder().GetFreq();
-    g_acore.mixer_cv.notify_all();
-    return dur;
+    auto status = get_slot_status(slot_handle);
+    return status ? status->Freq : 0;
 }
 
 PlaybackState audio_core_slot_get_play_state(int slot_handle)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto state = g_acore.slots_[slot_handle]->GetPlayState();
-    g_acore.mixer_cv.notify_all();
-    return state;
+    auto status = get_slot_status(slot_handle);
+    return status ? get_slot_state(*status) : PlayStateInvalid;
 }
 
 PlaybackState audio_core_slot_get_play_state(int slot_handle, float &pos_ms)
 {
-    std::lock_guard<std::mutex> lk(g_acore.mixer_mutex_m);
-    auto state = g_acore.slots_[slot_handle]->GetPlayState();
-    pos_ms = g_acore.slots_[slot_handle]->GetAlSource().GetPositionMs();
-    g_acore.mixer_cv.notify_all();
+    auto status = get_slot_status(slot_handle);
+    if (!status)
+    {
+        pos_ms = 0.f;
+        return PlayStateInvalid;
+    }
+    const PlaybackState state = get_slot_state(*status);
+    pos_ms = get_slot_pos_ms(*status, state);
     return state;
 }
 
@@ -441,32 +910,154 @@ PlaybackState audio_core_slot_get_play_state(int slot_handle, float &pos_ms)
 // AUDIO PROCESSING
 // -------------------------------------------------------------------------------------------------
 
-void audio_core_entry_poll()
+// Runs all the commands received from the game thread
+static void process_commands()
+{
+    AudioCommand cmd;
+    while (g_acore.commands.Pop(cmd))
+    {
+        if (cmd.Cmd == AudioCommand::kInit)
+        {
+            g_acore.slots_[cmd.Handle] = std::unique_ptr<AudioCoreSlot>(cmd.Slot);
+            cmd.Slot->PublishStatus(cmd.Seq);
+            continue;
+        }
+        auto found = g_acore.slots_.find(cmd.Handle);
+        if (found == g_acore.slots_.end())
+            continue;
+        auto &slot = found->second;
+        switch (cmd.Cmd)
+        {
+        case AudioCommand::kPlay:
+            slot->Play();
+            break;
+        case AudioCommand::kPause:
+            slot->Pause();
+            break;
+        case AudioCommand::kStop:
+            slot->Stop();
+            g_acore.slots_.erase(found);
+            continue;
+        case AudioCommand::kSeek:
+            slot->Seek(cmd.Args[0]);
+            break;
+        case AudioCommand::kConfigure:
+            {
+                auto &player = slot->GetAlSource();
+                player.SetVolume(cmd.Args[0]);
+                player.SetSpeed(cmd.Args[1]);
+                player.SetPanning(cmd.Args[2]);
+            }
+            break;
+        default:
+            break;
+        }
+        slot->PublishStatus(cmd.Seq);
+    }
+}
+
+// Processes commands and polls all slots; returns the time in ms until
+// the next poll is required, or negative value if none is
+static float audio_core_poll_slots()
 {
     // burn off any errors for new loop
     dump_al_errors();
 
+    process_commands();
+
+    float next_poll_ms = -1.f;
     for (auto &entry : g_acore.slots_) {
         auto &slot = entry.second;
 
+        float wait_ms = -1.f;
         try {
-            slot->Poll();
+            wait_ms = slot->Poll();
         } catch (const std::exception& e) {
             Debug::Printf(kDbgMsg_Error, "AudioCore poll exception: %s", e.what());
         }
+        slot->PublishStatus();
+        if ((wait_ms >= 0.f) && ((next_poll_ms < 0.f) || (wait_ms < next_poll_ms)))
+            next_poll_ms = wait_ms;
     }
+
+    // Without the decoder workers, the complete sounds are decoded here,
+    // one per poll, after the playing slots were given their data
+    if (!has_decode_workers() && decode_next_sound())
+        next_poll_ms = 0.f; // come back for the next one right away
+    return next_poll_ms;
+}
+
+// -------------------------------------------------------------------------------------------------
+// COMPLETE SOUNDS DECODING
+// -------------------------------------------------------------------------------------------------
+
+void audio_core_decode_sound(const String &name, std::shared_ptr<std::vector<uint8_t>> &data,
+    const String &extension_hint, float max_duration_ms)
+{
+    SoundDecodeJob job;
+    job.Name = name.GetCStr();
+    job.Data = data;
+    job.ExtHint = extension_hint.GetCStr();
+    job.MaxDurationMs = max_duration_ms;
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+        job.Generation = g_acore.sound_generation;
+        g_acore.sound_jobs.push_back(std::move(job));
+    }
+    if (has_decode_workers())
+        g_acore.decode_cv.notify_one();
+    else
+        wake_audio_thread();
+}
+
+void audio_core_get_decoded_sounds(std::vector<std::pair<String, std::shared_ptr<DecodedSound>>> &sounds)
+{
+    std::vector<SoundDecodeJob> results;
+    {
+        std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+        std::swap(results, g_acore.sound_results);
+    }
+    for (auto &job : results)
+        sounds.emplace_back(String(job.Name.c_str()), std::move(job.Result));
+}
+
+void audio_core_clear_decoded_sounds()
+{
+    std::lock_guard<std::mutex> lk(g_acore.decode_mutex);
+    g_acore.sound_jobs.clear();
+    g_acore.sound_results.clear();
+    g_acore.sound_generation++;
+}
+
+void audio_core_entry_poll()
+{
+    audio_core_poll_slots();
+}
+
+unsigned audio_core_get_underruns()
+{
+    return g_acore_underruns;
 }
 
 #if !defined(AGS_DISABLE_THREADS)
 static void audio_core_entry()
 {
     std::unique_lock<std::mutex> lk(g_acore.mixer_mutex_m);
+    auto has_work = []() { return g_acore.wake_pending || !g_acore.audio_core_thread_running; };
 
     while (g_acore.audio_core_thread_running) {
-
-        audio_core_entry_poll();
-
-        g_acore.mixer_cv.wait_for(lk, std::chrono::milliseconds(50));
+        g_acore.wake_pending = false;
+        lk.unlock();
+        const float next_poll_ms = audio_core_poll_slots();
+        lk.lock();
+
+        // Sleep until any of the playing slots needs more data, or until
+        // a new command arrives; if nothing is playing, then sleep indefinitely
+        if (next_poll_ms < 0.f)
+            g_acore.mixer_cv.wait(lk, has_work);
+        else
+            g_acore.mixer_cv.wait_for(lk,
+                std::chrono::microseconds(static_cast<int64_t>(next_poll_ms * 1000.f)), has_work);
     }
 }
 #endif
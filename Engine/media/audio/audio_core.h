@@ -18,13 +18,17 @@
 #ifndef __AGS_EE_MEDIA__AUDIOCORE_H
 #define __AGS_EE_MEDIA__AUDIOCORE_H
 #include <memory>
+#include <utility>
 #include <vector>
 #include "media/audio/audiodefines.h"
 #include "util/string.h"
 
+namespace AGS { namespace Engine { struct DecodedSound; } }
+
 // Initializes audio core system;
-// starts polling on a background thread.
-void audio_core_init(/*config, soundlib*/);
+// starts polling on a background thread, and optionally starts
+// a number of worker threads for decoding multiple sounds in parallel.
+void audio_core_init(int decoder_threads = 0);
 // Shut downs audio core system;
 // stops any associated threads.
 void audio_core_shutdown();
@@ -36,6 +40,8 @@ void audio_core_shutdown();
 int audio_core_slot_init(std::shared_ptr<std::vector<uint8_t>> &data, const AGS::Common::String &extension_hint, bool repeat);
 // Initializes playback streaming
 int audio_core_slot_init(std::unique_ptr<AGS::Common::Stream> in, const AGS::Common::String &extension_hint, bool repeat);
+// Initializes playback of the already decoded sound, which may be shared among multiple slots
+int audio_core_slot_init(std::shared_ptr<const AGS::Engine::DecodedSound> pcm, bool repeat);
 // Start playback on a slot
 PlaybackState audio_core_slot_play(int slot_handle);
 // Pause playback on a slot, resume with 'audio_core_slot_play'
@@ -63,4 +69,20 @@ float audio_core_slot_get_pos_ms(int slot_handle);
 float audio_core_slot_get_duration(int slot_handle);
 int audio_core_slot_get_freq(int slot_handle);
 
+// Returns the total number of times that a playback ran out of data
+unsigned audio_core_get_underruns();
+
+// Background decoding of complete sounds, for the decoded sound cache.
+//
+// Requests decoding of the complete sound data on a decoder worker, or on the
+// audio thread if there are no workers; fails if the sound is longer than
+// the given limit. The result is retrieved with audio_core_get_decoded_sounds.
+void audio_core_decode_sound(const AGS::Common::String &name, std::shared_ptr<std::vector<uint8_t>> &data,
+    const AGS::Common::String &extension_hint, float max_duration_ms);
+// Retrieves the sounds decoded since the last call; the failed ones have null data
+void audio_core_get_decoded_sounds(
+    std::vector<std::pair<AGS::Common::String, std::shared_ptr<AGS::Engine::DecodedSound>>> &sounds);
+// Cancels all the requested decoding, discards the results not retrieved yet
+void audio_core_clear_decoded_sounds();
+
 #endif // __AGS_EE_MEDIA__AUDIOCORE_H
@@ -135,23 +135,39 @@ float OpenAlSource::GetPositionMs() const
     float al_offset = 0.f;
     alGetSourcef(_source, AL_SEC_OFFSET, &al_offset);
     dump_al_errors();
+    float al_offset_ms = al_offset * 1000.f;
     for (const auto &r : _bufferRecords)
     {
-        float dur = (r.Duration * 0.001f) / r.Speed;
-        if (al_offset < dur)
+        if (al_offset_ms < r.AlDuration)
         {
-            float pos_ms = r.Timestamp + (al_offset * 1000.f) * r.Speed;
+            float pos_ms = r.Timestamp + al_offset_ms * r.Speed;
 #ifdef AUDIO_CORE_DEBUG
             Debug::Printf("OpenAlSource: pos = %f", pos_ms);
 #endif
             return pos_ms;
         }
-        al_offset -= dur;
+        al_offset_ms -= r.AlDuration;
     }
     // error? offset overflows buf records: return next ts prediction
     return _predictTs;
 }
 
+float OpenAlSource::GetQueuedMs() const
+{
+    if (_bufferRecords.size() == 0)
+        return 0.f;
+
+    // AL_SEC_OFFSET is the time played since the start of the queue, at the
+    // rate of the al buffers, so it's compared with the al buffers' durations
+    float total_ms = 0.f;
+    for (const auto &r : _bufferRecords)
+        total_ms += r.AlDuration;
+    float al_offset = 0.f;
+    alGetSourcef(_source, AL_SEC_OFFSET, &al_offset);
+    dump_al_errors();
+    return std::max(0.f, total_ms - al_offset * 1000.f);
+}
+
 size_t OpenAlSource::PutData(const SoundBuffer data)
 {
     Unqueue();
@@ -193,8 +209,11 @@ size_t OpenAlSource::PutData(const SoundBuffer data)
     dump_al_errors();
     _queued++;
     _predictTs = data.Ts >= 0.f ? (data.Ts + dur_ms) : (_predictTs + dur_ms);
-    // Push buffer record
-    _bufferRecords.push_back(BufferRecord(use_ts, dur_ms, _speed));
+    // Push buffer record, with the duration of the data as it's played by al,
+    // after the conversion which also applies the playback speed
+    const float al_dur_ms =
+        SoundHelper::MillisecondsFromBytes(input_buf.Size, _recvFmt.format, _recvFmt.channels, _recvFmt.rate);
+    _bufferRecords.push_back(BufferRecord(use_ts, dur_ms, al_dur_ms, _speed));
     return data.Size;
 }
 
@@ -235,7 +254,11 @@ ALuint OpenAlSource::Poll()
     dump_al_errors();
     if (state != AL_PLAYING)
     {
+        // Al source stops by itself only if it has played all the queued data
+        if ((state == AL_STOPPED) && _alStarted)
+            _underruns++;
         alSourcePlay(_source);
+        _alStarted = true;
         dump_al_errors();
     }
     return _queued;
@@ -256,6 +279,7 @@ void OpenAlSource::Play()
         {
             alSourcePlay(_source);
             dump_al_errors();
+            _alStarted = true;
         }
         break;
     default:
@@ -275,6 +299,7 @@ void OpenAlSource::Stop()
         alSourceStop(_source);
         dump_al_errors();
         Unqueue();
+        _alStarted = false;
         _playState = PlayStateStopped;
         _predictTs = 0.f;
         break;
@@ -294,6 +319,7 @@ void OpenAlSource::Pause()
         _playState = PlayStatePaused;
         alSourcePause(_source);
         dump_al_errors();
+        _alStarted = false;
         break;
     default:
         break;
@@ -34,7 +34,9 @@ class OpenAlSource
 {
 public:
     // Max sound buffers to queue before/during processing
-    static const ALuint MaxQueue = 2;
+    static const ALuint MaxQueue = 8;
+    // Duration of the sound data to keep queued ahead of playback, in ms
+    static constexpr float QueueAheadMs = 400.f;
 
     // Initializes Al source for the given format; if there's no direct format equivalent
     // found, setups a resampler.
@@ -48,8 +50,14 @@ public:
     PlaybackState GetPlayState() const { return _playState; }
     // Tells if the data queue is empty
     bool IsEmpty() const { return _queued == 0; }
+    // Tells if the data queue may accept more buffers
+    bool IsFull() const { return _queued >= MaxQueue; }
     // Gets current playback position, in ms
     float GetPositionMs() const;
+    // Gets duration of the queued data which is not played yet, in real time ms
+    float GetQueuedMs() const;
+    // Gets number of times the playback ran out of queued data
+    unsigned GetUnderruns() const { return _underruns; }
 
     // Try putting data into the queue; returns amount of data copied,
     // or 0 if data cannot be accepted at the moment.
@@ -88,6 +96,8 @@ private:
     float _speed = 1.f; // change in playback rate
     float _predictTs = 0.f; // next timestamp prediction
     unsigned _queued = 0u;
+    unsigned _underruns = 0u;
+    bool _alStarted = false; // whether al source was started by us
 
     // SDL resampler state, in case dynamic resampling in necessary
     SDLResampler _resampler;
@@ -95,10 +105,12 @@ private:
     struct BufferRecord
     {
         float Timestamp = 0.f;
-        float Duration = 0.f;
+        float Duration = 0.f; // duration of the sound data, in ms
+        float AlDuration = 0.f; // real playback duration of the al buffer, in ms
         float Speed = 0.f; // associated playback speed
         BufferRecord() = default;
-        BufferRecord(float ts, float dur, float sp) : Timestamp(ts), Duration(dur), Speed(sp) {}
+        BufferRecord(float ts, float dur, float al_dur, float sp)
+            : Timestamp(ts), Duration(dur), AlDuration(al_dur), Speed(sp) {}
     };
     // Playback parameters related to the queued buffers
     std::deque<BufferRecord> _bufferRecords;
@@ -12,6 +12,7 @@
 //
 //=============================================================================
 #include "media/audio/sdldecoder.h"
+#include <algorithm>
 #include "util/sdl2_util.h"
 
 namespace AGS
@@ -73,9 +74,16 @@ SDLDecoder::SDLDecoder(std::unique_ptr<Stream> in,
 {
 }
 
+SDLDecoder::SDLDecoder(std::shared_ptr<const DecodedSound> pcm, bool repeat)
+    : _pcm(pcm)
+    , _repeat(repeat)
+{
+}
+
 SDLDecoder::SDLDecoder(SDLDecoder &&dec)
 {
     _sampleData = (std::move(dec._sampleData));
+    _pcm = std::move(dec._pcm);
     _rwops = std::move(dec._rwops);
     dec._rwops = nullptr;
     _sampleExt = std::move(dec._sampleExt);
@@ -92,6 +100,19 @@ bool SDLDecoder::Open(float pos_ms)
         return true;
     }
 
+    if (_pcm)
+    { // decoded sound, only have to set the read position
+        _pcmOpen = true;
+        _durationMs = _pcm->DurationMs;
+        _posBytes = 0u;
+        _posMs = 0.f;
+        _EOS = _pcm->Data.empty();
+        if (pos_ms > 0.f) {
+            Seek(pos_ms);
+        }
+        return true;
+    }
+
     SoundSampleUniquePtr sample{};
     if (_rwops)
     {
@@ -126,10 +147,14 @@ void SDLDecoder::Close()
     _sample.reset();
     _rwops = nullptr; // rwops was closed by the Sound_NewSample
     _sampleData = nullptr;
+    _pcm = nullptr;
+    _pcmOpen = false;
 }
 
 float SDLDecoder::Seek(float pos_ms)
 {
+    if (_pcmOpen)
+        return SeekPCM(pos_ms);
     if (!_sample || pos_ms < 0.f)
         return _posMs;
     if (Sound_Seek(_sample.get(), static_cast<uint32_t>(pos_ms)) == 0)
@@ -142,6 +167,8 @@ float SDLDecoder::Seek(float pos_ms)
 
 SoundBuffer SDLDecoder::GetData()
 {
+    if (_pcmOpen)
+        return GetDataPCM();
     if (!_sample || _EOS)
         return SoundBuffer();
     float old_pos = _posMs;
@@ -171,5 +198,83 @@ SoundBuffer SDLDecoder::GetData()
         SoundHelper::MillisecondsFromBytes(sz, _sample->desired.format, _sample->desired.channels, _sample->desired.rate));
 }
 
+float SDLDecoder::SeekPCM(float pos_ms)
+{
+    if (pos_ms < 0.f)
+        return _posMs;
+    // Align the position to the whole sample frame
+    const size_t frame_sz = SoundHelper::BytesPerSample(_pcm->Format) * _pcm->Channels;
+    size_t pos = SoundHelper::BytesPerMs(pos_ms, _pcm->Format, _pcm->Channels, _pcm->Freq);
+    pos -= pos % frame_sz;
+    if (pos > _pcm->Data.size())
+        return _posMs; // old pos on failure
+    _posBytes = pos;
+    _posMs = pos_ms;
+    _EOS = _posBytes == _pcm->Data.size();
+    return pos_ms; // new pos on success
+}
+
+SoundBuffer SDLDecoder::GetDataPCM()
+{
+    if (_EOS)
+        return SoundBuffer();
+    // Pass the next part of the shared data, no copying here, because
+    // the data is kept alive for as long as this decoder exists
+    const float old_pos = _posMs;
+    const size_t sz = std::min<size_t>(SampleDefaultBufferSize, _pcm->Data.size() - _posBytes);
+    const uint8_t *data = _pcm->Data.data() + _posBytes;
+    _posBytes += sz;
+    _posMs = SoundHelper::MillisecondsFromBytes(_posBytes, _pcm->Format, _pcm->Channels, _pcm->Freq);
+    if (_posBytes >= _pcm->Data.size())
+    {
+        if (_repeat)
+        {
+            _posBytes = 0u;
+            _posMs = 0.f;
+        }
+        else
+        {
+            _EOS = true;
+        }
+    }
+    return SoundBuffer(data, sz, old_pos,
+        SoundHelper::MillisecondsFromBytes(sz, _pcm->Format, _pcm->Channels, _pcm->Freq));
+}
+
+std::shared_ptr<DecodedSound> DecodeSound(std::shared_ptr<std::vector<uint8_t>> &data,
+    const String &ext_hint, float max_duration_ms)
+{
+    SDLDecoder decoder(data, ext_hint, false);
+    if (!decoder.Open())
+        return nullptr;
+    const float dur_ms = decoder.GetDurationMs();
+    if ((dur_ms <= 0.f) || (dur_ms > max_duration_ms))
+        return nullptr;
+
+    auto pcm = std::make_shared<DecodedSound>();
+    pcm->Format = decoder.GetFormat();
+    pcm->Channels = decoder.GetChannels();
+    pcm->Freq = decoder.GetFreq();
+    // Reported duration may be not precise, leave a small margin
+    const size_t max_size = SoundHelper::BytesPerMs(max_duration_ms + 100.f,
+        pcm->Format, pcm->Channels, pcm->Freq);
+    pcm->Data.reserve(SoundHelper::BytesPerMs(dur_ms, pcm->Format, pcm->Channels, pcm->Freq));
+    while (!decoder.EOS())
+    {
+        SoundBuffer buf = decoder.GetData();
+        if (!buf)
+            continue;
+        if (pcm->Data.size() + buf.Size > max_size)
+            return nullptr;
+        const uint8_t *p = static_cast<const uint8_t*>(buf.Data);
+        pcm->Data.insert(pcm->Data.end(), p, p + buf.Size);
+    }
+    if (pcm->Data.empty())
+        return nullptr;
+    pcm->DurationMs = SoundHelper::MillisecondsFromBytes(pcm->Data.size(),
+        pcm->Format, pcm->Channels, pcm->Freq);
+    return pcm;
+}
+
 } // namespace Engine
 } // namespace AGS
@@ -67,6 +67,17 @@ struct SoundBuffer
     operator bool() const { return Data && Size > 0; }
 };
 
+// Fully decoded sound data, in the format of the source sample;
+// may be shared by any number of decoders playing it simultaneously.
+struct DecodedSound
+{
+    SDL_AudioFormat Format = 0;
+    int Channels = 0;
+    int Freq = 0;
+    float DurationMs = 0.f;
+    std::vector<uint8_t> Data;
+};
+
 // RAII wrapper over SDL resampling filter;
 // initialized by passing input and desired sound format;
 // tells whether conversion is necessary and performs one on command.
@@ -99,7 +110,8 @@ private:
 };
 
 // SDLDecoder uses SDL_Sound library to decode audio and retrieve result
-// in parts of the requested size.
+// in parts of the requested size. Alternatively it may play an already
+// decoded sound, in which case it only passes the parts of the PCM data.
 class SDLDecoder
 {
 public:
@@ -107,17 +119,22 @@ public:
     SDLDecoder(std::shared_ptr<std::vector<uint8_t>> &data, const String &ext_hint, bool repeat);
     // Initializes decoder with an input stream
     SDLDecoder(const std::unique_ptr<Stream> in, const String &ext_hint, bool repeat);
+    // Initializes decoder with a fully decoded sound
+    SDLDecoder(std::shared_ptr<const DecodedSound> pcm, bool repeat);
     SDLDecoder(SDLDecoder&& dec);
     ~SDLDecoder() = default;
 
     // Tells if the decoder is in a valid state, ready to work
-    bool IsValid() const { return _sample != nullptr; }
+    bool IsValid() const { return _sample != nullptr || _pcmOpen; }
     // Gets the audio format
-    SDL_AudioFormat GetFormat() const { return _sample ? _sample->desired.format : 0; }
+    SDL_AudioFormat GetFormat() const
+        { return _sample ? _sample->desired.format : (_pcm ? _pcm->Format : 0); }
     // Gets the number of channels
-    int GetChannels() const { return _sample ? _sample->desired.channels : 0; }
+    int GetChannels() const
+        { return _sample ? _sample->desired.channels : (_pcm ? _pcm->Channels : 0); }
     // Gets the audio rate (frequency)
-    int GetFreq() const { return _sample ? _sample->desired.rate : 0; }
+    int GetFreq() const
+        { return _sample ? _sample->desired.rate : (_pcm ? _pcm->Freq : 0); }
     // Tells if the data reading has reached EOS
     bool EOS() const { return _EOS; }
     // Gets current reading position, in ms
@@ -135,10 +152,15 @@ public:
     SoundBuffer GetData();
 
 private:
+    float SeekPCM(float pos_ms);
+    SoundBuffer GetDataPCM();
+
     SDL_RWops *_rwops = nullptr;
     std::shared_ptr<std::vector<uint8_t>> _sampleData{};
     String _sampleExt = "";
     SoundSampleUniquePtr _sample = nullptr;
+    std::shared_ptr<const DecodedSound> _pcm{};
+    bool _pcmOpen = false;
     float _durationMs = 0.f;
     bool _repeat = false;
     bool _EOS = false;
@@ -147,6 +169,12 @@ private:
 };
 
 
+// Decodes complete sound data at once; fails if the sound is longer than
+// the given limit, or if its duration cannot be told in advance
+std::shared_ptr<DecodedSound> DecodeSound(std::shared_ptr<std::vector<uint8_t>> &data,
+    const String &ext_hint, float max_duration_ms);
+
+
 namespace SoundHelper
 {
     // Tells bytes per sample from SDL_Audio format
@@ -15,14 +15,18 @@
 #include <cmath>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include "core/assetmanager.h"
+#include "debug/out.h"
 #include "media/audio/audio_core.h"
 #include "media/audio/audiodefines.h"
+#include "media/audio/sdldecoder.h"
 #include "util/path.h"
 #include "util/stream.h"
 #include "util/string_types.h"
 
 using namespace AGS::Common;
+using namespace AGS::Engine;
 
 static int GuessSoundTypeFromExt(const String &extension)
 {
@@ -56,12 +60,16 @@ static int GuessSoundTypeFromExt(const String &extension)
     return 0;
 }
 
+inline size_t GetDataSize(const std::vector<uint8_t> &data) { return data.size(); }
+inline size_t GetDataSize(const DecodedSound &pcm) { return pcm.Data.size(); }
+
 // Sound cache, stores most recent used sounds, tracks use history with MRU list.
 // TODO: refactor into the resource cache class, share with the sprite cache.
+template <typename TData>
 class SoundCache
 {
 public:
-    typedef std::shared_ptr<std::vector<uint8_t>> DataRef;
+    typedef std::shared_ptr<TData> DataRef;
 
     void SetMaxCacheSize(size_t size)
     {
@@ -69,11 +77,17 @@ public:
         FreeMem(0); // makes sure it does not exceed max size
     }
 
+    size_t GetMaxCacheSize() const { return _maxSize; }
+
     DataRef Get(const String &name)
     {
         const auto found = _map.find(name);
         if (found == _map.end())
+        {
+            _stats.Misses++;
             return DataRef();
+        }
+        _stats.Hits++;
         // Move to the beginning of the MRU list
         _mru.splice(_mru.begin(), _mru, found->second.MruIt);
         return found->second.Data;
@@ -85,17 +99,18 @@ public:
         assert(ref);
         if (!ref)
             return; // safety precaution
-        if (Get(name))
+        if (_map.count(name) > 0)
             return; // already in cache
-        if (_maxSize == 0)
-            return; // cache is disabled
+        const size_t size = GetDataSize(*ref);
+        if (_maxSize == 0 || size > _maxSize)
+            return; // cache is disabled, or the item won't fit at all
         // Clear up space before adding
-        if (_cacheSize + ref->size() > _maxSize)
-            FreeMem(ref->size());
+        if (_cacheSize + size > _maxSize)
+            FreeMem(size);
         SoundEntry entry(name, ref);
         entry.MruIt = _mru.insert(_mru.begin(), name);
         _map[name] = std::move(entry);
-        _cacheSize += ref->size();
+        _cacheSize += size;
     }
 
     // Clear the cache, dispose all resources
@@ -106,6 +121,15 @@ public:
         _cacheSize = 0u;
     }
 
+    // Gets current cache usage and the lookup statistics
+    SoundCacheStats GetStats() const
+    {
+        SoundCacheStats stats = _stats;
+        stats.Count = _map.size();
+        stats.Size = _cacheSize;
+        return stats;
+    }
+
 private:
     // Delete the oldest (least recently used) item in cache
     void DisposeOldest()
@@ -114,7 +138,7 @@ private:
         if (_mru.size() == 0) return;
         auto it = std::prev(_mru.end());
         const auto id = *it;
-        _cacheSize -= _map[id].Data->size();
+        _cacheSize -= GetDataSize(*_map[id].Data);
         _map.erase(id);
         // Remove from the mru list
         _mru.erase(it);
@@ -141,6 +165,7 @@ private:
 
     size_t _cacheSize = 0u;
     size_t _maxSize = DEFAULT_SOUNDCACHESIZE_KB;
+    SoundCacheStats _stats;
     std::unordered_map<String, SoundEntry, HashStrNoCase> _map;
     // MRU list: the way to track which items were used recently.
     // When clearing up space for new items, cache first deletes the items
@@ -153,7 +178,17 @@ private:
 // anything larger will be streamed
 // TODO: make configureable?
 static size_t MaxLoadAtOnce = DEFAULT_SOUNDLOADATONCE_KB;
-static SoundCache SndCache;
+static SoundCache<std::vector<uint8_t>> SndCache;
+// Second cache tier: fully decoded short sounds, which may be played
+// right away by any number of slots, without decoding them again
+static SoundCache<DecodedSound> PcmCache;
+// Max duration of a sound which is allowed into the decoded cache
+static float PcmMaxDurationMs = DEFAULT_SOUNDDECODEDMAXLEN_MS;
+// Sounds which were found unsuitable for the decoded cache,
+// remembered in order to not try decoding them again each time
+static std::unordered_set<String, HashStrNoCase> PcmRejected;
+// Sounds which are being decoded in background for the decoded cache
+static std::unordered_set<String, HashStrNoCase> PcmPending;
 
 void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize)
 {
@@ -161,9 +196,91 @@ void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize)
     SndCache.SetMaxCacheSize(max_cachesize);
 }
 
+void soundcache_set_decoded_rules(size_t max_cachesize, float max_duration_ms)
+{
+    PcmCache.SetMaxCacheSize(max_cachesize);
+    PcmMaxDurationMs = max_duration_ms;
+    PcmRejected.clear();
+    PcmPending.clear();
+    audio_core_clear_decoded_sounds();
+}
+
+SoundCacheStats soundcache_get_stats()
+{
+    return SndCache.GetStats();
+}
+
+SoundCacheStats soundcache_get_decoded_stats()
+{
+    return PcmCache.GetStats();
+}
+
 void soundcache_clear()
 {
+    const auto stats = SndCache.GetStats();
+    const auto pcm_stats = PcmCache.GetStats();
+    if (stats.Hits + stats.Misses > 0)
+        Debug::Printf("Sound cache: %zu hits, %zu misses; decoded cache: %zu hits, %zu misses, %zu sounds (%zu KB)",
+            stats.Hits, stats.Misses, pcm_stats.Hits, pcm_stats.Misses, pcm_stats.Count, pcm_stats.Size / 1024);
     SndCache.Clear();
+    PcmCache.Clear();
+    PcmRejected.clear();
+    PcmPending.clear();
+    audio_core_clear_decoded_sounds();
+}
+
+// Tells if the sound may be looked up in the decoded cache
+static bool is_decoded_cache_enabled()
+{
+    return (PcmCache.GetMaxCacheSize() > 0) && (PcmMaxDurationMs > 0.f);
+}
+
+// Puts the sounds decoded in background into the decoded cache
+static void collect_decoded_sounds()
+{
+    if (PcmPending.empty())
+        return;
+    std::vector<std::pair<String, std::shared_ptr<DecodedSound>>> sounds;
+    audio_core_get_decoded_sounds(sounds);
+    for (auto &snd : sounds)
+    {
+        PcmPending.erase(snd.first);
+        if (snd.second)
+            PcmCache.Put(snd.first, snd.second);
+        else
+            PcmRejected.insert(snd.first);
+    }
+}
+
+// Schedules the sound for decoding into the decoded cache, if it's short enough;
+// the duration is the one told by the sound's metadata, when starting its playback
+static void request_decoded_sound(const String &name, std::shared_ptr<std::vector<uint8_t>> &sounddata,
+    const String &ext_hint, float duration_ms)
+{
+    if (PcmRejected.count(name) > 0 || PcmPending.count(name) > 0)
+        return;
+    if ((duration_ms <= 0.f) || (duration_ms > PcmMaxDurationMs))
+    {
+        PcmRejected.insert(name);
+        return;
+    }
+    PcmPending.insert(name);
+    audio_core_decode_sound(name, sounddata, ext_hint, PcmMaxDurationMs);
+}
+
+// Creates a clip object for the initialized audio slot
+static SOUNDCLIP *make_clip(int slot, const String &ext_hint, bool loop)
+{
+    if (slot < 0) { return nullptr; }
+
+    const auto sound_type = GuessSoundTypeFromExt(ext_hint);
+    const auto lengthMs = (int)std::round(audio_core_slot_get_duration(slot));
+
+    auto clip = new SOUNDCLIP(slot);
+    clip->repeat = loop;
+    clip->soundType = sound_type;
+    clip->lengthMs = lengthMs;
+    return clip;
 }
 
 static SOUNDCLIP *my_load_clip(const AssetPath &apath, const char *extension_hint, bool loop)
@@ -177,7 +294,8 @@ static SOUNDCLIP *my_load_clip(const AssetPath &apath, const char *extension_hin
     }
     else
     {
-        s_in.reset(AssetMgr->OpenAsset(apath));
+        // Streamed sounds from the same library share one file handle
+        s_in.reset(AssetMgr->OpenAssetShared(apath));
         if (!s_in)
             return nullptr;
         asset_size = static_cast<size_t>(s_in->GetLength());
@@ -197,7 +315,25 @@ static SOUNDCLIP *my_load_clip(const AssetPath &apath, const char *extension_hin
             s_in->Read(sounddata->data(), asset_size);
             SndCache.Put(apath.Name, sounddata);
         }
-        slot = audio_core_slot_init(sounddata, ext_hint, loop);
+        // Short sounds are played from the decoded data, if it's cached;
+        // otherwise they are played from the sound data this time,
+        // while being decoded for the cache in background
+        std::shared_ptr<DecodedSound> pcm;
+        if (is_decoded_cache_enabled())
+        {
+            collect_decoded_sounds();
+            pcm = PcmCache.Get(apath.Name);
+        }
+        if (pcm)
+        {
+            slot = audio_core_slot_init(pcm, loop);
+        }
+        else
+        {
+            slot = audio_core_slot_init(sounddata, ext_hint, loop);
+            if ((slot >= 0) && is_decoded_cache_enabled())
+                request_decoded_sound(apath.Name, sounddata, ext_hint, audio_core_slot_get_duration(slot));
+        }
     }
     // Otherwise, if asset's size is too large, start streaming
     else
@@ -205,16 +341,13 @@ static SOUNDCLIP *my_load_clip(const AssetPath &apath, const char *extension_hin
         slot = audio_core_slot_init(std::move(s_in), ext_hint, loop);
     }
 
-    if (slot < 0) { return nullptr; }
-
-    const auto sound_type = GuessSoundTypeFromExt(ext_hint);
-    const auto lengthMs = (int)std::round(audio_core_slot_get_duration(slot));
+    return make_clip(slot, ext_hint, loop);
+}
 
-    auto clip = new SOUNDCLIP(slot);
-    clip->repeat = loop;
-    clip->soundType = sound_type;
-    clip->lengthMs = lengthMs;
-    return clip;
+SOUNDCLIP *my_load_data(const String &asset_name, std::shared_ptr<std::vector<uint8_t>> &data, bool loop)
+{
+    const auto ext_hint = AGS::Common::Path::GetFileExtension(asset_name);
+    return make_clip(audio_core_slot_init(data, ext_hint, loop), ext_hint, loop);
 }
 
 SOUNDCLIP *my_load_wave(const AssetPath &asset_name, bool loop)
@@ -18,6 +18,8 @@
 #ifndef __AC_SOUND_H
 #define __AC_SOUND_H
 
+#include <memory>
+#include <vector>
 #include "ac/asset_helper.h"
 #include "media/audio/soundclip.h"
 
@@ -25,16 +27,41 @@
 const size_t DEFAULT_SOUNDLOADATONCE_KB = 1024u;
 // Sound cache limit, in KB
 const size_t DEFAULT_SOUNDCACHESIZE_KB = 1024u * 32; // 32 MB
+// Decoded sound cache limit, in KB
+const size_t DEFAULT_SOUNDDECODEDCACHE_KB = 1024u * 16; // 16 MB
+// Max duration of a sound that may be put into the decoded cache, in ms
+const int DEFAULT_SOUNDDECODEDMAXLEN_MS = 3000;
+
+// Sound cache usage and lookup statistics
+struct SoundCacheStats
+{
+    size_t Hits = 0u;
+    size_t Misses = 0u;
+    size_t Count = 0u; // number of cached sounds
+    size_t Size = 0u; // total size of cached data, in bytes
+};
 
 // Sets sound loading and caching rules:
 // * max_loadatonce - threshold in bytes for loading sounds immediately, vs streaming
 // * max_cachesize - sound cache limit, in bytes
 void soundcache_set_rules(size_t max_loadatonce, size_t max_cachesize);
+// Sets rules for caching decoded sounds; only sounds which are loaded at once
+// may be decoded and cached, if they are not longer than the given limit:
+// * max_cachesize - decoded cache limit, in bytes; 0 disables decoded cache
+// * max_duration_ms - max duration of a cached sound, in milliseconds
+void soundcache_set_decoded_rules(size_t max_cachesize, float max_duration_ms);
+// Gets statistics of the sound cache and the decoded sound cache
+SoundCacheStats soundcache_get_stats();
+SoundCacheStats soundcache_get_decoded_stats();
 void soundcache_clear();
 SOUNDCLIP *my_load_wave(const AssetPath &asset_name, bool loop);
 SOUNDCLIP *my_load_mp3(const AssetPath &asset_name, bool loop);
 SOUNDCLIP *my_load_ogg(const AssetPath &asset_name, bool loop);
 SOUNDCLIP *my_load_midi(const AssetPath &asset_name, bool loop);
 SOUNDCLIP *my_load_mod(const AssetPath &asset_name, bool loop);
+// Creates a clip from the sound data which was loaded elsewhere; the sound
+// type is guessed from the asset name's extension. The data is not cached.
+SOUNDCLIP *my_load_data(const AGS::Common::String &asset_name,
+    std::shared_ptr<std::vector<uint8_t>> &data, bool loop);
 
 #endif // __AC_SOUND_H
@@ -188,6 +188,7 @@ void D3DGraphicsDriver::ReleaseDisplayMode()
   ClearDrawBackups();
   DestroyFxPool();
   DestroyAllStageScreens();
+  DestroyTexturePool();
 
   sys_window_set_style(kWnd_Windowed);
 }
@@ -773,6 +774,8 @@ void D3DGraphicsDriver::ReleaseRenderTargetData()
     {
         ddb->ReleaseTextureData();
     }
+    // Pooled textures may include render targets, which must be released too
+    DestroyTexturePool();
 }
 
 void D3DGraphicsDriver::RecreateRenderTargets()
@@ -1599,6 +1602,39 @@ void D3DGraphicsDriver::UpdateTextureRegion(D3DTextureTile *tile, Bitmap *bitmap
   newTexture->UnlockRect(0);
 }
 
+void D3DGraphicsDriver::UpdateTextureRegion(D3DTextureTile *tile, Bitmap *bitmap, const Rect &area, bool opaque, bool hasAlpha)
+{
+  TextureTile fixedTile;
+  fixedTile.x = std::max(area.Left, tile->x);
+  fixedTile.y = std::max(area.Top, tile->y);
+  fixedTile.width = std::min(area.Right + 1, tile->x + tile->width) - fixedTile.x;
+  fixedTile.height = std::min(area.Bottom + 1, tile->y + tile->height) - fixedTile.y;
+  if ((fixedTile.width <= 0) || (fixedTile.height <= 0))
+    return; // area does not intersect this tile
+
+  RECT lockRect;
+  lockRect.left = fixedTile.x - tile->x;
+  lockRect.top = fixedTile.y - tile->y;
+  lockRect.right = lockRect.left + fixedTile.width;
+  lockRect.bottom = lockRect.top + fixedTile.height;
+  D3DLOCKED_RECT lockedRegion;
+  HRESULT hr = tile->texture->LockRect(0, &lockedRegion, &lockRect, D3DLOCK_NOSYSLOCK);
+  if (hr != D3D_OK)
+  {
+    throw Ali3DException("Unable to lock texture");
+  }
+
+  bool usingLinearFiltering = _filter->NeedToColourEdgeLines();
+  char *memPtr = (char*)lockedRegion.pBits;
+
+  if (opaque)
+    BitmapToVideoMemOpaque(bitmap, hasAlpha, &fixedTile, memPtr, lockedRegion.Pitch);
+  else
+    BitmapToVideoMem(bitmap, hasAlpha, &fixedTile, memPtr, lockedRegion.Pitch, usingLinearFiltering);
+
+  tile->texture->UnlockRect(0);
+}
+
 void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap, bool hasAlpha)
 {
   D3DBitmap *target = (D3DBitmap*)bitmapToUpdate;
@@ -1612,6 +1648,28 @@ void D3DGraphicsDriver::UpdateDDBFromBitmap(IDriverDependantBitmap* bitmapToUpda
   UpdateTextureData(target->_data.get(), bitmap, target->_opaque, hasAlpha);
 }
 
+void D3DGraphicsDriver::UpdateDDBRegionFromBitmap(IDriverDependantBitmap* bitmapToUpdate, Bitmap *bitmap,
+    const Rect &area, bool hasAlpha)
+{
+  D3DBitmap *target = (D3DBitmap*)bitmapToUpdate;
+  if (target->_width != bitmap->GetWidth() || target->_height != bitmap->GetHeight())
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched bitmap size");
+  const int color_depth = bitmap->GetColorDepth();
+  if (color_depth != target->_colDepth)
+    throw Ali3DException("UpdateDDBRegionFromBitmap: mismatched colour depths");
+
+  target->_hasAlpha = hasAlpha;
+  if (color_depth == 8)
+      select_palette(palette);
+  auto *d3ddata = reinterpret_cast<D3DTextureData*>(target->_data.get());
+  for (size_t i = 0; i < d3ddata->_numTiles; ++i)
+  {
+    UpdateTextureRegion(&d3ddata->_tiles[i], bitmap, area, target->_opaque, hasAlpha);
+  }
+  if (color_depth == 8)
+      unselect_palette();
+}
+
 void D3DGraphicsDriver::UpdateTextureData(TextureData *txdata, Bitmap *bitmap, bool opaque, bool hasAlpha)
 {
   const int color_depth = bitmap->GetColorDepth();
@@ -1696,16 +1754,17 @@ IDriverDependantBitmap* D3DGraphicsDriver::CreateDDB(int width, int height, int
     if (color_depth != GetCompatibleBitmapFormat(color_depth))
         throw Ali3DException("CreateDDB: bitmap colour depth not supported");
     D3DBitmap *ddb = new D3DBitmap(width, height, color_depth, opaque);
-    ddb->_data.reset(reinterpret_cast<D3DTextureData*>(CreateTextureData(width, height, opaque)));
+    ddb->_data = std::static_pointer_cast<D3DTextureData>(AcquireTextureData(width, height, opaque));
     return ddb;
 }
 
 IDriverDependantBitmap *D3DGraphicsDriver::CreateDDB(std::shared_ptr<TextureData> txdata,
     int width, int height, int color_depth, bool opaque)
 {
-    auto *ddb = reinterpret_cast<D3DBitmap*>(CreateDDB(width, height, color_depth, opaque));
-    if (ddb)
-        ddb->_data = std::static_pointer_cast<D3DTextureData>(txdata);
+    if (color_depth != GetCompatibleBitmapFormat(color_depth))
+        throw Ali3DException("CreateDDB: bitmap colour depth not supported");
+    D3DBitmap *ddb = new D3DBitmap(width, height, color_depth, opaque);
+    ddb->_data = std::static_pointer_cast<D3DTextureData>(txdata);
     return ddb;
 }
 
@@ -1715,8 +1774,7 @@ IDriverDependantBitmap* D3DGraphicsDriver::CreateRenderTargetDDB(int width, int
         throw Ali3DException("CreateDDB: bitmap colour depth not supported");
     D3DBitmap *ddb = new D3DBitmap(width, height, color_depth, opaque);
     // FIXME: this ugly accessing internal texture members
-    ddb->_data.reset(reinterpret_cast<D3DTextureData*>(CreateTextureData(width, height, opaque, true)));
-    ddb->_data->RenderTarget = true;
+    ddb->_data = std::static_pointer_cast<D3DTextureData>(AcquireTextureData(width, height, opaque, true));
     IDirect3DTexture9 *tex = ddb->_data->_tiles->texture;
     HRESULT hr = tex->GetSurfaceLevel(0, &ddb->_renderSurface);
     assert(hr == D3D_OK);
@@ -1865,6 +1923,7 @@ TextureData *D3DGraphicsDriver::CreateTextureData(int width, int height, bool op
 
   txdata->_numTiles = numTiles;
   txdata->_tiles = tiles;
+  txdata->RenderTarget = as_render_target;
   return txdata;
 }
 
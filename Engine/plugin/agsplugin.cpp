@@ -39,6 +39,7 @@
 #include "ac/string.h"
 #include "ac/spritecache.h"
 #include "ac/sys_events.h"
+#include "ac/walkablearea.h"
 #include "ac/dynobj/scriptstring.h"
 #include "ac/dynobj/dynobj_manager.h"
 #include "font/fonts.h"
@@ -472,7 +473,13 @@ BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
     if (index == MASK_WALKABLE)
+    {
+        // Plugin may write to the mask, so make sure that pathfinder does not
+        // reuse the routes found before; the navigation graph is not rebuilt,
+        // as that is too slow to do whenever a plugin reads the mask
+        mark_walkable_areas_changed(false);
         return (BITMAP*)thisroom.WalkAreaMask->GetAllegroBitmap();
+    }
     else if (index == MASK_WALKBEHIND)
         return (BITMAP*)thisroom.WalkBehindMask->GetAllegroBitmap();
     else if (index == MASK_HOTSPOT)
@@ -0,0 +1,168 @@
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "gfx/pixel_conv.h"
+
+using namespace AGS::Engine;
+
+const uint16_t MASK16 = 0xF81F;
+const uint32_t MASK32 = 0x00FF00FF;
+
+// Fills the row with random pixels, with approximately 1/4 of them being mask color
+template <typename T>
+static void FillRandomRow(std::vector<T> &row, std::mt19937 &rng, T mask)
+{
+    for (auto &px : row)
+        px = (rng() % 4 == 0) ? mask : static_cast<T>(rng());
+}
+
+// Fills the row with alternating runs of mask color and random pixels,
+// like the ones found in sprites with transparent background
+template <typename T>
+static void FillSpriteRow(std::vector<T> &row, std::mt19937 &rng, T mask)
+{
+    bool transparent = (rng() % 2 == 0);
+    for (size_t x = 0; x < row.size(); transparent = !transparent)
+    {
+        for (size_t run = 1 + rng() % 12; (run > 0) && (x < row.size()); --run, ++x)
+            row[x] = transparent ? mask : static_cast<T>(rng());
+    }
+}
+
+// Runs the conversion with no vector instructions, then with the best ones
+// supported by this system, and compares results.
+class PixelConvSimd : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        PixelConv::SetSimdLevel(PixelConv::DetectSimdLevel());
+    }
+
+    template <typename TFunc>
+    void CompareRows(size_t width, TFunc conv)
+    {
+        std::vector<uint32_t> plain(width, 0xDEADBEEF), simd(width, 0xDEADBEEF);
+        PixelConv::SetSimdLevel(PixelConv::kSimd_None);
+        conv(plain.data());
+        PixelConv::SetSimdLevel(PixelConv::DetectSimdLevel());
+        conv(simd.data());
+        ASSERT_EQ(plain, simd);
+    }
+};
+
+TEST(PixelConv, Row16) {
+    PixelConv::PixelFormat fmt;
+    const uint16_t src[] = { 0xFFFF, MASK16, 0x0000, 0x8410 };
+    uint32_t dst[4];
+    PixelConv::Row16ToVMem(src, nullptr, nullptr, dst, 4, false, fmt);
+    ASSERT_EQ(dst[0], 0xFFFFFFFFu);
+    ASSERT_EQ(dst[1], 0x00000000u); // mask pixel followed by a black one
+    ASSERT_EQ(dst[2], 0xFF000000u);
+    ASSERT_EQ(dst[3], 0xFF848284u);
+}
+
+TEST(PixelConv, Row32) {
+    PixelConv::PixelFormat fmt;
+    fmt.DstR = 0; fmt.DstB = 16; // swap R and B, like in OpenGL
+    const uint32_t src[] = { 0x80112233, MASK32, 0x00445566, MASK32 };
+    uint32_t dst[4];
+    PixelConv::Row32ToVMem(src, nullptr, nullptr, dst, 4, false, false, fmt);
+    ASSERT_EQ(dst[0], 0xFF332211u);
+    ASSERT_EQ(dst[1], 0x00665544u); // receives next pixel's color
+    ASSERT_EQ(dst[2], 0xFF665544u);
+    ASSERT_EQ(dst[3], 0x00000000u);
+    PixelConv::Row32ToVMem(src, nullptr, nullptr, dst, 4, true, false, fmt);
+    ASSERT_EQ(dst[0], 0x80332211u);
+    ASSERT_EQ(dst[1], 0x00000000u); // no fixup when using alpha channel
+    ASSERT_EQ(dst[2], 0x00665544u);
+    ASSERT_EQ(dst[3], 0x00000000u);
+}
+
+TEST(PixelConv, Row32LinearFilter) {
+    PixelConv::PixelFormat fmt;
+    const uint32_t before[] = { 0, 0x00300000, 0 };
+    const uint32_t src[] = { 0x00000030, MASK32, 0x00003000 };
+    const uint32_t after[] = { 0, MASK32, 0 };
+    uint32_t dst[3];
+    PixelConv::Row32ToVMem(src, before, after, dst, 3, false, true, fmt);
+    ASSERT_EQ(dst[0], 0xFF000030u);
+    ASSERT_EQ(dst[1], 0x00003000u); // fixed up by the next pixel
+    ASSERT_EQ(dst[2], 0xFF003000u);
+    const uint32_t src2[] = { MASK32, MASK32, 0x00003000 };
+    PixelConv::Row32ToVMem(src2, before, after, dst, 3, false, true, fmt);
+    ASSERT_EQ(dst[0], 0x00000000u); // only black neighbour above
+    ASSERT_EQ(dst[1], 0x00003000u);
+    PixelConv::Row32ToVMem(src, before, after, dst, 3, true, true, fmt);
+    ASSERT_EQ(dst[1], 0x00101010u); // average of left, right and top
+}
+
+TEST_F(PixelConvSimd, Row16) {
+    std::mt19937 rng(16);
+    PixelConv::PixelFormat fmt;
+    for (size_t width = 1; width <= 67; ++width)
+    {
+        std::vector<uint16_t> before(width), src(width), after(width);
+        FillRandomRow(before, rng, MASK16);
+        FillRandomRow(src, rng, MASK16);
+        FillRandomRow(after, rng, MASK16);
+        for (int filter = 0; filter < 2; ++filter)
+        {
+            CompareRows(width, [&](uint32_t *dst)
+                { PixelConv::Row16ToVMem(src.data(), before.data(), after.data(), dst, width, filter != 0, fmt); });
+            CompareRows(width, [&](uint32_t *dst)
+                { PixelConv::Row16ToVMem(src.data(), nullptr, nullptr, dst, width, filter != 0, fmt); });
+        }
+        CompareRows(width, [&](uint32_t *dst)
+            { PixelConv::Row16ToVMemOpaque(src.data(), dst, width, fmt); });
+    }
+}
+
+TEST_F(PixelConvSimd, Row32) {
+    std::mt19937 rng(32);
+    PixelConv::PixelFormat fmt;
+    fmt.DstR = 0; fmt.DstB = 16;
+    for (size_t width = 1; width <= 67; ++width)
+    {
+        std::vector<uint32_t> before(width), src(width), after(width);
+        FillRandomRow(before, rng, MASK32);
+        FillRandomRow(src, rng, MASK32);
+        FillRandomRow(after, rng, MASK32);
+        for (int alpha = 0; alpha < 2; ++alpha)
+        {
+            for (int filter = 0; filter < 2; ++filter)
+            {
+                CompareRows(width, [&](uint32_t *dst)
+                    { PixelConv::Row32ToVMem(src.data(), before.data(), after.data(), dst, width, alpha != 0, filter != 0, fmt); });
+            }
+            CompareRows(width, [&](uint32_t *dst)
+                { PixelConv::Row32ToVMemOpaque(src.data(), dst, width, alpha != 0, fmt); });
+        }
+    }
+}
+
+TEST_F(PixelConvSimd, TransparentRuns) {
+    std::mt19937 rng(64);
+    PixelConv::PixelFormat fmt;
+    for (size_t width = 1; width <= 67; ++width)
+    {
+        std::vector<uint16_t> before16(width), src16(width), after16(width);
+        std::vector<uint32_t> before32(width), src32(width), after32(width);
+        FillSpriteRow(before16, rng, MASK16);
+        FillSpriteRow(src16, rng, MASK16);
+        FillSpriteRow(after16, rng, MASK16);
+        FillSpriteRow(before32, rng, MASK32);
+        FillSpriteRow(src32, rng, MASK32);
+        FillSpriteRow(after32, rng, MASK32);
+        for (int filter = 0; filter < 2; ++filter)
+        {
+            CompareRows(width, [&](uint32_t *dst)
+                { PixelConv::Row16ToVMem(src16.data(), before16.data(), after16.data(), dst, width, filter != 0, fmt); });
+            for (int alpha = 0; alpha < 2; ++alpha)
+            {
+                CompareRows(width, [&](uint32_t *dst)
+                    { PixelConv::Row32ToVMem(src32.data(), before32.data(), after32.data(), dst, width, alpha != 0, filter != 0, fmt); });
+            }
+        }
+    }
+}
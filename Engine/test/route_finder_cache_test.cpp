@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/movelist.h"
+#include "ac/route_finder_impl.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+using namespace AGS::Engine;
+
+extern std::vector<MoveList> mls;
+
+// Number of routes kept by the pathfinder (ROUTE_CACHE_SIZE)
+static const int RouteCacheSize = 32;
+
+// Room with a vertical wall, which has a single gap at the bottom,
+// so that any route across the wall has to go around it
+class RouteCache : public ::testing::Test {
+protected:
+    void SetUp() override {
+        mls.resize(2);
+        RouteFinder::init_pathfinder();
+        RouteFinder::set_route_move_speed(2, 2);
+        Mask.reset(BitmapHelper::CreateBitmap(200, 100, 8));
+        Mask->Clear(1);
+        Mask->FillRect(Rect(100, 0, 101, 89), 0);
+        RouteFinder::set_wallscreen_version(1);
+    }
+
+    void TearDown() override {
+        RouteFinder::shutdown_pathfinder();
+        Mask.reset();
+    }
+
+    // Finds the route, returns the number of nodes searched for it;
+    // if the route was taken from the cache, then no nodes are searched
+    size_t FindRoute(int srcx, int srcy, int dstx, int dsty) {
+        RouteFinder::get_search_nodes(true);
+        EXPECT_EQ(1, RouteFinder::find_route(srcx, srcy, dstx, dsty, Mask.get(), 1));
+        return RouteFinder::get_search_nodes(false);
+    }
+
+    // Gets the lowest point of the found route
+    static int GetRouteMaxY() {
+        int max_y = 0;
+        for (int i = 0; i < mls[1].numstage; ++i)
+            max_y = std::max(max_y, mls[1].pos[i] & 0xFFFF);
+        return max_y;
+    }
+
+    // Moves the gap in the wall to the top
+    void MoveGap() {
+        Mask->FillRect(Rect(100, 0, 101, 99), 0);
+        Mask->FillRect(Rect(100, 0, 101, 9), 1);
+    }
+
+    std::unique_ptr<Bitmap> Mask;
+};
+
+TEST_F(RouteCache, Hit) {
+    ASSERT_GT(FindRoute(20, 10, 180, 10), 0u);
+    const int stages = mls[1].numstage;
+    ASSERT_GE(stages, 3);
+    // Same route
+    EXPECT_EQ(0u, FindRoute(20, 10, 180, 10));
+    EXPECT_EQ(stages, mls[1].numstage);
+    // Nearby points, the route's ends are moved to them
+    EXPECT_EQ(0u, FindRoute(21, 11, 181, 12));
+    EXPECT_EQ(stages, mls[1].numstage);
+    EXPECT_EQ((21 << 16) | 11, mls[1].pos[0]);
+    EXPECT_EQ((181 << 16) | 12, mls[1].pos[stages - 1]);
+    // Far points
+    EXPECT_GT(FindRoute(20, 50, 180, 10), 0u);
+}
+
+TEST_F(RouteCache, InvalidatedByVersion) {
+    ASSERT_GT(FindRoute(20, 10, 180, 10), 0u);
+    EXPECT_GT(GetRouteMaxY(), 89);
+    // Changed mask with a new version
+    MoveGap();
+    RouteFinder::set_wallscreen_version(2);
+    EXPECT_GT(FindRoute(20, 10, 180, 10), 0u);
+    EXPECT_LT(GetRouteMaxY(), 50);
+    EXPECT_EQ(0u, FindRoute(20, 10, 180, 10));
+}
+
+TEST_F(RouteCache, InvalidatedByContents) {
+    // Without the version, the mask contents are compared
+    RouteFinder::set_wallscreen_version(0);
+    ASSERT_GT(FindRoute(20, 10, 180, 10), 0u);
+    EXPECT_EQ(0u, FindRoute(20, 10, 180, 10));
+    MoveGap();
+    EXPECT_GT(FindRoute(20, 10, 180, 10), 0u);
+    EXPECT_LT(GetRouteMaxY(), 50);
+    EXPECT_EQ(0u, FindRoute(20, 10, 180, 10));
+}
+
+TEST_F(RouteCache, Eviction) {
+    // Routes to the different cells across the wall
+    auto find_other_route = [this](int i) {
+        return FindRoute(20, 10, 130 + (i % 8) * 8, 36 + (i / 8) * 8);
+    };
+
+    ASSERT_GT(FindRoute(20, 10, 180, 10), 0u);
+    for (int i = 0; i < RouteCacheSize - 1; ++i)
+        ASSERT_GT(find_other_route(i), 0u) << "route " << i;
+    // The cache is full now; using the first route makes it the most recent,
+    // so the next new route replaces the least recently used one instead
+    EXPECT_EQ(0u, FindRoute(20, 10, 180, 10));
+    ASSERT_GT(find_other_route(RouteCacheSize - 1), 0u);
+    EXPECT_EQ(0u, FindRoute(20, 10, 180, 10));
+    EXPECT_GT(find_other_route(0), 0u); // replaces route 1
+    // Using all the other routes makes the first route the least recent
+    EXPECT_EQ(0u, find_other_route(0));
+    for (int i = 2; i < RouteCacheSize; ++i)
+        ASSERT_EQ(0u, find_other_route(i)) << "route " << i;
+    EXPECT_GT(FindRoute(20, 50, 180, 50), 0u);
+    EXPECT_GT(FindRoute(20, 10, 180, 10), 0u);
+}
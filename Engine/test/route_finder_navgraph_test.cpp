@@ -0,0 +1,105 @@
+#include <vector>
+#include "gtest/gtest.h"
+#include "ac/route_finder_navgraph.h"
+
+using namespace AGS::Engine::RouteFinder;
+
+// Walkable mask, where zero pixels are walls
+class TestMask
+{
+public:
+    TestMask(int width, int height)
+        : _width(width), _height(height), _data(width * height, 1) {}
+
+    void FillRect(int x1, int y1, int x2, int y2, uint8_t value)
+    {
+        for (int y = y1; y <= y2; ++y)
+            for (int x = x1; x <= x2; ++x)
+                _data[y * _width + x] = value;
+    }
+
+    void Assign(NavGraph &graph)
+    {
+        std::vector<const uint8_t*> rows(_height);
+        for (int y = 0; y < _height; ++y)
+            rows[y] = &_data[y * _width];
+        graph.SetMask(_width, _height, rows.data());
+    }
+
+private:
+    int _width, _height;
+    std::vector<uint8_t> _data;
+};
+
+static void Unpack(int sq, int &x, int &y)
+{
+    x = sq & 0xFFFF;
+    y = sq >> 16;
+}
+
+TEST(NavGraph, LocalRoute) {
+    NavGraph graph(8);
+    TestMask mask(32, 32);
+    mask.Assign(graph);
+    std::vector<int> waypoints;
+    // Both points in the same cluster, nothing for the graph to do
+    ASSERT_FALSE(graph.FindWaypoints(1, 1, 6, 6, waypoints));
+    ASSERT_TRUE(waypoints.empty());
+    ASSERT_TRUE(graph.FindWaypoints(1, 1, 30, 30, waypoints));
+    ASSERT_GE(waypoints.size(), 2u);
+    ASSERT_EQ(waypoints.front(), (1 << 16) | 1);
+    ASSERT_EQ(waypoints.back(), (30 << 16) | 30);
+}
+
+TEST(NavGraph, RouteThroughGap) {
+    NavGraph graph(8);
+    TestMask mask(32, 32);
+    // Vertical wall with a single gap near the bottom
+    mask.FillRect(16, 0, 17, 31, 0);
+    mask.FillRect(16, 28, 17, 29, 1);
+    mask.Assign(graph);
+    ASSERT_GT(graph.GetNodeCount(), 0u);
+    std::vector<int> waypoints;
+    ASSERT_TRUE(graph.FindWaypoints(2, 2, 29, 2, waypoints));
+    bool through_gap = false;
+    for (int sq : waypoints)
+    {
+        int x, y;
+        Unpack(sq, x, y);
+        ASSERT_FALSE(x >= 16 && x <= 17 && (y < 28 || y > 29)); // never inside the wall
+        through_gap |= (x >= 16 && x <= 17);
+    }
+    ASSERT_TRUE(through_gap);
+}
+
+TEST(NavGraph, SameClusterDisconnected) {
+    NavGraph graph(16);
+    TestMask mask(32, 32);
+    // Wall splits the first cluster; the way around goes through the others
+    mask.FillRect(8, 0, 8, 15, 0);
+    mask.Assign(graph);
+    std::vector<int> waypoints;
+    ASSERT_TRUE(graph.FindWaypoints(2, 2, 12, 2, waypoints));
+    bool leaves_cluster = false;
+    for (int sq : waypoints)
+    {
+        int x, y;
+        Unpack(sq, x, y);
+        leaves_cluster |= (x >= 16 || y >= 16);
+    }
+    ASSERT_TRUE(leaves_cluster);
+}
+
+TEST(NavGraph, Unreachable) {
+    NavGraph graph(8);
+    TestMask mask(32, 32);
+    mask.FillRect(16, 0, 16, 31, 0);
+    mask.Assign(graph);
+    std::vector<int> waypoints;
+    ASSERT_FALSE(graph.FindWaypoints(2, 2, 29, 2, waypoints)); // walled off
+    ASSERT_FALSE(graph.FindWaypoints(16, 2, 2, 2, waypoints)); // start in the wall
+    ASSERT_FALSE(graph.FindWaypoints(2, 2, 40, 2, waypoints)); // end out of mask
+    graph.Clear();
+    ASSERT_TRUE(graph.IsEmpty());
+    ASSERT_FALSE(graph.FindWaypoints(2, 2, 12, 2, waypoints));
+}